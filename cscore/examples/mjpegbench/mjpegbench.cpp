@@ -0,0 +1,141 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+// Measures MJPEG server CPU usage per streaming viewer, to compare the
+// thread-per-connection server with the event loop server.
+//
+// Usage: mjpegbench [threads|loop] [viewers] [seconds]
+//
+// CPU usage is measured for the server process only (the viewers run in a
+// forked child), first with no viewers and then with all viewers streaming.
+// Frames are 640x480 at 30 fps from a CvSource, so each frame is encoded
+// once regardless of the number of viewers.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+int main() {
+  std::fputs("not supported on Windows\n", stderr);
+  return 1;
+}
+#else
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "cscore.h"
+
+static constexpr int kPort = 8090;
+
+static double CpuSeconds() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// Connects the viewers after delay seconds and reads streams for seconds.
+static int RunViewers(int viewers, int delay, int seconds) {
+  std::this_thread::sleep_for(std::chrono::seconds(delay));
+
+  static const char request[] = "GET /stream.mjpg HTTP/1.0\r\n\r\n";
+  std::vector<pollfd> fds;
+  for (int i = 0; i < viewers; ++i) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        write(fd, request, sizeof(request) - 1) < 0) {
+      std::perror("viewer connect");
+      return 1;
+    }
+    fds.push_back(pollfd{fd, POLLIN, 0});
+  }
+
+  static char buf[65536];
+  uint64_t bytes = 0;
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+  while (std::chrono::steady_clock::now() < end) {
+    if (poll(fds.data(), fds.size(), 100) <= 0) continue;
+    for (auto& pfd : fds) {
+      if (!(pfd.revents & POLLIN)) continue;
+      ssize_t n = read(pfd.fd, buf, sizeof(buf));
+      if (n > 0) bytes += n;
+    }
+  }
+  std::printf("viewers received %.1f MB/s\n", bytes / 1e6 / seconds);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  bool loop = argc > 1 && std::strcmp(argv[1], "loop") == 0;
+  int viewers = argc > 2 ? std::atoi(argv[2]) : 10;
+  int seconds = argc > 3 ? std::atoi(argv[3]) : 10;
+
+  // Fork the viewers before starting any cscore threads
+  pid_t pid = fork();
+  if (pid == 0) return RunViewers(viewers, seconds + 2, seconds + 1);
+
+  cs::SetMjpegServerEventLoop(loop);
+  cs::CvSource source{"source", cs::VideoMode::kMJPEG, 640, 480, 30};
+  cs::MjpegServer server{"server", kPort};
+  server.SetSource(source);
+
+  std::atomic_bool done{false};
+  std::thread feeder([&] {
+    cv::Mat image{480, 640, CV_8UC3};
+    for (int i = 0; !done; ++i) {
+      image.setTo(cv::Scalar(i % 256, 128, 255 - i % 256));
+      source.PutFrame(image);
+      std::this_thread::sleep_for(std::chrono::milliseconds(33));
+    }
+  });
+
+  // Baseline with no viewers
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  double start = CpuSeconds();
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  double base = (CpuSeconds() - start) / seconds;
+
+  // With viewers (connected at seconds + 2)
+  std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+  start = CpuSeconds();
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  double total = (CpuSeconds() - start) / seconds;
+
+  done = true;
+  feeder.join();
+  int status;
+  waitpid(pid, &status, 0);
+
+  std::printf("%s: %d viewers\n", loop ? "loop" : "threads", viewers);
+  std::printf("CPU %.1f%% with no viewers, %.1f%% with viewers\n",
+              base * 100, total * 100);
+  if (viewers > 0)
+    std::printf("CPU per viewer %.2f%%\n", (total - base) * 100 / viewers);
+  return 0;
+}
+
+#endif  // _WIN32
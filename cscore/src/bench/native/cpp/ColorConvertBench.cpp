@@ -0,0 +1,94 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+// Compares the Frame color conversions against the OpenCV conversions they
+// replaced, for each implementation supported by this CPU.
+//
+// Usage: cscoreBench [width] [height] [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "ColorConvert.h"
+
+using namespace cs;
+
+struct Conversion {
+  const char* name;
+  int inType;
+  int outType;
+  int code;
+  void (*func)(const uint8_t* in, uint8_t* out, size_t pixels);
+};
+
+static const Conversion kConversions[] = {
+    {"YUYVToBGR", CV_8UC2, CV_8UC3, cv::COLOR_YUV2BGR_YUYV, YUYVToBGR},
+    {"YUYVToGray", CV_8UC2, CV_8UC1, -1, YUYVToGray},
+    {"BGRToGray", CV_8UC3, CV_8UC1, cv::COLOR_BGR2GRAY, BGRToGray},
+    {"BGRToRGB565", CV_8UC3, CV_8UC2, cv::COLOR_RGB2BGR565, BGRToRGB565},
+    {"RGB565ToBGR", CV_8UC2, CV_8UC3, cv::COLOR_BGR5652RGB, RGB565ToBGR},
+    {"GrayToBGR", CV_8UC1, CV_8UC3, cv::COLOR_GRAY2BGR, GrayToBGR}};
+
+// Returns the average time per frame in microseconds.
+static double Time(int frames, const std::function<void()>& func) {
+  func();  // warm up
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; ++i) func();
+  std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / frames;
+}
+
+int main(int argc, char** argv) {
+  int width = argc > 1 ? std::atoi(argv[1]) : 640;
+  int height = argc > 2 ? std::atoi(argv[2]) : 480;
+  int frames = argc > 3 ? std::atoi(argv[3]) : 1000;
+
+  std::printf("%dx%d, %d frames, default implementation %s\n", width, height,
+              frames, GetColorConvertImplName(GetColorConvertImpl()));
+  std::printf("%-12s %-8s %10s %8s\n", "conversion", "impl", "us/frame",
+              "speedup");
+
+  static const ColorConvertImpl kImpls[] = {
+      kColorConvertScalar, kColorConvertSSE41, kColorConvertAVX2,
+      kColorConvertNEON};
+  auto defaultImpl = GetColorConvertImpl();
+
+  for (auto&& conv : kConversions) {
+    cv::Mat in{height, width, conv.inType};
+    cv::randu(in, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat out{height, width, conv.outType};
+
+    // YUYV to gray previously went through BGR
+    double cvTime = Time(frames, [&] {
+      if (conv.code >= 0) {
+        cv::cvtColor(in, out, conv.code);
+      } else {
+        cv::Mat bgr;
+        cv::cvtColor(in, bgr, cv::COLOR_YUV2BGR_YUYV);
+        cv::cvtColor(bgr, out, cv::COLOR_BGR2GRAY);
+      }
+    });
+    std::printf("%-12s %-8s %10.1f %8s\n", conv.name, "OpenCV", cvTime, "");
+
+    for (auto impl : kImpls) {
+      if (!SetColorConvertImpl(impl)) continue;
+      double t = Time(frames, [&] {
+        conv.func(in.ptr<uint8_t>(), out.ptr<uint8_t>(), in.total());
+      });
+      std::printf("%-12s %-8s %10.1f %7.2fx\n", conv.name,
+                  GetColorConvertImplName(impl), t, cvTime / t);
+    }
+    SetColorConvertImpl(defaultImpl);
+  }
+  return 0;
+}
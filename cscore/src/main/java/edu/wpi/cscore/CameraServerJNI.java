@@ -160,6 +160,7 @@ public class CameraServerJNI {
   //
   public static native String getMjpegServerListenAddress(int sink);
   public static native int getMjpegServerPort(int sink);
+  public static native void setMjpegServerEventLoop(boolean enabled);
 
   //
   // OpenCV Sink Functions
@@ -167,6 +168,7 @@ public class CameraServerJNI {
   public static native void setSinkDescription(int sink, String description);
   public static native long grabSinkFrame(int sink, long imageNativeObj);
   public static native long grabSinkFrameTimeout(int sink, long imageNativeObj, double timeout);
+  public static native long getSinkLastFrameCaptureTime(int sink);
   public static native String getSinkError(int sink);
   public static native void setSinkEnabled(int sink, boolean enabled);
 
@@ -81,6 +81,18 @@ public class CvSink extends VideoSink {
     return CameraServerJNI.grabSinkFrame(m_handle, image.nativeObj);
   }
 
+  /**
+   * Get the time the frame last returned by grabFrame() was captured.  For
+   * cameras that provide hardware timestamps, this is earlier than the
+   * frame time returned by grabFrame() by the capture and driver latency;
+   * otherwise it's the same.
+   *
+   * @return Capture time, in 1 us increments
+   */
+  public long getLastFrameCaptureTime() {
+    return CameraServerJNI.getSinkLastFrameCaptureTime(m_handle);
+  }
+
   /**
    * Get error string.  Call this if WaitForFrame() returns 0 to determine
    * what the error is.
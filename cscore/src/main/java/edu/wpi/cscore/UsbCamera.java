@@ -63,4 +63,17 @@ public class UsbCamera extends VideoCamera {
     CameraServerJNI.setProperty(CameraServerJNI.getSourceProperty(m_handle, "connect_verbose"),
                                 level);
   }
+
+  /**
+   * Set whether frames reference the camera driver's buffers directly
+   * rather than copying them.  This avoids a copy of every frame, but more
+   * driver buffers are used, and frames are copied again if too many are
+   * held at once.  Changing this reconnects to the camera.
+   *
+   * @param enabled true to enable zero-copy frames
+   */
+  public void setZeroCopy(boolean enabled) {
+    CameraServerJNI.setProperty(CameraServerJNI.getSourceProperty(m_handle, "zero_copy"),
+                                enabled ? 1 : 0);
+  }
 }
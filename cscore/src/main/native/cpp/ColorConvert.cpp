@@ -0,0 +1,832 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include "ColorConvert.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define CSCORE_COLORCONVERT_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CSCORE_COLORCONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang require functions using instructions beyond the compiler's
+// baseline to be marked; MSVC allows them anywhere.
+#ifdef __GNUC__
+#define CS_TARGET(x) __attribute__((target(x)))
+#else
+#define CS_TARGET(x)
+#endif
+
+using namespace cs;
+
+namespace {
+
+// ITU-R BT.601 YUV to RGB, in 20 bit fixed point (as used by OpenCV)
+constexpr int kShift = 20;
+constexpr int kRound = 1 << (kShift - 1);
+constexpr int kCY = 1220542;
+constexpr int kCUB = 2116026;
+constexpr int kCUG = -409993;
+constexpr int kCVG = -852492;
+constexpr int kCVR = 1673527;
+
+// RGB to gray, in 14 bit fixed point (as used by OpenCV)
+constexpr int kGrayShift = 14;
+constexpr int kGrayRound = 1 << (kGrayShift - 1);
+constexpr int kGrayB = 1868;
+constexpr int kGrayG = 9617;
+constexpr int kGrayR = 4899;
+
+// Y to gray.  For Y - 16 in [0, 239], (y * kYGrayMul + kYGrayRound) >> 14
+// is identical to (y * kCY + kRound) >> 20, but the constants fit in 16 bits.
+constexpr int kYGrayMul = 19070;
+constexpr int kYGrayRound = 8308;
+
+inline uint8_t Saturate(int v) { return v < 0 ? 0 : (v > 255 ? 255 : v); }
+
+struct Kernels {
+  void (*yuyvToBGR)(const uint8_t* in, uint8_t* out, size_t pixels);
+  void (*yuyvToGray)(const uint8_t* in, uint8_t* out, size_t pixels);
+  void (*bgrToGray)(const uint8_t* in, uint8_t* out, size_t pixels);
+  void (*bgrToRGB565)(const uint8_t* in, uint8_t* out, size_t pixels);
+  void (*rgb565ToBGR)(const uint8_t* in, uint8_t* out, size_t pixels);
+  void (*grayToBGR)(const uint8_t* in, uint8_t* out, size_t pixels);
+  // ColorConversion bits for the kernels measured faster than cvtColor()
+  unsigned int faster;
+};
+
+//
+// Scalar implementations.  These are the reference for the others, and also
+// convert the pixels left over after their vector loops.
+//
+
+void YUYVToBGRScalar(const uint8_t* in, uint8_t* out, size_t pixels) {
+  for (size_t i = 0; i + 1 < pixels; i += 2, in += 4, out += 6) {
+    int u = in[1] - 128;
+    int v = in[3] - 128;
+    int ruv = kRound + kCVR * v;
+    int guv = kRound + kCVG * v + kCUG * u;
+    int buv = kRound + kCUB * u;
+    int y0 = std::max(0, in[0] - 16) * kCY;
+    int y1 = std::max(0, in[2] - 16) * kCY;
+    out[0] = Saturate((y0 + buv) >> kShift);
+    out[1] = Saturate((y0 + guv) >> kShift);
+    out[2] = Saturate((y0 + ruv) >> kShift);
+    out[3] = Saturate((y1 + buv) >> kShift);
+    out[4] = Saturate((y1 + guv) >> kShift);
+    out[5] = Saturate((y1 + ruv) >> kShift);
+  }
+}
+
+void YUYVToGrayScalar(const uint8_t* in, uint8_t* out, size_t pixels) {
+  for (size_t i = 0; i < pixels; ++i, in += 2, ++out) {
+    int y = std::max(0, in[0] - 16);
+    *out = Saturate((y * kYGrayMul + kYGrayRound) >> kGrayShift);
+  }
+}
+
+void BGRToGrayScalar(const uint8_t* in, uint8_t* out, size_t pixels) {
+  for (size_t i = 0; i < pixels; ++i, in += 3, ++out) {
+    *out = (in[0] * kGrayB + in[1] * kGrayG + in[2] * kGrayR + kGrayRound) >>
+           kGrayShift;
+  }
+}
+
+// Red is in the low bits (COLOR_RGB2BGR565 applied to BGR data).
+void BGRToRGB565Scalar(const uint8_t* in, uint8_t* out, size_t pixels) {
+  for (size_t i = 0; i < pixels; ++i, in += 3, out += 2) {
+    unsigned int v =
+        (in[2] >> 3) | ((in[1] & 0xfc) << 3) | ((in[0] & 0xf8) << 8);
+    out[0] = v & 0xff;
+    out[1] = v >> 8;
+  }
+}
+
+void RGB565ToBGRScalar(const uint8_t* in, uint8_t* out, size_t pixels) {
+  for (size_t i = 0; i < pixels; ++i, in += 2, out += 3) {
+    unsigned int v = in[0] | (in[1] << 8);
+    out[0] = (v >> 8) & 0xf8;
+    out[1] = (v >> 3) & 0xfc;
+    out[2] = (v << 3) & 0xf8;
+  }
+}
+
+void GrayToBGRScalar(const uint8_t* in, uint8_t* out, size_t pixels) {
+  for (size_t i = 0; i < pixels; ++i, ++in, out += 3) {
+    out[0] = *in;
+    out[1] = *in;
+    out[2] = *in;
+  }
+}
+
+const Kernels kScalarKernels = {YUYVToBGRScalar,   YUYVToGrayScalar,
+                                BGRToGrayScalar,   BGRToRGB565Scalar,
+                                RGB565ToBGRScalar, GrayToBGRScalar,
+                                0};
+
+#ifdef CSCORE_COLORCONVERT_X86
+
+//
+// SSE4.1 implementations (16 pixels at a time).  SSSE3 byte shuffles are
+// used to convert between packed BGR and separate B, G, and R vectors.
+//
+
+// Shuffles gathering channel c of 16 BGR pixels from each of the 3 vectors
+// they span: [c][vector]
+alignas(16) const uint8_t kDeinterleaveBGR[3][3][16] = {
+    {{0, 3, 6, 9, 12, 15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+      0x80},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 2, 5, 8, 11, 14, 0x80, 0x80, 0x80,
+      0x80, 0x80},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 1, 4, 7,
+      10, 13}},
+    {{1, 4, 7, 10, 13, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+      0x80, 0x80},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0, 3, 6, 9, 12, 15, 0x80, 0x80, 0x80, 0x80,
+      0x80},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 2, 5, 8,
+      11, 14}},
+    {{2, 5, 8, 11, 14, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+      0x80, 0x80},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 1, 4, 7, 10, 13, 0x80, 0x80, 0x80, 0x80,
+      0x80, 0x80},
+     {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0, 3, 6, 9,
+      12, 15}}};
+
+// Shuffles scattering channel c of 16 pixels into each of the 3 vectors of
+// packed BGR: [vector][c]
+alignas(16) const uint8_t kInterleaveBGR[3][3][16] = {
+    {{0, 0x80, 0x80, 1, 0x80, 0x80, 2, 0x80, 0x80, 3, 0x80, 0x80, 4, 0x80, 0x80,
+      5},
+     {0x80, 0, 0x80, 0x80, 1, 0x80, 0x80, 2, 0x80, 0x80, 3, 0x80, 0x80, 4, 0x80,
+      0x80},
+     {0x80, 0x80, 0, 0x80, 0x80, 1, 0x80, 0x80, 2, 0x80, 0x80, 3, 0x80, 0x80, 4,
+      0x80}},
+    {{0x80, 0x80, 6, 0x80, 0x80, 7, 0x80, 0x80, 8, 0x80, 0x80, 9, 0x80, 0x80,
+      10, 0x80},
+     {5, 0x80, 0x80, 6, 0x80, 0x80, 7, 0x80, 0x80, 8, 0x80, 0x80, 9, 0x80, 0x80,
+      10},
+     {0x80, 5, 0x80, 0x80, 6, 0x80, 0x80, 7, 0x80, 0x80, 8, 0x80, 0x80, 9, 0x80,
+      0x80}},
+    {{0x80, 11, 0x80, 0x80, 12, 0x80, 0x80, 13, 0x80, 0x80, 14, 0x80, 0x80, 15,
+      0x80, 0x80},
+     {0x80, 0x80, 11, 0x80, 0x80, 12, 0x80, 0x80, 13, 0x80, 0x80, 14, 0x80,
+      0x80, 15, 0x80},
+     {10, 0x80, 0x80, 11, 0x80, 0x80, 12, 0x80, 0x80, 13, 0x80, 0x80, 14, 0x80,
+      0x80, 15}}};
+
+CS_TARGET("sse4.1")
+inline __m128i Load(const uint8_t* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+CS_TARGET("sse4.1")
+inline void Store(uint8_t* p, __m128i v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+CS_TARGET("sse4.1")
+inline __m128i Shuffle(__m128i v, const uint8_t* mask) {
+  return _mm_shuffle_epi8(
+      v, _mm_load_si128(reinterpret_cast<const __m128i*>(mask)));
+}
+
+// Loads 16 BGR pixels as separate channels.
+CS_TARGET("sse4.1")
+inline void LoadBGR(const uint8_t* in, __m128i* b, __m128i* g, __m128i* r) {
+  __m128i s0 = Load(in);
+  __m128i s1 = Load(in + 16);
+  __m128i s2 = Load(in + 32);
+  __m128i* channels[3] = {b, g, r};
+  for (int c = 0; c < 3; ++c) {
+    *channels[c] =
+        _mm_or_si128(_mm_or_si128(Shuffle(s0, kDeinterleaveBGR[c][0]),
+                                  Shuffle(s1, kDeinterleaveBGR[c][1])),
+                     Shuffle(s2, kDeinterleaveBGR[c][2]));
+  }
+}
+
+// Stores 16 BGR pixels from separate channels.
+CS_TARGET("sse4.1")
+inline void StoreBGR(uint8_t* out, __m128i b, __m128i g, __m128i r) {
+  for (int i = 0; i < 3; ++i) {
+    Store(out + 16 * i,
+          _mm_or_si128(_mm_or_si128(Shuffle(b, kInterleaveBGR[i][0]),
+                                    Shuffle(g, kInterleaveBGR[i][1])),
+                       Shuffle(r, kInterleaveBGR[i][2])));
+  }
+}
+
+// Applies a U/V term (one per pair of pixels) to 8 scaled Y values, giving
+// 8 saturated 16-bit channel values.
+CS_TARGET("sse4.1")
+inline __m128i YUVChannel(__m128i y0, __m128i y1, __m128i uv) {
+  __m128i lo = _mm_srai_epi32(_mm_add_epi32(y0, _mm_unpacklo_epi32(uv, uv)),
+                              kShift);
+  __m128i hi = _mm_srai_epi32(_mm_add_epi32(y1, _mm_unpackhi_epi32(uv, uv)),
+                              kShift);
+  return _mm_packs_epi32(lo, hi);
+}
+
+// Converts 8 YUYV pixels to 16-bit B, G, and R values.
+CS_TARGET("sse4.1")
+inline void YUYVToBGR8(__m128i s, __m128i* b, __m128i* g, __m128i* r) {
+  // Y values less the 16 offset, as 32 bits scaled
+  __m128i y = _mm_subs_epu16(_mm_and_si128(s, _mm_set1_epi16(0xff)),
+                             _mm_set1_epi16(16));
+  __m128i y0 = _mm_mullo_epi32(_mm_unpacklo_epi16(y, _mm_setzero_si128()),
+                               _mm_set1_epi32(kCY));
+  __m128i y1 = _mm_mullo_epi32(_mm_unpackhi_epi16(y, _mm_setzero_si128()),
+                               _mm_set1_epi32(kCY));
+
+  // Each 32 bits of uv holds the U (low) and V (high) of a pair of pixels
+  __m128i uv = _mm_sub_epi16(_mm_srli_epi16(s, 8), _mm_set1_epi16(128));
+  __m128i u = _mm_srai_epi32(_mm_slli_epi32(uv, 16), 16);
+  __m128i v = _mm_srai_epi32(uv, 16);
+  __m128i round = _mm_set1_epi32(kRound);
+  __m128i ruv = _mm_add_epi32(round, _mm_mullo_epi32(v, _mm_set1_epi32(kCVR)));
+  __m128i guv = _mm_add_epi32(
+      _mm_add_epi32(round, _mm_mullo_epi32(v, _mm_set1_epi32(kCVG))),
+      _mm_mullo_epi32(u, _mm_set1_epi32(kCUG)));
+  __m128i buv = _mm_add_epi32(round, _mm_mullo_epi32(u, _mm_set1_epi32(kCUB)));
+
+  *b = YUVChannel(y0, y1, buv);
+  *g = YUVChannel(y0, y1, guv);
+  *r = YUVChannel(y0, y1, ruv);
+}
+
+CS_TARGET("sse4.1")
+void YUYVToBGRSSE41(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 32, out += 48) {
+    __m128i b0, g0, r0, b1, g1, r1;
+    YUYVToBGR8(Load(in), &b0, &g0, &r0);
+    YUYVToBGR8(Load(in + 16), &b1, &g1, &r1);
+    StoreBGR(out, _mm_packus_epi16(b0, b1), _mm_packus_epi16(g0, g1),
+             _mm_packus_epi16(r0, r1));
+  }
+  YUYVToBGRScalar(in, out, pixels - i);
+}
+
+// Converts 8 Y values (16 bits, less the 16 offset) to 16-bit gray values.
+CS_TARGET("sse4.1")
+inline __m128i YToGray8(__m128i y) {
+  // madd with pairs of (y, 1) and (kYGrayMul, kYGrayRound)
+  __m128i one = _mm_set1_epi16(1);
+  __m128i coeffs = _mm_set1_epi32(kYGrayMul | (kYGrayRound << 16));
+  __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(y, one), coeffs);
+  __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(y, one), coeffs);
+  return _mm_packs_epi32(_mm_srai_epi32(lo, kGrayShift),
+                         _mm_srai_epi32(hi, kGrayShift));
+}
+
+CS_TARGET("sse4.1")
+void YUYVToGraySSE41(const uint8_t* in, uint8_t* out, size_t pixels) {
+  __m128i mask = _mm_set1_epi16(0xff);
+  __m128i offset = _mm_set1_epi16(16);
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 32, out += 16) {
+    __m128i y0 = _mm_subs_epu16(_mm_and_si128(Load(in), mask), offset);
+    __m128i y1 = _mm_subs_epu16(_mm_and_si128(Load(in + 16), mask), offset);
+    Store(out, _mm_packus_epi16(YToGray8(y0), YToGray8(y1)));
+  }
+  YUYVToGrayScalar(in, out, pixels - i);
+}
+
+// Converts 8 pixels of 16-bit B, G, and R values to 16-bit gray values.
+CS_TARGET("sse4.1")
+inline __m128i BGRToGray8(__m128i b, __m128i g, __m128i r) {
+  // madd with pairs of (b, g) and (r, 1)
+  __m128i one = _mm_set1_epi16(1);
+  __m128i bgCoeffs = _mm_set1_epi32(kGrayB | (kGrayG << 16));
+  __m128i rCoeffs = _mm_set1_epi32(kGrayR | (kGrayRound << 16));
+  __m128i lo =
+      _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(b, g), bgCoeffs),
+                    _mm_madd_epi16(_mm_unpacklo_epi16(r, one), rCoeffs));
+  __m128i hi =
+      _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(b, g), bgCoeffs),
+                    _mm_madd_epi16(_mm_unpackhi_epi16(r, one), rCoeffs));
+  return _mm_packs_epi32(_mm_srli_epi32(lo, kGrayShift),
+                         _mm_srli_epi32(hi, kGrayShift));
+}
+
+CS_TARGET("sse4.1")
+void BGRToGraySSE41(const uint8_t* in, uint8_t* out, size_t pixels) {
+  __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 48, out += 16) {
+    __m128i b, g, r;
+    LoadBGR(in, &b, &g, &r);
+    __m128i lo = BGRToGray8(_mm_unpacklo_epi8(b, zero),
+                            _mm_unpacklo_epi8(g, zero),
+                            _mm_unpacklo_epi8(r, zero));
+    __m128i hi = BGRToGray8(_mm_unpackhi_epi8(b, zero),
+                            _mm_unpackhi_epi8(g, zero),
+                            _mm_unpackhi_epi8(r, zero));
+    Store(out, _mm_packus_epi16(lo, hi));
+  }
+  BGRToGrayScalar(in, out, pixels - i);
+}
+
+CS_TARGET("sse4.1")
+void BGRToRGB565SSE41(const uint8_t* in, uint8_t* out, size_t pixels) {
+  __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 48, out += 32) {
+    __m128i b, g, r;
+    LoadBGR(in, &b, &g, &r);
+    b = _mm_and_si128(b, _mm_set1_epi8(static_cast<char>(0xf8)));
+    g = _mm_and_si128(g, _mm_set1_epi8(static_cast<char>(0xfc)));
+    // r >> 3 (there is no 8-bit shift; the 16-bit shift is masked)
+    r = _mm_and_si128(_mm_srli_epi16(r, 3), _mm_set1_epi8(0x1f));
+    Store(out,
+          _mm_or_si128(_mm_unpacklo_epi8(r, b),
+                       _mm_slli_epi16(_mm_unpacklo_epi8(g, zero), 3)));
+    Store(out + 16,
+          _mm_or_si128(_mm_unpackhi_epi8(r, b),
+                       _mm_slli_epi16(_mm_unpackhi_epi8(g, zero), 3)));
+  }
+  BGRToRGB565Scalar(in, out, pixels - i);
+}
+
+// Converts 8 RGB565 pixels to 16-bit B, G, and R values.
+CS_TARGET("sse4.1")
+inline void RGB565ToBGR8(__m128i v, __m128i* b, __m128i* g, __m128i* r) {
+  *b = _mm_and_si128(_mm_srli_epi16(v, 8), _mm_set1_epi16(0xf8));
+  *g = _mm_and_si128(_mm_srli_epi16(v, 3), _mm_set1_epi16(0xfc));
+  *r = _mm_and_si128(_mm_slli_epi16(v, 3), _mm_set1_epi16(0xf8));
+}
+
+CS_TARGET("sse4.1")
+void RGB565ToBGRSSE41(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 32, out += 48) {
+    __m128i b0, g0, r0, b1, g1, r1;
+    RGB565ToBGR8(Load(in), &b0, &g0, &r0);
+    RGB565ToBGR8(Load(in + 16), &b1, &g1, &r1);
+    StoreBGR(out, _mm_packus_epi16(b0, b1), _mm_packus_epi16(g0, g1),
+             _mm_packus_epi16(r0, r1));
+  }
+  RGB565ToBGRScalar(in, out, pixels - i);
+}
+
+CS_TARGET("sse4.1")
+void GrayToBGRSSE41(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 16, out += 48) {
+    __m128i v = Load(in);
+    StoreBGR(out, v, v, v);
+  }
+  GrayToBGRScalar(in, out, pixels - i);
+}
+
+const Kernels kSSE41Kernels = {
+    YUYVToBGRSSE41,   YUYVToGraySSE41,
+    BGRToGraySSE41,   BGRToRGB565SSE41,
+    RGB565ToBGRSSE41, GrayToBGRSSE41,
+    kColorConvertYUYVToGray | kColorConvertBGRToGray};
+
+//
+// AVX2 implementations.  Only the arithmetic-heavy conversions benefit from
+// the wider vectors; the others are bound by the BGR shuffles, which don't
+// cross 128-bit lanes, so the SSE4.1 versions are used for them.
+//
+
+CS_TARGET("avx2")
+inline __m256i Load256(const uint8_t* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+// Packs 16 16-bit values to bytes (with unsigned saturation).
+CS_TARGET("avx2")
+inline __m128i PackBytes(__m256i v) {
+  return _mm_packus_epi16(_mm256_castsi256_si128(v),
+                          _mm256_extracti128_si256(v, 1));
+}
+
+// Same as YUVChannel(), for 16 pixels; the unpacks and packs operate within
+// 128-bit lanes, so the result is in pixel order.
+CS_TARGET("avx2")
+inline __m256i YUVChannel16(__m256i y0, __m256i y1, __m256i uv) {
+  __m256i lo = _mm256_srai_epi32(
+      _mm256_add_epi32(y0, _mm256_unpacklo_epi32(uv, uv)), kShift);
+  __m256i hi = _mm256_srai_epi32(
+      _mm256_add_epi32(y1, _mm256_unpackhi_epi32(uv, uv)), kShift);
+  return _mm256_packs_epi32(lo, hi);
+}
+
+CS_TARGET("avx2")
+void YUYVToBGRAVX2(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 32, out += 48) {
+    __m256i s = Load256(in);
+    __m256i y = _mm256_subs_epu16(_mm256_and_si256(s, _mm256_set1_epi16(0xff)),
+                                  _mm256_set1_epi16(16));
+    __m256i y0 =
+        _mm256_mullo_epi32(_mm256_unpacklo_epi16(y, _mm256_setzero_si256()),
+                           _mm256_set1_epi32(kCY));
+    __m256i y1 =
+        _mm256_mullo_epi32(_mm256_unpackhi_epi16(y, _mm256_setzero_si256()),
+                           _mm256_set1_epi32(kCY));
+
+    __m256i uv =
+        _mm256_sub_epi16(_mm256_srli_epi16(s, 8), _mm256_set1_epi16(128));
+    __m256i u = _mm256_srai_epi32(_mm256_slli_epi32(uv, 16), 16);
+    __m256i v = _mm256_srai_epi32(uv, 16);
+    __m256i round = _mm256_set1_epi32(kRound);
+    __m256i ruv = _mm256_add_epi32(
+        round, _mm256_mullo_epi32(v, _mm256_set1_epi32(kCVR)));
+    __m256i guv = _mm256_add_epi32(
+        _mm256_add_epi32(round,
+                         _mm256_mullo_epi32(v, _mm256_set1_epi32(kCVG))),
+        _mm256_mullo_epi32(u, _mm256_set1_epi32(kCUG)));
+    __m256i buv = _mm256_add_epi32(
+        round, _mm256_mullo_epi32(u, _mm256_set1_epi32(kCUB)));
+
+    StoreBGR(out, PackBytes(YUVChannel16(y0, y1, buv)),
+             PackBytes(YUVChannel16(y0, y1, guv)),
+             PackBytes(YUVChannel16(y0, y1, ruv)));
+  }
+  YUYVToBGRScalar(in, out, pixels - i);
+}
+
+CS_TARGET("avx2")
+void YUYVToGrayAVX2(const uint8_t* in, uint8_t* out, size_t pixels) {
+  __m256i mask = _mm256_set1_epi16(0xff);
+  __m256i offset = _mm256_set1_epi16(16);
+  __m256i one = _mm256_set1_epi16(1);
+  __m256i coeffs = _mm256_set1_epi32(kYGrayMul | (kYGrayRound << 16));
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 32, out += 16) {
+    __m256i y = _mm256_subs_epu16(_mm256_and_si256(Load256(in), mask), offset);
+    __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(y, one), coeffs);
+    __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(y, one), coeffs);
+    Store(out,
+          PackBytes(_mm256_packs_epi32(_mm256_srai_epi32(lo, kGrayShift),
+                                       _mm256_srai_epi32(hi, kGrayShift))));
+  }
+  YUYVToGrayScalar(in, out, pixels - i);
+}
+
+CS_TARGET("avx2")
+void BGRToGrayAVX2(const uint8_t* in, uint8_t* out, size_t pixels) {
+  __m256i one = _mm256_set1_epi16(1);
+  __m256i bgCoeffs = _mm256_set1_epi32(kGrayB | (kGrayG << 16));
+  __m256i rCoeffs = _mm256_set1_epi32(kGrayR | (kGrayRound << 16));
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 48, out += 16) {
+    __m128i b8, g8, r8;
+    LoadBGR(in, &b8, &g8, &r8);
+    __m256i b = _mm256_cvtepu8_epi16(b8);
+    __m256i g = _mm256_cvtepu8_epi16(g8);
+    __m256i r = _mm256_cvtepu8_epi16(r8);
+    __m256i lo = _mm256_add_epi32(
+        _mm256_madd_epi16(_mm256_unpacklo_epi16(b, g), bgCoeffs),
+        _mm256_madd_epi16(_mm256_unpacklo_epi16(r, one), rCoeffs));
+    __m256i hi = _mm256_add_epi32(
+        _mm256_madd_epi16(_mm256_unpackhi_epi16(b, g), bgCoeffs),
+        _mm256_madd_epi16(_mm256_unpackhi_epi16(r, one), rCoeffs));
+    Store(out,
+          PackBytes(_mm256_packs_epi32(_mm256_srli_epi32(lo, kGrayShift),
+                                       _mm256_srli_epi32(hi, kGrayShift))));
+  }
+  BGRToGrayScalar(in, out, pixels - i);
+}
+
+const Kernels kAVX2Kernels = {
+    YUYVToBGRAVX2,    YUYVToGrayAVX2,
+    BGRToGrayAVX2,    BGRToRGB565SSE41,
+    RGB565ToBGRSSE41, GrayToBGRSSE41,
+    kColorConvertYUYVToBGR | kColorConvertYUYVToGray | kColorConvertBGRToGray};
+
+bool HasSSE41() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 19)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+bool HasAVX2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  // OSXSAVE and AVX, and the OS saves the YMM registers
+  if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 ||
+      (_xgetbv(0) & 6) != 6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // CSCORE_COLORCONVERT_X86
+
+#ifdef CSCORE_COLORCONVERT_NEON
+
+//
+// NEON implementations (16 pixels at a time).  The structured loads and
+// stores convert between packed BGR and separate channels.
+//
+
+// Applies a U/V term (one per pair of pixels) to 4 pairs of scaled Y values,
+// giving 4 pairs of saturated channel values.
+inline uint8x8_t YUVChannel(int32x4_t y0lo, int32x4_t y0hi, int32x4_t y1lo,
+                            int32x4_t y1hi, int32x4_t uvlo, int32x4_t uvhi,
+                            uint8x8_t* odd) {
+  *odd = vqmovun_s16(
+      vcombine_s16(vqmovn_s32(vshrq_n_s32(vaddq_s32(y1lo, uvlo), kShift)),
+                   vqmovn_s32(vshrq_n_s32(vaddq_s32(y1hi, uvhi), kShift))));
+  return vqmovun_s16(
+      vcombine_s16(vqmovn_s32(vshrq_n_s32(vaddq_s32(y0lo, uvlo), kShift)),
+                   vqmovn_s32(vshrq_n_s32(vaddq_s32(y0hi, uvhi), kShift))));
+}
+
+// Interleaves even and odd pixel values.
+inline uint8x16_t Zip(uint8x8_t even, uint8x8_t odd) {
+  uint8x8x2_t z = vzip_u8(even, odd);
+  return vcombine_u8(z.val[0], z.val[1]);
+}
+
+// Scales 8 Y values (less the 16 offset) by kCY, as two sets of 4.
+inline void ScaleY(uint8x8_t y, int32x4_t* lo, int32x4_t* hi) {
+  uint16x8_t y16 = vmovl_u8(vqsub_u8(y, vdup_n_u8(16)));
+  *lo = vmulq_n_s32(vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(y16))), kCY);
+  *hi = vmulq_n_s32(vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(y16))), kCY);
+}
+
+void YUYVToBGRNEON(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 32, out += 48) {
+    // Y of even pixels, U, Y of odd pixels, V
+    uint8x8x4_t s = vld4_u8(in);
+    int32x4_t y0lo, y0hi, y1lo, y1hi;
+    ScaleY(s.val[0], &y0lo, &y0hi);
+    ScaleY(s.val[2], &y1lo, &y1hi);
+
+    int16x8_t u = vreinterpretq_s16_u16(vsubl_u8(s.val[1], vdup_n_u8(128)));
+    int16x8_t v = vreinterpretq_s16_u16(vsubl_u8(s.val[3], vdup_n_u8(128)));
+    int32x4_t ulo = vmovl_s16(vget_low_s16(u));
+    int32x4_t uhi = vmovl_s16(vget_high_s16(u));
+    int32x4_t vlo = vmovl_s16(vget_low_s16(v));
+    int32x4_t vhi = vmovl_s16(vget_high_s16(v));
+    int32x4_t round = vdupq_n_s32(kRound);
+    int32x4_t ruvlo = vmlaq_n_s32(round, vlo, kCVR);
+    int32x4_t ruvhi = vmlaq_n_s32(round, vhi, kCVR);
+    int32x4_t guvlo = vmlaq_n_s32(vmlaq_n_s32(round, vlo, kCVG), ulo, kCUG);
+    int32x4_t guvhi = vmlaq_n_s32(vmlaq_n_s32(round, vhi, kCVG), uhi, kCUG);
+    int32x4_t buvlo = vmlaq_n_s32(round, ulo, kCUB);
+    int32x4_t buvhi = vmlaq_n_s32(round, uhi, kCUB);
+
+    uint8x16x3_t bgr;
+    uint8x8_t odd;
+    uint8x8_t even = YUVChannel(y0lo, y0hi, y1lo, y1hi, buvlo, buvhi, &odd);
+    bgr.val[0] = Zip(even, odd);
+    even = YUVChannel(y0lo, y0hi, y1lo, y1hi, guvlo, guvhi, &odd);
+    bgr.val[1] = Zip(even, odd);
+    even = YUVChannel(y0lo, y0hi, y1lo, y1hi, ruvlo, ruvhi, &odd);
+    bgr.val[2] = Zip(even, odd);
+    vst3q_u8(out, bgr);
+  }
+  YUYVToBGRScalar(in, out, pixels - i);
+}
+
+// Converts 4 Y values (16 bits, less the 16 offset) to 16-bit gray values.
+inline uint16x4_t YToGray4(uint16x4_t y) {
+  return vshrn_n_u32(vmlal_n_u16(vdupq_n_u32(kYGrayRound), y, kYGrayMul),
+                     kGrayShift);
+}
+
+void YUYVToGrayNEON(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 32, out += 16) {
+    // Y, and U/V
+    uint8x16x2_t s = vld2q_u8(in);
+    uint8x16_t y = vqsubq_u8(s.val[0], vdupq_n_u8(16));
+    uint16x8_t lo = vmovl_u8(vget_low_u8(y));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(y));
+    lo = vcombine_u16(YToGray4(vget_low_u16(lo)), YToGray4(vget_high_u16(lo)));
+    hi = vcombine_u16(YToGray4(vget_low_u16(hi)), YToGray4(vget_high_u16(hi)));
+    vst1q_u8(out, vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+  }
+  YUYVToGrayScalar(in, out, pixels - i);
+}
+
+// Converts 4 pixels of 16-bit B, G, and R values to 16-bit gray values.
+inline uint16x4_t BGRToGray4(uint16x4_t b, uint16x4_t g, uint16x4_t r) {
+  uint32x4_t v = vmlal_n_u16(vdupq_n_u32(kGrayRound), b, kGrayB);
+  v = vmlal_n_u16(v, g, kGrayG);
+  v = vmlal_n_u16(v, r, kGrayR);
+  return vshrn_n_u32(v, kGrayShift);
+}
+
+// Converts 8 pixels of 8-bit B, G, and R values to gray values.
+inline uint8x8_t BGRToGray8(uint8x8_t b, uint8x8_t g, uint8x8_t r) {
+  uint16x8_t b16 = vmovl_u8(b);
+  uint16x8_t g16 = vmovl_u8(g);
+  uint16x8_t r16 = vmovl_u8(r);
+  return vmovn_u16(vcombine_u16(
+      BGRToGray4(vget_low_u16(b16), vget_low_u16(g16), vget_low_u16(r16)),
+      BGRToGray4(vget_high_u16(b16), vget_high_u16(g16),
+                 vget_high_u16(r16))));
+}
+
+void BGRToGrayNEON(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 48, out += 16) {
+    uint8x16x3_t bgr = vld3q_u8(in);
+    vst1q_u8(out, vcombine_u8(BGRToGray8(vget_low_u8(bgr.val[0]),
+                                         vget_low_u8(bgr.val[1]),
+                                         vget_low_u8(bgr.val[2])),
+                              BGRToGray8(vget_high_u8(bgr.val[0]),
+                                         vget_high_u8(bgr.val[1]),
+                                         vget_high_u8(bgr.val[2]))));
+  }
+  BGRToGrayScalar(in, out, pixels - i);
+}
+
+// Converts 8 pixels of 8-bit B, G, and R values to RGB565.
+inline uint16x8_t BGRToRGB5658(uint8x8_t b, uint8x8_t g, uint8x8_t r) {
+  return vorrq_u16(vorrq_u16(vshll_n_u8(vand_u8(b, vdup_n_u8(0xf8)), 8),
+                             vshll_n_u8(vand_u8(g, vdup_n_u8(0xfc)), 3)),
+                   vmovl_u8(vshr_n_u8(r, 3)));
+}
+
+void BGRToRGB565NEON(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 48, out += 32) {
+    uint8x16x3_t bgr = vld3q_u8(in);
+    vst1q_u8(out, vreinterpretq_u8_u16(BGRToRGB5658(
+                      vget_low_u8(bgr.val[0]), vget_low_u8(bgr.val[1]),
+                      vget_low_u8(bgr.val[2]))));
+    vst1q_u8(out + 16, vreinterpretq_u8_u16(BGRToRGB5658(
+                           vget_high_u8(bgr.val[0]), vget_high_u8(bgr.val[1]),
+                           vget_high_u8(bgr.val[2]))));
+  }
+  BGRToRGB565Scalar(in, out, pixels - i);
+}
+
+void RGB565ToBGRNEON(const uint8_t* in, uint8_t* out, size_t pixels) {
+  uint8x8_t bMask = vdup_n_u8(0xf8);
+  uint8x8_t gMask = vdup_n_u8(0xfc);
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 32, out += 48) {
+    uint16x8_t v0 = vreinterpretq_u16_u8(vld1q_u8(in));
+    uint16x8_t v1 = vreinterpretq_u16_u8(vld1q_u8(in + 16));
+    uint8x16x3_t bgr;
+    bgr.val[0] = vcombine_u8(vand_u8(vshrn_n_u16(v0, 8), bMask),
+                             vand_u8(vshrn_n_u16(v1, 8), bMask));
+    bgr.val[1] = vcombine_u8(vand_u8(vshrn_n_u16(v0, 3), gMask),
+                             vand_u8(vshrn_n_u16(v1, 3), gMask));
+    bgr.val[2] = vcombine_u8(vand_u8(vmovn_u16(vshlq_n_u16(v0, 3)), bMask),
+                             vand_u8(vmovn_u16(vshlq_n_u16(v1, 3)), bMask));
+    vst3q_u8(out, bgr);
+  }
+  RGB565ToBGRScalar(in, out, pixels - i);
+}
+
+void GrayToBGRNEON(const uint8_t* in, uint8_t* out, size_t pixels) {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16, in += 16, out += 48) {
+    uint8x16x3_t bgr;
+    bgr.val[0] = bgr.val[1] = bgr.val[2] = vld1q_u8(in);
+    vst3q_u8(out, bgr);
+  }
+  GrayToBGRScalar(in, out, pixels - i);
+}
+
+// Not yet benchmarked on ARM hardware, so Frame keeps using cvtColor().
+const Kernels kNEONKernels = {YUYVToBGRNEON,   YUYVToGrayNEON,
+                              BGRToGrayNEON,   BGRToRGB565NEON,
+                              RGB565ToBGRNEON, GrayToBGRNEON,
+                              0};
+
+#endif  // CSCORE_COLORCONVERT_NEON
+
+const Kernels* GetKernels(ColorConvertImpl impl) {
+  switch (impl) {
+    case kColorConvertScalar:
+      return &kScalarKernels;
+#ifdef CSCORE_COLORCONVERT_X86
+    case kColorConvertSSE41:
+      return HasSSE41() ? &kSSE41Kernels : nullptr;
+    case kColorConvertAVX2:
+      return HasAVX2() ? &kAVX2Kernels : nullptr;
+#endif
+#ifdef CSCORE_COLORCONVERT_NEON
+    case kColorConvertNEON:
+      return &kNEONKernels;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+ColorConvertImpl GetBestImpl() {
+  for (auto impl : {kColorConvertAVX2, kColorConvertSSE41, kColorConvertNEON}) {
+    if (GetKernels(impl)) return impl;
+  }
+  return kColorConvertScalar;
+}
+
+std::atomic_int gImpl{-1};
+std::atomic<const Kernels*> gKernels{nullptr};
+
+const Kernels& GetKernels() {
+  const Kernels* kernels = gKernels;
+  if (!kernels) {
+    // racing initializations all select the same implementation
+    auto impl = GetBestImpl();
+    kernels = GetKernels(impl);
+    gImpl = impl;
+    gKernels = kernels;
+  }
+  return *kernels;
+}
+
+}  // namespace
+
+namespace cs {
+
+void YUYVToBGR(const uint8_t* in, uint8_t* out, size_t pixels) {
+  GetKernels().yuyvToBGR(in, out, pixels);
+}
+
+void YUYVToGray(const uint8_t* in, uint8_t* out, size_t pixels) {
+  GetKernels().yuyvToGray(in, out, pixels);
+}
+
+void BGRToGray(const uint8_t* in, uint8_t* out, size_t pixels) {
+  GetKernels().bgrToGray(in, out, pixels);
+}
+
+void BGRToRGB565(const uint8_t* in, uint8_t* out, size_t pixels) {
+  GetKernels().bgrToRGB565(in, out, pixels);
+}
+
+void RGB565ToBGR(const uint8_t* in, uint8_t* out, size_t pixels) {
+  GetKernels().rgb565ToBGR(in, out, pixels);
+}
+
+void GrayToBGR(const uint8_t* in, uint8_t* out, size_t pixels) {
+  GetKernels().grayToBGR(in, out, pixels);
+}
+
+bool IsColorConvertFaster(ColorConversion conversion) {
+  return (GetKernels().faster & conversion) != 0;
+}
+
+const char* GetColorConvertImplName(ColorConvertImpl impl) {
+  switch (impl) {
+    case kColorConvertScalar:
+      return "scalar";
+    case kColorConvertSSE41:
+      return "SSE4.1";
+    case kColorConvertAVX2:
+      return "AVX2";
+    case kColorConvertNEON:
+      return "NEON";
+    default:
+      return "unknown";
+  }
+}
+
+bool IsColorConvertImplSupported(ColorConvertImpl impl) {
+  return GetKernels(impl) != nullptr;
+}
+
+ColorConvertImpl GetColorConvertImpl() {
+  GetKernels();
+  return static_cast<ColorConvertImpl>(gImpl.load());
+}
+
+bool SetColorConvertImpl(ColorConvertImpl impl) {
+  const Kernels* kernels = GetKernels(impl);
+  if (!kernels) return false;
+  gImpl = impl;
+  gKernels = kernels;
+  return true;
+}
+
+}  // namespace cs
@@ -0,0 +1,58 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef CSCORE_COLORCONVERT_H_
+#define CSCORE_COLORCONVERT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cs {
+
+// Color conversions between the fixed pixel formats.  Images are tightly
+// packed and the size is given in pixels (width * height; even for YUYV).
+//
+// Results are identical to the OpenCV cvtColor() conversions
+// (COLOR_YUV2BGR_YUYV, COLOR_BGR2GRAY, COLOR_RGB2BGR565, COLOR_BGR5652RGB,
+// and COLOR_GRAY2BGR).  YUYVToGray() gives the same result as YUYVToBGR()
+// followed by BGRToGray() for neutral colors, but uses only the Y values.
+void YUYVToBGR(const uint8_t* in, uint8_t* out, size_t pixels);
+void YUYVToGray(const uint8_t* in, uint8_t* out, size_t pixels);
+void BGRToGray(const uint8_t* in, uint8_t* out, size_t pixels);
+void BGRToRGB565(const uint8_t* in, uint8_t* out, size_t pixels);
+void RGB565ToBGR(const uint8_t* in, uint8_t* out, size_t pixels);
+void GrayToBGR(const uint8_t* in, uint8_t* out, size_t pixels);
+
+// Implementations of the above.  The best one supported by the CPU is
+// selected at runtime; the others are for testing and benchmarking.
+enum ColorConvertImpl {
+  kColorConvertScalar = 0,
+  kColorConvertSSE41,
+  kColorConvertAVX2,
+  kColorConvertNEON
+};
+
+const char* GetColorConvertImplName(ColorConvertImpl impl);
+bool IsColorConvertImplSupported(ColorConvertImpl impl);
+ColorConvertImpl GetColorConvertImpl();
+
+// Returns false (and does nothing) if the implementation isn't supported.
+bool SetColorConvertImpl(ColorConvertImpl impl);
+
+// Frame uses cv::cvtColor() unless the selected implementation of a
+// conversion was measured (with cscoreBench) to be faster than it.
+enum ColorConversion {
+  kColorConvertYUYVToBGR = 1,
+  kColorConvertYUYVToGray = 2,
+  kColorConvertBGRToGray = 4
+};
+
+bool IsColorConvertFaster(ColorConversion conversion);
+
+}  // namespace cs
+
+#endif  // CSCORE_COLORCONVERT_H_
@@ -68,6 +68,7 @@ uint64_t CvSinkImpl::GrabFrame(cv::Mat& image) {
     return 0;
   }
 
+  m_lastCaptureTime = frame.GetCaptureTime();
   return frame.GetTime();
 }
 
@@ -94,6 +95,7 @@ uint64_t CvSinkImpl::GrabFrame(cv::Mat& image, double timeout) {
     return 0;
   }
 
+  m_lastCaptureTime = frame.GetCaptureTime();
   return frame.GetTime();
 }
 
@@ -167,6 +169,15 @@ uint64_t GrabSinkFrameTimeout(CS_Sink sink, cv::Mat& image, double timeout,
   return static_cast<CvSinkImpl&>(*data->sink).GrabFrame(image, timeout);
 }
 
+uint64_t GetSinkLastFrameCaptureTime(CS_Sink sink, CS_Status* status) {
+  auto data = Instance::GetInstance().GetSink(sink);
+  if (!data || data->kind != CS_SINK_CV) {
+    *status = CS_INVALID_HANDLE;
+    return 0;
+  }
+  return static_cast<CvSinkImpl&>(*data->sink).GetLastFrameCaptureTime();
+}
+
 std::string GetSinkError(CS_Sink sink, CS_Status* status) {
   auto data = Instance::GetInstance().GetSink(sink);
   if (!data || data->kind != CS_SINK_CV) {
@@ -236,6 +247,10 @@ uint64_t CS_GrabSinkFrameTimeoutCpp(CS_Sink sink, cv::Mat* image,
   return cs::GrabSinkFrameTimeout(sink, *image, timeout, status);
 }
 
+uint64_t CS_GetSinkLastFrameCaptureTime(CS_Sink sink, CS_Status* status) {
+  return cs::GetSinkLastFrameCaptureTime(sink, status);
+}
+
 char* CS_GetSinkError(CS_Sink sink, CS_Status* status) {
   wpi::SmallString<128> buf;
   auto str = cs::GetSinkError(sink, buf, status);
@@ -39,12 +39,16 @@ class CvSinkImpl : public SinkImpl {
   uint64_t GrabFrame(cv::Mat& image);
   uint64_t GrabFrame(cv::Mat& image, double timeout);
 
+  // Capture time of the frame last returned by GrabFrame()
+  uint64_t GetLastFrameCaptureTime() const { return m_lastCaptureTime; }
+
  private:
   void ThreadMain();
 
   std::atomic_bool m_active;  // set to false to terminate threads
   std::thread m_thread;
   std::function<void(uint64_t time)> m_processFrame;
+  std::atomic<uint64_t> m_lastCaptureTime{0};
 };
 
 }  // namespace cs
@@ -13,6 +13,7 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include "ColorConvert.h"
 #include "Instance.h"
 #include "Log.h"
 #include "SourceImpl.h"
@@ -24,13 +25,16 @@ Frame::Frame(SourceImpl& source, const wpi::Twine& error, Time time)
   m_impl->refcount = 1;
   m_impl->error = error.str();
   m_impl->time = time;
+  m_impl->captureTime = time;
 }
 
-Frame::Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time)
+Frame::Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time,
+             Time captureTime)
     : m_impl{source.AllocFrameImpl().release()} {
   m_impl->refcount = 1;
   m_impl->error.resize(0);
   m_impl->time = time;
+  m_impl->captureTime = captureTime != 0 ? captureTime : time;
   m_impl->images.push_back(image.release());
 }
 
@@ -196,12 +200,15 @@ Image* Frame::ConvertImpl(Image* image, VideoMode::PixelFormat pixelFormat,
       }
       return ConvertBGRToRGB565(cur);
     case VideoMode::kGray:
-      // If source is YUYV or RGB565, need to convert to BGR first
+      // If source is YUYV or RGB565, need to convert to BGR first, unless
+      // YUYV can be converted directly (from the Y values) faster
       if (cur->pixelFormat == VideoMode::kYUYV) {
         // Check to see if BGR version already exists...
         if (Image* newImage =
                 GetExistingImage(cur->width, cur->height, VideoMode::kBGR))
           cur = newImage;
+        else if (IsColorConvertFaster(kColorConvertYUYVToGray))
+          return ConvertYUYVToGray(cur);
         else
           cur = ConvertYUYVToBGR(cur);
       } else if (cur->pixelFormat == VideoMode::kRGB565) {
@@ -289,7 +296,34 @@ Image* Frame::ConvertYUYVToBGR(Image* image) {
                                 image->width * image->height * 3);
 
   // Convert
-  cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_YUV2BGR_YUYV);
+  if (IsColorConvertFaster(kColorConvertYUYVToBGR))
+    YUYVToBGR(reinterpret_cast<const uint8_t*>(image->data()),
+              reinterpret_cast<uint8_t*>(newImage->data()),
+              image->width * image->height);
+  else
+    cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_YUV2BGR_YUYV);
+
+  // Save the result
+  Image* rv = newImage.release();
+  if (m_impl) {
+    std::lock_guard<wpi::recursive_mutex> lock(m_impl->mutex);
+    m_impl->images.push_back(rv);
+  }
+  return rv;
+}
+
+Image* Frame::ConvertYUYVToGray(Image* image) {
+  if (!image || image->pixelFormat != VideoMode::kYUYV) return nullptr;
+
+  // Allocate a grayscale image
+  auto newImage =
+      m_impl->source.AllocImage(VideoMode::kGray, image->width, image->height,
+                                image->width * image->height);
+
+  // Convert
+  YUYVToGray(reinterpret_cast<const uint8_t*>(image->data()),
+             reinterpret_cast<uint8_t*>(newImage->data()),
+             image->width * image->height);
 
   // Save the result
   Image* rv = newImage.release();
@@ -349,7 +383,12 @@ Image* Frame::ConvertBGRToGray(Image* image) {
                                 image->width * image->height);
 
   // Convert
-  cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_BGR2GRAY);
+  if (IsColorConvertFaster(kColorConvertBGRToGray))
+    BGRToGray(reinterpret_cast<const uint8_t*>(image->data()),
+              reinterpret_cast<uint8_t*>(newImage->data()),
+              image->width * image->height);
+  else
+    cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_BGR2GRAY);
 
   // Save the result
   Image* rv = newImage.release();
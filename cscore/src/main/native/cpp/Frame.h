@@ -38,6 +38,7 @@ class Frame {
     wpi::recursive_mutex mutex;
     std::atomic_int refcount{0};
     Time time{0};
+    Time captureTime{0};
     SourceImpl& source;
     std::string error;
     wpi::SmallVector<Image*, 4> images;
@@ -49,7 +50,10 @@ class Frame {
 
   Frame(SourceImpl& source, const wpi::Twine& error, Time time);
 
-  Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time);
+  // The capture time is when the image was captured by the hardware, if
+  // known; 0 means the same as the frame time.
+  Frame(SourceImpl& source, std::unique_ptr<Image> image, Time time,
+        Time captureTime = 0);
 
   Frame(const Frame& frame) noexcept : m_impl{frame.m_impl} {
     if (m_impl) ++m_impl->refcount;
@@ -71,8 +75,13 @@ class Frame {
     swap(first.m_impl, second.m_impl);
   }
 
+  // Time the frame was delivered by the source.
   Time GetTime() const { return m_impl ? m_impl->time : 0; }
 
+  // Time the image was captured (e.g. from driver timestamps).  Earlier
+  // than GetTime() by the capture and driver latency, when known.
+  Time GetCaptureTime() const { return m_impl ? m_impl->captureTime : 0; }
+
   wpi::StringRef GetError() const {
     if (!m_impl) return wpi::StringRef{};
     return m_impl->error;
@@ -160,6 +169,7 @@ class Frame {
   Image* ConvertMJPEGToBGR(Image* image);
   Image* ConvertMJPEGToGray(Image* image);
   Image* ConvertYUYVToBGR(Image* image);
+  Image* ConvertYUYVToGray(Image* image);
   Image* ConvertBGRToRGB565(Image* image);
   Image* ConvertRGB565ToBGR(Image* image);
   Image* ConvertBGRToGray(Image* image);
@@ -8,6 +8,8 @@
 #ifndef CSCORE_IMAGE_H_
 #define CSCORE_IMAGE_H_
 
+#include <functional>
+#include <utility>
 #include <vector>
 
 #include <opencv2/core/core.hpp>
@@ -33,18 +35,36 @@ class Image {
   }
 #endif
 
+  // Wraps data owned by someone else (e.g. a camera driver buffer) instead
+  // of copying it.  The release function is called when the image is
+  // destroyed; these images are never returned to the image pool.
+  Image(char* data, size_t size, std::function<void()> release)
+      : m_extData{reinterpret_cast<uchar*>(data)},
+        m_extSize{size},
+        m_release{std::move(release)} {}
+
+  ~Image() {
+    if (m_release) m_release();
+  }
+
   Image(const Image&) = delete;
   Image& operator=(const Image&) = delete;
 
   // Getters
   operator wpi::StringRef() const { return str(); }
   wpi::StringRef str() const { return wpi::StringRef(data(), size()); }
-  size_t capacity() const { return m_data.capacity(); }
+  size_t capacity() const {
+    return m_extData ? m_extSize : m_data.capacity();
+  }
   const char* data() const {
-    return reinterpret_cast<const char*>(m_data.data());
+    return reinterpret_cast<const char*>(m_extData ? m_extData
+                                                   : m_data.data());
+  }
+  char* data() {
+    return reinterpret_cast<char*>(m_extData ? m_extData : m_data.data());
   }
-  char* data() { return reinterpret_cast<char*>(m_data.data()); }
-  size_t size() const { return m_data.size(); }
+  size_t size() const { return m_extData ? m_extSize : m_data.size(); }
+  bool IsExternal() const { return m_extData != nullptr; }
 
   const std::vector<uchar>& vec() const { return m_data; }
   std::vector<uchar>& vec() { return m_data; }
@@ -68,10 +88,14 @@ class Image {
         type = CV_8UC1;
         break;
     }
-    return cv::Mat{height, width, type, m_data.data()};
+    return cv::Mat{height, width, type, data()};
   }
 
-  cv::_InputArray AsInputArray() { return cv::_InputArray{m_data}; }
+  cv::_InputArray AsInputArray() {
+    if (m_extData)
+      return cv::_InputArray{m_extData, static_cast<int>(m_extSize)};
+    return cv::_InputArray{m_data};
+  }
 
   bool Is(int width_, int height_) {
     return width == width_ && height == height_;
@@ -98,6 +122,9 @@ class Image {
 
  private:
   std::vector<uchar> m_data;
+  uchar* m_extData{nullptr};
+  size_t m_extSize{0};
+  std::function<void()> m_release;
 
  public:
   VideoMode::PixelFormat pixelFormat{VideoMode::kUnknown};
@@ -8,6 +8,7 @@
 #ifndef CSCORE_INSTANCE_H_
 #define CSCORE_INSTANCE_H_
 
+#include <atomic>
 #include <memory>
 #include <utility>
 
@@ -65,6 +66,9 @@ class Instance {
  public:
   wpi::EventLoopRunner eventLoop;
 
+  // Whether new MJPEG servers use eventLoop rather than threads
+  std::atomic_bool mjpegServerEventLoop{false};
+
   std::pair<CS_Sink, std::shared_ptr<SinkData>> FindSink(const SinkImpl& sink);
   std::pair<CS_Source, std::shared_ptr<SourceData>> FindSource(
       const SourceImpl& source);
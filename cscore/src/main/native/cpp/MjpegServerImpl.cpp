@@ -7,13 +7,20 @@
 
 #include "MjpegServerImpl.h"
 
+#include <algorithm>
 #include <chrono>
 
+#include <wpi/EventLoopRunner.h>
 #include <wpi/HttpUtil.h>
 #include <wpi/SmallString.h>
 #include <wpi/TCPAcceptor.h>
 #include <wpi/raw_socket_istream.h>
 #include <wpi/raw_socket_ostream.h>
+#include <wpi/timestamp.h>
+#include <wpi/uv/Async.h>
+#include <wpi/uv/Tcp.h>
+#include <wpi/uv/Timer.h>
+#include <wpi/uv/Work.h>
 
 #include "Handle.h"
 #include "Instance.h"
@@ -30,6 +37,16 @@ using namespace cs;
 // It separates the multipart stream of pictures
 #define BOUNDARY "boundarydonotcross"
 
+// Maximum number of simultaneous streams per server.
+static constexpr int kMaxStreams = 10;
+
+// Event loop server keep-alive period (ms).  A "\r\n" is sent to streaming
+// connections that haven't been sent anything for this long.
+static constexpr uint64_t kKeepAlivePeriod = 250;
+
+// Maximum size of an HTTP request header.
+static constexpr size_t kMaxRequestSize = 8192;
+
 // A bare-bones HTML webpage for user friendliness.
 static const char* emptyRootPage =
     "</head><body>"
@@ -73,24 +90,158 @@ static const char* startRootPage =
     "<div class=\"settings\">\n";
 static const char* endRootPage = "</div></body></html>";
 
-class MjpegServerImpl::ConnThread : public wpi::SafeThread {
+// Encodes each frame into a complete multipart stream part (boundary,
+// headers, and JPEG data) once for each distinct source and output
+// settings, so that all connections streaming with the same settings share
+// the same part rather than each converting and formatting it.
+class MjpegServerImpl::PartCache {
  public:
-  explicit ConnThread(const wpi::Twine& name, wpi::Logger& logger)
-      : m_name(name.str()), m_logger(logger) {}
+  typedef std::shared_ptr<const std::string> Part;
 
-  void Main();
+  // Gets the part for a frame; returns nullptr if the frame can't be
+  // converted to JPEG.
+  Part GetPart(SourceImpl& source, Frame& frame, int width, int height,
+               int requiredQuality, int defaultQuality);
+
+ private:
+  struct Entry {
+    const SourceImpl* source;
+    int width;
+    int height;
+    int requiredQuality;
+    int defaultQuality;
+    wpi::mutex mutex;  // held while encoding
+    Frame::Time time = 0;
+    Frame::Time lastUsed = 0;
+    Part part;
+  };
+
+  static Part MakePart(Frame& frame, int width, int height,
+                       int requiredQuality, int defaultQuality);
+
+  wpi::mutex m_mutex;
+  // shared so an entry erased while another connection is encoding with it
+  // stays alive until that connection is done
+  std::vector<std::shared_ptr<Entry>> m_entries;
+};
+
+MjpegServerImpl::PartCache::Part MjpegServerImpl::PartCache::GetPart(
+    SourceImpl& source, Frame& frame, int width, int height,
+    int requiredQuality, int defaultQuality) {
+  auto now = wpi::Now();
+  std::shared_ptr<Entry> entry;
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    for (auto& e : m_entries) {
+      if (e->source == &source && e->width == width && e->height == height &&
+          e->requiredQuality == requiredQuality &&
+          e->defaultQuality == defaultQuality) {
+        entry = e;
+        break;
+      }
+    }
+    if (!entry) {
+      // drop entries nobody has used recently (e.g. from old sources);
+      // another thread may have set lastUsed later than our now
+      m_entries.erase(
+          std::remove_if(m_entries.begin(), m_entries.end(),
+                         [&](const std::shared_ptr<Entry>& e) {
+                           return now > e->lastUsed + 1000000;
+                         }),
+          m_entries.end());
+      entry = std::make_shared<Entry>();
+      m_entries.emplace_back(entry);
+      entry->source = &source;
+      entry->width = width;
+      entry->height = height;
+      entry->requiredQuality = requiredQuality;
+      entry->defaultQuality = defaultQuality;
+    }
+    if (now > entry->lastUsed) entry->lastUsed = now;
+  }
 
+  // other connections wait here for the first one to encode the frame
+  std::lock_guard<wpi::mutex> lock(entry->mutex);
+  if (entry->time != frame.GetTime() || !entry->part) {
+    entry->part =
+        MakePart(frame, width, height, requiredQuality, defaultQuality);
+    entry->time = frame.GetTime();
+  }
+  return entry->part;
+}
+
+MjpegServerImpl::PartCache::Part MjpegServerImpl::PartCache::MakePart(
+    Frame& frame, int width, int height, int requiredQuality,
+    int defaultQuality) {
+  Image* image =
+      frame.GetImageMJPEG(width, height, requiredQuality, defaultQuality);
+  if (!image || image->pixelFormat != VideoMode::kMJPEG) return nullptr;
+
+  // Determine if we need to add DHT to it
+  const char* data = image->data();
+  size_t size = image->size();
+  size_t locSOF = size;
+  bool addDHT = JpegNeedsDHT(data, &size, &locSOF);
+
+  // print the individual mimetype and the length
+  // sending the content-length fixes random stream disruption observed
+  // with firefox
+  // X-Timestamp is the capture time; X-Delivery-Timestamp is when the
+  // source delivered the frame.
+  auto part = std::make_shared<std::string>();
+  part->reserve(size + 200);
+  wpi::raw_string_ostream os{*part};
+  os << "\r\n--" BOUNDARY "\r\n"
+     << "Content-Type: image/jpeg\r\n"
+     << "Content-Length: " << size << "\r\n"
+     << "X-Timestamp: " << (frame.GetCaptureTime() / 1000000.0) << "\r\n"
+     << "X-Delivery-Timestamp: " << (frame.GetTime() / 1000000.0) << "\r\n"
+     << "\r\n";
+  if (addDHT) {
+    // Insert DHT data immediately before SOF
+    os << wpi::StringRef(data, locSOF);
+    os << JpegGetDHT();
+    os << wpi::StringRef(data + locSOF, image->size() - locSOF);
+  } else {
+    os << wpi::StringRef(data, size);
+  }
+  os.flush();
+  return part;
+}
+
+// Per-connection request settings and responses, shared by the connection
+// threads and the event loop server.
+class MjpegServerImpl::ConnState {
+ public:
+  enum Kind {
+    kCommand,
+    kStream,
+    kGetSettings,
+    kGetSourceConfig,
+    kRootPage,
+    kNotFound
+  };
+
+  ConnState(const wpi::Twine& name, wpi::Logger& logger,
+            std::shared_ptr<PartCache> partCache)
+      : m_name(name.str()), m_logger(logger), m_partCache(partCache) {}
+
+  Kind ParseRequest(wpi::StringRef req, wpi::StringRef* parameters);
   bool ProcessCommand(wpi::raw_ostream& os, SourceImpl& source,
                       wpi::StringRef parameters, bool respond);
   void SendJSON(wpi::raw_ostream& os, SourceImpl& source, bool header);
   void SendHTMLHeadTitle(wpi::raw_ostream& os) const;
   void SendHTML(wpi::raw_ostream& os, SourceImpl& source, bool header);
-  void SendStream(wpi::raw_socket_ostream& os);
-  void ProcessRequest();
+  // Sends the complete response to any request other than kStream.
+  void SendResponse(wpi::raw_ostream& os, Kind kind, SourceImpl* source,
+                    wpi::StringRef parameters);
+
+  // Frame rate limiting for streams.  SkipFrame() returns true if the frame
+  // is early for the requested frame rate and should be dropped.
+  void StartFrameRate();
+  bool SkipFrame(Frame::Time time);
+  void FrameSent(Frame::Time time) { m_lastFrameTime = time; }
 
-  std::unique_ptr<wpi::NetworkStream> m_stream;
-  std::shared_ptr<SourceImpl> m_source;
-  bool m_streaming = false;
   bool m_noStreaming = false;
   int m_width = 0;
   int m_height = 0;
@@ -98,12 +249,36 @@ class MjpegServerImpl::ConnThread : public wpi::SafeThread {
   int m_defaultCompression = 80;
   int m_fps = 0;
 
- private:
+ protected:
   std::string m_name;
   wpi::Logger& m_logger;
+  std::shared_ptr<PartCache> m_partCache;
 
   wpi::StringRef GetName() { return m_name; }
 
+ private:
+  Frame::Time m_lastFrameTime = 0;
+  Frame::Time m_timePerFrame = 0;
+  Frame::Time m_averageFrameTime = 0;
+  Frame::Time m_averagePeriod = 0;
+};
+
+class MjpegServerImpl::ConnThread : public wpi::SafeThread, public ConnState {
+ public:
+  ConnThread(const wpi::Twine& name, wpi::Logger& logger,
+             std::shared_ptr<PartCache> partCache)
+      : ConnState(name, logger, partCache) {}
+
+  void Main();
+
+  void SendStream(wpi::raw_socket_ostream& os);
+  void ProcessRequest();
+
+  std::unique_ptr<wpi::NetworkStream> m_stream;
+  std::shared_ptr<SourceImpl> m_source;
+  bool m_streaming = false;
+
+ private:
   std::shared_ptr<SourceImpl> GetSource() {
     std::lock_guard<wpi::mutex> lock(m_mutex);
     return m_source;
@@ -122,6 +297,66 @@ class MjpegServerImpl::ConnThread : public wpi::SafeThread {
   }
 };
 
+// Serves all of a server's connections from the event loop rather than a
+// thread per connection.  The source wakes the loop as each frame arrives
+// (via a frame listener), and every streaming connection is then sent the
+// latest frame.  A connection has at most one part being encoded or written
+// at a time, so a slow connection skips to the latest frame when its write
+// completes rather than queuing frames.  Encoding runs on the libuv thread
+// pool so it doesn't hold up the loop.
+class MjpegServerImpl::LoopServer
+    : public std::enable_shared_from_this<LoopServer> {
+ public:
+  LoopServer(MjpegServerImpl& server, wpi::EventLoopRunner& runner)
+      : m_server(server), m_runner(runner), m_logger(server.m_logger) {}
+
+  void Start();
+  void Stop();
+  void SetSource(std::shared_ptr<SourceImpl> source);
+
+ private:
+  struct Conn : public ConnState {
+    Conn(const wpi::Twine& name, wpi::Logger& logger,
+         std::shared_ptr<PartCache> partCache,
+         std::shared_ptr<wpi::uv::Tcp> stream_)
+        : ConnState(name, logger, partCache), stream(stream_) {}
+
+    std::shared_ptr<wpi::uv::Tcp> stream;
+    std::string request;  // request header received so far
+    bool streaming = false;
+    bool busy = false;  // a part is being encoded or written
+    Frame::Time lastFrameTime = 0;  // last frame sent (or attempted)
+    uint64_t lastSendTime = 0;
+  };
+
+  wpi::StringRef GetName() { return m_server.GetName(); }
+
+  void DoSetSource(std::shared_ptr<SourceImpl> source);
+  void Accept();
+  void CloseConn(const std::shared_ptr<Conn>& conn);
+  void ProcessRequest(const std::shared_ptr<Conn>& conn);
+  void Respond(const std::shared_ptr<Conn>& conn, wpi::StringRef response,
+               bool close);
+  void SendFrames();
+  void SendFrame(const std::shared_ptr<Conn>& conn, Frame frame);
+  void SendPart(const std::shared_ptr<Conn>& conn, Frame::Time time,
+                std::shared_ptr<const std::string> part);
+  void KeepAlive();
+
+  MjpegServerImpl& m_server;
+  wpi::EventLoopRunner& m_runner;
+  wpi::Logger& m_logger;
+
+  // Only accessed from the loop thread
+  bool m_stopped = false;
+  std::shared_ptr<wpi::uv::Tcp> m_listener;
+  std::shared_ptr<wpi::uv::Async<>> m_frameReady;
+  std::shared_ptr<wpi::uv::Timer> m_keepAlive;
+  std::vector<std::shared_ptr<Conn>> m_conns;
+  std::shared_ptr<SourceImpl> m_source;
+  int m_frameListener = 0;
+};
+
 // Standard header to send along with other header information like mimetype.
 //
 // The parameters should ensure the browser does not cache our answer.
@@ -190,10 +425,10 @@ static void SendError(wpi::raw_ostream& os, int code,
 }
 
 // Perform a command specified by HTTP GET parameters.
-bool MjpegServerImpl::ConnThread::ProcessCommand(wpi::raw_ostream& os,
-                                                 SourceImpl& source,
-                                                 wpi::StringRef parameters,
-                                                 bool respond) {
+bool MjpegServerImpl::ConnState::ProcessCommand(wpi::raw_ostream& os,
+                                                SourceImpl& source,
+                                                wpi::StringRef parameters,
+                                                bool respond) {
   wpi::SmallString<256> responseBuf;
   wpi::raw_svector_ostream response{responseBuf};
   // command format: param1=value1&param2=value2...
@@ -333,15 +568,15 @@ bool MjpegServerImpl::ConnThread::ProcessCommand(wpi::raw_ostream& os,
   return true;
 }
 
-void MjpegServerImpl::ConnThread::SendHTMLHeadTitle(
+void MjpegServerImpl::ConnState::SendHTMLHeadTitle(
     wpi::raw_ostream& os) const {
   os << "<html><head><title>" << m_name << " CameraServer</title>"
      << "<meta charset=\"UTF-8\">";
 }
 
 // Send the root html file with controls for all the settable properties.
-void MjpegServerImpl::ConnThread::SendHTML(wpi::raw_ostream& os,
-                                           SourceImpl& source, bool header) {
+void MjpegServerImpl::ConnState::SendHTML(wpi::raw_ostream& os,
+                                          SourceImpl& source, bool header) {
   if (header) SendHeader(os, 200, "OK", "text/html");
 
   SendHTMLHeadTitle(os);
@@ -462,8 +697,8 @@ void MjpegServerImpl::ConnThread::SendHTML(wpi::raw_ostream& os,
 }
 
 // Send a JSON file which is contains information about the source parameters.
-void MjpegServerImpl::ConnThread::SendJSON(wpi::raw_ostream& os,
-                                           SourceImpl& source, bool header) {
+void MjpegServerImpl::ConnState::SendJSON(wpi::raw_ostream& os,
+                                          SourceImpl& source, bool header) {
   if (header) SendHeader(os, 200, "OK", "application/json");
 
   os << "{\n\"controls\": [\n";
@@ -569,12 +804,31 @@ MjpegServerImpl::MjpegServerImpl(const wpi::Twine& name, wpi::Logger& logger,
     : SinkImpl{name, logger, notifier, telemetry},
       m_listenAddress(listenAddress.str()),
       m_port(port),
-      m_acceptor{std::move(acceptor)} {
+      m_acceptor{std::move(acceptor)},
+      m_partCache{std::make_shared<PartCache>()} {
   m_active = true;
+  CreateProperties();
+  m_serverThread = std::thread(&MjpegServerImpl::ServerThreadMain, this);
+}
+
+MjpegServerImpl::MjpegServerImpl(const wpi::Twine& name, wpi::Logger& logger,
+                                 Notifier& notifier, Telemetry& telemetry,
+                                 const wpi::Twine& listenAddress, int port,
+                                 wpi::EventLoopRunner& loop)
+    : SinkImpl{name, logger, notifier, telemetry},
+      m_listenAddress(listenAddress.str()),
+      m_port(port),
+      m_partCache{std::make_shared<PartCache>()} {
+  m_active = true;
+  CreateProperties();
+  m_loopServer = std::make_shared<LoopServer>(*this, loop);
+  m_loopServer->Start();
+}
 
+void MjpegServerImpl::CreateProperties() {
   wpi::SmallString<128> descBuf;
   wpi::raw_svector_ostream desc{descBuf};
-  desc << "HTTP Server on port " << port;
+  desc << "HTTP Server on port " << m_port;
   SetDescription(desc.str());
 
   // Create properties
@@ -595,8 +849,14 @@ MjpegServerImpl::MjpegServerImpl(const wpi::Twine& name, wpi::Logger& logger,
   m_fpsProp = CreateProperty("fps", [] {
     return std::make_unique<PropertyImpl>("fps", CS_PROP_INTEGER, 1, 0, 0);
   });
+}
 
-  m_serverThread = std::thread(&MjpegServerImpl::ServerThreadMain, this);
+void MjpegServerImpl::SetConnDefaults(ConnState& conn) {
+  conn.m_width = GetProperty(m_widthProp)->value;
+  conn.m_height = GetProperty(m_heightProp)->value;
+  conn.m_compression = GetProperty(m_compressionProp)->value;
+  conn.m_defaultCompression = GetProperty(m_defaultCompressionProp)->value;
+  conn.m_fps = GetProperty(m_fpsProp)->value;
 }
 
 MjpegServerImpl::~MjpegServerImpl() { Stop(); }
@@ -604,6 +864,11 @@ MjpegServerImpl::~MjpegServerImpl() { Stop(); }
 void MjpegServerImpl::Stop() {
   m_active = false;
 
+  if (m_loopServer) {
+    m_loopServer->Stop();
+    return;
+  }
+
   // wake up server thread by shutting down the socket
   m_acceptor->shutdown();
 
@@ -622,6 +887,36 @@ void MjpegServerImpl::Stop() {
   if (auto source = GetSource()) source->Wakeup();
 }
 
+void MjpegServerImpl::ConnState::StartFrameRate() {
+  m_lastFrameTime = 0;
+  m_timePerFrame = 0;
+  if (m_fps != 0) m_timePerFrame = 1000000.0 / m_fps;
+  m_averageFrameTime = 0;
+  m_averagePeriod = 1000000;  // 1 second window
+  if (m_averagePeriod < m_timePerFrame) m_averagePeriod = m_timePerFrame * 10;
+}
+
+bool MjpegServerImpl::ConnState::SkipFrame(Frame::Time time) {
+  if (time == 0 || m_timePerFrame == 0 || m_lastFrameTime == 0) return false;
+  Frame::Time deltaTime = time - m_lastFrameTime;
+
+  // drop frame if it is early compared to the desired frame rate AND
+  // the current average is higher than the desired average
+  if (deltaTime < m_timePerFrame && m_averageFrameTime < m_timePerFrame)
+    return true;
+
+  // update average
+  if (m_averageFrameTime != 0) {
+    m_averageFrameTime = m_averageFrameTime *
+                             (m_averagePeriod - m_timePerFrame) /
+                             m_averagePeriod +
+                         deltaTime * m_timePerFrame / m_averagePeriod;
+  } else {
+    m_averageFrameTime = deltaTime;
+  }
+  return false;
+}
+
 // Send HTTP response and a stream of JPG-frames
 void MjpegServerImpl::ConnThread::SendStream(wpi::raw_socket_ostream& os) {
   if (m_noStreaming) {
@@ -640,12 +935,7 @@ void MjpegServerImpl::ConnThread::SendStream(wpi::raw_socket_ostream& os) {
 
   SDEBUG("Headers send, sending stream now");
 
-  Frame::Time lastFrameTime = 0;
-  Frame::Time timePerFrame = 0;
-  if (m_fps != 0) timePerFrame = 1000000.0 / m_fps;
-  Frame::Time averageFrameTime = 0;
-  Frame::Time averagePeriod = 1000000;  // 1 second window
-  if (averagePeriod < timePerFrame) averagePeriod = timePerFrame * 10;
+  StartFrameRate();
 
   StartStream();
   while (m_active && !os.has_error()) {
@@ -667,97 +957,36 @@ void MjpegServerImpl::ConnThread::SendStream(wpi::raw_socket_ostream& os) {
     }
 
     auto thisFrameTime = frame.GetTime();
-    if (thisFrameTime != 0 && timePerFrame != 0 && lastFrameTime != 0) {
-      Frame::Time deltaTime = thisFrameTime - lastFrameTime;
-
-      // drop frame if it is early compared to the desired frame rate AND
-      // the current average is higher than the desired average
-      if (deltaTime < timePerFrame && averageFrameTime < timePerFrame) {
-        // sleep for 1 ms so we don't consume all processor time
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        continue;
-      }
-
-      // update average
-      if (averageFrameTime != 0) {
-        averageFrameTime =
-            averageFrameTime * (averagePeriod - timePerFrame) / averagePeriod +
-            deltaTime * timePerFrame / averagePeriod;
-      } else {
-        averageFrameTime = deltaTime;
-      }
+    if (SkipFrame(thisFrameTime)) {
+      // sleep for 1 ms so we don't consume all processor time
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
     }
 
     int width = m_width != 0 ? m_width : frame.GetOriginalWidth();
     int height = m_height != 0 ? m_height : frame.GetOriginalHeight();
-    Image* image = frame.GetImageMJPEG(
-        width, height, m_compression,
+    auto part = m_partCache->GetPart(
+        *source, frame, width, height, m_compression,
         m_compression == -1 ? m_defaultCompression : m_compression);
-    if (!image) {
-      // Shouldn't happen, but just in case...
-      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    if (!part) {
+      // Bad frame; sleep for 10 ms so we don't consume all processor time.
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
       continue;
     }
 
-    const char* data = image->data();
-    size_t size = image->size();
-    bool addDHT = false;
-    size_t locSOF = size;
-    switch (image->pixelFormat) {
-      case VideoMode::kMJPEG:
-        // Determine if we need to add DHT to it, and allocate enough space
-        // for adding it if required.
-        addDHT = JpegNeedsDHT(data, &size, &locSOF);
-        break;
-      case VideoMode::kYUYV:
-      case VideoMode::kRGB565:
-      default:
-        // Bad frame; sleep for 10 ms so we don't consume all processor time.
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        continue;
-    }
-
-    SDEBUG4("sending frame size=" << size << " addDHT=" << addDHT);
-
-    // print the individual mimetype and the length
-    // sending the content-length fixes random stream disruption observed
-    // with firefox
-    lastFrameTime = thisFrameTime;
-    double timestamp = lastFrameTime / 1000000.0;
-    header.clear();
-    oss << "\r\n--" BOUNDARY "\r\n"
-        << "Content-Type: image/jpeg\r\n"
-        << "Content-Length: " << size << "\r\n"
-        << "X-Timestamp: " << timestamp << "\r\n"
-        << "\r\n";
-    os << oss.str();
-    if (addDHT) {
-      // Insert DHT data immediately before SOF
-      os << wpi::StringRef(data, locSOF);
-      os << JpegGetDHT();
-      os << wpi::StringRef(data + locSOF, image->size() - locSOF);
-    } else {
-      os << wpi::StringRef(data, size);
-    }
+    // A slow connection only holds up its own thread; when it catches up,
+    // it skips straight to the latest frame.
+    SDEBUG4("sending frame size=" << part->size());
+    FrameSent(thisFrameTime);
+    os << *part;
     // os.flush();
   }
   StopStream();
 }
 
-void MjpegServerImpl::ConnThread::ProcessRequest() {
-  wpi::raw_socket_istream is{*m_stream};
-  wpi::raw_socket_ostream os{*m_stream, true};
-
-  // Read the request string from the stream
-  wpi::SmallString<128> reqBuf;
-  wpi::StringRef req = is.getline(reqBuf, 4096);
-  if (is.has_error()) {
-    SDEBUG("error getting request string");
-    return;
-  }
-
-  enum { kCommand, kStream, kGetSettings, kGetSourceConfig, kRootPage } kind;
-  wpi::StringRef parameters;
+MjpegServerImpl::ConnState::Kind MjpegServerImpl::ConnState::ParseRequest(
+    wpi::StringRef req, wpi::StringRef* parameters) {
+  Kind kind;
   size_t pos;
 
   SDEBUG("HTTP request: '" << req << "'\n");
@@ -766,13 +995,13 @@ void MjpegServerImpl::ConnThread::ProcessRequest() {
   // compatibility, others are for Axis camera compatibility.
   if ((pos = req.find("POST /stream")) != wpi::StringRef::npos) {
     kind = kStream;
-    parameters = req.substr(req.find('?', pos + 12)).substr(1);
+    *parameters = req.substr(req.find('?', pos + 12)).substr(1);
   } else if ((pos = req.find("GET /?action=stream")) != wpi::StringRef::npos) {
     kind = kStream;
-    parameters = req.substr(req.find('&', pos + 19)).substr(1);
+    *parameters = req.substr(req.find('&', pos + 19)).substr(1);
   } else if ((pos = req.find("GET /stream.mjpg")) != wpi::StringRef::npos) {
     kind = kStream;
-    parameters = req.substr(req.find('?', pos + 16)).substr(1);
+    *parameters = req.substr(req.find('?', pos + 16)).substr(1);
   } else if (req.find("GET /settings") != wpi::StringRef::npos &&
              req.find(".json") != wpi::StringRef::npos) {
     kind = kGetSettings;
@@ -787,41 +1016,29 @@ void MjpegServerImpl::ConnThread::ProcessRequest() {
     kind = kGetSettings;
   } else if ((pos = req.find("GET /?action=command")) != wpi::StringRef::npos) {
     kind = kCommand;
-    parameters = req.substr(req.find('&', pos + 20)).substr(1);
+    *parameters = req.substr(req.find('&', pos + 20)).substr(1);
   } else if (req.find("GET / ") != wpi::StringRef::npos || req == "GET /\n") {
     kind = kRootPage;
   } else {
     SDEBUG("HTTP request resource not found");
-    SendError(os, 404, "Resource not found");
-    return;
+    return kNotFound;
   }
 
   // Parameter can only be certain characters.  This also strips the EOL.
-  pos = parameters.find_first_not_of(
+  pos = parameters->find_first_not_of(
       "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_"
       "-=&1234567890%./");
-  parameters = parameters.substr(0, pos);
-  SDEBUG("command parameters: \"" << parameters << "\"");
-
-  // Read the rest of the HTTP request.
-  // The end of the request is marked by a single, empty line
-  wpi::SmallString<128> lineBuf;
-  for (;;) {
-    if (is.getline(lineBuf, 4096).startswith("\n")) break;
-    if (is.has_error()) return;
-  }
+  *parameters = parameters->substr(0, pos);
+  SDEBUG("command parameters: \"" << *parameters << "\"");
+  return kind;
+}
 
-  // Send response
+void MjpegServerImpl::ConnState::SendResponse(wpi::raw_ostream& os, Kind kind,
+                                              SourceImpl* source,
+                                              wpi::StringRef parameters) {
   switch (kind) {
-    case kStream:
-      if (auto source = GetSource()) {
-        SDEBUG("request for stream " << source->GetName());
-        if (!ProcessCommand(os, *source, parameters, false)) return;
-      }
-      SendStream(os);
-      break;
     case kCommand:
-      if (auto source = GetSource()) {
+      if (source) {
         ProcessCommand(os, *source, parameters, true);
       } else {
         SendHeader(os, 200, "OK", "text/plain");
@@ -832,14 +1049,14 @@ void MjpegServerImpl::ConnThread::ProcessRequest() {
       break;
     case kGetSettings:
       SDEBUG("request for JSON file");
-      if (auto source = GetSource())
+      if (source)
         SendJSON(os, *source, true);
       else
         SendError(os, 404, "Resource not found");
       break;
     case kGetSourceConfig:
       SDEBUG("request for JSON file");
-      if (auto source = GetSource()) {
+      if (source) {
         SendHeader(os, 200, "OK", "application/json");
         CS_Status status = CS_OK;
         os << source->GetConfigJson(&status);
@@ -851,13 +1068,55 @@ void MjpegServerImpl::ConnThread::ProcessRequest() {
     case kRootPage:
       SDEBUG("request for root page");
       SendHeader(os, 200, "OK", "text/html");
-      if (auto source = GetSource()) {
+      if (source) {
         SendHTML(os, *source, false);
       } else {
         SendHTMLHeadTitle(os);
         os << emptyRootPage << "\r\n";
       }
       break;
+    default:
+      SendError(os, 404, "Resource not found");
+      break;
+  }
+}
+
+void MjpegServerImpl::ConnThread::ProcessRequest() {
+  wpi::raw_socket_istream is{*m_stream};
+  wpi::raw_socket_ostream os{*m_stream, true};
+
+  // Read the request string from the stream
+  wpi::SmallString<128> reqBuf;
+  wpi::StringRef req = is.getline(reqBuf, 4096);
+  if (is.has_error()) {
+    SDEBUG("error getting request string");
+    return;
+  }
+
+  wpi::StringRef parameters;
+  Kind kind = ParseRequest(req, &parameters);
+  if (kind == kNotFound) {
+    SendError(os, 404, "Resource not found");
+    return;
+  }
+
+  // Read the rest of the HTTP request.
+  // The end of the request is marked by a single, empty line
+  wpi::SmallString<128> lineBuf;
+  for (;;) {
+    if (is.getline(lineBuf, 4096).startswith("\n")) break;
+    if (is.has_error()) return;
+  }
+
+  // Send response
+  if (kind == kStream) {
+    if (auto source = GetSource()) {
+      SDEBUG("request for stream " << source->GetName());
+      if (!ProcessCommand(os, *source, parameters, false)) return;
+    }
+    SendStream(os);
+  } else {
+    SendResponse(os, kind, GetSource().get(), parameters);
   }
 
   SDEBUG("leaving HTTP client thread");
@@ -911,7 +1170,7 @@ void MjpegServerImpl::ServerThreadMain() {
     }
 
     // Start it if not already started
-    it->Start(GetName(), m_logger);
+    it->Start(GetName(), m_logger, m_partCache);
 
     auto nstreams =
         std::count_if(m_connThreads.begin(), m_connThreads.end(),
@@ -924,19 +1183,295 @@ void MjpegServerImpl::ServerThreadMain() {
     auto thr = it->GetThread();
     thr->m_stream = std::move(stream);
     thr->m_source = source;
-    thr->m_noStreaming = nstreams >= 10;
-    thr->m_width = GetProperty(m_widthProp)->value;
-    thr->m_height = GetProperty(m_heightProp)->value;
-    thr->m_compression = GetProperty(m_compressionProp)->value;
-    thr->m_defaultCompression = GetProperty(m_defaultCompressionProp)->value;
-    thr->m_fps = GetProperty(m_fpsProp)->value;
+    thr->m_noStreaming = nstreams >= kMaxStreams;
+    SetConnDefaults(*thr);
     thr->m_cond.notify_one();
   }
 
   SDEBUG("leaving server thread");
 }
 
+void MjpegServerImpl::LoopServer::Start() {
+  m_runner.ExecSync([this](wpi::uv::Loop& loop) {
+    m_listener = wpi::uv::Tcp::Create(loop);
+    m_frameReady = wpi::uv::Async<>::Create(loop);
+    m_keepAlive = wpi::uv::Timer::Create(loop);
+    if (!m_listener || !m_frameReady || !m_keepAlive) return;
+
+    // These handles are closed by Stop(), so their callbacks can't outlive
+    // this object.
+    m_listener->error.connect(
+        [this](wpi::uv::Error err) { SERROR("server: " << err.str()); });
+    m_listener->connection.connect([this] { Accept(); });
+    const std::string& addr = m_server.m_listenAddress;
+    m_listener->Bind(addr.empty() ? "0.0.0.0" : addr, m_server.m_port);
+    m_listener->Listen();
+
+    m_frameReady->wakeup.connect([this] { SendFrames(); });
+
+    m_keepAlive->timeout.connect([this] { KeepAlive(); });
+    m_keepAlive->Start(wpi::uv::Timer::Time{kKeepAlivePeriod},
+                       wpi::uv::Timer::Time{kKeepAlivePeriod});
+
+    SDEBUG("waiting for clients to connect");
+  });
+}
+
+void MjpegServerImpl::LoopServer::Stop() {
+  m_runner.ExecSync([this](wpi::uv::Loop&) {
+    if (m_stopped) return;
+    DoSetSource(nullptr);
+    m_stopped = true;
+    while (!m_conns.empty()) {
+      auto conn = m_conns.back();
+      CloseConn(conn);
+    }
+    if (m_listener) m_listener->Close();
+    if (m_frameReady) m_frameReady->Close();
+    if (m_keepAlive) m_keepAlive->Close();
+  });
+}
+
+void MjpegServerImpl::LoopServer::SetSource(
+    std::shared_ptr<SourceImpl> source) {
+  std::weak_ptr<LoopServer> weak = shared_from_this();
+  m_runner.ExecAsync([=](wpi::uv::Loop&) {
+    if (auto self = weak.lock()) self->DoSetSource(source);
+  });
+}
+
+void MjpegServerImpl::LoopServer::DoSetSource(
+    std::shared_ptr<SourceImpl> source) {
+  if (m_stopped || source == m_source) return;
+  if (m_source) {
+    m_source->RemoveFrameListener(m_frameListener);
+    for (auto& conn : m_conns) {
+      if (conn->streaming) m_source->DisableSink();
+    }
+  }
+  m_source = source;
+  if (m_source) {
+    for (auto& conn : m_conns) {
+      if (conn->streaming) m_source->EnableSink();
+    }
+    std::weak_ptr<wpi::uv::Async<>> frameReady = m_frameReady;
+    m_frameListener = m_source->AddFrameListener([frameReady] {
+      if (auto async = frameReady.lock()) async->Send();
+    });
+  }
+}
+
+void MjpegServerImpl::LoopServer::Accept() {
+  if (m_stopped) return;
+  auto stream = m_listener->Accept();
+  if (!stream) return;
+  stream->SetNoDelay(true);
+
+  auto conn = std::make_shared<Conn>(GetName(), m_logger,
+                                     m_server.m_partCache, stream);
+  {
+    std::lock_guard<wpi::mutex> lock(m_server.m_mutex);
+    m_server.SetConnDefaults(*conn);
+  }
+  m_conns.emplace_back(conn);
+
+  // Write errors can be reported while the stream is closing, after Stop(),
+  // so these callbacks only hold weak references.
+  std::weak_ptr<LoopServer> weak = shared_from_this();
+  std::weak_ptr<Conn> weakConn = conn;
+  auto close = [weak, weakConn] {
+    auto self = weak.lock();
+    auto conn = weakConn.lock();
+    if (self && conn && !self->m_stopped) self->CloseConn(conn);
+  };
+  stream->error.connect([close](wpi::uv::Error) { close(); });
+  stream->end.connect(close);
+  stream->data.connect([weak, weakConn, close](wpi::uv::Buffer& buf,
+                                               size_t len) {
+    auto self = weak.lock();
+    auto conn = weakConn.lock();
+    if (!self || !conn || self->m_stopped) return;
+    conn->request.append(buf.base, len);
+    if (conn->request.find("\n\r\n") != std::string::npos ||
+        conn->request.find("\n\n") != std::string::npos) {
+      conn->stream->StopRead();
+      self->ProcessRequest(conn);
+    } else if (conn->request.size() > kMaxRequestSize) {
+      close();
+    }
+  });
+  stream->StartRead();
+}
+
+void MjpegServerImpl::LoopServer::CloseConn(
+    const std::shared_ptr<Conn>& conn) {
+  auto it = std::find(m_conns.begin(), m_conns.end(), conn);
+  if (it == m_conns.end()) return;
+  if (conn->streaming && m_source) m_source->DisableSink();
+  conn->streaming = false;
+  conn->stream->Close();
+  m_conns.erase(it);
+}
+
+void MjpegServerImpl::LoopServer::ProcessRequest(
+    const std::shared_ptr<Conn>& conn) {
+  wpi::StringRef req{conn->request};
+  req = req.substr(0, req.find('\n') + 1);
+
+  wpi::StringRef parameters;
+  auto kind = conn->ParseRequest(req, &parameters);
+
+  std::string response;
+  wpi::raw_string_ostream os{response};
+  if (kind != ConnState::kStream) {
+    conn->SendResponse(os, kind, m_source.get(), parameters);
+    os.flush();
+    Respond(conn, response, true);
+    return;
+  }
+
+  if (m_source) {
+    SDEBUG("request for stream " << m_source->GetName());
+    if (!conn->ProcessCommand(os, *m_source, parameters, false)) {
+      os.flush();
+      Respond(conn, response, true);
+      return;
+    }
+  }
+  // Count streams here rather than on accept: several connections can be
+  // accepted before any of them has sent its request.
+  if (std::count_if(m_conns.begin(), m_conns.end(),
+                    [](const std::shared_ptr<Conn>& c) {
+                      return c->streaming;
+                    }) >= kMaxStreams) {
+    SERROR("Too many simultaneous client streams");
+    SendError(os, 503, "Too many simultaneous streams");
+    os.flush();
+    Respond(conn, response, true);
+    return;
+  }
+
+  SendHeader(os, 200, "OK", "multipart/x-mixed-replace;boundary=" BOUNDARY);
+  os.flush();
+  Respond(conn, response, false);
+
+  SDEBUG("Headers send, sending stream now");
+  conn->StartFrameRate();
+  conn->streaming = true;
+  if (m_source) m_source->EnableSink();
+}
+
+void MjpegServerImpl::LoopServer::Respond(const std::shared_ptr<Conn>& conn,
+                                          wpi::StringRef response,
+                                          bool close) {
+  auto buf = wpi::uv::Buffer::Dup(response);
+  conn->busy = true;
+  conn->lastSendTime = wpi::Now();
+  std::weak_ptr<LoopServer> weak = shared_from_this();
+  conn->stream->Write(buf, [weak, conn, close](
+                               wpi::MutableArrayRef<wpi::uv::Buffer> bufs,
+                               wpi::uv::Error err) {
+    for (auto&& buf : bufs) buf.Deallocate();
+    auto self = weak.lock();
+    if (!self || self->m_stopped) return;
+    conn->busy = false;
+    if (close)
+      self->CloseConn(conn);
+    else if (!err && self->m_source)
+      self->SendFrame(conn, self->m_source->GetCurFrame());
+  });
+}
+
+void MjpegServerImpl::LoopServer::SendFrames() {
+  if (m_stopped || !m_source) return;
+  Frame frame = m_source->GetCurFrame();
+  for (auto& conn : m_conns) {
+    if (conn->streaming && !conn->busy) SendFrame(conn, frame);
+  }
+}
+
+void MjpegServerImpl::LoopServer::SendFrame(const std::shared_ptr<Conn>& conn,
+                                            Frame frame) {
+  if (!conn->streaming || conn->busy || !frame) return;
+  auto time = frame.GetTime();
+  if (time == conn->lastFrameTime) return;
+  conn->lastFrameTime = time;
+  if (conn->SkipFrame(time)) return;
+
+  // Encode on the thread pool, then write from the loop
+  conn->busy = true;
+  int width = conn->m_width != 0 ? conn->m_width : frame.GetOriginalWidth();
+  int height =
+      conn->m_height != 0 ? conn->m_height : frame.GetOriginalHeight();
+  int requiredQuality = conn->m_compression;
+  int defaultQuality = conn->m_compression == -1 ? conn->m_defaultCompression
+                                                 : conn->m_compression;
+  auto partCache = m_server.m_partCache;
+  auto source = m_source;
+  auto part = std::make_shared<PartCache::Part>();
+  std::weak_ptr<LoopServer> weak = shared_from_this();
+  wpi::uv::QueueWork(
+      conn->stream->GetLoopRef(),
+      [=]() mutable {
+        *part = partCache->GetPart(*source, frame, width, height,
+                                   requiredQuality, defaultQuality);
+      },
+      [=] {
+        auto self = weak.lock();
+        if (!self || self->m_stopped) return;
+        conn->busy = false;
+        self->SendPart(conn, time, *part);
+      });
+}
+
+void MjpegServerImpl::LoopServer::SendPart(
+    const std::shared_ptr<Conn>& conn, Frame::Time time,
+    std::shared_ptr<const std::string> part) {
+  if (!conn->streaming || !part) return;  // closed, or bad frame
+
+  SDEBUG4("sending frame size=" << part->size());
+  conn->FrameSent(time);
+  conn->busy = true;
+  conn->lastSendTime = wpi::Now();
+  std::weak_ptr<LoopServer> weak = shared_from_this();
+  conn->stream->Write(
+      wpi::uv::Buffer{*part},
+      [weak, conn, part](wpi::MutableArrayRef<wpi::uv::Buffer>,
+                         wpi::uv::Error err) {
+        auto self = weak.lock();
+        if (!self || self->m_stopped) return;
+        conn->busy = false;
+        // catch up to any frame that arrived during the write
+        if (!err && self->m_source)
+          self->SendFrame(conn, self->m_source->GetCurFrame());
+      });
+}
+
+void MjpegServerImpl::LoopServer::KeepAlive() {
+  static const char keepAlive[] = "\r\n";
+  auto now = wpi::Now();
+  for (auto& conn : m_conns) {
+    if (!conn->streaming || conn->busy ||
+        now - conn->lastSendTime < kKeepAlivePeriod * 1000)
+      continue;
+    conn->busy = true;
+    conn->lastSendTime = now;
+    std::weak_ptr<LoopServer> weak = shared_from_this();
+    conn->stream->Write(
+        wpi::uv::Buffer{keepAlive, 2},
+        [weak, conn](wpi::MutableArrayRef<wpi::uv::Buffer>, wpi::uv::Error) {
+          auto self = weak.lock();
+          if (!self || self->m_stopped) return;
+          conn->busy = false;
+        });
+  }
+}
+
 void MjpegServerImpl::SetSourceImpl(std::shared_ptr<SourceImpl> source) {
+  if (m_loopServer) {
+    m_loopServer->SetSource(source);
+    return;
+  }
   std::lock_guard<wpi::mutex> lock(m_mutex);
   for (auto& connThread : m_connThreads) {
     if (auto thr = connThread.GetThread()) {
@@ -956,6 +1491,13 @@ CS_Sink CreateMjpegServer(const wpi::Twine& name,
                           const wpi::Twine& listenAddress, int port,
                           CS_Status* status) {
   auto& inst = Instance::GetInstance();
+  if (inst.mjpegServerEventLoop) {
+    return inst.CreateSink(
+        CS_SINK_MJPEG,
+        std::make_shared<MjpegServerImpl>(name, inst.logger, inst.notifier,
+                                          inst.telemetry, listenAddress, port,
+                                          inst.eventLoop));
+  }
   wpi::SmallString<128> listenAddressBuf;
   return inst.CreateSink(
       CS_SINK_MJPEG,
@@ -985,6 +1527,10 @@ int GetMjpegServerPort(CS_Sink sink, CS_Status* status) {
   return static_cast<MjpegServerImpl&>(*data->sink).GetPort();
 }
 
+void SetMjpegServerEventLoop(bool enabled) {
+  Instance::GetInstance().mjpegServerEventLoop = enabled;
+}
+
 }  // namespace cs
 
 extern "C" {
@@ -1002,4 +1548,8 @@ int CS_GetMjpegServerPort(CS_Sink sink, CS_Status* status) {
   return cs::GetMjpegServerPort(sink, status);
 }
 
+void CS_SetMjpegServerEventLoop(CS_Bool enabled) {
+  cs::SetMjpegServerEventLoop(enabled);
+}
+
 }  // extern "C"
@@ -25,6 +25,10 @@
 
 #include "SinkImpl.h"
 
+namespace wpi {
+class EventLoopRunner;
+}  // namespace wpi
+
 namespace cs {
 
 class SourceImpl;
@@ -35,6 +39,12 @@ class MjpegServerImpl : public SinkImpl {
                   Notifier& notifier, Telemetry& telemetry,
                   const wpi::Twine& listenAddress, int port,
                   std::unique_ptr<wpi::NetworkAcceptor> acceptor);
+  // Serves all connections from an event loop rather than a thread per
+  // connection.
+  MjpegServerImpl(const wpi::Twine& name, wpi::Logger& logger,
+                  Notifier& notifier, Telemetry& telemetry,
+                  const wpi::Twine& listenAddress, int port,
+                  wpi::EventLoopRunner& loop);
   ~MjpegServerImpl() override;
 
   void Stop();
@@ -44,9 +54,17 @@ class MjpegServerImpl : public SinkImpl {
  private:
   void SetSourceImpl(std::shared_ptr<SourceImpl> source) override;
 
+  void CreateProperties();
   void ServerThreadMain();
 
+  class ConnState;
   class ConnThread;
+  class LoopServer;
+  class PartCache;
+
+  // Sets the connection settings from the server properties.
+  // Must be called with m_mutex held.
+  void SetConnDefaults(ConnState& conn);
 
   // Never changed, so not protected by mutex
   std::string m_listenAddress;
@@ -58,6 +76,12 @@ class MjpegServerImpl : public SinkImpl {
 
   std::vector<wpi::SafeThreadOwner<ConnThread>> m_connThreads;
 
+  // Event loop server; if set, used instead of the thread-based server.
+  std::shared_ptr<LoopServer> m_loopServer;
+
+  // Encoded stream parts, shared by all connections
+  std::shared_ptr<PartCache> m_partCache;
+
   // property indices
   int m_widthProp;
   int m_heightProp;
@@ -98,6 +98,29 @@ void SourceImpl::Wakeup() {
     m_frame = Frame{*this, wpi::StringRef{}, 0};
   }
   m_frameCv.notify_all();
+  NotifyFrameListeners();
+}
+
+int SourceImpl::AddFrameListener(std::function<void()> listener) {
+  std::lock_guard<wpi::mutex> lock{m_frameListenersMutex};
+  int uid = ++m_frameListenerUid;
+  m_frameListeners.emplace_back(uid, std::move(listener));
+  return uid;
+}
+
+void SourceImpl::RemoveFrameListener(int uid) {
+  std::lock_guard<wpi::mutex> lock{m_frameListenersMutex};
+  m_frameListeners.erase(
+      std::remove_if(m_frameListeners.begin(), m_frameListeners.end(),
+                     [=](const std::pair<int, std::function<void()>>& l) {
+                       return l.first == uid;
+                     }),
+      m_frameListeners.end());
+}
+
+void SourceImpl::NotifyFrameListeners() {
+  std::lock_guard<wpi::mutex> lock{m_frameListenersMutex};
+  for (auto& listener : m_frameListeners) listener.second();
 }
 
 void SourceImpl::SetBrightness(int brightness, CS_Status* status) {
@@ -421,7 +444,8 @@ std::unique_ptr<Image> SourceImpl::AllocImage(
 }
 
 void SourceImpl::PutFrame(VideoMode::PixelFormat pixelFormat, int width,
-                          int height, wpi::StringRef data, Frame::Time time) {
+                          int height, wpi::StringRef data, Frame::Time time,
+                          Frame::Time captureTime) {
   auto image = AllocImage(pixelFormat, width, height, data.size());
 
   // Copy in image data
@@ -431,10 +455,11 @@ void SourceImpl::PutFrame(VideoMode::PixelFormat pixelFormat, int width,
           << " bytes)");
   std::memcpy(image->data(), data.data(), data.size());
 
-  PutFrame(std::move(image), time);
+  PutFrame(std::move(image), time, captureTime);
 }
 
-void SourceImpl::PutFrame(std::unique_ptr<Image> image, Frame::Time time) {
+void SourceImpl::PutFrame(std::unique_ptr<Image> image, Frame::Time time,
+                          Frame::Time captureTime) {
   // Update telemetry
   m_telemetry.RecordSourceFrames(*this, 1);
   m_telemetry.RecordSourceBytes(*this, static_cast<int>(image->size()));
@@ -442,11 +467,12 @@ void SourceImpl::PutFrame(std::unique_ptr<Image> image, Frame::Time time) {
   // Update frame
   {
     std::lock_guard<wpi::mutex> lock{m_frameMutex};
-    m_frame = Frame{*this, std::move(image), time};
+    m_frame = Frame{*this, std::move(image), time, captureTime};
   }
 
   // Signal listeners
   m_frameCv.notify_all();
+  NotifyFrameListeners();
 }
 
 void SourceImpl::PutError(const wpi::Twine& msg, Frame::Time time) {
@@ -458,6 +484,7 @@ void SourceImpl::PutError(const wpi::Twine& msg, Frame::Time time) {
 
   // Signal listeners
   m_frameCv.notify_all();
+  NotifyFrameListeners();
 }
 
 void SourceImpl::NotifyPropertyCreated(int propIndex, PropertyImpl& prop) {
@@ -490,6 +517,8 @@ void SourceImpl::UpdatePropertyValue(int property, bool setString, int value,
 }
 
 void SourceImpl::ReleaseImage(std::unique_ptr<Image> image) {
+  // Images wrapping external data are released by their destructor
+  if (image->IsExternal()) return;
   std::lock_guard<wpi::mutex> lock{m_poolMutex};
   if (m_destroyFrames) return;
   // Return the frame to the pool.  First try to find an empty slot, otherwise
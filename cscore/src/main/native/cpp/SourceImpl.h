@@ -10,8 +10,10 @@
 
 #include <atomic>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <wpi/ArrayRef.h>
@@ -110,6 +112,13 @@ class SourceImpl : public PropertyContainer {
   // Force a wakeup of all GetNextFrame() callers by sending an empty frame.
   void Wakeup();
 
+  // Frame listeners are called (on the thread that put the frame) each time
+  // GetNextFrame() callers are woken.  They must not block; they are intended
+  // for waking an event loop, which then calls GetCurFrame().  Once
+  // RemoveFrameListener() returns, the listener will not be called again.
+  int AddFrameListener(std::function<void()> listener);
+  void RemoveFrameListener(int uid);
+
   // Standard common camera properties
   virtual void SetBrightness(int brightness, CS_Status* status);
   virtual int GetBrightness(CS_Status* status) const;
@@ -146,9 +155,13 @@ class SourceImpl : public PropertyContainer {
   void UpdatePropertyValue(int property, bool setString, int value,
                            const wpi::Twine& valueStr) override;
 
+  // captureTime is the hardware capture time if known (see
+  // Frame::GetCaptureTime()); 0 means the same as time.
   void PutFrame(VideoMode::PixelFormat pixelFormat, int width, int height,
-                wpi::StringRef data, Frame::Time time);
-  void PutFrame(std::unique_ptr<Image> image, Frame::Time time);
+                wpi::StringRef data, Frame::Time time,
+                Frame::Time captureTime = 0);
+  void PutFrame(std::unique_ptr<Image> image, Frame::Time time,
+                Frame::Time captureTime = 0);
   void PutError(const wpi::Twine& msg, Frame::Time time);
 
   // Notification functions for corresponding atomics
@@ -171,6 +184,7 @@ class SourceImpl : public PropertyContainer {
   void ReleaseImage(std::unique_ptr<Image> image);
   std::unique_ptr<Frame::Impl> AllocFrameImpl();
   void ReleaseFrameImpl(std::unique_ptr<Frame::Impl> data);
+  void NotifyFrameListeners();
 
   std::string m_name;
   std::string m_description;
@@ -183,6 +197,10 @@ class SourceImpl : public PropertyContainer {
 
   bool m_destroyFrames{false};
 
+  wpi::mutex m_frameListenersMutex;
+  std::vector<std::pair<int, std::function<void()>>> m_frameListeners;
+  int m_frameListenerUid{0};
+
   // Pool of frames/images to reduce malloc traffic.
   wpi::mutex m_poolMutex;
   std::vector<std::unique_ptr<Frame::Impl>> m_framesAvail;
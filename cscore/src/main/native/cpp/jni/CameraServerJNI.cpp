@@ -1430,6 +1430,18 @@ Java_edu_wpi_cscore_CameraServerJNI_getMjpegServerPort
   return val;
 }
 
+/*
+ * Class:     edu_wpi_cscore_CameraServerJNI
+ * Method:    setMjpegServerEventLoop
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_cscore_CameraServerJNI_setMjpegServerEventLoop
+  (JNIEnv* env, jclass, jboolean enabled)
+{
+  cs::SetMjpegServerEventLoop(enabled);
+}
+
 /*
  * Class:     edu_wpi_cscore_CameraServerJNI
  * Method:    setSinkDescription
@@ -1480,6 +1492,21 @@ Java_edu_wpi_cscore_CameraServerJNI_grabSinkFrameTimeout
   return rv;
 }
 
+/*
+ * Class:     edu_wpi_cscore_CameraServerJNI
+ * Method:    getSinkLastFrameCaptureTime
+ * Signature: (I)J
+ */
+JNIEXPORT jlong JNICALL
+Java_edu_wpi_cscore_CameraServerJNI_getSinkLastFrameCaptureTime
+  (JNIEnv* env, jclass, jint sink)
+{
+  CS_Status status = 0;
+  auto rv = cs::GetSinkLastFrameCaptureTime(sink, &status);
+  CheckStatus(env, status);
+  return rv;
+}
+
 /*
  * Class:     edu_wpi_cscore_CameraServerJNI
  * Method:    getSinkError
@@ -407,6 +407,7 @@ void CS_ReleaseSink(CS_Sink sink, CS_Status* status);
  */
 char* CS_GetMjpegServerListenAddress(CS_Sink sink, CS_Status* status);
 int CS_GetMjpegServerPort(CS_Sink sink, CS_Status* status);
+void CS_SetMjpegServerEventLoop(CS_Bool enabled);
 /** @} */
 
 /**
@@ -418,6 +419,7 @@ void CS_SetSinkDescription(CS_Sink sink, const char* description,
 uint64_t CS_GrabSinkFrame(CS_Sink sink, struct CvMat* image, CS_Status* status);
 uint64_t CS_GrabSinkFrameTimeout(CS_Sink sink, struct CvMat* image,
                                  double timeout, CS_Status* status);
+uint64_t CS_GetSinkLastFrameCaptureTime(CS_Sink sink, CS_Status* status);
 char* CS_GetSinkError(CS_Sink sink, CS_Status* status);
 void CS_SetSinkEnabled(CS_Sink sink, CS_Bool enabled, CS_Status* status);
 /** @} */
@@ -348,6 +348,7 @@ void ReleaseSink(CS_Sink sink, CS_Status* status);
  */
 std::string GetMjpegServerListenAddress(CS_Sink sink, CS_Status* status);
 int GetMjpegServerPort(CS_Sink sink, CS_Status* status);
+void SetMjpegServerEventLoop(bool enabled);
 /** @} */
 
 /**
@@ -359,6 +360,7 @@ void SetSinkDescription(CS_Sink sink, const wpi::Twine& description,
 uint64_t GrabSinkFrame(CS_Sink sink, cv::Mat& image, CS_Status* status);
 uint64_t GrabSinkFrameTimeout(CS_Sink sink, cv::Mat& image, double timeout,
                               CS_Status* status);
+uint64_t GetSinkLastFrameCaptureTime(CS_Sink sink, CS_Status* status);
 std::string GetSinkError(CS_Sink sink, CS_Status* status);
 wpi::StringRef GetSinkError(CS_Sink sink, wpi::SmallVectorImpl<char>& buf,
                             CS_Status* status);
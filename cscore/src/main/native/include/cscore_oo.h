@@ -460,6 +460,16 @@ class UsbCamera : public VideoCamera {
    * @param level 0=don't display Connecting message, 1=do display message
    */
   void SetConnectVerbose(int level);
+
+  /**
+   * Set whether frames reference the camera driver's buffers directly
+   * rather than copying them.  This avoids a copy of every frame, but more
+   * driver buffers are used, and frames are copied again if too many are
+   * held at once.  Changing this reconnects to the camera.
+   *
+   * @param enabled true to enable zero-copy frames
+   */
+  void SetZeroCopy(bool enabled);
 };
 
 /**
@@ -1038,6 +1048,17 @@ class CvSink : public VideoSink {
    */
   uint64_t GrabFrameNoTimeout(cv::Mat& image) const;
 
+  /**
+   * Get the time the frame last returned by GrabFrame() was captured.  For
+   * cameras that provide hardware timestamps, this is earlier than the
+   * frame time returned by GrabFrame() by the capture and driver latency;
+   * otherwise it's the same.
+   *
+   * @return Capture time, in the same time base as wpi::Now(), in 1 us
+   *         increments
+   */
+  uint64_t GetLastFrameCaptureTime() const;
+
   /**
    * Get error string.  Call this if WaitForFrame() returns 0 to determine
    * what the error is.
@@ -271,6 +271,12 @@ inline void UsbCamera::SetConnectVerbose(int level) {
               &m_status);
 }
 
+inline void UsbCamera::SetZeroCopy(bool enabled) {
+  m_status = 0;
+  SetProperty(GetSourceProperty(m_handle, "zero_copy", &m_status),
+              enabled ? 1 : 0, &m_status);
+}
+
 inline HttpCamera::HttpCamera(const wpi::Twine& name, const wpi::Twine& url,
                               HttpCameraKind kind) {
   m_handle = CreateHttpCamera(
@@ -599,6 +605,11 @@ inline uint64_t CvSink::GrabFrameNoTimeout(cv::Mat& image) const {
   return GrabSinkFrame(m_handle, image, &m_status);
 }
 
+inline uint64_t CvSink::GetLastFrameCaptureTime() const {
+  m_status = 0;
+  return GetSinkLastFrameCaptureTime(m_handle, &m_status);
+}
+
 inline std::string CvSink::GetError() const {
   m_status = 0;
   return GetSinkError(m_handle, &m_status);
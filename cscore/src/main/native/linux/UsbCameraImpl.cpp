@@ -20,6 +20,7 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -49,6 +50,31 @@ static constexpr char const* kPropExValue = "exposure_absolute";
 static constexpr char const* kPropBrValue = "brightness";
 static constexpr char const* kPropConnectVerbose = "connect_verbose";
 static constexpr unsigned kPropConnectVerboseId = 0;
+static constexpr char const* kPropZeroCopy = "zero_copy";
+static constexpr unsigned kPropZeroCopyId = 1;
+
+// Converts a V4L2 buffer timestamp into the wpi::Now() time base, given the
+// current wpi::Now() time.  Returns 0 if the driver doesn't provide monotonic
+// timestamps.  Depending on the driver, the timestamp is taken at either the
+// start or the end of the frame.
+static Frame::Time GetCaptureTime(const struct v4l2_buffer& buf,
+                                  Frame::Time now) {
+#ifdef V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC
+  if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) !=
+      V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+    return 0;
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return 0;
+  // wpi::Now() may use a different clock, so convert using the age
+  int64_t age = (static_cast<int64_t>(ts.tv_sec) - buf.timestamp.tv_sec) *
+                    1000000 +
+                (ts.tv_nsec / 1000 - buf.timestamp.tv_usec);
+  if (age < 0 || static_cast<uint64_t>(age) >= now) return 0;
+  return now - age;
+#else
+  return 0;
+#endif
+}
 
 // Conversions v4l2_fract time per frame from/to frames per second (fps)
 static inline int FractToFPS(const struct v4l2_fract& timeperframe) {
@@ -220,6 +246,9 @@ UsbCameraImpl::UsbCameraImpl(const wpi::Twine& name, wpi::Logger& logger,
       m_fd{-1},
       m_command_fd{eventfd(0, 0)},
       m_active{true} {
+  m_returnedBuffers = std::make_shared<ReturnedBuffers>();
+  m_returnedBuffers->command_fd = m_command_fd;
+
   SetDescription(GetDescriptionImpl(m_path.c_str()));
   SetQuirks();
 
@@ -228,6 +257,10 @@ UsbCameraImpl::UsbCameraImpl(const wpi::Twine& name, wpi::Logger& logger,
                                                kPropConnectVerboseId,
                                                CS_PROP_INTEGER, 0, 1, 1, 1, 1);
   });
+  CreateProperty(kPropZeroCopy, [] {
+    return std::make_unique<UsbCameraProperty>(kPropZeroCopy, kPropZeroCopyId,
+                                               CS_PROP_BOOLEAN, 0, 1, 1, 0, 0);
+  });
 }
 
 UsbCameraImpl::~UsbCameraImpl() {
@@ -243,6 +276,12 @@ UsbCameraImpl::~UsbCameraImpl() {
   // join camera thread
   if (m_cameraThread.joinable()) m_cameraThread.join();
 
+  // frames may still hold driver buffers; stop them from waking us
+  {
+    std::lock_guard<wpi::mutex> lock(m_returnedBuffers->mutex);
+    m_returnedBuffers->command_fd = -1;
+  }
+
   // close command fd
   int fd = m_command_fd.exchange(-1);
   if (fd >= 0) close(fd);
@@ -378,6 +417,7 @@ void UsbCameraImpl::CameraThreadMain() {
       // Read it to clear
       eventfd_t val;
       eventfd_read(command_fd, &val);
+      DeviceRequeueBuffers();
       DeviceProcessCommands();
       continue;
     }
@@ -400,16 +440,21 @@ void UsbCameraImpl::CameraThreadMain() {
         continue;         // will reconnect
       }
 
+      --m_numQueued;
+      Frame::Time now = wpi::Now();
+      Frame::Time captureTime = GetCaptureTime(buf, now);
+
       if ((buf.flags & V4L2_BUF_FLAG_ERROR) == 0) {
         SDEBUG4("got image size=" << buf.bytesused << " index=" << buf.index);
 
-        if (buf.index >= kNumBuffers || !m_buffers[buf.index].m_data) {
+        if (buf.index >= static_cast<unsigned>(m_numBuffers) ||
+            !m_buffers[buf.index]) {
           SWARNING("invalid buffer" << buf.index);
           continue;
         }
 
         wpi::StringRef image{
-            static_cast<const char*>(m_buffers[buf.index].m_data),
+            static_cast<const char*>(m_buffers[buf.index]->m_data),
             static_cast<size_t>(buf.bytesused)};
         int width = m_mode.width;
         int height = m_mode.height;
@@ -419,14 +464,20 @@ void UsbCameraImpl::CameraThreadMain() {
           SWARNING("invalid JPEG image received from camera");
           good = false;
         }
+        if (good && m_zeroCopy && m_numQueued >= kMinQueuedBuffers) {
+          // hand the buffer itself to the frame; it's requeued once released
+          DevicePutBuffer(buf.index, image.size(), width, height, now,
+                          captureTime);
+          continue;
+        }
         if (good) {
           PutFrame(static_cast<VideoMode::PixelFormat>(m_mode.pixelFormat),
-                   width, height, image, wpi::Now());  // TODO: time
+                   width, height, image, now, captureTime);
         }
       }
 
       // Requeue buffer
-      if (DoIoctl(fd, VIDIOC_QBUF, &buf) != 0) {
+      if (!DeviceQueueBuffer(buf.index)) {
         SWARNING("could not requeue buffer");
         wasStreaming = m_streaming;
         DeviceStreamOff();
@@ -446,9 +497,9 @@ void UsbCameraImpl::DeviceDisconnect() {
   int fd = m_fd.exchange(-1);
   if (fd < 0) return;  // already disconnected
 
-  // Unmap buffers
-  for (int i = 0; i < kNumBuffers; ++i)
-    m_buffers[i] = std::move(UsbCameraBuffer{});
+  // Unmap buffers (buffers still held by frames are unmapped when released)
+  for (auto& buffer : m_buffers) buffer.reset();
+  m_numBuffers = 0;
 
   // Close device
   close(fd);
@@ -507,19 +558,21 @@ void UsbCameraImpl::DeviceConnect() {
   SDEBUG3("allocating buffers");
   struct v4l2_requestbuffers rb;
   std::memset(&rb, 0, sizeof(rb));
-  rb.count = kNumBuffers;
+  rb.count = m_zeroCopy ? kNumZeroCopyBuffers : kNumBuffers;
   rb.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
   rb.memory = V4L2_MEMORY_MMAP;
-  if (DoIoctl(fd, VIDIOC_REQBUFS, &rb) != 0) {
+  if (DoIoctl(fd, VIDIOC_REQBUFS, &rb) != 0 || rb.count == 0) {
     SWARNING("could not allocate buffers");
     close(fd);
     m_fd = -1;
     return;
   }
+  // the driver may give us a different number than we asked for
+  m_numBuffers = std::min<int>(rb.count, kNumZeroCopyBuffers);
 
   // Map buffers
   SDEBUG3("mapping buffers");
-  for (int i = 0; i < kNumBuffers; ++i) {
+  for (int i = 0; i < m_numBuffers; ++i) {
     struct v4l2_buffer buf;
     std::memset(&buf, 0, sizeof(buf));
     buf.index = i;
@@ -527,6 +580,8 @@ void UsbCameraImpl::DeviceConnect() {
     buf.memory = V4L2_MEMORY_MMAP;
     if (DoIoctl(fd, VIDIOC_QUERYBUF, &buf) != 0) {
       SWARNING("could not query buffer " << i);
+      for (int j = 0; j < i; ++j) m_buffers[j].reset();
+      m_numBuffers = 0;
       close(fd);
       m_fd = -1;
       return;
@@ -534,17 +589,20 @@ void UsbCameraImpl::DeviceConnect() {
     SDEBUG4("buf " << i << " length=" << buf.length
                    << " offset=" << buf.m.offset);
 
-    m_buffers[i] = std::move(UsbCameraBuffer(fd, buf.length, buf.m.offset));
-    if (!m_buffers[i].m_data) {
+    m_buffers[i] =
+        std::make_shared<UsbCameraBuffer>(fd, buf.length, buf.m.offset);
+    m_bufferHeld[i] = false;
+    if (!m_buffers[i]->m_data) {
       SWARNING("could not map buffer " << i);
       // release other buffers
-      for (int j = 0; j < i; ++j) m_buffers[j] = std::move(UsbCameraBuffer{});
+      for (int j = 0; j <= i; ++j) m_buffers[j].reset();
+      m_numBuffers = 0;
       close(fd);
       m_fd = -1;
       return;
     }
 
-    SDEBUG4("buf " << i << " address=" << m_buffers[i].m_data);
+    SDEBUG4("buf " << i << " address=" << m_buffers[i]->m_data);
   }
 
   // Update description (as it may have changed)
@@ -562,15 +620,13 @@ bool UsbCameraImpl::DeviceStreamOn() {
   int fd = m_fd.load();
   if (fd < 0) return false;
 
-  // Queue buffers
+  // Queue buffers (except for ones still held by frames; those are queued
+  // when released)
   SDEBUG3("queuing buffers");
-  for (int i = 0; i < kNumBuffers; ++i) {
-    struct v4l2_buffer buf;
-    std::memset(&buf, 0, sizeof(buf));
-    buf.index = i;
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_MMAP;
-    if (DoIoctl(fd, VIDIOC_QBUF, &buf) != 0) {
+  m_numQueued = 0;
+  for (int i = 0; i < m_numBuffers; ++i) {
+    if (m_bufferHeld[i]) continue;
+    if (!DeviceQueueBuffer(i)) {
       SWARNING("could not queue buffer " << i);
       return false;
     }
@@ -604,9 +660,58 @@ bool UsbCameraImpl::DeviceStreamOff() {
   if (DoIoctl(fd, VIDIOC_STREAMOFF, &type) != 0) return false;
   SDEBUG4("disabled streaming");
   m_streaming = false;
+  m_numQueued = 0;  // stream off dequeues all buffers
   return true;
 }
 
+bool UsbCameraImpl::DeviceQueueBuffer(int index) {
+  int fd = m_fd.load();
+  if (fd < 0) return false;
+  struct v4l2_buffer buf;
+  std::memset(&buf, 0, sizeof(buf));
+  buf.index = index;
+  buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  buf.memory = V4L2_MEMORY_MMAP;
+  if (DoIoctl(fd, VIDIOC_QBUF, &buf) != 0) return false;
+  ++m_numQueued;
+  return true;
+}
+
+void UsbCameraImpl::DeviceRequeueBuffers() {
+  decltype(m_returnedBuffers->buffers) returned;
+  {
+    std::lock_guard<wpi::mutex> lock(m_returnedBuffers->mutex);
+    returned.swap(m_returnedBuffers->buffers);
+  }
+  for (auto& buffer : returned) {
+    int index = buffer.first;
+    // buffers from before a reconnect are simply unmapped
+    if (index >= m_numBuffers || m_buffers[index] != buffer.second) continue;
+    m_bufferHeld[index] = false;
+    if (m_streaming && !DeviceQueueBuffer(index))
+      SWARNING("could not requeue buffer " << index);
+  }
+}
+
+void UsbCameraImpl::DevicePutBuffer(int index, size_t size, int width,
+                                    int height, Frame::Time time,
+                                    Frame::Time captureTime) {
+  auto buffer = m_buffers[index];
+  auto returned = m_returnedBuffers;
+  auto image = std::make_unique<Image>(
+      static_cast<char*>(buffer->m_data), size, [=] {
+        std::lock_guard<wpi::mutex> lock(returned->mutex);
+        if (returned->command_fd < 0) return;
+        returned->buffers.emplace_back(index, buffer);
+        eventfd_write(returned->command_fd, 1);
+      });
+  image->pixelFormat = static_cast<VideoMode::PixelFormat>(m_mode.pixelFormat);
+  image->width = width;
+  image->height = height;
+  m_bufferHeld[index] = true;
+  PutFrame(std::move(image), time, captureTime);
+}
+
 CS_StatusValue UsbCameraImpl::DeviceCmdSetMode(
     std::unique_lock<wpi::mutex>& lock, const Message& msg) {
   VideoMode newMode;
@@ -703,7 +808,21 @@ CS_StatusValue UsbCameraImpl::DeviceCmdSetProperty(
 
   // Actually set the new value on the device (if possible)
   if (!prop->device) {
-    if (prop->id == kPropConnectVerboseId) m_connectVerbose = value;
+    if (prop->id == kPropConnectVerboseId) {
+      m_connectVerbose = value;
+    } else if (prop->id == kPropZeroCopyId && m_zeroCopy != (value != 0)) {
+      m_zeroCopy = value != 0;
+      // the number of buffers is set on connect, so reconnect
+      lock.unlock();
+      bool wasStreaming = m_streaming;
+      if (wasStreaming) DeviceStreamOff();
+      if (m_fd >= 0) {
+        DeviceDisconnect();
+        DeviceConnect();
+      }
+      if (wasStreaming) DeviceStreamOn();
+      lock.lock();
+    }
   } else {
     if (!prop->DeviceSet(lock, m_fd, value, valueStr))
       return CS_PROPERTY_WRITE_FAILED;
@@ -117,6 +117,10 @@ class UsbCameraImpl : public SourceImpl {
   void DeviceConnect();
   bool DeviceStreamOn();
   bool DeviceStreamOff();
+  bool DeviceQueueBuffer(int index);
+  void DeviceRequeueBuffers();
+  void DevicePutBuffer(int index, size_t size, int width, int height,
+                       Frame::Time time, Frame::Time captureTime);
   void DeviceProcessCommands();
   void DeviceSetMode();
   void DeviceSetFPS();
@@ -150,7 +154,27 @@ class UsbCameraImpl : public SourceImpl {
   unsigned m_capabilities = 0;
   // Number of buffers to ask OS for
   static constexpr int kNumBuffers = 4;
-  std::array<UsbCameraBuffer, kNumBuffers> m_buffers;
+  // In zero-copy mode, frames hold on to driver buffers until they are
+  // released, so ask for more to keep capturing in the meantime.  If fewer
+  // than kMinQueuedBuffers would be left queued, the frame is copied
+  // instead.
+  static constexpr int kNumZeroCopyBuffers = 8;
+  static constexpr int kMinQueuedBuffers = 2;
+  std::array<std::shared_ptr<UsbCameraBuffer>, kNumZeroCopyBuffers> m_buffers;
+  std::array<bool, kNumZeroCopyBuffers> m_bufferHeld;  // held by a frame
+  int m_numBuffers{0};
+  int m_numQueued{0};  // buffers currently queued to the driver
+  bool m_zeroCopy{false};
+
+  // Driver buffers released by frames (zero-copy mode), waiting to be
+  // requeued by the camera thread.  Shared with the frames, as they may
+  // outlive this object.
+  struct ReturnedBuffers {
+    wpi::mutex mutex;
+    int command_fd;  // -1 once the camera is destroyed
+    std::vector<std::pair<int, std::shared_ptr<UsbCameraBuffer>>> buffers;
+  };
+  std::shared_ptr<ReturnedBuffers> m_returnedBuffers;
 
   //
   // Path never changes, so not protected by mutex.
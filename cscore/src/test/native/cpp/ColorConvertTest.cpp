@@ -0,0 +1,157 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "ColorConvert.h"
+#include "gtest/gtest.h"
+
+namespace cs {
+
+// Runs each test with every implementation supported by this CPU; results
+// must be identical to the OpenCV conversions.
+class ColorConvertTest : public ::testing::TestWithParam<ColorConvertImpl> {
+ protected:
+  void SetUp() override {
+    m_prevImpl = GetColorConvertImpl();
+    if (!SetColorConvertImpl(GetParam()))
+      m_supported = false;
+  }
+
+  void TearDown() override { SetColorConvertImpl(m_prevImpl); }
+
+  static cv::Mat RandomMat(int width, int height, int type) {
+    cv::Mat mat{height, width, type};
+    cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(256));
+    return mat;
+  }
+
+  static const uint8_t* In(const cv::Mat& mat) { return mat.ptr<uint8_t>(); }
+  static uint8_t* Out(cv::Mat& mat) { return mat.ptr<uint8_t>(); }
+
+  static void ExpectEqual(const cv::Mat& expected, const cv::Mat& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    ASSERT_EQ(expected.type(), actual.type());
+    EXPECT_EQ(0, cv::norm(expected, actual, cv::NORM_INF));
+  }
+
+  bool m_supported = true;
+
+ private:
+  ColorConvertImpl m_prevImpl;
+};
+
+// Widths exercising the vector loops and the scalar remainders
+static const int kWidths[] = {2, 14, 16, 18, 46, 320, 642};
+
+TEST_P(ColorConvertTest, YUYVToBGR) {
+  if (!m_supported) return;
+  for (int width : kWidths) {
+    cv::Mat in = RandomMat(width, 3, CV_8UC2);
+    cv::Mat expected, actual{3, width, CV_8UC3};
+    cv::cvtColor(in, expected, cv::COLOR_YUV2BGR_YUYV);
+    YUYVToBGR(In(in), Out(actual), in.total());
+    ExpectEqual(expected, actual);
+  }
+}
+
+TEST_P(ColorConvertTest, YUYVToBGRExtremes) {
+  if (!m_supported) return;
+  // every U/V combination with Y at and beyond the ends of its range
+  cv::Mat in{256, 256 * 4, CV_8UC2};
+  for (int u = 0; u < 256; ++u) {
+    for (int v = 0; v < 256; ++v) {
+      for (int i = 0; i < 4; ++i) {
+        static const uint8_t kY[] = {0, 16, 235, 255};
+        uint8_t* p = in.ptr<uint8_t>(u, v * 4 + i);
+        p[0] = kY[i];
+        p[1] = (i % 2) == 0 ? u : v;
+      }
+    }
+  }
+  cv::Mat expected, actual{in.rows, in.cols, CV_8UC3};
+  cv::cvtColor(in, expected, cv::COLOR_YUV2BGR_YUYV);
+  YUYVToBGR(In(in), Out(actual), in.total());
+  ExpectEqual(expected, actual);
+}
+
+TEST_P(ColorConvertTest, YUYVToGray) {
+  if (!m_supported) return;
+  for (int width : kWidths) {
+    cv::Mat in = RandomMat(width, 3, CV_8UC2);
+    // neutral chroma, so the result matches conversion through BGR
+    for (size_t i = 0; i < in.total(); ++i) Out(in)[i * 2 + 1] = 128;
+    cv::Mat bgr, expected, actual{3, width, CV_8UC1};
+    cv::cvtColor(in, bgr, cv::COLOR_YUV2BGR_YUYV);
+    cv::cvtColor(bgr, expected, cv::COLOR_BGR2GRAY);
+    YUYVToGray(In(in), Out(actual), in.total());
+    ExpectEqual(expected, actual);
+  }
+}
+
+TEST_P(ColorConvertTest, BGRToGray) {
+  if (!m_supported) return;
+  for (int width : kWidths) {
+    cv::Mat in = RandomMat(width, 3, CV_8UC3);
+    cv::Mat expected, actual{3, width, CV_8UC1};
+    cv::cvtColor(in, expected, cv::COLOR_BGR2GRAY);
+    BGRToGray(In(in), Out(actual), in.total());
+    ExpectEqual(expected, actual);
+  }
+}
+
+TEST_P(ColorConvertTest, BGRToRGB565) {
+  if (!m_supported) return;
+  for (int width : kWidths) {
+    cv::Mat in = RandomMat(width, 3, CV_8UC3);
+    cv::Mat expected, actual{3, width, CV_8UC2};
+    cv::cvtColor(in, expected, cv::COLOR_RGB2BGR565);
+    BGRToRGB565(In(in), Out(actual), in.total());
+    ExpectEqual(expected, actual);
+  }
+}
+
+TEST_P(ColorConvertTest, RGB565ToBGR) {
+  if (!m_supported) return;
+  for (int width : kWidths) {
+    cv::Mat in = RandomMat(width, 3, CV_8UC2);
+    cv::Mat expected, actual{3, width, CV_8UC3};
+    cv::cvtColor(in, expected, cv::COLOR_BGR5652RGB);
+    RGB565ToBGR(In(in), Out(actual), in.total());
+    ExpectEqual(expected, actual);
+  }
+}
+
+TEST_P(ColorConvertTest, GrayToBGR) {
+  if (!m_supported) return;
+  for (int width : kWidths) {
+    cv::Mat in = RandomMat(width, 3, CV_8UC1);
+    cv::Mat expected, actual{3, width, CV_8UC3};
+    cv::cvtColor(in, expected, cv::COLOR_GRAY2BGR);
+    GrayToBGR(In(in), Out(actual), in.total());
+    ExpectEqual(expected, actual);
+  }
+}
+
+// Frame must keep using cvtColor() when there's no vector implementation
+TEST(ColorConvertFasterTest, Scalar) {
+  auto prevImpl = GetColorConvertImpl();
+  SetColorConvertImpl(kColorConvertScalar);
+  EXPECT_FALSE(IsColorConvertFaster(kColorConvertYUYVToBGR));
+  EXPECT_FALSE(IsColorConvertFaster(kColorConvertYUYVToGray));
+  EXPECT_FALSE(IsColorConvertFaster(kColorConvertBGRToGray));
+  SetColorConvertImpl(prevImpl);
+}
+
+INSTANTIATE_TEST_CASE_P(ColorConvertImpls, ColorConvertTest,
+                        ::testing::Values(kColorConvertScalar,
+                                          kColorConvertSSE41,
+                                          kColorConvertAVX2,
+                                          kColorConvertNEON));
+
+}  // namespace cs
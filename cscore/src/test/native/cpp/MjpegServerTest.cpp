@@ -0,0 +1,148 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <wpi/Logger.h>
+#include <wpi/StringRef.h>
+#include <wpi/TCPConnector.h>
+
+#include "cscore.h"
+#include "gtest/gtest.h"
+
+namespace cs {
+
+// Parameter is whether to use the event loop server
+class MjpegServerTest : public ::testing::TestWithParam<bool> {
+ protected:
+  MjpegServerTest() { SetMjpegServerEventLoop(GetParam()); }
+  ~MjpegServerTest() override { SetMjpegServerEventLoop(false); }
+
+  // Connects to the stream and returns the number of complete frames read
+  // (up to count) before the timeout.
+  int ReadFrames(int port, int count);
+
+  wpi::Logger m_logger;
+};
+
+int MjpegServerTest::ReadFrames(int port, int count) {
+  // The server may not be listening yet
+  std::unique_ptr<wpi::NetworkStream> stream;
+  for (int i = 0; i < 50 && !stream; ++i) {
+    stream = wpi::TCPConnector::connect("127.0.0.1", port, m_logger, 1);
+    if (!stream) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  if (!stream) return -1;
+  wpi::NetworkStream::Error err;
+  static const char request[] = "GET /stream.mjpg HTTP/1.0\r\n\r\n";
+  stream->send(request, sizeof(request) - 1, &err);
+
+  // Parse parts as they arrive; each must hold a complete JPEG image.
+  std::string data;
+  size_t pos = 0;
+  char buf[4096];
+  int frames = 0;
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (frames < count && std::chrono::steady_clock::now() < end) {
+    size_t len = stream->receive(buf, sizeof(buf), &err, 1);
+    if (len == 0) {
+      if (err == wpi::NetworkStream::kConnectionTimedOut) continue;
+      break;
+    }
+    data.append(buf, len);
+    while (frames < count) {
+      size_t part = data.find("\r\n--boundarydonotcross\r\n", pos);
+      if (part == std::string::npos) break;
+      size_t lenPos = data.find("Content-Length: ", part);
+      size_t body = data.find("\r\n\r\n", part);
+      if (lenPos == std::string::npos || body == std::string::npos) break;
+      size_t size = std::stoul(data.substr(lenPos + 16));
+      body += 4;
+      if (data.size() < body + size) break;
+      EXPECT_EQ(data.substr(body, 2), "\xff\xd8");
+      EXPECT_EQ(data.substr(body + size - 2, 2), "\xff\xd9");
+      pos = body + size;
+      ++frames;
+    }
+  }
+  stream->close();
+  return frames;
+}
+
+TEST_P(MjpegServerTest, Stream) {
+  int port = GetParam() ? 8093 : 8092;
+  CvSource source{"source", VideoMode::kMJPEG, 160, 120, 30};
+  MjpegServer server{"server", port};
+  server.SetSource(source);
+
+  std::atomic_bool done{false};
+  std::thread feeder([&] {
+    cv::Mat image{120, 160, CV_8UC3};
+    for (int i = 0; !done; ++i) {
+      image.setTo(cv::Scalar(i % 256, 128, 255 - i % 256));
+      source.PutFrame(image);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  });
+
+  // Read several frames, disconnect, then check the server still streams to
+  // a new connection.
+  EXPECT_EQ(ReadFrames(port, 5), 5);
+  EXPECT_EQ(ReadFrames(port, 3), 3);
+
+  done = true;
+  feeder.join();
+}
+
+// Connections accepted together must not all be allowed to stream.
+TEST(MjpegServerLoopTest, StreamLimit) {
+  SetMjpegServerEventLoop(true);
+  CvSource source{"source", VideoMode::kMJPEG, 160, 120, 30};
+  MjpegServer server{"server", 8094};
+  server.SetSource(source);
+  SetMjpegServerEventLoop(false);
+
+  wpi::Logger logger;
+  std::vector<std::unique_ptr<wpi::NetworkStream>> streams;
+  for (int i = 0; i < 12; ++i) {
+    auto stream = wpi::TCPConnector::connect("127.0.0.1", 8094, logger, 1);
+    ASSERT_TRUE(stream);
+    streams.emplace_back(std::move(stream));
+  }
+  wpi::NetworkStream::Error err;
+  static const char request[] = "GET /stream.mjpg HTTP/1.0\r\n\r\n";
+  for (auto& stream : streams) stream->send(request, sizeof(request) - 1, &err);
+
+  int ok = 0;
+  int busy = 0;
+  for (auto& stream : streams) {
+    char buf[13];
+    size_t len = 0;
+    while (len < sizeof(buf) - 1) {
+      size_t n = stream->receive(buf + len, sizeof(buf) - 1 - len, &err, 2);
+      if (n == 0) break;
+      len += n;
+    }
+    wpi::StringRef status{buf, len};
+    if (status == "HTTP/1.0 200") ++ok;
+    if (status == "HTTP/1.0 503") ++busy;
+    stream->close();
+  }
+  EXPECT_EQ(ok, 10);
+  EXPECT_EQ(busy, 2);
+}
+
+INSTANTIATE_TEST_CASE_P(MjpegServerTests, MjpegServerTest,
+                        ::testing::Values(false, true));
+
+}  // namespace cs
@@ -0,0 +1,182 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include "Benchmark.h"
+
+#include <algorithm>
+
+#include <wpi/FileSystem.h>
+#include <wpi/Format.h>
+#include <wpi/json.h>
+#include <wpi/raw_ostream.h>
+
+using namespace nt::bench;
+
+namespace {
+
+struct BenchmarkInfo {
+  std::string name;
+  BenchmarkFunc func;
+  uint64_t iterations;
+};
+
+struct Result {
+  std::string name;
+  uint64_t iterations = 0;
+  double ns_per_iter = 0;  // median over repetitions
+  double ns_min = 0;
+  double ns_max = 0;
+  double items_per_sec = 0;
+  double bytes_per_sec = 0;
+  std::vector<std::pair<std::string, double>> counters;
+  std::string error;
+};
+
+}  // namespace
+
+static std::vector<BenchmarkInfo>& GetBenchmarks() {
+  static std::vector<BenchmarkInfo> benchmarks;
+  return benchmarks;
+}
+
+void nt::bench::Register(const wpi::Twine& name, BenchmarkFunc func,
+                         uint64_t iterations) {
+  GetBenchmarks().push_back(BenchmarkInfo{name.str(), func, iterations});
+}
+
+static Result RunOne(const BenchmarkInfo& info, const Options& options) {
+  Result result;
+  result.name = info.name;
+
+  // calibrate the number of iterations so a single run takes at least
+  // min_time seconds
+  uint64_t iterations = info.iterations;
+  if (iterations == 0) {
+    iterations = 1;
+    for (;;) {
+      State state(iterations);
+      info.func(state);
+      if (state.error()) {
+        result.error = state.error();
+        return result;
+      }
+      double secs = state.elapsed().count();
+      if (secs >= options.min_time || iterations >= (1ull << 40)) break;
+      // aim 40% beyond the target, but grow by at most 10x per step
+      double mult = secs > 0 ? options.min_time * 1.4 / secs : 10.0;
+      if (mult > 10.0) mult = 10.0;
+      if (mult < 2.0) mult = 2.0;
+      iterations = static_cast<uint64_t>(iterations * mult);
+    }
+  }
+  result.iterations = iterations;
+
+  std::vector<double> times;
+  double items = 0;
+  double bytes = 0;
+  for (int rep = 0; rep < options.repetitions; ++rep) {
+    State state(iterations);
+    info.func(state);
+    if (state.error()) {
+      result.error = state.error();
+      return result;
+    }
+    double secs = state.elapsed().count();
+    times.push_back(secs * 1e9 / iterations);
+    if (secs > 0) {
+      items += state.items() / secs;
+      bytes += state.bytes() / secs;
+    }
+    result.counters = state.counters();
+  }
+
+  std::sort(times.begin(), times.end());
+  result.ns_per_iter = times[times.size() / 2];
+  result.ns_min = times.front();
+  result.ns_max = times.back();
+  result.items_per_sec = items / options.repetitions;
+  result.bytes_per_sec = bytes / options.repetitions;
+  return result;
+}
+
+static void WriteJson(const std::string& filename,
+                      const std::vector<Result>& results,
+                      const Options& options) {
+  wpi::json j;
+  j["context"] = {{"min_time", options.min_time},
+                  {"repetitions", options.repetitions}};
+  wpi::json benchmarks = wpi::json::array();
+  for (auto& result : results) {
+    wpi::json b = {{"name", result.name}};
+    if (!result.error.empty()) {
+      b["error"] = result.error;
+    } else {
+      b["iterations"] = result.iterations;
+      b["time_ns"] = result.ns_per_iter;
+      b["time_min_ns"] = result.ns_min;
+      b["time_max_ns"] = result.ns_max;
+      if (result.items_per_sec != 0)
+        b["items_per_second"] = result.items_per_sec;
+      if (result.bytes_per_sec != 0)
+        b["bytes_per_second"] = result.bytes_per_sec;
+      for (auto& counter : result.counters)
+        b["counters"][counter.first] = counter.second;
+    }
+    benchmarks.push_back(std::move(b));
+  }
+  j["benchmarks"] = std::move(benchmarks);
+
+  std::error_code ec;
+  wpi::raw_fd_ostream os(filename, ec, wpi::sys::fs::F_Text);
+  if (ec) {
+    wpi::errs() << "could not open '" << filename << "': " << ec.message()
+                << '\n';
+    return;
+  }
+  j.dump(os, 2);
+  os << '\n';
+}
+
+int nt::bench::RunBenchmarks(const Options& options) {
+  std::vector<Result> results;
+  int failed = 0;
+
+  auto& os = wpi::outs();
+  os << wpi::format("%-44s %14s %14s %12s\n",
+                    static_cast<const char*>("Benchmark"),
+                    static_cast<const char*>("Time (ns)"),
+                    static_cast<const char*>("Iterations"),
+                    static_cast<const char*>("Items/s"));
+  os << std::string(87, '-') << '\n';
+  os.flush();
+
+  for (auto& info : GetBenchmarks()) {
+    if (!options.filter.empty() &&
+        wpi::StringRef(info.name).find(options.filter) == wpi::StringRef::npos)
+      continue;
+    auto result = RunOne(info, options);
+    if (!result.error.empty()) {
+      os << wpi::format("%-44s ERROR: %s\n", result.name.c_str(),
+                        result.error.c_str());
+      ++failed;
+    } else {
+      os << wpi::format("%-44s %14.1f %14llu %12.4g\n", result.name.c_str(),
+                        result.ns_per_iter,
+                        static_cast<unsigned long long>(result.iterations),
+                        result.items_per_sec);
+      for (auto& counter : result.counters)
+        os << wpi::format("  %-42s %14.4g\n", counter.first.c_str(),
+                          counter.second);
+    }
+    os.flush();
+    results.push_back(std::move(result));
+  }
+
+  if (!options.json_filename.empty())
+    WriteJson(options.json_filename, results, options);
+  return failed;
+}
@@ -0,0 +1,122 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_BENCHMARK_H_
+#define NTCORE_BENCHMARK_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <wpi/StringRef.h>
+#include <wpi/Twine.h>
+
+namespace nt {
+namespace bench {
+
+/* Per-run state handed to a benchmark function.  The benchmark performs any
+ * setup, then loops on KeepRunning(); only the time spent inside the loop is
+ * measured.
+ *
+ *   void MyBench(State& state) {
+ *     Setup();
+ *     while (state.KeepRunning()) DoWork();
+ *   }
+ */
+class State {
+ public:
+  explicit State(uint64_t iterations) : m_iterations(iterations) {}
+
+  bool KeepRunning() {
+    if (m_remaining == m_iterations) {
+      m_start = std::chrono::steady_clock::now();
+    } else if (m_remaining == 0) {
+      m_elapsed += std::chrono::steady_clock::now() - m_start;
+      return false;
+    }
+    --m_remaining;
+    return true;
+  }
+
+  /* Excludes work from the timing (e.g. per-iteration resets). */
+  void PauseTiming() {
+    m_elapsed += std::chrono::steady_clock::now() - m_start;
+  }
+  void ResumeTiming() { m_start = std::chrono::steady_clock::now(); }
+
+  /* Number of iterations the loop will run. */
+  uint64_t iterations() const { return m_iterations; }
+
+  /* Items/bytes processed over all iterations, used for throughput output. */
+  void SetItemsProcessed(uint64_t items) { m_items = items; }
+  void SetBytesProcessed(uint64_t bytes) { m_bytes = bytes; }
+
+  /* Records a named value to report alongside the timing (e.g. resource
+   * usage).  The values from the last repetition are reported.
+   */
+  void SetCounter(const wpi::Twine& name, double value) {
+    m_counters.emplace_back(name.str(), value);
+  }
+
+  /* Records an error; the benchmark is reported as failed. */
+  void SkipWithError(const char* msg) { m_error = msg; }
+
+  std::chrono::duration<double> elapsed() const { return m_elapsed; }
+  uint64_t items() const { return m_items; }
+  uint64_t bytes() const { return m_bytes; }
+  const char* error() const { return m_error; }
+  const std::vector<std::pair<std::string, double>>& counters() const {
+    return m_counters;
+  }
+
+ private:
+  uint64_t m_iterations;
+  uint64_t m_remaining{m_iterations};
+  std::chrono::steady_clock::time_point m_start;
+  std::chrono::steady_clock::duration m_elapsed{0};
+  uint64_t m_items = 0;
+  uint64_t m_bytes = 0;
+  std::vector<std::pair<std::string, double>> m_counters;
+  const char* m_error = nullptr;
+};
+
+typedef std::function<void(State& state)> BenchmarkFunc;
+
+/* Registers a benchmark.  If iterations is nonzero, the benchmark is run for
+ * exactly that many iterations instead of being calibrated (useful for
+ * expensive benchmarks such as network round trips).
+ */
+void Register(const wpi::Twine& name, BenchmarkFunc func,
+              uint64_t iterations = 0);
+
+// Registration functions for each benchmark group.
+void RegisterStorageBenchmarks();
+void RegisterWireBenchmarks();
+void RegisterNetworkBenchmarks();
+void RegisterNotifierBenchmarks();
+void RegisterDataLogBenchmarks();
+
+struct Options {
+  std::string filter;
+  std::string json_filename;
+  double min_time = 0.5;
+  int repetitions = 5;
+};
+
+/* Runs all registered benchmarks matching the filter.  Returns the number of
+ * benchmarks that failed.
+ */
+int RunBenchmarks(const Options& options);
+
+}  // namespace bench
+}  // namespace nt
+
+#endif  // NTCORE_BENCHMARK_H_
@@ -0,0 +1,59 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <cstdio>
+#include <vector>
+
+#include <wpi/Twine.h>
+
+#include "Benchmark.h"
+#include "ntcore_cpp.h"
+
+using namespace nt;
+using namespace nt::bench;
+
+static constexpr const char* kLogFilename = "ntcoreBench.ntlog";
+
+// Changes per iteration; each iteration waits for the notifier thread to
+// drain its queue, so the time includes encoding the changes into the log.
+static constexpr size_t kBatch = 100;
+
+// Local double updates (as robot code publishes telemetry), with or without
+// a data log recording them.
+static void SetWithLogBench(State& state, bool log) {
+  NT_Inst inst = CreateInstance();
+  std::vector<NT_Entry> entries;
+  for (size_t i = 0; i < 200; ++i)
+    entries.push_back(GetEntry(inst, "/bench/entry" + wpi::Twine(i)));
+  // a listener, so both cases pay for queueing notifications
+  AddEntryListener(inst, "/bench/", [](const EntryNotification&) {},
+                   NT_NOTIFY_LOCAL | NT_NOTIFY_NEW | NT_NOTIFY_UPDATE);
+  NT_DataLogger logger = 0;
+  if (log) {
+    logger = StartDataLog(inst, kLogFilename, "/bench/");
+    if (logger == 0) state.SkipWithError("could not start data log");
+  }
+
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    for (size_t j = 0; j < kBatch; ++j, ++i)
+      SetEntryDouble(entries[i % entries.size()], static_cast<double>(i));
+    WaitForEntryListenerQueue(inst, -1);
+  }
+  state.SetItemsProcessed(state.iterations() * kBatch);
+
+  if (logger != 0) StopDataLog(logger);
+  DestroyInstance(inst);
+  std::remove(kLogFilename);
+}
+
+void nt::bench::RegisterDataLogBenchmarks() {
+  Register("DataLogSetDouble/nolog",
+           [](State& state) { SetWithLogBench(state, false); });
+  Register("DataLogSetDouble/log",
+           [](State& state) { SetWithLogBench(state, true); });
+}
@@ -0,0 +1,293 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifdef __linux__
+#include <dirent.h>
+#endif
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <wpi/Logger.h>
+#include <wpi/Twine.h>
+
+#include "Benchmark.h"
+#include "NetworkConnection.h"
+#include "NullInterfaces.h"
+#include "ntcore.h"
+
+using namespace nt;
+using namespace nt::bench;
+
+// Port used for loopback benchmarks; chosen to not collide with a real
+// NetworkTables server running on the same machine.
+static constexpr unsigned int kBenchPort = 11735;
+
+// Measures the cost of queueing and posting entry updates on a connection.
+// The write thread encodes and "sends" to a stream that discards the data.
+static void QueueOutgoing(State& state, size_t n) {
+  wpi::Logger logger;
+  NullConnectionNotifier notifier;
+  NetworkConnection conn(
+      1, std::unique_ptr<wpi::NetworkStream>(new NullNetworkStream), notifier,
+      logger, [](NetworkConnection&, std::function<std::shared_ptr<Message>()>,
+                 std::function<void(wpi::ArrayRef<std::shared_ptr<Message>>)>) {
+        return true;
+      },
+      [](unsigned int) { return NT_DOUBLE; });
+  conn.set_process_incoming(
+      [](std::shared_ptr<Message>, NetworkConnection*) {});
+  conn.Start();
+
+  auto value = Value::MakeDouble(1.0);
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    unsigned int id = i % n;
+    conn.QueueOutgoing(Message::EntryUpdate(id, i & 0xffff, value));
+    if (id == n - 1) conn.PostOutgoing(false);
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+  conn.Stop();
+}
+
+// Only print warnings and errors, so connection messages don't clutter the
+// benchmark output.
+static void AddWarningLogger(NT_Inst inst) {
+  nt::AddLogger(inst,
+                [](const nt::LogMessage& msg) {
+                  std::fputs(msg.message.c_str(), stderr);
+                  std::fputc('\n', stderr);
+                },
+                NT_LOG_WARNING, UINT_MAX);
+}
+
+// Network settings for round trip latency measurements.
+struct FlushConfig {
+  NT_NetworkFlushMode mode;
+  double window;
+  unsigned int socket_flags;
+  bool flush;  // call Flush() after each change
+};
+
+// Measures client -> server -> client round trip latency of an entry update
+// over a loopback TCP connection, with the given flush settings on both
+// ends.  Also reports the median and 99th percentile round trip times.
+static void LoopbackRoundTrip(State& state, const FlushConfig& config) {
+  auto server = nt::CreateInstance();
+  auto client = nt::CreateInstance();
+  AddWarningLogger(server);
+  AddWarningLogger(client);
+  for (auto inst : {server, client}) {
+    nt::SetUpdateRate(inst, 0.01);
+    nt::SetNetworkFlushMode(inst, config.mode, config.window);
+    nt::SetNetworkSocketFlags(inst, config.socket_flags);
+  }
+  nt::StartServer(server, "", "127.0.0.1", kBenchPort);
+  nt::StartClient(client, "127.0.0.1", kBenchPort);
+
+  auto server_ping = nt::GetEntry(server, "/bench/ping");
+  auto server_pong = nt::GetEntry(server, "/bench/pong");
+  nt::AddEntryListener(server_ping,
+                       [=](const EntryNotification& event) {
+                         nt::SetEntryValue(server_pong, event.value);
+                         if (config.flush) nt::Flush(server);
+                       },
+                       NT_NOTIFY_NEW | NT_NOTIFY_UPDATE);
+
+  auto client_ping = nt::GetEntry(client, "/bench/ping");
+  auto client_pong = nt::GetEntry(client, "/bench/pong");
+  auto poller = nt::CreateEntryListenerPoller(client);
+  nt::AddPolledEntryListener(poller, client_pong,
+                             NT_NOTIFY_NEW | NT_NOTIFY_UPDATE);
+
+  // wait for connection
+  auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!nt::IsConnected(client)) {
+    if (std::chrono::steady_clock::now() > timeout) {
+      state.SkipWithError("could not connect to loopback server");
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  std::vector<double> latencies;
+  uint64_t i = 0;
+  while (!state.error() && state.KeepRunning()) {
+    double expected = static_cast<double>(++i);
+    auto start = std::chrono::steady_clock::now();
+    nt::SetEntryValue(client_ping, Value::MakeDouble(expected));
+    if (config.flush) nt::Flush(client);
+    bool done = false;
+    while (!done) {
+      bool timed_out = false;
+      for (auto& event : nt::PollEntryListener(poller, 1.0, &timed_out)) {
+        if (event.value && event.value->IsDouble() &&
+            event.value->GetDouble() == expected)
+          done = true;
+      }
+      if (timed_out) {
+        state.SkipWithError("timed out waiting for response");
+        break;
+      }
+    }
+    if (!done) break;
+    latencies.push_back(std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - start)
+                            .count());
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    state.SetCounter("p50_us", latencies[latencies.size() / 2]);
+    state.SetCounter("p99_us", latencies[latencies.size() * 99 / 100]);
+  }
+
+  nt::DestroyEntryListenerPoller(poller);
+  nt::StopClient(client);
+  nt::StopServer(server);
+  nt::DestroyInstance(client);
+  nt::DestroyInstance(server);
+}
+
+// Number of threads in this process; 0 if unknown.
+static int GetThreadCount() {
+#ifdef __linux__
+  int count = 0;
+  if (DIR* dir = opendir("/proc/self/task")) {
+    while (dirent* ent = readdir(dir)) {
+      if (ent->d_name[0] != '.') ++count;
+    }
+    closedir(dir);
+  }
+  return count;
+#else
+  return 0;
+#endif
+}
+
+// Number of context switches (voluntary and involuntary) so far in this
+// process; 0 if unknown.
+static uint64_t GetContextSwitches() {
+#ifndef _WIN32
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return usage.ru_nvcsw + usage.ru_nivcsw;
+#else
+  return 0;
+#endif
+}
+
+// Measures fan-out of server entry updates to a number of clients over
+// loopback TCP, either with per-connection threads or with event loops.
+// Also reports the process thread count and context switches per update.
+static void ClientFanOut(State& state, size_t num_clients, bool event_loop) {
+  auto server = nt::CreateInstance();
+  AddWarningLogger(server);
+  nt::SetNetworkEventLoop(server, event_loop);
+  nt::SetUpdateRate(server, 0.01);
+  nt::StartServer(server, "", "127.0.0.1", kBenchPort);
+  auto server_value = nt::GetEntry(server, "/bench/value");
+
+  std::vector<NT_Inst> clients;
+  std::vector<NT_EntryListenerPoller> pollers;
+  for (size_t i = 0; i < num_clients; ++i) {
+    auto client = nt::CreateInstance();
+    AddWarningLogger(client);
+    nt::SetNetworkEventLoop(client, event_loop);
+    nt::SetUpdateRate(client, 0.01);
+    nt::StartClient(client, "127.0.0.1", kBenchPort);
+    auto poller = nt::CreateEntryListenerPoller(client);
+    nt::AddPolledEntryListener(poller, nt::GetEntry(client, "/bench/value"),
+                               NT_NOTIFY_NEW | NT_NOTIFY_UPDATE);
+    clients.push_back(client);
+    pollers.push_back(poller);
+  }
+
+  // wait for all clients to connect
+  auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (nt::GetConnections(server).size() < num_clients) {
+    if (std::chrono::steady_clock::now() > timeout) {
+      state.SkipWithError("could not connect to loopback server");
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  int threads = GetThreadCount();
+  uint64_t switches = GetContextSwitches();
+  uint64_t i = 0;
+  while (!state.error() && state.KeepRunning()) {
+    double expected = static_cast<double>(++i);
+    nt::SetEntryValue(server_value, Value::MakeDouble(expected));
+    nt::Flush(server);
+    for (auto poller : pollers) {
+      bool done = false;
+      while (!done) {
+        bool timed_out = false;
+        for (auto& event : nt::PollEntryListener(poller, 1.0, &timed_out)) {
+          if (event.value && event.value->IsDouble() &&
+              event.value->GetDouble() == expected)
+            done = true;
+        }
+        if (timed_out) {
+          state.SkipWithError("timed out waiting for update");
+          break;
+        }
+      }
+      if (!done) break;
+    }
+  }
+  switches = GetContextSwitches() - switches;
+  state.SetItemsProcessed(state.iterations() * num_clients);
+  state.SetCounter("threads", threads);
+  state.SetCounter("context_switches/update",
+                   static_cast<double>(switches) / state.iterations());
+
+  for (auto poller : pollers) nt::DestroyEntryListenerPoller(poller);
+  for (auto client : clients) {
+    nt::StopClient(client);
+    nt::DestroyInstance(client);
+  }
+  nt::StopServer(server);
+  nt::DestroyInstance(server);
+}
+
+void nt::bench::RegisterNetworkBenchmarks() {
+  for (size_t n : {100, 1000}) {
+    Register("NetworkConnectionQueueOutgoing/" + wpi::Twine(n),
+             [=](State& state) { QueueOutgoing(state, n); });
+  }
+  static const struct {
+    const char* name;
+    FlushConfig config;
+  } round_trips[] = {
+      {"periodic", {NT_NET_FLUSH_PERIODIC, 0, 0, false}},
+      {"periodic_flush", {NT_NET_FLUSH_PERIODIC, 0, 0, true}},
+      {"idle", {NT_NET_FLUSH_IDLE, 0, 0, false}},
+      {"idle_1ms", {NT_NET_FLUSH_IDLE, 0.001, 0, false}},
+      {"idle_nagle", {NT_NET_FLUSH_IDLE, 0, NT_NET_SOCKET_NAGLE, false}},
+      {"idle_cork", {NT_NET_FLUSH_IDLE, 0, NT_NET_SOCKET_CORK, false}}};
+  for (auto& rt : round_trips) {
+    FlushConfig config = rt.config;
+    Register("LoopbackRoundTrip/" + wpi::Twine(rt.name),
+             [=](State& state) { LoopbackRoundTrip(state, config); }, 100);
+  }
+  for (bool event_loop : {false, true}) {
+    Register("ClientFanOut/10/" +
+                 wpi::Twine(event_loop ? "event_loop" : "threads"),
+             [=](State& state) { ClientFanOut(state, 10, event_loop); }, 100);
+  }
+}
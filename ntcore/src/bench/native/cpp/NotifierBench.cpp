@@ -0,0 +1,62 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <wpi/Logger.h>
+#include <wpi/Twine.h>
+
+#include "Benchmark.h"
+#include "EntryNotifier.h"
+
+using namespace nt;
+using namespace nt::bench;
+
+// Notifications per iteration; each iteration waits for the notifier thread
+// to drain its queue.
+static constexpr size_t kBatch = 100;
+
+// Dashboard-like setup: one prefix listener per table (as a widget or
+// NetworkTable listener would add) plus one listener per entry.  Each
+// notification matches one of each.
+static void NotifyEntryBench(State& state, size_t num_tables) {
+  wpi::Logger logger;
+  EntryNotifier notifier(1, logger);
+  std::atomic<uint64_t> count{0};
+  auto callback = [&](const EntryNotification&) { ++count; };
+
+  std::vector<std::string> names;
+  for (size_t i = 0; i < num_tables; ++i) {
+    std::string prefix = ("/SmartDashboard/table" + wpi::Twine(i) + "/").str();
+    notifier.Add(callback, prefix, NT_NOTIFY_UPDATE);
+    names.emplace_back(prefix + "value");
+    notifier.Add(callback, i, NT_NOTIFY_UPDATE);
+  }
+
+  auto value = Value::MakeDouble(1);
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    for (size_t j = 0; j < kBatch; ++j, ++i) {
+      size_t table = (i * 7) % num_tables;
+      notifier.NotifyEntry(table, names[table], value, NT_NOTIFY_UPDATE);
+    }
+    notifier.WaitForQueue(-1);
+  }
+  if (count != 2 * kBatch * state.iterations())
+    state.SkipWithError("wrong number of callbacks");
+  state.SetItemsProcessed(state.iterations() * kBatch);
+  notifier.Stop();
+}
+
+void nt::bench::RegisterNotifierBenchmarks() {
+  for (size_t n : {10, 300, 1000}) {
+    Register("NotifierNotifyEntry/" + wpi::Twine(n),
+             [=](State& state) { NotifyEntryBench(state, n); });
+  }
+}
@@ -0,0 +1,106 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_NULLINTERFACES_H_
+#define NTCORE_NULLINTERFACES_H_
+
+#include <memory>
+
+#include <wpi/NetworkStream.h>
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+
+#include "IConnectionNotifier.h"
+#include "IDispatcher.h"
+#include "IEntryNotifier.h"
+#include "IRpcServer.h"
+
+namespace nt {
+namespace bench {
+
+// No-op implementations of the internal interfaces, used to benchmark
+// individual components in isolation.
+
+class NullEntryNotifier : public IEntryNotifier {
+ public:
+  bool local_notifiers() const override { return false; }
+  unsigned int Add(std::function<void(const EntryNotification& event)>,
+                   wpi::StringRef, unsigned int) override {
+    return 0;
+  }
+  unsigned int Add(std::function<void(const EntryNotification& event)>,
+                   unsigned int, unsigned int) override {
+    return 0;
+  }
+  unsigned int AddPolled(unsigned int, wpi::StringRef, unsigned int) override {
+    return 0;
+  }
+  unsigned int AddPolled(unsigned int, unsigned int, unsigned int) override {
+    return 0;
+  }
+  void NotifyEntry(unsigned int, StringRef, std::shared_ptr<Value>,
+                   unsigned int, unsigned int) override {}
+};
+
+class NullConnectionNotifier : public IConnectionNotifier {
+ public:
+  unsigned int Add(
+      std::function<void(const ConnectionNotification& event)>) override {
+    return 0;
+  }
+  unsigned int AddPolled(unsigned int) override { return 0; }
+  void NotifyConnection(bool, const ConnectionInfo&, unsigned int) override {}
+};
+
+class NullRpcServer : public IRpcServer {
+ public:
+  void RemoveRpc(unsigned int) override {}
+  void ProcessRpc(unsigned int, unsigned int, StringRef, StringRef,
+                  const ConnectionInfo&, SendResponseFunc,
+                  unsigned int) override {}
+};
+
+class NullDispatcher : public IDispatcher {
+ public:
+  void QueueOutgoing(std::shared_ptr<Message>, INetworkConnection*,
+                     INetworkConnection*) override {}
+};
+
+// Stream that discards everything written to it.  Reads block until the
+// stream is closed.
+class NullNetworkStream : public wpi::NetworkStream {
+ public:
+  size_t send(const char*, size_t len, Error*) override { return len; }
+  size_t receive(char*, size_t, Error* err, int) override {
+    std::unique_lock<wpi::mutex> lock(m_mutex);
+    m_cond.wait(lock, [&] { return m_closed; });
+    *err = kConnectionClosed;
+    return 0;
+  }
+  void close() override {
+    {
+      std::lock_guard<wpi::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+    m_cond.notify_all();
+  }
+  StringRef getPeerIP() const override { return "127.0.0.1"; }
+  int getPeerPort() const override { return 0; }
+  void setNoDelay() override {}
+  bool setBlocking(bool) override { return true; }
+  int getNativeHandle() const override { return -1; }
+
+ private:
+  wpi::mutex m_mutex;
+  wpi::condition_variable m_cond;
+  bool m_closed = false;
+};
+
+}  // namespace bench
+}  // namespace nt
+
+#endif  // NTCORE_NULLINTERFACES_H_
@@ -0,0 +1,266 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <wpi/Logger.h>
+#include <wpi/SmallString.h>
+#include <wpi/StringMap.h>
+#include <wpi/Twine.h>
+#include <wpi/raw_istream.h>
+#include <wpi/raw_ostream.h>
+
+#include "Benchmark.h"
+#include "NullInterfaces.h"
+#include "Storage.h"
+
+using namespace nt;
+using namespace nt::bench;
+
+namespace {
+
+// Storage hooked up to null notifier/dispatcher implementations, so the
+// benchmarks measure Storage itself plus outgoing message generation.
+class StorageFixture {
+ public:
+  explicit StorageFixture(size_t num_entries)
+      : storage(notifier, rpc_server, logger) {
+    storage.SetDispatcher(&dispatcher, true);
+    for (size_t i = 0; i < num_entries; ++i) {
+      names.emplace_back(("/bench/table" + wpi::Twine(i % 16) + "/entry" +
+                          wpi::Twine(i))
+                             .str());
+      auto local_id = storage.GetEntry(names.back());
+      local_ids.push_back(local_id);
+      storage.SetEntryValue(local_id, Value::MakeDouble(0));
+    }
+  }
+
+  wpi::Logger logger;
+  NullEntryNotifier notifier;
+  NullRpcServer rpc_server;
+  NullDispatcher dispatcher;
+  Storage storage;
+  std::vector<std::string> names;
+  std::vector<unsigned int> local_ids;
+};
+
+}  // namespace
+
+static void SetEntryValueByName(State& state, size_t n) {
+  StorageFixture f(n);
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    f.storage.SetEntryValue(f.names[i % n], Value::MakeDouble(i));
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void SetEntryValueByLocalId(State& state, size_t n) {
+  StorageFixture f(n);
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    f.storage.SetEntryValue(f.local_ids[i % n], Value::MakeDouble(i));
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Publishes a telemetry snapshot of n doubles, one entry at a time or as a
+// single batch.
+static void SetSnapshot(State& state, size_t n, bool batch) {
+  StorageFixture f(n);
+  std::vector<std::shared_ptr<Value>> values(n);
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    for (size_t j = 0; j < n; ++j) values[j] = Value::MakeDouble(i + j);
+    if (batch) {
+      f.storage.SetEntryValues(f.local_ids, values);
+    } else {
+      for (size_t j = 0; j < n; ++j)
+        f.storage.SetEntryValue(f.local_ids[j], values[j]);
+    }
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Reads a snapshot of n doubles (as a dashboard or robot loop polls them),
+// as values or directly into an array.
+static void GetSnapshot(State& state, size_t n, bool doubles) {
+  StorageFixture f(n);
+  std::vector<double> out(n);
+  while (state.KeepRunning()) {
+    if (doubles) {
+      if (f.storage.GetEntryDoubles(f.local_ids, 0, out.data()) != n)
+        state.SkipWithError("missing value");
+    } else {
+      auto values = f.storage.GetEntryValues(f.local_ids);
+      for (size_t j = 0; j < n; ++j) out[j] = values[j]->GetDouble();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void GetEntryValueByName(State& state, size_t n) {
+  StorageFixture f(n);
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    auto value = f.storage.GetEntryValue(f.names[i % n]);
+    if (!value) state.SkipWithError("missing value");
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void GetEntryValueByLocalId(State& state, size_t n) {
+  StorageFixture f(n);
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    auto value = f.storage.GetEntryValue(f.local_ids[i % n]);
+    if (!value) state.SkipWithError("missing value");
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Reads by local id while another thread continuously writes, to measure how
+// much readers are slowed down by writers.
+static void GetEntryValueByLocalIdContended(State& state, size_t n) {
+  StorageFixture f(n);
+  std::atomic_bool done{false};
+  std::thread writer([&] {
+    uint64_t i = 0;
+    while (!done) {
+      f.storage.SetEntryValue(f.local_ids[i % n], Value::MakeDouble(i));
+      ++i;
+    }
+  });
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    auto value = f.storage.GetEntryValue(f.local_ids[i % n]);
+    if (!value) state.SkipWithError("missing value");
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+  done = true;
+  writer.join();
+}
+
+static void GetEntriesPrefix(State& state, size_t n) {
+  StorageFixture f(n);
+  while (state.KeepRunning()) {
+    auto ids = f.storage.GetEntries("/bench/table3/", 0);
+    if (ids.empty()) state.SkipWithError("no entries");
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Baseline for GetEntriesPrefix: checking every name, as Storage did before
+// it kept entries sorted by name.
+static void GetEntriesPrefixScan(State& state, size_t n) {
+  StorageFixture f(n);
+  wpi::StringMap<unsigned int> entries;
+  for (size_t i = 0; i < n; ++i) entries[f.names[i]] = f.local_ids[i];
+  while (state.KeepRunning()) {
+    std::vector<unsigned int> ids;
+    for (auto& i : entries) {
+      if (i.getKey().startswith("/bench/table3/")) ids.push_back(i.getValue());
+    }
+    if (ids.empty()) state.SkipWithError("no entries");
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Make the first n entries persistent (as a robot's tuning constants are).
+static void MakePersistent(StorageFixture& f, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    f.storage.SetEntryValue(f.local_ids[i], Value::MakeDouble(i * 0.37));
+    f.storage.SetEntryFlags(f.local_ids[i], NT_PERSISTENT);
+  }
+}
+
+static void SavePersistent(const Storage& storage, bool binary,
+                           wpi::SmallVectorImpl<char>& buf) {
+  buf.clear();
+  wpi::raw_svector_ostream os(buf);
+  if (binary)
+    storage.SavePersistentBinary(os, false);
+  else
+    storage.SavePersistent(os, false);
+}
+
+static void SavePersistentBench(State& state, size_t n, bool binary) {
+  StorageFixture f(n);
+  MakePersistent(f, n);
+  wpi::SmallString<4096> buf;
+  while (state.KeepRunning()) SavePersistent(f.storage, binary, buf);
+  state.SetCounter("bytes", buf.size());
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void LoadPersistentBench(State& state, size_t n, bool binary) {
+  wpi::SmallString<4096> buf;
+  {
+    StorageFixture f(n);
+    MakePersistent(f, n);
+    SavePersistent(f.storage, binary, buf);
+  }
+  // loading into a populated storage measures parsing plus value updates
+  StorageFixture f(0);
+  while (state.KeepRunning()) {
+    bool ok;
+    if (binary) {
+      ok = f.storage.LoadEntriesBinary(buf, "", true, nullptr);
+    } else {
+      wpi::raw_mem_istream is(buf.data(), buf.size());
+      ok = f.storage.LoadEntries(is, "", true, nullptr);
+    }
+    if (!ok) state.SkipWithError("load failed");
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void nt::bench::RegisterStorageBenchmarks() {
+  Register("StorageSetSnapshot/200/individual",
+           [](State& state) { SetSnapshot(state, 200, false); });
+  Register("StorageSetSnapshot/200/batch",
+           [](State& state) { SetSnapshot(state, 200, true); });
+  Register("StorageGetSnapshot/200/values",
+           [](State& state) { GetSnapshot(state, 200, false); });
+  Register("StorageGetSnapshot/200/doubles",
+           [](State& state) { GetSnapshot(state, 200, true); });
+  for (size_t n : {1000, 10000}) {
+    Register("StorageSetEntryValueByName/" + wpi::Twine(n),
+             [=](State& state) { SetEntryValueByName(state, n); });
+    Register("StorageSetEntryValueByLocalId/" + wpi::Twine(n),
+             [=](State& state) { SetEntryValueByLocalId(state, n); });
+    Register("StorageGetEntryValueByName/" + wpi::Twine(n),
+             [=](State& state) { GetEntryValueByName(state, n); });
+    Register("StorageGetEntryValueByLocalId/" + wpi::Twine(n),
+             [=](State& state) { GetEntryValueByLocalId(state, n); });
+    Register("StorageGetEntryValueByLocalIdContended/" + wpi::Twine(n),
+             [=](State& state) { GetEntryValueByLocalIdContended(state, n); });
+    Register("StorageGetEntriesPrefix/" + wpi::Twine(n),
+             [=](State& state) { GetEntriesPrefix(state, n); });
+    Register("StorageGetEntriesPrefixScan/" + wpi::Twine(n),
+             [=](State& state) { GetEntriesPrefixScan(state, n); });
+    Register("StorageSavePersistent/" + wpi::Twine(n) + "/text",
+             [=](State& state) { SavePersistentBench(state, n, false); });
+    Register("StorageSavePersistent/" + wpi::Twine(n) + "/binary",
+             [=](State& state) { SavePersistentBench(state, n, true); });
+    Register("StorageLoadPersistent/" + wpi::Twine(n) + "/text",
+             [=](State& state) { LoadPersistentBench(state, n, false); });
+    Register("StorageLoadPersistent/" + wpi::Twine(n) + "/binary",
+             [=](State& state) { LoadPersistentBench(state, n, true); });
+  }
+}
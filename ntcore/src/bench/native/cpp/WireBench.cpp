@@ -0,0 +1,140 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wpi/Logger.h>
+#include <wpi/Twine.h>
+#include <wpi/raw_istream.h>
+
+#include "Benchmark.h"
+#include "Message.h"
+#include "WireDecoder.h"
+#include "WireEncoder.h"
+
+using namespace nt;
+using namespace nt::bench;
+
+// Deterministic mix of value types roughly matching a typical robot table:
+// mostly doubles, with some booleans, strings and double arrays.
+static std::shared_ptr<Value> MakeBenchValue(size_t i) {
+  switch (i % 8) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      return Value::MakeDouble(i * 0.5);
+    case 4:
+    case 5:
+      return Value::MakeBoolean((i & 1) != 0);
+    case 6:
+      return Value::MakeString("value" + wpi::Twine(i));
+    default:
+      return Value::MakeDoubleArray(std::vector<double>(8, i * 0.25));
+  }
+}
+
+static std::vector<std::shared_ptr<Message>> MakeFullTable(size_t n) {
+  std::vector<std::shared_ptr<Message>> msgs;
+  msgs.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    msgs.emplace_back(Message::EntryAssign(
+        ("/bench/table" + wpi::Twine(i % 16) + "/entry" + wpi::Twine(i)).str(),
+        i, 1, MakeBenchValue(i), 0));
+  }
+  return msgs;
+}
+
+static void EncodeFullTable(State& state, size_t n) {
+  auto msgs = MakeFullTable(n);
+  WireEncoder encoder(0x0300);
+  while (state.KeepRunning()) {
+    encoder.Reset();
+    for (auto& msg : msgs) msg->Write(encoder);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * encoder.size());
+}
+
+static void DecodeFullTable(State& state, size_t n) {
+  wpi::Logger logger;
+  std::vector<NT_Type> types;
+  std::string buf;
+  {
+    auto msgs = MakeFullTable(n);
+    WireEncoder encoder(0x0300);
+    for (auto& msg : msgs) {
+      msg->Write(encoder);
+      types.push_back(msg->value()->type());
+    }
+    buf = encoder.ToStringRef();
+  }
+  auto get_entry_type = [&](unsigned int id) { return types[id]; };
+  while (state.KeepRunning()) {
+    wpi::raw_mem_istream is(buf.data(), buf.size());
+    WireDecoder decoder(is, 0x0300, logger);
+    for (size_t i = 0; i < n; ++i) {
+      if (!Message::Read(decoder, get_entry_type)) {
+        state.SkipWithError("decode failed");
+        break;
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * buf.size());
+}
+
+static void EncodeEntryUpdate(State& state, NT_Type type) {
+  std::shared_ptr<Value> value;
+  if (type == NT_DOUBLE)
+    value = Value::MakeDouble(1.5);
+  else
+    value = Value::MakeDoubleArray(std::vector<double>(100, 1.5));
+  auto msg = Message::EntryUpdate(5, 1, value);
+  WireEncoder encoder(0x0300);
+  while (state.KeepRunning()) {
+    encoder.Reset();
+    msg->Write(encoder);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * encoder.size());
+}
+
+// Encodes a 100 element double array update with a few changed elements as
+// a delta against the previous value.
+static void EncodeEntryUpdateDelta(State& state) {
+  std::vector<double> arr(100, 1.5);
+  auto base = Value::MakeDoubleArray(arr);
+  arr[10] = 2.5;
+  arr[11] = 3.5;
+  arr[70] = 4.5;
+  auto msg = Message::EntryUpdate(5, 1, Value::MakeDoubleArray(arr));
+  WireEncoder encoder(0x0300);
+  while (state.KeepRunning()) {
+    encoder.Reset();
+    if (!msg->WriteDelta(encoder, *base)) state.SkipWithError("no delta");
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * encoder.size());
+}
+
+void nt::bench::RegisterWireBenchmarks() {
+  for (size_t n : {1000, 10000, 50000}) {
+    Register("WireEncodeFullTable/" + wpi::Twine(n),
+             [=](State& state) { EncodeFullTable(state, n); });
+    Register("WireDecodeFullTable/" + wpi::Twine(n),
+             [=](State& state) { DecodeFullTable(state, n); });
+  }
+  Register("WireEncodeEntryUpdate/double",
+           [](State& state) { EncodeEntryUpdate(state, NT_DOUBLE); });
+  Register("WireEncodeEntryUpdate/double_array_100",
+           [](State& state) { EncodeEntryUpdate(state, NT_DOUBLE_ARRAY); });
+  Register("WireEncodeEntryUpdate/double_array_100_delta",
+           EncodeEntryUpdateDelta);
+}
@@ -0,0 +1,52 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <cstdlib>
+#include <tuple>
+
+#include <wpi/StringRef.h>
+#include <wpi/raw_ostream.h>
+
+#include "Benchmark.h"
+
+static void Usage(const char* argv0) {
+  wpi::errs() << "Usage: " << argv0 << " [options]\n"
+              << "  --filter=<substr>    only run benchmarks matching substr\n"
+              << "  --json=<file>        write machine-readable results\n"
+              << "  --min_time=<secs>    minimum time per run (default 0.5)\n"
+              << "  --repetitions=<n>    runs per benchmark (default 5)\n";
+}
+
+int main(int argc, char** argv) {
+  nt::bench::Options options;
+  for (int i = 1; i < argc; ++i) {
+    wpi::StringRef arg{argv[i]};
+    wpi::StringRef key, value;
+    std::tie(key, value) = arg.split('=');
+    if (key == "--filter") {
+      options.filter = value;
+    } else if (key == "--json") {
+      options.json_filename = value;
+    } else if (key == "--min_time") {
+      options.min_time = std::atof(value.str().c_str());
+    } else if (key == "--repetitions") {
+      options.repetitions = std::atoi(value.str().c_str());
+      if (options.repetitions < 1) options.repetitions = 1;
+    } else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+
+  nt::bench::RegisterStorageBenchmarks();
+  nt::bench::RegisterWireBenchmarks();
+  nt::bench::RegisterNetworkBenchmarks();
+  nt::bench::RegisterNotifierBenchmarks();
+  nt::bench::RegisterDataLogBenchmarks();
+
+  return nt::bench::RunBenchmarks(options) == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+package edu.wpi.first.networktables;
+
+/**
+ * NetworkTables Connection statistics.
+ */
+@SuppressWarnings("MemberName")
+public final class ConnectionStats {
+  /** Message type index for keep alive messages. */
+  public static final int kKeepAlive = 0;
+  /** Message type index for client and server hello messages. */
+  public static final int kHandshake = 1;
+  /** Message type index for entry assignment messages. */
+  public static final int kEntryAssign = 2;
+  /** Message type index for entry update messages (including deltas). */
+  public static final int kEntryUpdate = 3;
+  /** Message type index for flags update messages. */
+  public static final int kFlagsUpdate = 4;
+  /** Message type index for entry delete messages. */
+  public static final int kEntryDelete = 5;
+  /** Message type index for clear all entries messages. */
+  public static final int kClearEntries = 6;
+  /** Message type index for RPC execute messages. */
+  public static final int kExecuteRpc = 7;
+  /** Message type index for RPC response messages. */
+  public static final int kRpcResponse = 8;
+
+  /**
+   * Connection information.
+   */
+  public final ConnectionInfo conn;
+
+  /**
+   * Number of bytes sent.
+   */
+  public final long bytes_sent;
+
+  /**
+   * Number of bytes received.
+   */
+  public final long bytes_received;
+
+  /**
+   * Number of messages sent, indexed by message type (e.g. kEntryUpdate).
+   */
+  public final long[] messages_sent;
+
+  /**
+   * Number of messages received, indexed by message type (e.g. kEntryUpdate).
+   */
+  public final long[] messages_received;
+
+  /**
+   * Number of outgoing messages replaced by a later message for the same
+   * entry before they were sent.
+   */
+  public final long coalesced;
+
+  /**
+   * Number of outgoing entry messages not sent because the remote client is
+   * not subscribed to the entry.
+   */
+  public final long filtered;
+
+  /**
+   * Number of outgoing messages waiting for the next flush.
+   */
+  public final long pending;
+
+  /**
+   * Number of flushed batches of messages not yet written to the socket.
+   */
+  public final long queued;
+
+  /**
+   * Round trip time estimate, in microseconds (0 if not available).
+   */
+  public final int rtt;
+
+  /** Constructor.
+   * This should generally only be used internally to NetworkTables.
+   *
+   * @param conn Connection information
+   * @param bytesSent Number of bytes sent
+   * @param bytesReceived Number of bytes received
+   * @param messagesSent Number of messages sent, by type
+   * @param messagesReceived Number of messages received, by type
+   * @param coalesced Number of coalesced outgoing messages
+   * @param filtered Number of outgoing messages filtered by subscriptions
+   * @param pending Number of outgoing messages waiting for flush
+   * @param queued Number of flushed batches waiting to be written
+   * @param rtt Round trip time estimate, in microseconds
+   */
+  @SuppressWarnings("ParameterNumber")
+  public ConnectionStats(ConnectionInfo conn, long bytesSent, long bytesReceived,
+                         long[] messagesSent, long[] messagesReceived, long coalesced,
+                         long filtered, long pending, long queued, int rtt) {
+    this.conn = conn;
+    bytes_sent = bytesSent;
+    bytes_received = bytesReceived;
+    messages_sent = messagesSent;
+    messages_received = messagesReceived;
+    this.coalesced = coalesced;
+    this.filtered = filtered;
+    this.pending = pending;
+    this.queued = queued;
+    this.rtt = rtt;
+  }
+}
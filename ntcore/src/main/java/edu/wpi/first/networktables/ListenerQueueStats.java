@@ -0,0 +1,49 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+package edu.wpi.first.networktables;
+
+/**
+ * NetworkTables Listener Queue Statistics.
+ */
+public final class ListenerQueueStats {
+  /**
+   * Number of notifications currently queued.
+   */
+  public final long queued;
+
+  /**
+   * Maximum number of queued notifications (0 if unlimited).
+   */
+  public final long capacity;
+
+  /**
+   * Number of notifications dropped because the queue was full.
+   */
+  public final long dropped;
+
+  /**
+   * Number of notifications merged into an already queued notification
+   * because the queue was full.
+   */
+  public final long coalesced;
+
+  /** Constructor.
+   * This should generally only be used internally to NetworkTables.
+   *
+   * @param queued Number of queued notifications
+   * @param capacity Queue capacity
+   * @param dropped Number of dropped notifications
+   * @param coalesced Number of coalesced notifications
+   */
+  public ListenerQueueStats(long queued, long capacity, long dropped, long coalesced) {
+    this.queued = queued;
+    this.capacity = capacity;
+    this.dropped = dropped;
+    this.coalesced = coalesced;
+  }
+}
@@ -122,6 +122,41 @@ public final class NetworkTableEntry {
     return NetworkTablesJNI.getValue(m_handle);
   }
 
+  /**
+   * Gets the entry's value at a past time (the latest value recorded at or
+   * before that time).  Only the current value is available unless history
+   * is enabled with {@link #setHistory(int)}.
+   * Returns a value with type NetworkTableType.kUnassigned if no value is
+   * known for the time.
+   *
+   * @param time time, in the units returned by {@link NetworkTablesJNI#now()}
+   * @return the entry's value
+   */
+  public NetworkTableValue getValueAt(long time) {
+    return NetworkTablesJNI.getValueAt(m_handle, time);
+  }
+
+  /**
+   * Gets the entry's recorded values at or after a time, oldest first.
+   * A deletion of the entry is returned as a value with type
+   * NetworkTableType.kUnassigned.
+   *
+   * @param since time, in the units returned by {@link NetworkTablesJNI#now()}
+   * @return the entry's values
+   */
+  public NetworkTableValue[] getHistory(long since) {
+    return NetworkTablesJNI.getHistory(m_handle, since);
+  }
+
+  /**
+   * Enables recording the entry's past values.
+   *
+   * @param capacity maximum number of values to keep (0 to disable)
+   */
+  public void setHistory(int capacity) {
+    NetworkTablesJNI.setEntryHistory(m_handle, capacity);
+  }
+
   /**
    * Gets the entry's value as a boolean. If the entry does not exist or is of
    * different type, it will return the default value.
@@ -223,6 +258,34 @@ public final class NetworkTableEntry {
         NetworkTableValue.toNative(defaultValue)));
   }
 
+  /**
+   * Reads the entry's value as a boolean array into an existing array,
+   * without allocating a new one.  If the entry's value is longer than the
+   * array, only the first values.length elements are read.
+   *
+   * @param values the array to read into
+   * @return the length of the entry's value (which may be greater than
+   *         values.length), or -1 if the entry does not exist or is of
+   *         different type
+   */
+  public int readBooleanArray(boolean[] values) {
+    return NetworkTablesJNI.readBooleanArray(m_handle, values);
+  }
+
+  /**
+   * Reads the entry's value as a double array into an existing array,
+   * without allocating a new one.  If the entry's value is longer than the
+   * array, only the first values.length elements are read.
+   *
+   * @param values the array to read into
+   * @return the length of the entry's value (which may be greater than
+   *         values.length), or -1 if the entry does not exist or is of
+   *         different type
+   */
+  public int readDoubleArray(double[] values) {
+    return NetworkTablesJNI.readDoubleArray(m_handle, values);
+  }
+
   /**
    * Gets the entry's value as a double array. If the entry does not exist
    * or is of different type, it will return the default value.
@@ -802,6 +865,28 @@ public final class NetworkTableEntry {
     return (getFlags() & kPersistent) != 0;
   }
 
+  /**
+   * Sets the update rate of this entry, overriding the instance update rate.
+   * An interval of 0 sends each change immediately; a positive interval
+   * sends changes at most once per interval (latest value only).
+   *
+   * @param interval minimum update interval in seconds, or negative to use
+   *                 the prefix or instance update rate
+   */
+  public void setUpdateRate(double interval) {
+    NetworkTablesJNI.setEntryUpdateRate(m_handle, interval);
+  }
+
+  /**
+   * Gets the update rate of this entry.
+   *
+   * @return Entry or prefix update interval in seconds, or -1 if the
+   *         instance update rate is used
+   */
+  public double getUpdateRate() {
+    return NetworkTablesJNI.getEntryUpdateRate(m_handle);
+  }
+
   /**
    * Deletes the entry.
    */
@@ -45,6 +45,19 @@ public final class NetworkTableInstance implements AutoCloseable {
   public static final int kNetModeStarting = 0x04;
   public static final int kNetModeFailure = 0x08;
 
+  /**
+   * Network flush modes (as used by {@link #setNetworkFlushMode(int, double)}).
+   */
+  public static final int kFlushPeriodic = 0;
+  public static final int kFlushIdle = 1;
+
+  /**
+   * Network socket option flag values (as used by
+   * {@link #setNetworkSocketFlags(int)}).  This is a bitmask.
+   */
+  public static final int kSocketNagle = 0x01;
+  public static final int kSocketCork = 0x02;
+
   /**
    * The default port that network tables operates on.
    */
@@ -164,6 +177,26 @@ public final class NetworkTableInstance implements AutoCloseable {
     return NetworkTablesJNI.getEntryInfo(this, m_handle, prefix, types);
   }
 
+  /**
+   * Sets the values of several double entries at once.
+   * This is cheaper than calling {@link NetworkTableEntry#setDouble(double)}
+   * for each entry, as the network updates are queued as a single batch.
+   * The update is not atomic; other readers may observe the new values one
+   * at a time.  Entries that exist with a different type are not updated.
+   *
+   * @param entries entries to set; must belong to this instance
+   * @param values new values (must be the same length as entries)
+   * @return False if any entry exists with a different type or the lengths
+   *     differ
+   */
+  public boolean setDoubles(NetworkTableEntry[] entries, double[] values) {
+    int[] handles = new int[entries.length];
+    for (int i = 0; i < entries.length; i++) {
+      handles[i] = entries[i].getHandle();
+    }
+    return NetworkTablesJNI.setDoubles(handles, 0, values);
+  }
+
   /* Cache of created tables. */
   private final ConcurrentMap<String, NetworkTable> m_tables = new ConcurrentHashMap<>();
 
@@ -223,6 +256,8 @@ public final class NetworkTableInstance implements AutoCloseable {
   private Thread m_entryListenerThread;
   private int m_entryListenerPoller;
   private boolean m_entryListenerWaitQueue;
+  private long m_entryListenerQueueCapacity;
+  private int m_entryListenerQueueOverflow = QueueOverflow.kDropOldest;
   private final Condition m_entryListenerWaitQueueCond = m_entryListenerLock.newCondition();
 
   private void startEntryListenerThread() {
@@ -295,6 +330,8 @@ public final class NetworkTableInstance implements AutoCloseable {
     try {
       if (m_entryListenerPoller == 0) {
         m_entryListenerPoller = NetworkTablesJNI.createEntryListenerPoller(m_handle);
+        NetworkTablesJNI.setEntryListenerQueue(m_entryListenerPoller,
+            m_entryListenerQueueCapacity, m_entryListenerQueueOverflow);
         startEntryListenerThread();
       }
       int handle = NetworkTablesJNI.addPolledEntryListener(m_entryListenerPoller, prefix, flags);
@@ -323,6 +360,8 @@ public final class NetworkTableInstance implements AutoCloseable {
     try {
       if (m_entryListenerPoller == 0) {
         m_entryListenerPoller = NetworkTablesJNI.createEntryListenerPoller(m_handle);
+        NetworkTablesJNI.setEntryListenerQueue(m_entryListenerPoller,
+            m_entryListenerQueueCapacity, m_entryListenerQueueOverflow);
         startEntryListenerThread();
       }
       int handle = NetworkTablesJNI.addPolledEntryListener(m_entryListenerPoller, entry.getHandle(),
@@ -343,6 +382,44 @@ public final class NetworkTableInstance implements AutoCloseable {
     NetworkTablesJNI.removeEntryListener(listener);
   }
 
+  /**
+   * Limit the number of entry listener notifications waiting to be delivered.
+   * By default the queue is unlimited, so listeners that can't keep up use
+   * more and more memory.
+   *
+   * @param capacity  maximum number of queued notifications (0 for unlimited)
+   * @param overflow  what to do when the queue is full ({@link QueueOverflow})
+   */
+  public void setEntryListenerQueue(long capacity, int overflow) {
+    m_entryListenerLock.lock();
+    try {
+      m_entryListenerQueueCapacity = capacity;
+      m_entryListenerQueueOverflow = overflow;
+      if (m_entryListenerPoller != 0) {
+        NetworkTablesJNI.setEntryListenerQueue(m_entryListenerPoller, capacity, overflow);
+      }
+    } finally {
+      m_entryListenerLock.unlock();
+    }
+  }
+
+  /**
+   * Get statistics for the entry listener queue.
+   *
+   * @return Queue statistics
+   */
+  public ListenerQueueStats getEntryListenerQueueStats() {
+    m_entryListenerLock.lock();
+    try {
+      if (m_entryListenerPoller == 0) {
+        return new ListenerQueueStats(0, m_entryListenerQueueCapacity, 0, 0);
+      }
+      return NetworkTablesJNI.getEntryListenerQueueStats(m_entryListenerPoller);
+    } finally {
+      m_entryListenerLock.unlock();
+    }
+  }
+
   /**
    * Wait for the entry listener queue to be empty.  This is primarily useful
    * for deterministic testing.  This blocks until either the entry listener
@@ -935,6 +1012,69 @@ public final class NetworkTableInstance implements AutoCloseable {
     NetworkTablesJNI.setUpdateRate(m_handle, interval);
   }
 
+  /**
+   * Enable or disable event loop networking.
+   * When enabled, all network connections are serviced by a single event
+   * loop thread, rather than each connection having its own threads.
+   * This only takes effect when the client or server is next started.
+   *
+   * @param enabled true to use an event loop, false to use threads (default)
+   */
+  public void setNetworkEventLoop(boolean enabled) {
+    NetworkTablesJNI.setNetworkEventLoop(m_handle, enabled);
+  }
+
+  /**
+   * Set the network flush mode.
+   * In periodic mode (the default), changes are sent at the update rate, or
+   * sooner when {@link #flush()} is called.  In idle mode, changes are sent
+   * as soon as they are queued, after waiting up to the window for further
+   * changes to send with them.
+   *
+   * @param mode flush mode (kFlushPeriodic or kFlushIdle)
+   * @param window batching window in seconds (range 0 to 1.0)
+   */
+  public void setNetworkFlushMode(int mode, double window) {
+    NetworkTablesJNI.setNetworkFlushMode(m_handle, mode, window);
+  }
+
+  /**
+   * Set network socket options.
+   * This only takes effect for new connections.
+   *
+   * @param flags bitmask of socket flag values (kSocketNagle, kSocketCork)
+   */
+  public void setNetworkSocketFlags(int flags) {
+    NetworkTablesJNI.setNetworkSocketFlags(m_handle, flags);
+  }
+
+  /**
+   * Set the entry name prefixes to receive updates for when connected as a
+   * client.  Entries outside the prefixes are still received once when
+   * connecting, but are not updated after that, so their local values go
+   * stale until the next connection.  Publishing such an entry from the
+   * client subscribes to it.  An empty array (the default) receives
+   * everything.  This only takes effect for new connections.
+   *
+   * @param prefixes entry name prefixes
+   */
+  public void setNetworkSubscriptions(String[] prefixes) {
+    NetworkTablesJNI.setNetworkSubscriptions(m_handle, prefixes);
+  }
+
+  /**
+   * Sets the update rate of all entries starting with a prefix, overriding
+   * the instance update rate.  Entry-specific update rates take precedence,
+   * and the longest matching prefix is used.
+   *
+   * @param prefix entry name prefix
+   * @param interval minimum update interval in seconds (0 to send each
+   *                 change immediately), or negative to remove
+   */
+  public void setPrefixUpdateRate(String prefix, double interval) {
+    NetworkTablesJNI.setPrefixUpdateRate(m_handle, prefix, interval);
+  }
+
   /**
    * Flushes all updated values immediately to the network.
    * Note: This is rate-limited to protect the network from flooding.
@@ -955,6 +1095,15 @@ public final class NetworkTableInstance implements AutoCloseable {
     return NetworkTablesJNI.getConnections(m_handle);
   }
 
+  /**
+   * Gets statistics for the currently established network connections.
+   *
+   * @return array of connection statistics
+   */
+  public ConnectionStats[] getConnectionStats() {
+    return NetworkTablesJNI.getConnectionStats(m_handle);
+  }
+
   /**
    * Return whether or not the instance is connected to another node.
    *
@@ -985,6 +1134,31 @@ public final class NetworkTableInstance implements AutoCloseable {
     return NetworkTablesJNI.loadPersistent(m_handle, filename);
   }
 
+  /**
+   * Selects the file format used for saving persistent values.  The text
+   * format is used by default.  The binary format is faster to save and load
+   * and includes a checksum; loadPersistent() and loadEntries() accept either
+   * format, and saveEntries() always uses the text format.
+   *
+   * @param binary true to use the binary format, false for text
+   */
+  public void setPersistentBinary(boolean binary) {
+    NetworkTablesJNI.setPersistentBinary(m_handle, binary);
+  }
+
+  /**
+   * Enables journaling of persistent values.  Instead of rewriting the whole
+   * persistent file, periodic saves append changed values to
+   * "&lt;filename&gt;.journal", and the persistent file is rewritten in the
+   * background once the journal grows large.  loadPersistent() applies the
+   * journal when it is present.
+   *
+   * @param enabled true to enable journaling
+   */
+  public void setPersistentJournal(boolean enabled) {
+    NetworkTablesJNI.setPersistentJournal(m_handle, enabled);
+  }
+
   /**
    * Save table values to a file.  The file format used is identical to
    * that used for SavePersistent.
@@ -1010,6 +1184,69 @@ public final class NetworkTableInstance implements AutoCloseable {
     return NetworkTablesJNI.loadEntries(m_handle, filename, prefix);
   }
 
+  /**
+   * Start logging entry changes to a binary data log file.  The current value
+   * of each matching entry and every subsequent change and deletion is
+   * recorded with its timestamp.  Changes are written to the file by a
+   * background thread.  Any existing file is replaced.
+   *
+   * @param filename  filename
+   * @param prefix    log only keys starting with this prefix
+   * @return Data logger handle
+   * @throws PersistentException if error opening file
+   */
+  public int startDataLog(String filename, String prefix) throws PersistentException {
+    return NetworkTablesJNI.startDataLog(m_handle, filename, prefix);
+  }
+
+  /**
+   * Stop a data log.  Buffered changes are written to the file before this
+   * function returns.
+   *
+   * @param logger Data logger handle returned by startDataLog()
+   */
+  public void stopDataLog(int logger) {
+    NetworkTablesJNI.stopDataLog(logger);
+  }
+
+  /**
+   * Start replaying a binary data log into this instance.  Each recorded
+   * change and deletion is applied as a local change (so it drives entry
+   * listeners and is sent to any connected clients), with the same spacing
+   * as the recording divided by speed.  The replay runs on a background
+   * thread.
+   *
+   * @param filename  data log filename
+   * @param speed     replay speed relative to the recording (e.g. 1 for real
+   *                  time, 10 for 10x); 0 replays as fast as possible
+   * @return Data log replay handle
+   * @throws PersistentException if error reading file
+   */
+  public int startDataLogReplay(String filename, double speed) throws PersistentException {
+    return NetworkTablesJNI.startDataLogReplay(m_handle, filename, speed);
+  }
+
+  /**
+   * Wait for a data log replay to finish.
+   *
+   * @param replay  Data log replay handle returned by startDataLogReplay()
+   * @param timeout timeout, in seconds; a negative value waits forever
+   * @return False if timed out, otherwise true.
+   */
+  public boolean waitForDataLogReplay(int replay, double timeout) {
+    return NetworkTablesJNI.waitForDataLogReplay(replay, timeout);
+  }
+
+  /**
+   * Stop a data log replay (if it is still running) and release its handle.
+   * Must be called for each replay, even one that has finished.
+   *
+   * @param replay  Data log replay handle returned by startDataLogReplay()
+   */
+  public void stopDataLogReplay(int replay) {
+    NetworkTablesJNI.stopDataLogReplay(replay);
+  }
+
   private final ReentrantLock m_loggerLock = new ReentrantLock();
   private final Map<Integer, Consumer<LogMessage>> m_loggers = new HashMap<>();
   private Thread m_loggerThread;
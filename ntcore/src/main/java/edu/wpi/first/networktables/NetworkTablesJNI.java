@@ -49,8 +49,17 @@ public final class NetworkTablesJNI {
   public static native boolean setBooleanArray(int entry, long time, boolean[] value, boolean force);
   public static native boolean setDoubleArray(int entry, long time, double[] value, boolean force);
   public static native boolean setStringArray(int entry, long time, String[] value, boolean force);
+  public static native boolean setDoubles(int[] entries, long time, double[] values);
 
   public static native NetworkTableValue getValue(int entry);
+  public static native NetworkTableValue[] getValues(int[] entries);
+  public static native int getDoubles(int[] entries, double[] values, double defaultValue);
+  public static native int getDoublesBuffer(int[] entries, ByteBuffer values, double defaultValue);
+  public static native int getBooleans(int[] entries, boolean[] values, boolean defaultValue);
+  public static native int getBooleansBuffer(int[] entries, ByteBuffer values, boolean defaultValue);
+  public static native NetworkTableValue getValueAt(int entry, long time);
+  public static native NetworkTableValue[] getHistory(int entry, long since);
+  public static native void setEntryHistory(int entry, int capacity);
 
   public static native boolean getBoolean(int entry, boolean defaultValue);
   public static native double getDouble(int entry, double defaultValue);
@@ -58,6 +67,8 @@ public final class NetworkTablesJNI {
   public static native byte[] getRaw(int entry, byte[] defaultValue);
   public static native boolean[] getBooleanArray(int entry, boolean[] defaultValue);
   public static native double[] getDoubleArray(int entry, double[] defaultValue);
+  public static native int readBooleanArray(int entry, boolean[] values);
+  public static native int readDoubleArray(int entry, double[] values);
   public static native String[] getStringArray(int entry, String[] defaultValue);
   public static native boolean setDefaultBoolean(int entry, long time, boolean defaultValue);
 
@@ -70,6 +81,8 @@ public final class NetworkTablesJNI {
 
   public static native void setEntryFlags(int entry, int flags);
   public static native int getEntryFlags(int entry);
+  public static native void setEntryUpdateRate(int entry, double interval);
+  public static native double getEntryUpdateRate(int entry);
 
   public static native void deleteEntry(int entry);
 
@@ -87,6 +100,8 @@ public final class NetworkTablesJNI {
   public static native void cancelPollEntryListener(int poller);
   public static native void removeEntryListener(int entryListener);
   public static native boolean waitForEntryListenerQueue(int inst, double timeout);
+  public static native void setEntryListenerQueue(int handle, long capacity, int overflow);
+  public static native ListenerQueueStats getEntryListenerQueueStats(int handle);
 
   public static native int createConnectionListenerPoller(int inst);
   public static native void destroyConnectionListenerPoller(int poller);
@@ -127,19 +142,33 @@ public final class NetworkTablesJNI {
   public static native void startDSClient(int inst, int port);
   public static native void stopDSClient(int inst);
   public static native void setUpdateRate(int inst, double interval);
+  public static native void setNetworkEventLoop(int inst, boolean enabled);
+  public static native void setNetworkFlushMode(int inst, int mode, double window);
+  public static native void setNetworkSocketFlags(int inst, int flags);
+  public static native void setNetworkSubscriptions(int inst, String[] prefixes);
+  public static native void setPrefixUpdateRate(int inst, String prefix, double interval);
 
   public static native void flush(int inst);
 
   public static native ConnectionInfo[] getConnections(int inst);
+  public static native ConnectionStats[] getConnectionStats(int inst);
 
   public static native boolean isConnected(int inst);
 
   public static native void savePersistent(int inst, String filename) throws PersistentException;
   public static native String[] loadPersistent(int inst, String filename) throws PersistentException;  // returns warnings
+  public static native void setPersistentBinary(int inst, boolean binary);
+  public static native void setPersistentJournal(int inst, boolean enabled);
 
   public static native void saveEntries(int inst, String filename, String prefix) throws PersistentException;
   public static native String[] loadEntries(int inst, String filename, String prefix) throws PersistentException;  // returns warnings
 
+  public static native int startDataLog(int inst, String filename, String prefix) throws PersistentException;
+  public static native void stopDataLog(int logger);
+  public static native int startDataLogReplay(int inst, String filename, double speed) throws PersistentException;
+  public static native boolean waitForDataLogReplay(int replay, double timeout);
+  public static native void stopDataLogReplay(int replay);
+
   public static native long now();
 
   public static native int createLoggerPoller(int inst);
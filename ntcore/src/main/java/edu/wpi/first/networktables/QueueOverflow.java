@@ -0,0 +1,31 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+package edu.wpi.first.networktables;
+
+/**
+ * Policies for what to do when a bounded entry listener queue is full.
+ */
+public interface QueueOverflow {
+  /**
+   * Drop the oldest queued notification.
+   */
+  int kDropOldest = 0;
+
+  /**
+   * Replace a queued notification for the same entry and listener (so only
+   * the latest value is delivered).  If there is none, the oldest queued
+   * notification is dropped.
+   */
+  int kCoalesce = 1;
+
+  /**
+   * Wait for the queue to be polled.  This delays notifications to all other
+   * listeners of the instance.
+   */
+  int kBlock = 2;
+}
@@ -0,0 +1,93 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_APPENDONLYVECTOR_H_
+#define NTCORE_APPENDONLYVECTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace nt {
+
+// A vector that only grows, and whose existing elements can be read from
+// other threads without locking while elements are being appended.
+//
+// Elements are stored in fixed-size chunks that are never reallocated, so
+// element addresses are stable.  The size is published with release semantics
+// after the element is constructed, so a reader that checks an index against
+// size() is guaranteed to see a fully constructed element.
+//
+// Appends must be externally synchronized with each other.  Modifying an
+// element that is concurrently read is the caller's responsibility.
+// Appending to a full vector does nothing and returns nullptr.
+//
+// @tparam T          element type
+// @tparam ChunkBits  log2 of the number of elements per chunk
+// @tparam MaxChunks  maximum number of chunks (capacity is
+//                    MaxChunks << ChunkBits)
+template <typename T, size_t ChunkBits = 10, size_t MaxChunks = 1024>
+class AppendOnlyVector {
+ public:
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+
+  static constexpr size_type kChunkSize = size_type{1} << ChunkBits;
+
+  AppendOnlyVector() = default;
+  AppendOnlyVector(const AppendOnlyVector&) = delete;
+  AppendOnlyVector& operator=(const AppendOnlyVector&) = delete;
+
+  ~AppendOnlyVector() {
+    size_type n = size();
+    for (size_type i = 0; i < n; ++i) Element(i)->~T();
+  }
+
+  size_type size() const { return m_size.load(std::memory_order_acquire); }
+  bool empty() const { return size() == 0; }
+  static constexpr size_type max_size() { return MaxChunks << ChunkBits; }
+
+  reference operator[](size_type i) { return *Element(i); }
+  const_reference operator[](size_type i) const { return *Element(i); }
+
+  reference back() { return (*this)[size() - 1]; }
+  const_reference back() const { return (*this)[size() - 1]; }
+
+  bool full() const { return size() >= max_size(); }
+
+  template <typename... Args>
+  T* emplace_back(Args&&... args) {
+    size_type n = m_size.load(std::memory_order_relaxed);
+    if (n >= max_size()) return nullptr;
+    auto& chunk = m_chunks[n >> ChunkBits];
+    if (!chunk) chunk.reset(new Storage[kChunkSize]);
+    T* elem =
+        new (&chunk[n & (kChunkSize - 1)]) T(std::forward<Args>(args)...);
+    m_size.store(n + 1, std::memory_order_release);
+    return elem;
+  }
+
+ private:
+  typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+  T* Element(size_type i) const {
+    return reinterpret_cast<T*>(
+        &m_chunks[i >> ChunkBits][i & (kChunkSize - 1)]);
+  }
+
+  std::unique_ptr<Storage[]> m_chunks[MaxChunks];
+  std::atomic<size_type> m_size{0};
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_APPENDONLYVECTOR_H_
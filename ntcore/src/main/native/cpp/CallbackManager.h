@@ -8,11 +8,14 @@
 #ifndef NTCORE_CALLBACKMANAGER_H_
 #define NTCORE_CALLBACKMANAGER_H_
 
+#include <stdint.h>
+
 #include <atomic>
+#include <chrono>
 #include <climits>
 #include <functional>
 #include <memory>
-#include <queue>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -22,6 +25,9 @@
 #include <wpi/mutex.h>
 #include <wpi/raw_ostream.h>
 
+#include "RingQueue.h"
+#include "ntcore_cpp.h"
+
 namespace nt {
 
 namespace impl {
@@ -39,6 +45,33 @@ class ListenerData {
   unsigned int poller_uid = UINT_MAX;
 };
 
+// Overflow policy and counters for a bounded queue
+struct QueueOverflow {
+  unsigned int policy = NT_QUEUE_DROP_OLDEST;
+  uint64_t dropped = 0;
+  uint64_t coalesced = 0;
+};
+
+// Push item to queue, applying the overflow policy if the queue is full
+// (other than blocking, which is up to the caller).  merge(queued, item)
+// returns true if it merged item into a queued item.
+template <typename T, typename F>
+void Push(RingQueue<T>* queue, QueueOverflow* overflow, T item, F merge) {
+  if (queue->full()) {
+    if (overflow->policy != NT_QUEUE_DROP_OLDEST) {
+      for (size_t i = 0; i < queue->size(); ++i) {
+        if (merge(&(*queue)[i], item)) {
+          ++overflow->coalesced;
+          return;
+        }
+      }
+    }
+    queue->pop();
+    ++overflow->dropped;
+  }
+  queue->emplace(std::move(item));
+}
+
 // CRTP callback manager thread
 // @tparam Derived        derived class
 // @tparam NotifierData   data buffered for each callback
@@ -47,6 +80,8 @@ class ListenerData {
 //   bool Matches(const ListenerData& listener, const NotifierData& data);
 //   void SetListener(NotifierData* data, unsigned int listener_uid);
 //   void DoCallback(Callback callback, const NotifierData& data);
+// Derived may also hide ListenerAdded(), ListenerRemoved(), GetCandidates()
+// and Coalesce() to index its listeners and merge queued notifications.
 template <typename Derived, typename TUserInfo,
           typename TListenerData =
               ListenerData<std::function<void(const TUserInfo& info)>>,
@@ -66,9 +101,34 @@ class CallbackThread : public wpi::SafeThread {
 
   void Main() override;
 
+  // Called with m_mutex held after a listener is added, and before one is
+  // removed.
+  void ListenerAdded(unsigned int listener_uid) {}
+  void ListenerRemoved(unsigned int listener_uid) {}
+
+  // Called with m_mutex held to get the uids (in increasing order) of the
+  // listeners that may match data.  Return false to check every listener.
+  bool GetCandidates(const NotifierData& data,
+                     std::vector<unsigned int>* listener_uids) {
+    return false;
+  }
+
+  // Called with m_mutex held when the queue for a listener (or for the
+  // thread, when queued is a thread queue item) is full.  Return true if data
+  // was merged into queued; otherwise the oldest notification is dropped.
+  bool Coalesce(NotifierData* queued, const NotifierData& data) {
+    return false;
+  }
+
   wpi::UidVector<ListenerData, 64> m_listeners;
 
-  std::queue<std::pair<unsigned int, NotifierData>> m_queue;
+  // Pending notifications; listener uid is UINT_MAX for all listeners.
+  // NT_QUEUE_BLOCK is not supported for this queue (it's filled while
+  // holding other locks) and behaves like NT_QUEUE_COALESCE.
+  RingQueue<std::pair<unsigned int, NotifierData>> m_queue;
+  QueueOverflow m_queue_overflow;
+  // True while a notification taken from m_queue is being dispatched
+  bool m_dispatching = false;
   wpi::condition_variable m_queue_empty;
 
   struct Poller {
@@ -78,10 +138,14 @@ class CallbackThread : public wpi::SafeThread {
         terminating = true;
       }
       poll_cond.notify_all();
+      space_cond.notify_all();
     }
-    std::queue<NotifierData> poll_queue;
+    RingQueue<NotifierData> poll_queue;
+    QueueOverflow overflow;
     wpi::mutex poll_mutex;
     wpi::condition_variable poll_cond;
+    // notified when poll_queue is drained (for NT_QUEUE_BLOCK)
+    wpi::condition_variable space_cond;
     bool terminating = false;
     bool cancelling = false;
   };
@@ -89,16 +153,30 @@ class CallbackThread : public wpi::SafeThread {
 
   // Must be called with m_mutex held
   template <typename... Args>
-  void SendPoller(unsigned int poller_uid, Args&&... args) {
-    if (poller_uid > m_pollers.size()) return;
-    auto poller = m_pollers[poller_uid];
-    if (!poller) return;
-    {
-      std::lock_guard<wpi::mutex> lock(poller->poll_mutex);
-      poller->poll_queue.emplace(std::forward<Args>(args)...);
-    }
-    poller->poll_cond.notify_one();
+  void Enqueue(unsigned int only_listener, Args&&... args) {
+    typedef std::pair<unsigned int, NotifierData> Item;
+    Push(&m_queue, &m_queue_overflow,
+         Item(std::piecewise_construct, std::make_tuple(only_listener),
+              std::forward_as_tuple(std::forward<Args>(args)...)),
+         [this](Item* queued, const Item& item) {
+           return queued->first == item.first &&
+                  static_cast<Derived*>(this)->Coalesce(&queued->second,
+                                                        item.second);
+         });
   }
+
+  // Must be called with m_mutex held (lock).  If the poller's queue is full
+  // and its overflow policy is NT_QUEUE_BLOCK, lock is released while waiting
+  // for the queue to be drained.
+  void SendPoller(unsigned int poller_uid, NotifierData data,
+                  std::unique_lock<wpi::mutex>& lock);
+
+ private:
+  // Must be called with m_mutex held (lock)
+  void Notify(unsigned int listener_uid, NotifierData& data,
+              std::unique_lock<wpi::mutex>& lock);
+
+  std::vector<unsigned int> m_candidates;
 };
 
 template <typename Derived, typename TUserInfo, typename TListenerData,
@@ -113,7 +191,11 @@ void CallbackThread<Derived, TUserInfo, TListenerData, TNotifierData>::Main() {
 
     while (!m_queue.empty()) {
       if (!m_active) return;
+      // Pop before dispatching, so the queue can be added to (and overflow)
+      // while callbacks are running.
       auto item = std::move(m_queue.front());
+      m_queue.pop();
+      m_dispatching = true;
 
       if (item.first != UINT_MAX) {
         if (item.first < m_listeners.size()) {
@@ -127,35 +209,84 @@ void CallbackThread<Derived, TUserInfo, TListenerData, TNotifierData>::Main() {
                                                       item.second);
               lock.lock();
             } else if (listener.poller_uid != UINT_MAX) {
-              SendPoller(listener.poller_uid, std::move(item.second));
+              SendPoller(listener.poller_uid, std::move(item.second), lock);
             }
           }
         }
+      } else if (static_cast<Derived*>(this)->GetCandidates(item.second,
+                                                             &m_candidates)) {
+        // Only Main() uses m_candidates, so it's safe to iterate while
+        // callbacks are running.
+        for (unsigned int i : m_candidates) Notify(i, item.second, lock);
       } else {
         // Use index because iterator might get invalidated.
-        for (size_t i = 0; i < m_listeners.size(); ++i) {
-          auto& listener = m_listeners[i];
-          if (!listener) continue;
-          if (!static_cast<Derived*>(this)->Matches(listener, item.second))
-            continue;
-          static_cast<Derived*>(this)->SetListener(&item.second, i);
-          if (listener.callback) {
-            lock.unlock();
-            static_cast<Derived*>(this)->DoCallback(listener.callback,
-                                                    item.second);
-            lock.lock();
-          } else if (listener.poller_uid != UINT_MAX) {
-            SendPoller(listener.poller_uid, item.second);
-          }
-        }
+        for (size_t i = 0; i < m_listeners.size(); ++i)
+          Notify(i, item.second, lock);
       }
-      m_queue.pop();
+      m_dispatching = false;
     }
 
     m_queue_empty.notify_all();
   }
 }
 
+template <typename Derived, typename TUserInfo, typename TListenerData,
+          typename TNotifierData>
+void CallbackThread<Derived, TUserInfo, TListenerData, TNotifierData>::Notify(
+    unsigned int listener_uid, NotifierData& data,
+    std::unique_lock<wpi::mutex>& lock) {
+  if (listener_uid >= m_listeners.size()) return;
+  auto& listener = m_listeners[listener_uid];
+  if (!listener) return;
+  if (!static_cast<Derived*>(this)->Matches(listener, data)) return;
+  static_cast<Derived*>(this)->SetListener(&data, listener_uid);
+  if (listener.callback) {
+    lock.unlock();
+    static_cast<Derived*>(this)->DoCallback(listener.callback, data);
+    lock.lock();
+  } else if (listener.poller_uid != UINT_MAX) {
+    SendPoller(listener.poller_uid, data, lock);
+  }
+}
+
+template <typename Derived, typename TUserInfo, typename TListenerData,
+          typename TNotifierData>
+void CallbackThread<Derived, TUserInfo, TListenerData,
+                    TNotifierData>::SendPoller(unsigned int poller_uid,
+                                               NotifierData data,
+                                               std::unique_lock<wpi::mutex>&
+                                                   lock) {
+  if (poller_uid >= m_pollers.size()) return;
+  auto poller = m_pollers[poller_uid];
+  if (!poller) return;
+  {
+    std::unique_lock<wpi::mutex> poll_lock(poller->poll_mutex);
+    auto& queue = poller->poll_queue;
+    auto& overflow = poller->overflow;
+    if (queue.full() && overflow.policy == NT_QUEUE_BLOCK) {
+      // Release the thread lock while waiting, so the poller can be polled
+      // and removed.  The lock is reacquired after poll_lock is released to
+      // keep the lock order (m_mutex, then poll_mutex).
+      lock.unlock();
+      while (queue.full() && overflow.policy == NT_QUEUE_BLOCK &&
+             !poller->terminating && m_active) {
+        poller->space_cond.wait_for(poll_lock, std::chrono::milliseconds(100));
+      }
+      if (poller->terminating || !m_active) {
+        poll_lock.unlock();
+        lock.lock();
+        return;
+      }
+    }
+    Push(&queue, &overflow, std::move(data),
+         [this](NotifierData* queued, const NotifierData& item) {
+           return static_cast<Derived*>(this)->Coalesce(queued, item);
+         });
+  }
+  poller->poll_cond.notify_one();
+  if (!lock.owns_lock()) lock.lock();
+}
+
 }  // namespace impl
 
 // CRTP callback manager
@@ -174,6 +305,7 @@ class CallbackManager {
   void Remove(unsigned int listener_uid) {
     auto thr = m_owner.GetThread();
     if (!thr) return;
+    thr->ListenerRemoved(listener_uid);
     thr->m_listeners.erase(listener_uid);
   }
 
@@ -190,8 +322,10 @@ class CallbackManager {
 
     // Remove any listeners that are associated with this poller
     for (size_t i = 0; i < thr->m_listeners.size(); ++i) {
-      if (thr->m_listeners[i].poller_uid == poller_uid)
+      if (thr->m_listeners[i].poller_uid == poller_uid) {
+        thr->ListenerRemoved(i);
         thr->m_listeners.erase(i);
+      }
     }
 
     // Wake up any blocked pollers
@@ -209,7 +343,7 @@ class CallbackManager {
     auto& lock = thr.GetLock();
     auto timeout_time = std::chrono::steady_clock::now() +
                         std::chrono::duration<double>(timeout);
-    while (!thr->m_queue.empty()) {
+    while (!thr->m_queue.empty() || thr->m_dispatching) {
       if (!thr->m_active) return true;
       if (timeout == 0) return false;
       if (timeout < 0) {
@@ -271,9 +405,56 @@ class CallbackManager {
       infos.emplace_back(std::move(poller->poll_queue.front()));
       poller->poll_queue.pop();
     }
+    poller->space_cond.notify_all();
     return infos;
   }
 
+  // Set the capacity (0 for unbounded) and NT_QueueOverflow policy of the
+  // queue of notifications waiting for callbacks.
+  void SetQueue(size_t capacity, unsigned int policy) {
+    static_cast<Derived*>(this)->Start();
+    auto thr = m_owner.GetThread();
+    thr->m_queue_overflow.dropped += thr->m_queue.set_capacity(capacity);
+    thr->m_queue_overflow.policy = policy;
+  }
+
+  ListenerQueueStats GetQueueStats() const {
+    ListenerQueueStats stats{0, 0, 0, 0};
+    auto thr = m_owner.GetThread();
+    if (!thr) return stats;
+    stats.queued = thr->m_queue.size();
+    stats.capacity = thr->m_queue.capacity();
+    stats.dropped = thr->m_queue_overflow.dropped;
+    stats.coalesced = thr->m_queue_overflow.coalesced;
+    return stats;
+  }
+
+  // Set the capacity (0 for unbounded) and NT_QueueOverflow policy of a
+  // poller's queue.
+  void SetPollerQueue(unsigned int poller_uid, size_t capacity,
+                      unsigned int policy) {
+    auto poller = GetPoller(poller_uid);
+    if (!poller) return;
+    {
+      std::lock_guard<wpi::mutex> lock(poller->poll_mutex);
+      poller->overflow.dropped += poller->poll_queue.set_capacity(capacity);
+      poller->overflow.policy = policy;
+    }
+    poller->space_cond.notify_all();
+  }
+
+  ListenerQueueStats GetPollerQueueStats(unsigned int poller_uid) const {
+    ListenerQueueStats stats{0, 0, 0, 0};
+    auto poller = GetPoller(poller_uid);
+    if (!poller) return stats;
+    std::lock_guard<wpi::mutex> lock(poller->poll_mutex);
+    stats.queued = poller->poll_queue.size();
+    stats.capacity = poller->poll_queue.capacity();
+    stats.dropped = poller->overflow.dropped;
+    stats.coalesced = poller->overflow.coalesced;
+    return stats;
+  }
+
   void CancelPoll(unsigned int poller_uid) {
     std::shared_ptr<typename Thread::Poller> poller;
     {
@@ -301,16 +482,17 @@ class CallbackManager {
   unsigned int DoAdd(Args&&... args) {
     static_cast<Derived*>(this)->Start();
     auto thr = m_owner.GetThread();
-    return thr->m_listeners.emplace_back(std::forward<Args>(args)...);
+    unsigned int uid =
+        thr->m_listeners.emplace_back(std::forward<Args>(args)...);
+    thr->ListenerAdded(uid);
+    return uid;
   }
 
   template <typename... Args>
   void Send(unsigned int only_listener, Args&&... args) {
     auto thr = m_owner.GetThread();
     if (!thr || thr->m_listeners.empty()) return;
-    thr->m_queue.emplace(std::piecewise_construct,
-                         std::make_tuple(only_listener),
-                         std::forward_as_tuple(std::forward<Args>(args)...));
+    thr->Enqueue(only_listener, std::forward<Args>(args)...);
     thr->m_cond.notify_one();
   }
 
@@ -318,6 +500,13 @@ class CallbackManager {
     return m_owner.GetThread();
   }
 
+  std::shared_ptr<typename Thread::Poller> GetPoller(
+      unsigned int poller_uid) const {
+    auto thr = m_owner.GetThread();
+    if (!thr || poller_uid >= thr->m_pollers.size()) return nullptr;
+    return thr->m_pollers[poller_uid];
+  }
+
  private:
   wpi::SafeThreadOwner<Thread> m_owner;
 };
@@ -0,0 +1,47 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_DATALOGFORMAT_H_
+#define NTCORE_DATALOGFORMAT_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+
+namespace nt {
+namespace datalog {
+
+// Data log file layout.  Fixed-size integers are little endian; "uleb" is an
+// unsigned LEB128 integer.
+//
+//   header (16 bytes):
+//     magic        4 bytes: 0x89 'N' 'T' 'L'
+//     version      u32
+//     start time   u64 time (in nt::Now() units) the log was started
+//   records, each starting with a u8 record type:
+//     kStart       uleb entry id, uleb name length, name bytes
+//                  (precedes the first record for an entry id)
+//     kValue       uleb entry id, uleb time delta, u8 NT_Type, value:
+//       boolean      u8
+//       double       IEEE 754 double (as u64)
+//       string/raw   uleb length, then bytes
+//       arrays       uleb element count, then elements encoded as above
+//     kDelete      uleb entry id, uleb time delta
+//
+// Time deltas are relative to the previous timestamped record (or the start
+// time), so timestamps never decrease.  The file is only ever appended to;
+// a log that was not closed cleanly ends with at most one partial record.
+constexpr char kMagic[4] = {'\x89', 'N', 'T', 'L'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 16;
+
+enum RecordType { kStart = 1, kValue = 2, kDelete = 3 };
+
+}  // namespace datalog
+}  // namespace nt
+
+#endif  // NTCORE_DATALOGFORMAT_H_
@@ -0,0 +1,411 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include "DataLogReader.h"
+
+#include <cstring>
+#include <string>
+
+#include <wpi/Base64.h>
+#include <wpi/Format.h>
+#include <wpi/StringExtras.h>
+
+#include "Handle.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace nt;
+
+static uint64_t Get64(const char* buf) {
+  uint64_t val = 0;
+  for (int i = 7; i >= 0; --i)
+    val = (val << 8) | static_cast<unsigned char>(buf[i]);
+  return val;
+}
+
+static double GetDouble(const char* buf) {
+  uint64_t v = Get64(buf);
+  double val;
+  std::memcpy(&val, &v, sizeof(val));
+  return val;
+}
+
+const char* DataLogReader::Open(const Twine& filename) {
+  int fd;
+  if (wpi::sys::fs::openFileForRead(filename, fd)) return "could not open file";
+  wpi::sys::fs::file_status status;
+  if (wpi::sys::fs::status(fd, status)) {
+    ::close(fd);
+    return "could not open file";
+  }
+  if (status.getSize() < datalog::kHeaderSize) {
+    ::close(fd);
+    return "not a data log";
+  }
+
+  std::error_code ec;
+  m_region.reset(new wpi::sys::fs::mapped_file_region(
+      fd, wpi::sys::fs::mapped_file_region::readonly, status.getSize(), 0,
+      ec));
+  ::close(fd);
+  if (ec) {
+    m_region.reset();
+    return "could not read file";
+  }
+  return SetData(StringRef(m_region->const_data(), m_region->size()));
+}
+
+const char* DataLogReader::SetData(StringRef data) {
+  if (data.size() < datalog::kHeaderSize ||
+      std::memcmp(data.data(), datalog::kMagic, sizeof(datalog::kMagic)) != 0)
+    return "not a data log";
+  uint32_t version = 0;
+  for (int i = 7; i >= 4; --i)
+    version = (version << 8) | static_cast<unsigned char>(data[i]);
+  if (version != datalog::kVersion) return "unsupported data log version";
+  m_start_time = Get64(data.data() + 8);
+  m_time = m_start_time;
+  m_data = data.drop_front(datalog::kHeaderSize);
+  m_record_num = 0;
+  m_names.clear();
+  return nullptr;
+}
+
+bool DataLogReader::Next(Record* rec) {
+  while (!m_data.empty()) {
+    ++m_record_num;
+    auto type = static_cast<unsigned char>(m_data[0]);
+    m_data = m_data.drop_front();
+    uint64_t id;
+    if (!ReadUleb128(&id)) return Invalid();
+    if (type == datalog::kStart) {
+      StringRef name;
+      // ids are entry handle indices; a larger one is corrupt and would
+      // otherwise size m_names from untrusted data
+      if (!ReadString(&name) || name.empty() || id > Handle::kIndexMax)
+        return Invalid();
+      if (id >= m_names.size()) m_names.resize(id + 1);
+      m_names[id] = name;
+      continue;
+    }
+    if (type != datalog::kValue && type != datalog::kDelete) return Invalid();
+    if (id >= m_names.size() || m_names[id].empty()) return Invalid();
+    uint64_t delta;
+    if (!ReadUleb128(&delta)) return Invalid();
+    m_time += delta;
+    rec->value = nullptr;
+    if (type == datalog::kValue) {
+      if (m_data.empty()) return Invalid();
+      auto value_type =
+          static_cast<NT_Type>(static_cast<unsigned char>(m_data[0]));
+      m_data = m_data.drop_front();
+      rec->value =
+          ReadValue(value_type, m_value_time ? m_value_time(m_time) : m_time);
+      if (!rec->value) return Invalid();
+    }
+    rec->type = static_cast<datalog::RecordType>(type);
+    rec->id = id;
+    rec->name = m_names[id];
+    rec->time = m_time;
+    return true;
+  }
+  return false;
+}
+
+bool DataLogReader::Invalid() {
+  // a log that was not closed cleanly can end with a partial record
+  Warn("incomplete or invalid record; ignoring rest of log");
+  m_data = StringRef{};
+  return false;
+}
+
+bool DataLogReader::ReadUleb128(uint64_t* val) {
+  uint64_t result = 0;
+  int shift = 0;
+  for (size_t i = 0; i < m_data.size() && shift < 64; ++i) {
+    auto byte = static_cast<unsigned char>(m_data[i]);
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+    if ((byte & 0x80) == 0) {
+      *val = result;
+      m_data = m_data.drop_front(i + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool DataLogReader::ReadString(StringRef* str) {
+  uint64_t len;
+  if (!ReadUleb128(&len) || m_data.size() < len) return false;
+  *str = m_data.substr(0, len);
+  m_data = m_data.drop_front(len);
+  return true;
+}
+
+std::shared_ptr<Value> DataLogReader::ReadValue(NT_Type type,
+                                                uint64_t time) {
+  switch (type) {
+    case NT_BOOLEAN: {
+      if (m_data.empty()) return nullptr;
+      bool val = m_data[0] != 0;
+      m_data = m_data.drop_front();
+      return Value::MakeBoolean(val, time);
+    }
+    case NT_DOUBLE: {
+      if (m_data.size() < 8) return nullptr;
+      double val = GetDouble(m_data.data());
+      m_data = m_data.drop_front(8);
+      return Value::MakeDouble(val, time);
+    }
+    case NT_STRING:
+    case NT_RAW:
+    case NT_RPC: {
+      StringRef str;
+      if (!ReadString(&str)) return nullptr;
+      if (type == NT_STRING) return Value::MakeString(str, time);
+      if (type == NT_RAW) return Value::MakeRaw(str, time);
+      return Value::MakeRpc(str, time);
+    }
+    case NT_BOOLEAN_ARRAY: {
+      uint64_t size;
+      if (!ReadUleb128(&size) || m_data.size() < size) return nullptr;
+      std::vector<int> arr;
+      arr.reserve(size);
+      for (size_t i = 0; i < size; ++i) arr.push_back(m_data[i] != 0);
+      m_data = m_data.drop_front(size);
+      return Value::MakeBooleanArray(std::move(arr), time);
+    }
+    case NT_DOUBLE_ARRAY: {
+      uint64_t size;
+      if (!ReadUleb128(&size) || m_data.size() / 8 < size) return nullptr;
+      std::vector<double> arr;
+      arr.reserve(size);
+      for (size_t i = 0; i < size; ++i)
+        arr.push_back(GetDouble(m_data.data() + 8 * i));
+      m_data = m_data.drop_front(8 * size);
+      return Value::MakeDoubleArray(std::move(arr), time);
+    }
+    case NT_STRING_ARRAY: {
+      uint64_t size;
+      // each element is at least one byte
+      if (!ReadUleb128(&size) || m_data.size() < size) return nullptr;
+      std::vector<std::string> arr;
+      arr.reserve(size);
+      for (size_t i = 0; i < size; ++i) {
+        StringRef str;
+        if (!ReadString(&str)) return nullptr;
+        arr.emplace_back(str);
+      }
+      return Value::MakeStringArray(std::move(arr), time);
+    }
+    default:
+      return nullptr;
+  }
+}
+
+static const char* TypeName(NT_Type type) {
+  switch (type) {
+    case NT_BOOLEAN:
+      return "boolean";
+    case NT_DOUBLE:
+      return "double";
+    case NT_STRING:
+      return "string";
+    case NT_RAW:
+      return "raw";
+    case NT_RPC:
+      return "rpc";
+    case NT_BOOLEAN_ARRAY:
+      return "boolean[]";
+    case NT_DOUBLE_ARRAY:
+      return "double[]";
+    case NT_STRING_ARRAY:
+      return "string[]";
+    default:
+      return "unknown";
+  }
+}
+
+static void WriteJsonString(wpi::raw_ostream& os, StringRef str) {
+  os << '"';
+  for (auto c : str) {
+    switch (c) {
+      case '\\':
+        os << "\\\\";
+        break;
+      case '"':
+        os << "\\\"";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\r':
+        os << "\\r";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << "\\u00" << wpi::hexdigit((c >> 4) & 0xF)
+             << wpi::hexdigit(c & 0xF);
+          break;
+        }
+        os << c;
+    }
+  }
+  os << '"';
+}
+
+static void WriteJsonDouble(wpi::raw_ostream& os, double val) {
+  // JSON has no representation for infinity or NaN
+  if (val != val || val - val != 0)
+    os << "null";
+  else
+    os << wpi::format("%.15g", val);
+}
+
+// Writes a value as JSON (strings and raw values are quoted, raw values are
+// base64 encoded).
+static void WriteJsonValue(wpi::raw_ostream& os, const Value& value) {
+  switch (value.type()) {
+    case NT_BOOLEAN:
+      os << (value.GetBoolean() ? "true" : "false");
+      break;
+    case NT_DOUBLE:
+      WriteJsonDouble(os, value.GetDouble());
+      break;
+    case NT_STRING:
+      WriteJsonString(os, value.GetString());
+      break;
+    case NT_RAW:
+    case NT_RPC: {
+      os << '"';
+      wpi::Base64Encode(os, value.type() == NT_RAW ? value.GetRaw()
+                                                   : value.GetRpc());
+      os << '"';
+      break;
+    }
+    case NT_BOOLEAN_ARRAY: {
+      os << '[';
+      bool first = true;
+      for (auto elem : value.GetBooleanArray()) {
+        if (!first) os << ',';
+        first = false;
+        os << (elem ? "true" : "false");
+      }
+      os << ']';
+      break;
+    }
+    case NT_DOUBLE_ARRAY: {
+      os << '[';
+      bool first = true;
+      for (auto elem : value.GetDoubleArray()) {
+        if (!first) os << ',';
+        first = false;
+        WriteJsonDouble(os, elem);
+      }
+      os << ']';
+      break;
+    }
+    case NT_STRING_ARRAY: {
+      os << '[';
+      bool first = true;
+      for (auto& elem : value.GetStringArray()) {
+        if (!first) os << ',';
+        first = false;
+        WriteJsonString(os, elem);
+      }
+      os << ']';
+      break;
+    }
+    default:
+      os << "null";
+      break;
+  }
+}
+
+// Writes a CSV field, quoting it if necessary.
+static void WriteCsvField(wpi::raw_ostream& os, StringRef str) {
+  if (str.find_first_of(",\"\r\n") == StringRef::npos) {
+    os << str;
+    return;
+  }
+  os << '"';
+  for (auto c : str) {
+    if (c == '"') os << '"';
+    os << c;
+  }
+  os << '"';
+}
+
+void DataLogReader::Convert(wpi::raw_ostream& os, NT_DataLogFormat format) {
+  // times are written in seconds since the start of the log
+  Record rec;
+  std::string buf;
+  bool first = true;
+  if (format == NT_DATALOG_JSON)
+    os << "[";
+  else
+    os << "time,name,type,value\n";
+  while (Next(&rec)) {
+    double time = (rec.time - m_start_time) * 1.0e-6;
+    if (format == NT_DATALOG_JSON) {
+      os << (first ? "\n" : ",\n") << "{\"time\":" << wpi::format("%.6f", time)
+         << ",\"name\":";
+      WriteJsonString(os, rec.name);
+      if (rec.value) {
+        os << ",\"type\":\"" << TypeName(rec.value->type()) << "\",\"value\":";
+        WriteJsonValue(os, *rec.value);
+      } else {
+        os << ",\"type\":\"delete\"";
+      }
+      os << '}';
+    } else {
+      os << wpi::format("%.6f", time) << ',';
+      WriteCsvField(os, rec.name);
+      if (!rec.value) {
+        os << ",delete,\n";
+        continue;
+      }
+      os << ',' << TypeName(rec.value->type()) << ',';
+      switch (rec.value->type()) {
+        case NT_BOOLEAN:
+          os << (rec.value->GetBoolean() ? "true" : "false");
+          break;
+        case NT_DOUBLE:
+          os << wpi::format("%.15g", rec.value->GetDouble());
+          break;
+        case NT_STRING:
+          WriteCsvField(os, rec.value->GetString());
+          break;
+        case NT_RAW:
+          wpi::Base64Encode(os, rec.value->GetRaw());
+          break;
+        case NT_RPC:
+          wpi::Base64Encode(os, rec.value->GetRpc());
+          break;
+        default: {
+          // arrays use their JSON representation
+          buf.clear();
+          wpi::raw_string_ostream json(buf);
+          WriteJsonValue(json, *rec.value);
+          WriteCsvField(os, json.str());
+          break;
+        }
+      }
+      os << '\n';
+    }
+    first = false;
+  }
+  if (format == NT_DATALOG_JSON) os << "\n]\n";
+}
@@ -0,0 +1,96 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_DATALOGREADER_H_
+#define NTCORE_DATALOGREADER_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <wpi/FileSystem.h>
+#include <wpi/StringRef.h>
+#include <wpi/Twine.h>
+#include <wpi/raw_ostream.h>
+
+#include "DataLogFormat.h"
+#include "ntcore_cpp.h"
+
+namespace nt {
+
+// Reads the records of a data log written by DataLogger.
+class DataLogReader {
+ public:
+  typedef std::function<void(size_t record, const char* msg)> WarnFunc;
+
+  // A value or delete record; start records are handled internally.
+  struct Record {
+    datalog::RecordType type;
+    unsigned int id;
+    // Entry name; refers to the log data
+    StringRef name;
+    uint64_t time;
+    // Null for delete records
+    std::shared_ptr<Value> value;
+  };
+
+  // Maps a recorded time to the creation time to use for a value (0 for the
+  // current time).
+  typedef std::function<uint64_t(uint64_t time)> ValueTimeFunc;
+
+  explicit DataLogReader(WarnFunc warn = nullptr) : m_warn(warn) {}
+
+  DataLogReader(const DataLogReader&) = delete;
+  DataLogReader& operator=(const DataLogReader&) = delete;
+
+  // Maps a log file for reading.  Returns an error string, or nullptr if
+  // successful.
+  const char* Open(const Twine& filename);
+
+  // Reads a log from memory; data must outlive the reader.  Returns an error
+  // string, or nullptr if successful.
+  const char* SetData(StringRef data);
+
+  uint64_t start_time() const { return m_start_time; }
+
+  // By default values are created with their recorded time.
+  void SetValueTime(ValueTimeFunc func) { m_value_time = func; }
+
+  // Reads the next record.  Returns false at the end of the log; a log that
+  // ends in a partial or corrupt record is read up to that record (with a
+  // warning).
+  bool Next(Record* rec);
+
+  // Converts the remainder of the log to text.
+  void Convert(wpi::raw_ostream& os, NT_DataLogFormat format);
+
+ private:
+  bool Invalid();
+  bool ReadUleb128(uint64_t* val);
+  bool ReadString(StringRef* str);
+  std::shared_ptr<Value> ReadValue(NT_Type type, uint64_t time);
+
+  void Warn(const char* msg) {
+    if (m_warn) m_warn(m_record_num, msg);
+  }
+
+  WarnFunc m_warn;
+  ValueTimeFunc m_value_time;
+  std::unique_ptr<wpi::sys::fs::mapped_file_region> m_region;
+  StringRef m_data;
+  uint64_t m_start_time = 0;
+  uint64_t m_time = 0;
+  size_t m_record_num = 0;
+  // Entry names (referring to the log data), by id
+  std::vector<StringRef> m_names;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_DATALOGREADER_H_
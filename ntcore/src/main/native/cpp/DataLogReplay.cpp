@@ -0,0 +1,153 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include "DataLogReplay.h"
+
+#include <chrono>
+#include <vector>
+
+#include <wpi/condition_variable.h>
+#include <wpi/timestamp.h>
+
+#include "DataLogReader.h"
+#include "Storage.h"
+
+using namespace nt;
+
+class DataLogReplay::Thread : public wpi::SafeThread {
+ public:
+  Thread(std::unique_ptr<DataLogReader> reader, double speed, Storage& storage,
+         wpi::Logger& logger)
+      : m_reader(std::move(reader)),
+        m_speed(speed),
+        m_storage(storage),
+        m_logger(logger) {}
+
+  void Main() override;
+
+  // Set (with m_mutex held) when the replay has finished
+  bool m_done = false;
+  wpi::condition_variable m_done_cond;
+
+ private:
+  std::unique_ptr<DataLogReader> m_reader;
+  double m_speed;
+  Storage& m_storage;
+  wpi::Logger& m_logger;
+};
+
+void DataLogReplay::Thread::Main() {
+  // Each change is scheduled relative to the start of the log.  Values are
+  // stamped with the time they are scheduled to be set, so listeners see the
+  // same spacing between timestamps as the recording (scaled by the speed).
+  auto start = std::chrono::steady_clock::now();
+  uint64_t start_now = wpi::Now();
+  uint64_t log_start = m_reader->start_time();
+  auto offset = [&](uint64_t time) {
+    return time < log_start ? 0.0 : (time - log_start) / m_speed;
+  };
+  if (m_speed > 0) {
+    m_reader->SetValueTime([&](uint64_t time) {
+      return start_now + static_cast<uint64_t>(offset(time));
+    });
+  } else {
+    m_reader->SetValueTime([](uint64_t) { return 0; });
+  }
+
+  // local id + 1 by log entry id (0 if not yet looked up)
+  std::vector<unsigned int> local_ids;
+  DataLogReader::Record rec;
+  while (m_active && m_reader->Next(&rec)) {
+    if (m_speed > 0) {
+      auto when = start + std::chrono::duration_cast<
+                              std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double, std::micro>(
+                                  offset(rec.time)));
+      std::unique_lock<wpi::mutex> lock(m_mutex);
+      m_cond.wait_until(lock, when, [&] { return !m_active; });
+      if (!m_active) break;
+    }
+
+    if (rec.id >= local_ids.size()) local_ids.resize(rec.id + 1);
+    if (local_ids[rec.id] == 0)
+      local_ids[rec.id] = m_storage.GetEntry(rec.name) + 1;
+    unsigned int local_id = local_ids[rec.id] - 1;
+    if (rec.value)
+      m_storage.SetEntryTypeValue(local_id, rec.value);
+    else
+      m_storage.DeleteEntry(local_id);
+  }
+
+  DEBUG("data log replay finished");
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  m_done = true;
+  m_done_cond.notify_all();
+}
+
+DataLogReplay::DataLogReplay(Storage& storage, wpi::Logger& logger)
+    : m_storage(storage), m_logger(logger) {}
+
+DataLogReplay::~DataLogReplay() { StopAll(); }
+
+const char* DataLogReplay::Start(const Twine& filename, double speed,
+                                 unsigned int* uid) {
+  auto& logger = m_logger;
+  std::unique_ptr<DataLogReader> reader(
+      new DataLogReader([&logger](size_t record, const char* msg) {
+        WPI_WARNING(logger, "data log replay: record " << record << ": "
+                                                       << msg);
+      }));
+  if (const char* err = reader->Open(filename)) return err;
+
+  DEBUG("replaying data log '" << filename << "'");
+  auto owner = std::make_shared<Owner>();
+  owner->Start(std::move(reader), speed, m_storage, m_logger);
+
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  *uid = m_replays.emplace_back(std::move(owner));
+  return nullptr;
+}
+
+void DataLogReplay::Stop(unsigned int uid) {
+  std::shared_ptr<Owner> owner;
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    if (uid >= m_replays.size() || !m_replays[uid]) return;
+    owner = m_replays[uid];
+    m_replays.erase(uid);
+  }
+  owner->Join();
+}
+
+bool DataLogReplay::Wait(unsigned int uid, double timeout) {
+  std::shared_ptr<Owner> owner;
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    if (uid >= m_replays.size() || !m_replays[uid]) return true;
+    owner = m_replays[uid];
+  }
+  auto thr = owner->GetThread();
+  if (!thr) return true;
+  auto& lock = thr.GetLock();
+  auto done = [&] { return thr->m_done; };
+  if (timeout < 0) {
+    thr->m_done_cond.wait(lock, done);
+    return true;
+  }
+  return thr->m_done_cond.wait_for(lock, std::chrono::duration<double>(timeout),
+                                   done);
+}
+
+void DataLogReplay::StopAll() {
+  std::vector<std::shared_ptr<Owner>> owners;
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    for (auto& owner : m_replays) owners.emplace_back(std::move(owner));
+    m_replays.clear();
+  }
+  for (auto& owner : owners) owner->Join();
+}
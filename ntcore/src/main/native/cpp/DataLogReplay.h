@@ -0,0 +1,64 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_DATALOGREPLAY_H_
+#define NTCORE_DATALOGREPLAY_H_
+
+#include <memory>
+
+#include <wpi/SafeThread.h>
+#include <wpi/Twine.h>
+#include <wpi/UidVector.h>
+#include <wpi/mutex.h>
+
+#include "Log.h"
+
+namespace nt {
+
+class Storage;
+
+// Replays data logs written by DataLogger into storage, each on its own
+// thread.  Changes are applied as local changes, so they drive entry
+// listeners (and are sent to any connected clients) just as the recorded
+// changes did.
+class DataLogReplay {
+ public:
+  DataLogReplay(Storage& storage, wpi::Logger& logger);
+  ~DataLogReplay();
+
+  DataLogReplay(const DataLogReplay&) = delete;
+  DataLogReplay& operator=(const DataLogReplay&) = delete;
+
+  // Starts replaying filename at speed times the recorded rate (or as fast
+  // as possible if speed <= 0).  Returns an error string, or nullptr (and
+  // sets *uid) if successful.
+  const char* Start(const wpi::Twine& filename, double speed,
+                    unsigned int* uid);
+
+  // Stops (if still running) and releases a replay.
+  void Stop(unsigned int uid);
+
+  // Waits for a replay to finish.  Returns false on timeout; a negative
+  // timeout waits forever.
+  bool Wait(unsigned int uid, double timeout);
+
+  void StopAll();
+
+ private:
+  class Thread;
+  typedef wpi::SafeThreadOwner<Thread> Owner;
+
+  Storage& m_storage;
+  wpi::Logger& m_logger;
+
+  wpi::mutex m_mutex;
+  wpi::UidVector<std::shared_ptr<Owner>, 4> m_replays;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_DATALOGREPLAY_H_
@@ -0,0 +1,263 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include "DataLogger.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <wpi/FileSystem.h>
+#include <wpi/SafeThread.h>
+#include <wpi/SmallString.h>
+#include <wpi/raw_ostream.h>
+#include <wpi/timestamp.h>
+
+#include "DataLogFormat.h"
+#include "EntryNotifier.h"
+#include "Handle.h"
+#include "Storage.h"
+
+using namespace nt;
+
+// The writer wakes up this often, or sooner once this much data is buffered.
+static constexpr auto kFlushPeriod = std::chrono::milliseconds(250);
+static constexpr size_t kFlushSize = 64 * 1024;
+// Changes are dropped (rather than using unbounded memory) if this much data
+// is waiting on a stalled disk.
+static constexpr size_t kMaxBufferSize = 16 * 1024 * 1024;
+
+static void Write64(std::string& buf, uint64_t val) {
+  for (int i = 0; i < 8; ++i) buf.push_back(static_cast<char>(val >> (8 * i)));
+}
+
+static void WriteUleb128(std::string& buf, uint64_t val) {
+  do {
+    unsigned char byte = val & 0x7f;
+    val >>= 7;
+    if (val != 0) byte |= 0x80;
+    buf.push_back(static_cast<char>(byte));
+  } while (val != 0);
+}
+
+static void WriteDouble(std::string& buf, double val) {
+  uint64_t v;
+  std::memcpy(&v, &val, sizeof(v));
+  Write64(buf, v);
+}
+
+static void WriteString(std::string& buf, StringRef str) {
+  WriteUleb128(buf, str.size());
+  buf.append(str.data(), str.size());
+}
+
+class DataLogger::Thread : public wpi::SafeThread {
+ public:
+  Thread(std::unique_ptr<wpi::raw_fd_ostream> os, uint64_t start_time,
+         wpi::Logger& logger)
+      : m_os(std::move(os)), m_time(start_time), m_logger(logger) {}
+
+  void Main() override;
+
+  // Encodes a change into the buffer.  Must be called with m_mutex held.
+  void Append(const EntryNotification& event);
+
+ private:
+  void WriteTime(uint64_t time);
+  void WriteValue(const Value& value);
+  void WriteFile(const std::string& buf);
+
+  std::unique_ptr<wpi::raw_fd_ostream> m_os;
+  // Time of the last timestamped record
+  uint64_t m_time;
+  wpi::Logger& m_logger;
+
+  // Buffer being filled by Append(); the writer swaps it for an empty one
+  std::string m_buf;
+  // Entry ids that have had a start record written, by local id
+  std::vector<bool> m_started;
+  bool m_overflow = false;
+};
+
+struct DataLogger::Log {
+  wpi::SafeThreadOwner<Thread> owner;
+  unsigned int listener = 0;
+};
+
+void DataLogger::Thread::Main() {
+  std::string buf;
+  std::unique_lock<wpi::mutex> lock(m_mutex);
+  while (m_active) {
+    m_cond.wait_for(lock, kFlushPeriod,
+                    [&] { return !m_active || m_buf.size() >= kFlushSize; });
+    if (m_buf.empty()) continue;
+    buf.swap(m_buf);
+    lock.unlock();
+    WriteFile(buf);
+    buf.clear();
+    lock.lock();
+  }
+
+  // Stopped; no more changes will be appended
+  lock.unlock();
+  WriteFile(m_buf);
+  m_os->close();
+  if (m_os->has_error()) {
+    WARNING("error closing data log");
+    m_os->clear_error();
+  }
+}
+
+void DataLogger::Thread::Append(const EntryNotification& event) {
+  if (m_buf.size() >= kMaxBufferSize) {
+    if (!m_overflow) WARNING("data log writer fell behind; dropping changes");
+    m_overflow = true;
+    return;
+  }
+  m_overflow = false;
+
+  unsigned int id = Handle{event.entry}.GetIndex();
+  if (id >= m_started.size()) m_started.resize(id + 1);
+  if (!m_started[id]) {
+    m_buf.push_back(datalog::kStart);
+    WriteUleb128(m_buf, id);
+    WriteString(m_buf, event.name);
+    m_started[id] = true;
+  }
+
+  if ((event.flags & NT_NOTIFY_DELETE) != 0) {
+    m_buf.push_back(datalog::kDelete);
+    WriteUleb128(m_buf, id);
+    WriteTime(wpi::Now());
+  } else if (event.value) {
+    m_buf.push_back(datalog::kValue);
+    WriteUleb128(m_buf, id);
+    WriteTime(event.value->time());
+    WriteValue(*event.value);
+  }
+
+  if (m_buf.size() >= kFlushSize) m_cond.notify_one();
+}
+
+void DataLogger::Thread::WriteTime(uint64_t time) {
+  // values set on other threads may be notified slightly out of order
+  if (time < m_time) time = m_time;
+  WriteUleb128(m_buf, time - m_time);
+  m_time = time;
+}
+
+void DataLogger::Thread::WriteValue(const Value& value) {
+  m_buf.push_back(static_cast<char>(value.type()));
+  switch (value.type()) {
+    case NT_BOOLEAN:
+      m_buf.push_back(value.GetBoolean() ? 1 : 0);
+      break;
+    case NT_DOUBLE:
+      WriteDouble(m_buf, value.GetDouble());
+      break;
+    case NT_STRING:
+      WriteString(m_buf, value.GetString());
+      break;
+    case NT_RAW:
+      WriteString(m_buf, value.GetRaw());
+      break;
+    case NT_RPC:
+      WriteString(m_buf, value.GetRpc());
+      break;
+    case NT_BOOLEAN_ARRAY:
+      WriteUleb128(m_buf, value.GetBooleanArray().size());
+      for (auto elem : value.GetBooleanArray()) m_buf.push_back(elem ? 1 : 0);
+      break;
+    case NT_DOUBLE_ARRAY:
+      WriteUleb128(m_buf, value.GetDoubleArray().size());
+      for (auto elem : value.GetDoubleArray()) WriteDouble(m_buf, elem);
+      break;
+    case NT_STRING_ARRAY:
+      WriteUleb128(m_buf, value.GetStringArray().size());
+      for (auto& elem : value.GetStringArray()) WriteString(m_buf, elem);
+      break;
+    default:
+      break;
+  }
+}
+
+void DataLogger::Thread::WriteFile(const std::string& buf) {
+  if (buf.empty() || m_os->has_error()) return;
+  m_os->write(buf.data(), buf.size());
+  if (m_os->has_error()) WARNING("error writing data log; logging stopped");
+}
+
+DataLogger::DataLogger(Storage& storage, EntryNotifier& notifier,
+                       wpi::Logger& logger)
+    : m_storage(storage), m_notifier(notifier), m_logger(logger) {}
+
+DataLogger::~DataLogger() { StopAll(); }
+
+const char* DataLogger::Start(const Twine& filename, const Twine& prefix,
+                              unsigned int* uid) {
+  wpi::SmallString<128> fn;
+  filename.toVector(fn);
+  std::error_code ec;
+  std::unique_ptr<wpi::raw_fd_ostream> os(
+      new wpi::raw_fd_ostream(fn, ec, wpi::sys::fs::F_None));
+  if (ec.value() != 0) return "could not open file";
+  // the writer thread only writes large blocks
+  os->SetUnbuffered();
+
+  uint64_t start_time = wpi::Now();
+  std::string header(datalog::kMagic, sizeof(datalog::kMagic));
+  for (int i = 0; i < 4; ++i)
+    header.push_back(static_cast<char>(datalog::kVersion >> (8 * i)));
+  Write64(header, start_time);
+  *os << header;
+  if (os->has_error()) {
+    os->clear_error();
+    return "error writing file";
+  }
+
+  DEBUG("starting data log '" << filename << "'");
+  auto log = std::make_shared<Log>();
+  log->owner.Start(std::move(os), start_time, m_logger);
+  // the immediate notifications record the initial values
+  log->listener = m_storage.AddListener(
+      prefix,
+      [log](const EntryNotification& event) {
+        if (auto thr = log->owner.GetThread()) thr->Append(event);
+      },
+      NT_NOTIFY_IMMEDIATE | NT_NOTIFY_LOCAL | NT_NOTIFY_NEW |
+          NT_NOTIFY_DELETE | NT_NOTIFY_UPDATE);
+
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  *uid = m_logs.emplace_back(std::move(log));
+  return nullptr;
+}
+
+void DataLogger::Stop(unsigned int uid) {
+  std::shared_ptr<Log> log;
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    if (uid >= m_logs.size() || !m_logs[uid]) return;
+    log = m_logs[uid];
+    m_logs.erase(uid);
+  }
+  m_notifier.Remove(log->listener);
+  log->owner.Join();
+}
+
+void DataLogger::StopAll() {
+  std::vector<std::shared_ptr<Log>> logs;
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    for (auto& log : m_logs) logs.emplace_back(std::move(log));
+    m_logs.clear();
+  }
+  for (auto& log : logs) {
+    m_notifier.Remove(log->listener);
+    log->owner.Join();
+  }
+}
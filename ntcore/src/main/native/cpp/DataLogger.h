@@ -0,0 +1,62 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_DATALOGGER_H_
+#define NTCORE_DATALOGGER_H_
+
+#include <memory>
+
+#include <wpi/Twine.h>
+#include <wpi/UidVector.h>
+#include <wpi/mutex.h>
+
+#include "Log.h"
+
+namespace nt {
+
+class EntryNotifier;
+class Storage;
+
+// Streams entry changes to append-only binary log files (see
+// DataLogFormat.h).  Each log has an entry listener that encodes changes
+// into an in-memory buffer and a writer thread that periodically swaps the
+// buffer for an empty one and writes the full one to the file, so the
+// notifier thread never waits on the disk.
+class DataLogger {
+ public:
+  DataLogger(Storage& storage, EntryNotifier& notifier, wpi::Logger& logger);
+  ~DataLogger();
+
+  DataLogger(const DataLogger&) = delete;
+  DataLogger& operator=(const DataLogger&) = delete;
+
+  // Starts logging entries starting with prefix to filename, replacing any
+  // existing file.  Returns an error string, or nullptr (and sets *uid) if
+  // successful.
+  const char* Start(const wpi::Twine& filename, const wpi::Twine& prefix,
+                    unsigned int* uid);
+
+  // Stops logging and writes any buffered data before returning.
+  void Stop(unsigned int uid);
+
+  void StopAll();
+
+ private:
+  class Thread;
+  struct Log;
+
+  Storage& m_storage;
+  EntryNotifier& m_notifier;
+  wpi::Logger& m_logger;
+
+  wpi::mutex m_mutex;
+  wpi::UidVector<std::shared_ptr<Log>, 4> m_logs;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_DATALOGGER_H_
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <iterator>
 
+#include <wpi/EventLoopRunner.h>
 #include <wpi/TCPAcceptor.h>
 #include <wpi/TCPConnector.h>
 
@@ -145,6 +146,8 @@ void DispatcherBase::StartServer(
 
   m_storage.SetDispatcher(this, true);
 
+  if (m_use_event_loop)
+    m_loop_runner = std::make_shared<wpi::EventLoopRunner>();
   m_dispatch_thread = std::thread(&Dispatcher::DispatchThreadMain, this);
   m_clientserver_thread = std::thread(&Dispatcher::ServerThreadMain, this);
 }
@@ -158,6 +161,8 @@ void DispatcherBase::StartClient() {
   m_networkMode = NT_NET_MODE_CLIENT | NT_NET_MODE_STARTING;
   m_storage.SetDispatcher(this, false);
 
+  if (m_use_event_loop)
+    m_loop_runner = std::make_shared<wpi::EventLoopRunner>();
   m_dispatch_thread = std::thread(&Dispatcher::DispatchThreadMain, this);
   m_clientserver_thread = std::thread(&Dispatcher::ClientThreadMain, this);
 }
@@ -190,6 +195,15 @@ void DispatcherBase::Stop() {
 
   // close all connections
   conns.resize(0);
+
+  // Connections still referenced elsewhere keep the loop running until they
+  // are destroyed.  Wait for any loop callback that holds a connection
+  // reference to finish, so the last reference to the loop is never
+  // released on the loop thread itself.
+  if (m_loop_runner) {
+    m_loop_runner->ExecSync([](wpi::uv::Loop&) {});
+    m_loop_runner.reset();
+  }
 }
 
 void DispatcherBase::SetUpdateRate(double interval) {
@@ -201,6 +215,32 @@ void DispatcherBase::SetUpdateRate(double interval) {
   m_update_rate = static_cast<unsigned int>(interval * 1000);
 }
 
+void DispatcherBase::SetEventLoop(bool enabled) {
+  std::lock_guard<wpi::mutex> lock(m_user_mutex);
+  if (m_active) return;  // only takes effect on the next start
+  m_use_event_loop = enabled;
+}
+
+void DispatcherBase::SetFlushMode(NT_NetworkFlushMode mode, double window) {
+  // don't allow batching windows longer than 1 second
+  if (window < 0)
+    window = 0;
+  else if (window > 1.0)
+    window = 1.0;
+  m_flush_window = static_cast<unsigned int>(window * 1000000);
+  m_flush_on_idle = mode == NT_NET_FLUSH_IDLE;
+}
+
+void DispatcherBase::SetSocketFlags(unsigned int flags) {
+  m_socket_flags = flags;
+}
+
+void DispatcherBase::SetSubscriptions(wpi::ArrayRef<StringRef> prefixes) {
+  std::lock_guard<wpi::mutex> lock(m_user_mutex);
+  m_subscriptions.clear();
+  for (auto& prefix : prefixes) m_subscriptions.emplace_back(prefix);
+}
+
 void DispatcherBase::SetIdentity(const Twine& name) {
   std::lock_guard<wpi::mutex> lock(m_user_mutex);
   m_identity = name.str();
@@ -208,11 +248,23 @@ void DispatcherBase::SetIdentity(const Twine& name) {
 
 void DispatcherBase::Flush() {
   auto now = std::chrono::steady_clock::now();
-  {
+  // idle mode already sends as soon as possible, so there's no batching for
+  // frequent flushes to defeat
+  if (!m_flush_on_idle) {
     std::lock_guard<wpi::mutex> lock(m_flush_mutex);
     // don't allow flushes more often than every 10 ms
     if ((now - m_last_flush) < std::chrono::milliseconds(10)) return;
     m_last_flush = now;
+  }
+  ScheduleFlush(now);
+}
+
+void DispatcherBase::ScheduleFlush(std::chrono::steady_clock::time_point when) {
+  {
+    std::lock_guard<wpi::mutex> lock(m_flush_mutex);
+    // an earlier flush is already scheduled
+    if (m_do_flush && m_flush_time <= when) return;
+    m_flush_time = when;
     m_do_flush = true;
   }
   m_flush_cv.notify_one();
@@ -231,6 +283,19 @@ std::vector<ConnectionInfo> DispatcherBase::GetConnections() const {
   return conns;
 }
 
+std::vector<ConnectionStats> DispatcherBase::GetConnectionStats() const {
+  std::vector<ConnectionStats> stats;
+  if (!m_active) return stats;
+
+  std::lock_guard<wpi::mutex> lock(m_user_mutex);
+  for (auto& conn : m_connections) {
+    if (conn->state() != NetworkConnection::kActive) continue;
+    stats.emplace_back(conn->stats());
+  }
+
+  return stats;
+}
+
 bool DispatcherBase::IsConnected() const {
   if (!m_active) return false;
 
@@ -287,7 +352,9 @@ void DispatcherBase::ClearConnectorOverride() {
 }
 
 void DispatcherBase::DispatchThreadMain() {
-  auto timeout_time = std::chrono::steady_clock::now();
+  auto timeout_time =
+      std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(static_cast<unsigned int>(m_update_rate));
 
   static const auto save_delta_time = std::chrono::seconds(1);
   auto next_save_time = timeout_time + save_delta_time;
@@ -295,19 +362,29 @@ void DispatcherBase::DispatchThreadMain() {
   int count = 0;
 
   while (m_active) {
-    // handle loop taking too long
-    auto start = std::chrono::steady_clock::now();
-    if (start > timeout_time) timeout_time = start;
-
-    // wait for periodic or when flushed
-    timeout_time += std::chrono::milliseconds(m_update_rate);
+    // wait for periodic or when a flush is due
     std::unique_lock<wpi::mutex> flush_lock(m_flush_mutex);
-    m_flush_cv.wait_until(flush_lock, timeout_time,
-                          [&] { return !m_active || m_do_flush; });
-    m_do_flush = false;
+    for (;;) {
+      if (!m_active) break;
+      auto now = std::chrono::steady_clock::now();
+      if (now >= timeout_time || (m_do_flush && now >= m_flush_time)) break;
+      m_flush_cv.wait_until(flush_lock,
+                            m_do_flush ? std::min(timeout_time, m_flush_time)
+                                       : timeout_time);
+    }
+    // a flush scheduled for later than this periodic update stays pending
+    if (m_do_flush && std::chrono::steady_clock::now() >= m_flush_time)
+      m_do_flush = false;
     flush_lock.unlock();
     if (!m_active) break;  // in case we were woken up to terminate
 
+    // flushes don't move the next periodic update; this also handles the
+    // loop taking too long
+    auto start = std::chrono::steady_clock::now();
+    if (start >= timeout_time)
+      timeout_time = start + std::chrono::milliseconds(
+                                 static_cast<unsigned int>(m_update_rate));
+
     // perform periodic persistent save
     if ((m_networkMode & NT_NET_MODE_SERVER) != 0 &&
         !m_persist_filename.empty() && start > next_save_time) {
@@ -350,16 +427,34 @@ void DispatcherBase::DispatchThreadMain() {
 void DispatcherBase::QueueOutgoing(std::shared_ptr<Message> msg,
                                    INetworkConnection* only,
                                    INetworkConnection* except) {
-  std::lock_guard<wpi::mutex> user_lock(m_user_mutex);
-  for (auto& conn : m_connections) {
-    if (conn.get() == except) continue;
-    if (only && conn.get() != only) continue;
-    auto state = conn->state();
-    if (state != NetworkConnection::kSynchronized &&
-        state != NetworkConnection::kActive)
-      continue;
-    conn->QueueOutgoing(msg);
+  QueueOutgoing(wpi::ArrayRef<std::shared_ptr<Message>>(msg), only, except);
+}
+
+void DispatcherBase::QueueOutgoing(
+    wpi::ArrayRef<std::shared_ptr<Message>> msgs, INetworkConnection* only,
+    INetworkConnection* except) {
+  bool flush_on_idle = m_flush_on_idle;
+  unsigned int window = m_flush_window;
+  bool queued = false;
+  {
+    std::lock_guard<wpi::mutex> user_lock(m_user_mutex);
+    for (auto& conn : m_connections) {
+      if (conn.get() == except) continue;
+      if (only && conn.get() != only) continue;
+      auto state = conn->state();
+      if (state != NetworkConnection::kSynchronized &&
+          state != NetworkConnection::kActive)
+        continue;
+      conn->QueueOutgoing(msgs);
+      queued = true;
+      // with no batching window, hand off to the write thread right away
+      if (flush_on_idle && window == 0 && state == NetworkConnection::kActive)
+        conn->PostOutgoing(false);
+    }
   }
+  if (queued && flush_on_idle && window != 0)
+    ScheduleFlush(std::chrono::steady_clock::now() +
+                  std::chrono::microseconds(window));
 }
 
 void DispatcherBase::ServerThreadMain() {
@@ -391,20 +486,31 @@ void DispatcherBase::ServerThreadMain() {
     conn->set_process_incoming(
         std::bind(&IStorage::ProcessIncoming, &m_storage, _1, _2,
                   std::weak_ptr<NetworkConnection>(conn)));
+    if (m_loop_runner) conn->set_event_loop(m_loop_runner);
+    conn->set_schedule_flush(
+        [this](std::chrono::steady_clock::time_point when) {
+          ScheduleFlush(when);
+        });
+    conn->set_socket_flags(m_socket_flags);
+    std::shared_ptr<INetworkConnection> dead;
     {
       std::lock_guard<wpi::mutex> lock(m_user_mutex);
       // reuse dead connection slots
       bool placed = false;
       for (auto& c : m_connections) {
         if (c->state() == NetworkConnection::kDead) {
+          dead.swap(c);
           c = conn;
           placed = true;
           break;
         }
       }
       if (!placed) m_connections.emplace_back(conn);
-      conn->Start();
     }
+    // Start, and destroy the replaced connection, without holding the user
+    // mutex; in event loop mode both wait on the loop, which may itself be
+    // waiting on the user mutex to queue outgoing messages.
+    conn->Start();
   }
   m_networkMode = NT_NET_MODE_NONE;
 }
@@ -448,16 +554,28 @@ void DispatcherBase::ClientThreadMain() {
     conn->set_process_incoming(
         std::bind(&IStorage::ProcessIncoming, &m_storage, _1, _2,
                   std::weak_ptr<NetworkConnection>(conn)));
-    m_connections.resize(0);  // disconnect any current
+    if (m_loop_runner) conn->set_event_loop(m_loop_runner);
+    conn->set_schedule_flush(
+        [this](std::chrono::steady_clock::time_point when) {
+          ScheduleFlush(when);
+        });
+    conn->set_socket_flags(m_socket_flags);
+    std::vector<std::shared_ptr<INetworkConnection>> old;
+    old.swap(m_connections);  // disconnect any current
     m_connections.emplace_back(conn);
     conn->set_proto_rev(m_reconnect_proto_rev);
-    conn->Start();
 
     // reconnect the next time starting with latest protocol revision
     m_reconnect_proto_rev = 0x0300;
+    m_do_reconnect = false;
+
+    // see ServerThreadMain() for why this is done without the lock held
+    lock.unlock();
+    old.clear();
+    conn->Start();
+    lock.lock();
 
     // block until told to reconnect
-    m_do_reconnect = false;
     m_reconnect_cv.wait(lock, [&] { return !m_active || m_do_reconnect; });
   }
   m_networkMode = NT_NET_MODE_NONE;
@@ -491,11 +609,15 @@ bool DispatcherBase::ClientHandshake(
   }
 
   bool new_server = true;
+  bool array_deltas = false;
+  bool subscribe = false;
   if (conn.proto_rev() >= 0x0300) {
     // should be server hello; if not, disconnect.
     if (!msg->Is(Message::kServerHello)) return false;
     conn.set_remote_id(msg->str());
     if ((msg->flags() & 1) != 0) new_server = false;
+    if ((msg->flags() & Message::kFeatureArrayDelta) != 0) array_deltas = true;
+    if ((msg->flags() & Message::kFeatureSubscribe) != 0) subscribe = true;
     // get the next message
     msg = get_msg();
   }
@@ -531,8 +653,24 @@ bool DispatcherBase::ClientHandshake(
   // generate outgoing assignments
   NetworkConnection::Outgoing outgoing;
 
+  // send subscriptions first so the server sees our own assignments as
+  // published by us; this must not be sent to servers that don't support it
+  if (subscribe) {
+    std::lock_guard<wpi::mutex> lock(m_user_mutex);
+    if (!m_subscriptions.empty())
+      outgoing.emplace_back(Message::ClientSubscribe(m_subscriptions));
+  }
+
   m_storage.ApplyInitialAssignments(conn, incoming, new_server, &outgoing);
 
+  // acknowledge protocol extensions supported by the server; this must not
+  // be sent to servers that don't support it
+  if (array_deltas) {
+    outgoing.emplace_back(
+        Message::ClientFeatures(Message::kFeatureArrayDelta));
+    conn.set_array_deltas(true);
+  }
+
   if (conn.proto_rev() >= 0x0300)
     outgoing.emplace_back(Message::ClientHelloDone());
 
@@ -577,7 +715,10 @@ bool DispatcherBase::ServerHandshake(
   // Start with server hello.  TODO: initial connection flag
   if (proto_rev >= 0x0300) {
     std::lock_guard<wpi::mutex> lock(m_user_mutex);
-    outgoing.emplace_back(Message::ServerHello(0u, m_identity));
+    outgoing.emplace_back(
+        Message::ServerHello(
+            Message::kFeatureArrayDelta | Message::kFeatureSubscribe,
+            m_identity));
   }
 
   // Get snapshot of initial assignments
@@ -610,6 +751,18 @@ bool DispatcherBase::ServerHandshake(
         msg = get_msg();
         continue;
       }
+      if (msg->Is(Message::kClientFeatures)) {
+        if ((msg->flags() & Message::kFeatureArrayDelta) != 0)
+          conn.set_array_deltas(true);
+        msg = get_msg();
+        continue;
+      }
+      if (msg->Is(Message::kClientSubscribe)) {
+        // the initial assignments have already been sent unfiltered
+        conn.set_subscriptions(msg->value()->GetStringArray(), outgoing);
+        msg = get_msg();
+        continue;
+      }
       if (!msg->Is(Message::kEntryAssign)) {
         // unexpected message
         DEBUG("server: received message ("
@@ -26,6 +26,7 @@
 #include "INetworkConnection.h"
 
 namespace wpi {
+class EventLoopRunner;
 class Logger;
 class NetworkAcceptor;
 class NetworkStream;
@@ -53,9 +54,14 @@ class DispatcherBase : public IDispatcher {
   void StartClient();
   void Stop();
   void SetUpdateRate(double interval);
+  void SetEventLoop(bool enabled);
+  void SetFlushMode(NT_NetworkFlushMode mode, double window);
+  void SetSocketFlags(unsigned int flags);
+  void SetSubscriptions(wpi::ArrayRef<StringRef> prefixes);
   void SetIdentity(const Twine& name);
   void Flush();
   std::vector<ConnectionInfo> GetConnections() const;
+  std::vector<ConnectionStats> GetConnectionStats() const;
   bool IsConnected() const;
 
   unsigned int AddListener(
@@ -89,8 +95,13 @@ class DispatcherBase : public IDispatcher {
 
   void ClientReconnect(unsigned int proto_rev = 0x0300);
 
+  void ScheduleFlush(std::chrono::steady_clock::time_point when);
+
   void QueueOutgoing(std::shared_ptr<Message> msg, INetworkConnection* only,
                      INetworkConnection* except) override;
+  void QueueOutgoing(wpi::ArrayRef<std::shared_ptr<Message>> msgs,
+                     INetworkConnection* only,
+                     INetworkConnection* except) override;
 
   IStorage& m_storage;
   IConnectionNotifier& m_notifier;
@@ -99,6 +110,11 @@ class DispatcherBase : public IDispatcher {
   std::thread m_dispatch_thread;
   std::thread m_clientserver_thread;
 
+  // If enabled, connections are driven by a single event loop thread rather
+  // than each having their own read and write threads.
+  bool m_use_event_loop = false;
+  std::shared_ptr<wpi::EventLoopRunner> m_loop_runner;
+
   std::unique_ptr<wpi::NetworkAcceptor> m_server_acceptor;
   Connector m_client_connector_override;
   Connector m_client_connector;
@@ -108,14 +124,24 @@ class DispatcherBase : public IDispatcher {
   mutable wpi::mutex m_user_mutex;
   std::vector<std::shared_ptr<INetworkConnection>> m_connections;
   std::string m_identity;
+  std::vector<std::string> m_subscriptions;  // empty means everything
 
   std::atomic_bool m_active;       // set to false to terminate threads
   std::atomic_uint m_update_rate;  // periodic dispatch update rate, in ms
 
+  // Idle flush mode: send as soon as messages are queued, after waiting up
+  // to the window (in us) for more
+  std::atomic_bool m_flush_on_idle{false};
+  std::atomic_uint m_flush_window{0};
+
+  // NT_NetworkSocketFlags for new connections
+  std::atomic_uint m_socket_flags{0};
+
   // Condition variable for forced dispatch wakeup (flush)
   wpi::mutex m_flush_mutex;
   wpi::condition_variable m_flush_cv;
   std::chrono::steady_clock::time_point m_last_flush;
+  std::chrono::steady_clock::time_point m_flush_time;
   bool m_do_flush = false;
 
   // Condition variable for client reconnect (uses user mutex)
@@ -7,6 +7,8 @@
 
 #include "EntryNotifier.h"
 
+#include <algorithm>
+
 #include "Log.h"
 
 using namespace nt;
@@ -47,6 +49,80 @@ bool impl::EntryNotifierThread::Matches(const EntryListenerData& listener,
   return true;
 }
 
+size_t impl::EntryNotifierThread::FindChild(size_t node, char ch) const {
+  for (auto& child : m_prefix_nodes[node].children) {
+    if (child.first == ch) return child.second;
+  }
+  return 0;
+}
+
+void impl::EntryNotifierThread::ListenerAdded(unsigned int listener_uid) {
+  auto& listener = m_listeners[listener_uid];
+  if (listener.entry != 0) {
+    m_entry_listeners[listener.entry].push_back(listener_uid);
+    return;
+  }
+
+  size_t node = 0;
+  for (char ch : listener.prefix) {
+    size_t child = FindChild(node, ch);
+    if (child == 0) {
+      child = m_prefix_nodes.size();
+      m_prefix_nodes.emplace_back();
+      m_prefix_nodes[node].children.emplace_back(ch, child);
+    }
+    node = child;
+  }
+  m_prefix_nodes[node].listeners.push_back(listener_uid);
+}
+
+void impl::EntryNotifierThread::ListenerRemoved(unsigned int listener_uid) {
+  if (listener_uid >= m_listeners.size()) return;
+  auto& listener = m_listeners[listener_uid];
+  if (!listener) return;
+
+  std::vector<unsigned int>* uids;
+  if (listener.entry != 0) {
+    auto it = m_entry_listeners.find(listener.entry);
+    if (it == m_entry_listeners.end()) return;
+    uids = &it->second;
+  } else {
+    size_t node = 0;
+    for (char ch : listener.prefix) {
+      node = FindChild(node, ch);
+      if (node == 0) return;
+    }
+    uids = &m_prefix_nodes[node].listeners;
+  }
+  uids->erase(std::remove(uids->begin(), uids->end(), listener_uid),
+              uids->end());
+}
+
+bool impl::EntryNotifierThread::GetCandidates(
+    const EntryNotification& data, std::vector<unsigned int>* listener_uids) {
+  listener_uids->clear();
+  if (!data.value) return true;
+
+  auto it = m_entry_listeners.find(data.entry);
+  if (it != m_entry_listeners.end())
+    listener_uids->insert(listener_uids->end(), it->second.begin(),
+                          it->second.end());
+
+  // every node along the name is a matching prefix
+  size_t node = 0;
+  for (size_t i = 0;; ++i) {
+    auto& uids = m_prefix_nodes[node].listeners;
+    listener_uids->insert(listener_uids->end(), uids.begin(), uids.end());
+    if (i == data.name.size()) break;
+    node = FindChild(node, data.name[i]);
+    if (node == 0) break;
+  }
+
+  // notify in uid order, as when checking every listener
+  std::sort(listener_uids->begin(), listener_uids->end());
+  return true;
+}
+
 unsigned int EntryNotifier::Add(
     std::function<void(const EntryNotification& event)> callback,
     StringRef prefix, unsigned int flags) {
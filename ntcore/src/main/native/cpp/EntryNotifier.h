@@ -11,6 +11,10 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include <wpi/DenseMap.h>
 
 #include "CallbackManager.h"
 #include "Handle.h"
@@ -67,7 +71,38 @@ class EntryNotifierThread
     callback(data);
   }
 
+  void ListenerAdded(unsigned int listener_uid);
+  void ListenerRemoved(unsigned int listener_uid);
+  bool GetCandidates(const EntryNotification& data,
+                     std::vector<unsigned int>* listener_uids);
+
+  // Replaces a queued notification for the same entry and listener with the
+  // same flags (so only the latest value is delivered).
+  bool Coalesce(EntryNotification* queued, const EntryNotification& data) {
+    if (queued->entry != data.entry || queued->listener != data.listener ||
+        queued->flags != data.flags)
+      return false;
+    queued->value = data.value;
+    return true;
+  }
+
   int m_inst;
+
+ private:
+  // Prefix listeners are kept in a trie with one node per prefix character,
+  // so finding the listeners for a name only visits the nodes along the
+  // name.  Nodes are not freed when listeners are removed.
+  struct PrefixNode {
+    std::vector<unsigned int> listeners;
+    std::vector<std::pair<char, size_t>> children;  // index in m_prefix_nodes
+  };
+
+  // Returns the index of the child node, or 0 (the root) if none
+  size_t FindChild(size_t node, char ch) const;
+
+  std::vector<PrefixNode> m_prefix_nodes{1};
+  // Entry listeners by entry handle
+  wpi::DenseMap<NT_Entry, std::vector<unsigned int>> m_entry_listeners;
 };
 
 }  // namespace impl
@@ -29,7 +29,9 @@ class Handle {
     kLogger,
     kLoggerPoller,
     kRpcCall,
-    kRpcCallPoller
+    kRpcCallPoller,
+    kDataLogger,
+    kDataLogReplay
   };
   enum { kIndexMax = 0xfffff };
 
@@ -10,6 +10,8 @@
 
 #include <memory>
 
+#include <wpi/ArrayRef.h>
+
 #include "Message.h"
 
 namespace nt {
@@ -27,6 +29,11 @@ class IDispatcher {
   virtual void QueueOutgoing(std::shared_ptr<Message> msg,
                              INetworkConnection* only,
                              INetworkConnection* except) = 0;
+  virtual void QueueOutgoing(wpi::ArrayRef<std::shared_ptr<Message>> msgs,
+                             INetworkConnection* only,
+                             INetworkConnection* except) {
+    for (auto& msg : msgs) QueueOutgoing(msg, only, except);
+  }
 };
 
 }  // namespace nt
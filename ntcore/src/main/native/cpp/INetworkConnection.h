@@ -10,6 +10,8 @@
 
 #include <memory>
 
+#include <wpi/ArrayRef.h>
+
 #include "Message.h"
 #include "ntcore_cpp.h"
 
@@ -25,10 +27,18 @@ class INetworkConnection {
   virtual ~INetworkConnection() = default;
 
   virtual ConnectionInfo info() const = 0;
+  virtual ConnectionStats stats() const = 0;
 
   virtual void QueueOutgoing(std::shared_ptr<Message> msg) = 0;
+  virtual void QueueOutgoing(wpi::ArrayRef<std::shared_ptr<Message>> msgs) {
+    for (auto& msg : msgs) QueueOutgoing(msg);
+  }
   virtual void PostOutgoing(bool keep_alive) = 0;
 
+  // Whether the assignment of an entry was not sent because the remote end
+  // did not subscribe to it.
+  virtual bool IsFiltered(unsigned int id) const { return false; }
+
   virtual unsigned int proto_rev() const = 0;
   virtual void set_proto_rev(unsigned int proto_rev) = 0;
 
@@ -24,7 +24,9 @@ InstanceImpl::InstanceImpl(int inst)
       rpc_server(inst, logger),
       storage(entry_notifier, rpc_server, logger),
       dispatcher(storage, connection_notifier, logger),
-      ds_client(dispatcher, logger) {
+      ds_client(dispatcher, logger),
+      data_logger(storage, entry_notifier, logger),
+      data_log_replay(storage, logger) {
   logger.set_min_level(logger_impl.GetMinLevel());
 }
 
@@ -15,6 +15,8 @@
 #include <wpi/mutex.h>
 
 #include "ConnectionNotifier.h"
+#include "DataLogReplay.h"
+#include "DataLogger.h"
 #include "Dispatcher.h"
 #include "DsClient.h"
 #include "EntryNotifier.h"
@@ -45,6 +47,8 @@ class InstanceImpl {
   Storage storage;
   Dispatcher dispatcher;
   DsClient ds_client;
+  DataLogger data_logger;
+  DataLogReplay data_log_replay;
 
  private:
   static int AllocImpl();
@@ -9,7 +9,15 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <wpi/SmallVector.h>
+
 #include "Log.h"
+#include "PoolAllocator.h"
 #include "WireDecoder.h"
 #include "WireEncoder.h"
 
@@ -17,12 +25,21 @@
 
 using namespace nt;
 
+constexpr unsigned int Message::kSendDefault;
+
+// Bitwise comparison so that e.g. -0.0 and 0.0 are treated as different
+static bool SameDouble(double a, double b) {
+  return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
 std::shared_ptr<Message> Message::Read(WireDecoder& decoder,
-                                       GetEntryTypeFunc get_entry_type) {
+                                       GetEntryTypeFunc get_entry_type,
+                                       GetDeltaBaseFunc get_delta_base) {
   unsigned int msg_type = 0;
   if (!decoder.Read8(&msg_type)) return nullptr;
-  auto msg =
-      std::make_shared<Message>(static_cast<MsgType>(msg_type), private_init());
+  auto msg = std::allocate_shared<Message>(PoolAllocator<Message>(),
+                                          static_cast<MsgType>(msg_type),
+                                          private_init());
   switch (msg_type) {
     case kKeepAlive:
       break;
@@ -57,6 +74,22 @@ std::shared_ptr<Message> Message::Read(WireDecoder& decoder,
         return nullptr;
       }
       break;
+    case kClientFeatures:
+      if (decoder.proto_rev() < 0x0300u) {
+        decoder.set_error("received CLIENT_FEATURES in protocol < 3.0");
+        return nullptr;
+      }
+      if (!decoder.Read8(&msg->m_flags)) return nullptr;
+      break;
+    case kClientSubscribe:
+      if (decoder.proto_rev() < 0x0300u) {
+        decoder.set_error("received CLIENT_SUBSCRIBE in protocol < 3.0");
+        return nullptr;
+      }
+      // prefixes
+      msg->m_value = decoder.ReadValue(NT_STRING_ARRAY);
+      if (!msg->m_value) return nullptr;
+      break;
     case kEntryAssign: {
       if (!decoder.ReadString(&msg->m_str)) return nullptr;  // name
       NT_Type type;
@@ -84,6 +117,42 @@ std::shared_ptr<Message> Message::Read(WireDecoder& decoder,
       if (!msg->m_value) return nullptr;
       break;
     }
+    case kEntryUpdateDelta: {
+      if (decoder.proto_rev() < 0x0300u || !get_delta_base) {
+        decoder.set_error("received unexpected ENTRY_UPDATE_DELTA");
+        return nullptr;
+      }
+      if (!decoder.Read16(&msg->m_id)) return nullptr;           // id
+      if (!decoder.Read16(&msg->m_seq_num_uid)) return nullptr;  // seq num
+      unsigned int size, num_runs;
+      if (!decoder.Read8(&size)) return nullptr;
+      if (!decoder.Read8(&num_runs)) return nullptr;
+      auto base = get_delta_base(msg->m_id);
+      if (!base || !base->IsDoubleArray()) {
+        decoder.set_error("received ENTRY_UPDATE_DELTA without base value");
+        return nullptr;
+      }
+      auto base_arr = base->GetDoubleArray();
+      std::vector<double> arr(size, 0.0);
+      std::copy_n(base_arr.begin(), std::min<size_t>(size, base_arr.size()),
+                  arr.begin());
+      for (unsigned int i = 0; i < num_runs; ++i) {
+        unsigned int start, len;
+        if (!decoder.Read8(&start)) return nullptr;
+        if (!decoder.Read8(&len)) return nullptr;
+        if (start + len > size) {
+          decoder.set_error("ENTRY_UPDATE_DELTA run out of range");
+          return nullptr;
+        }
+        for (unsigned int j = start; j < start + len; ++j) {
+          if (!decoder.ReadDouble(&arr[j])) return nullptr;
+        }
+      }
+      // present to the rest of the system as a normal update
+      msg->m_type = kEntryUpdate;
+      msg->m_value = Value::MakeDoubleArray(arr);
+      break;
+    }
     case kFlagsUpdate: {
       if (decoder.proto_rev() < 0x0300u) {
         decoder.set_error("received FLAGS_UPDATE in protocol < 3.0");
@@ -165,6 +234,19 @@ std::shared_ptr<Message> Message::ServerHello(unsigned int flags,
   return msg;
 }
 
+std::shared_ptr<Message> Message::ClientFeatures(unsigned int flags) {
+  auto msg = std::make_shared<Message>(kClientFeatures, private_init());
+  msg->m_flags = flags;
+  return msg;
+}
+
+std::shared_ptr<Message> Message::ClientSubscribe(
+    wpi::ArrayRef<std::string> prefixes) {
+  auto msg = std::make_shared<Message>(kClientSubscribe, private_init());
+  msg->m_value = Value::MakeStringArray(prefixes);
+  return msg;
+}
+
 std::shared_ptr<Message> Message::EntryAssign(wpi::StringRef name,
                                               unsigned int id,
                                               unsigned int seq_num,
@@ -182,7 +264,9 @@ std::shared_ptr<Message> Message::EntryAssign(wpi::StringRef name,
 std::shared_ptr<Message> Message::EntryUpdate(unsigned int id,
                                               unsigned int seq_num,
                                               std::shared_ptr<Value> value) {
-  auto msg = std::make_shared<Message>(kEntryUpdate, private_init());
+  // pooled, as this is generated for every value change
+  auto msg = std::allocate_shared<Message>(PoolAllocator<Message>(),
+                                          kEntryUpdate, private_init());
   msg->m_value = value;
   msg->m_id = id;
   msg->m_seq_num_uid = seq_num;
@@ -249,6 +333,16 @@ void Message::Write(WireEncoder& encoder) const {
       if (encoder.proto_rev() < 0x0300u) return;  // new message in version 3.0
       encoder.Write8(kClientHelloDone);
       break;
+    case kClientFeatures:
+      if (encoder.proto_rev() < 0x0300u) return;  // new message in version 3.0
+      encoder.Write8(kClientFeatures);
+      encoder.Write8(m_flags);
+      break;
+    case kClientSubscribe:
+      if (encoder.proto_rev() < 0x0300u) return;  // new message in version 3.0
+      encoder.Write8(kClientSubscribe);
+      encoder.WriteValue(*m_value);
+      break;
     case kEntryAssign:
       encoder.Write8(kEntryAssign);
       encoder.WriteString(m_str);
@@ -299,3 +393,84 @@ void Message::Write(WireEncoder& encoder) const {
       break;
   }
 }
+
+size_t Message::GetSize(const WireEncoder& encoder) const {
+  bool v3 = encoder.proto_rev() >= 0x0300u;
+  switch (m_type) {
+    case kKeepAlive:
+    case kServerHelloDone:
+      return 1;
+    case kClientHello:
+      return 3 + (v3 ? encoder.GetStringSize(m_str) : 0);
+    case kProtoUnsup:
+      return 3;
+    case kServerHello:
+      return v3 ? 2 + encoder.GetStringSize(m_str) : 0;
+    case kClientHelloDone:
+      return v3 ? 1 : 0;
+    case kClientFeatures:
+      return v3 ? 2 : 0;
+    case kClientSubscribe:
+      return v3 ? 1 + encoder.GetValueSize(*m_value) : 0;
+    case kEntryAssign:
+      return 6 + (v3 ? 1 : 0) + encoder.GetStringSize(m_str) +
+             encoder.GetValueSize(*m_value);
+    case kEntryUpdate:
+      return 5 + (v3 ? 1 : 0) + encoder.GetValueSize(*m_value);
+    case kFlagsUpdate:
+      return v3 ? 4 : 0;
+    case kEntryDelete:
+      return v3 ? 3 : 0;
+    case kClearEntries:
+      return v3 ? 5 : 0;
+    case kExecuteRpc:
+    case kRpcResponse:
+      return v3 ? 5 + encoder.GetStringSize(m_str) : 0;
+    default:
+      return 0;
+  }
+}
+
+bool Message::WriteDelta(WireEncoder& encoder, const Value& base) const {
+  if (m_type != kEntryUpdate || encoder.proto_rev() < 0x0300u) return false;
+  if (!m_value || !m_value->IsDoubleArray() || !base.IsDoubleArray())
+    return false;
+  auto arr = m_value->GetDoubleArray();
+  auto old = base.GetDoubleArray();
+  // sizes are only 1 byte, truncate (as WriteValue does)
+  size_t size = std::min<size_t>(arr.size(), 0xff);
+  size_t old_size = std::min<size_t>(old.size(), 0xff);
+
+  // find runs of changed elements
+  wpi::SmallVector<std::pair<size_t, size_t>, 16> runs;  // start, length
+  size_t changed = 0;
+  size_t i = 0;
+  while (i < size) {
+    if (i < old_size && SameDouble(arr[i], old[i])) {
+      ++i;
+      continue;
+    }
+    size_t start = i;
+    while (i < size && !(i < old_size && SameDouble(arr[i], old[i]))) ++i;
+    runs.emplace_back(start, i - start);
+    changed += i - start;
+  }
+
+  // only worth it if smaller than a full update; both have the same 5 byte
+  // header (type, id, seq num), a full update then has type, size and values
+  if (runs.size() > 0xff || 2 + runs.size() * 2 + changed * 8 >= 2 + size * 8)
+    return false;
+
+  encoder.Write8(kEntryUpdateDelta);
+  encoder.Write16(m_id);
+  encoder.Write16(m_seq_num_uid);
+  encoder.Write8(size);
+  encoder.Write8(runs.size());
+  for (auto& run : runs) {
+    encoder.Write8(run.first);
+    encoder.Write8(run.second);
+    for (size_t j = run.first; j < run.first + run.second; ++j)
+      encoder.WriteDouble(arr[j]);
+  }
+  return true;
+}
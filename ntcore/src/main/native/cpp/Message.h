@@ -8,6 +8,7 @@
 #ifndef NTCORE_MESSAGE_H_
 #define NTCORE_MESSAGE_H_
 
+#include <climits>
 #include <functional>
 #include <memory>
 #include <string>
@@ -31,15 +32,34 @@ class Message {
     kServerHelloDone = 0x03,
     kServerHello = 0x04,
     kClientHelloDone = 0x05,
+    kClientFeatures = 0x06,
+    kClientSubscribe = 0x07,
     kEntryAssign = 0x10,
     kEntryUpdate = 0x11,
     kFlagsUpdate = 0x12,
     kEntryDelete = 0x13,
     kClearEntries = 0x14,
+    kEntryUpdateDelta = 0x15,
     kExecuteRpc = 0x20,
     kRpcResponse = 0x21
   };
   typedef std::function<NT_Type(unsigned int id)> GetEntryTypeFunc;
+  typedef std::function<std::shared_ptr<Value>(unsigned int id)>
+      GetDeltaBaseFunc;
+
+  // Protocol extension flags.  These are advertised by the server in the
+  // SERVER_HELLO flags and acknowledged by the client with a CLIENT_FEATURES
+  // message; neither side uses an extension unless both support it.
+  enum Features {
+    // ENTRY_UPDATE_DELTA messages for double arrays
+    kFeatureArrayDelta = 0x02,
+    // CLIENT_SUBSCRIBE messages; the server only sends entries under the
+    // subscribed prefixes (and entries the client itself publishes)
+    kFeatureSubscribe = 0x04
+  };
+
+  // Send period value meaning "send with the next periodic update".
+  static constexpr unsigned int kSendDefault = UINT_MAX;
 
   Message() : m_type(kUnknown), m_id(0), m_flags(0), m_seq_num_uid(0) {}
   Message(MsgType type, const private_init&)
@@ -56,10 +76,30 @@ class Message {
   unsigned int flags() const { return m_flags; }
   unsigned int seq_num_uid() const { return m_seq_num_uid; }
 
-  // Read and write from wire representation
+  // Send period hint for entry assignments and updates, in milliseconds.
+  // This is not part of the wire protocol.  0 means send immediately;
+  // otherwise updates for the entry are sent at most once per period, and
+  // only the latest value is sent.
+  unsigned int send_period() const { return m_send_period; }
+  void set_send_period(unsigned int period) { m_send_period = period; }
+
+  // Read and write from wire representation.  ENTRY_UPDATE_DELTA messages
+  // are only accepted if get_delta_base is provided; it is called to get the
+  // value the delta applies to, and the delta is returned as an ENTRY_UPDATE
+  // with the full resulting value.
   void Write(WireEncoder& encoder) const;
-  static std::shared_ptr<Message> Read(WireDecoder& decoder,
-                                       GetEntryTypeFunc get_entry_type);
+  static std::shared_ptr<Message> Read(
+      WireDecoder& decoder, GetEntryTypeFunc get_entry_type,
+      GetDeltaBaseFunc get_delta_base = nullptr);
+
+  // Write an ENTRY_UPDATE as an ENTRY_UPDATE_DELTA relative to base (the
+  // value last sent for the same id).  Returns false without writing anything
+  // if this is not a double array update or the delta would not be smaller
+  // than the full update.
+  bool WriteDelta(WireEncoder& encoder, const Value& base) const;
+
+  // Get the number of bytes Write() would write (without writing it).
+  size_t GetSize(const WireEncoder& encoder) const;
 
   // Create messages without data
   static std::shared_ptr<Message> KeepAlive() {
@@ -82,6 +122,9 @@ class Message {
   static std::shared_ptr<Message> ClientHello(wpi::StringRef self_id);
   static std::shared_ptr<Message> ServerHello(unsigned int flags,
                                               wpi::StringRef self_id);
+  static std::shared_ptr<Message> ClientFeatures(unsigned int flags);
+  static std::shared_ptr<Message> ClientSubscribe(
+      wpi::ArrayRef<std::string> prefixes);
   static std::shared_ptr<Message> EntryAssign(wpi::StringRef name,
                                               unsigned int id,
                                               unsigned int seq_num,
@@ -110,6 +153,7 @@ class Message {
   unsigned int m_id;  // also used for proto_rev
   unsigned int m_flags;
   unsigned int m_seq_num_uid;
+  unsigned int m_send_period = kSendDefault;
 };
 
 }  // namespace nt
@@ -7,9 +7,18 @@
 
 #include "NetworkConnection.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include <wpi/EventLoopRunner.h>
 #include <wpi/NetworkStream.h>
+#include <wpi/SmallVector.h>
+#include <wpi/raw_istream.h>
 #include <wpi/raw_socket_istream.h>
 #include <wpi/timestamp.h>
+#include <wpi/uv/Async.h>
+#include <wpi/uv/Loop.h>
+#include <wpi/uv/Poll.h>
 
 #include "IConnectionNotifier.h"
 #include "Log.h"
@@ -18,6 +27,100 @@
 
 using namespace nt;
 
+namespace {
+
+// Input stream over the bytes received so far.  Reading past the end sets
+// the error flag, which the event loop treats as an incomplete message.
+class BufferIstream : public wpi::raw_istream {
+ public:
+  void Reset(const char* data, size_t len) {
+    m_cur = data;
+    m_left = len;
+    clear_error();
+  }
+  void close() override {}
+  size_t in_avail() const override { return m_left; }
+
+ private:
+  void read_impl(void* data, size_t len) override {
+    if (len > m_left) {
+      error_detected();
+      len = m_left;
+    }
+    std::memcpy(data, m_cur, len);
+    m_cur += len;
+    m_left -= len;
+    set_read_count(len);
+  }
+
+  const char* m_cur = nullptr;
+  size_t m_left = 0;
+};
+
+// Input stream that counts the bytes read from another stream.
+class CountingIstream : public wpi::raw_istream {
+ public:
+  CountingIstream(wpi::raw_istream& is, std::atomic<uint64_t>& count)
+      : m_is(is), m_count(count) {}
+  void close() override { m_is.close(); }
+  size_t in_avail() const override { return m_is.in_avail(); }
+
+ private:
+  void read_impl(void* data, size_t len) override {
+    m_is.read(data, len);
+    size_t count = m_is.read_count();
+    m_count.store(m_count.load(std::memory_order_relaxed) + count,
+                  std::memory_order_relaxed);
+    if (m_is.has_error()) error_detected();
+    set_read_count(count);
+  }
+
+  wpi::raw_istream& m_is;
+  std::atomic<uint64_t>& m_count;
+};
+
+}  // namespace
+
+struct NetworkConnection::LoopState {
+  LoopState(unsigned int proto_rev, wpi::Logger& logger)
+      : decoder(is, proto_rev, logger), encoder(proto_rev) {
+    encoder.set_zero_copy_threshold(kZeroCopyThreshold);
+  }
+
+  // Handles; only accessed from the loop, except for wakeup->Send().
+  std::shared_ptr<wpi::uv::Poll> poll;
+  std::shared_ptr<wpi::uv::Async<>> wakeup;
+  int poll_events = 0;
+  bool closed = false;
+
+  // Prevents wakeup from being signaled once it's been closed.
+  wpi::mutex wakeup_mutex;
+  bool closing = false;
+
+  // Messages received during the handshake are passed to the handshake
+  // thread.  Once the handshake is done, the loop takes over (active).
+  // Until then, a message is only decoded when the handshake thread asks for
+  // one (handshake_wants), so it's decoded with the protocol revision
+  // negotiated by the messages before it.
+  wpi::ConcurrentQueue<std::shared_ptr<Message>> handshake_incoming;
+  std::atomic_bool handshake_wants{false};
+  std::atomic_bool handshake_done{false};
+  bool active = false;
+
+  BufferIstream is;
+  WireDecoder decoder;
+  std::string rx_buf;
+
+  // Data being sent is left in the encoder (and, for zero-copy writes, in
+  // the messages, which tx_batches keeps alive); tx_bufs is what remains to
+  // be sent.  Nothing more is encoded until it has all been sent.
+  WireEncoder encoder;
+  std::vector<Outgoing> tx_batches;
+  wpi::SmallVector<wpi::StringRef, 16> tx_bufs;
+  size_t tx_index = 0;
+  bool corked = false;
+};
+
 NetworkConnection::NetworkConnection(unsigned int uid,
                                      std::unique_ptr<wpi::NetworkStream> stream,
                                      IConnectionNotifier& notifier,
@@ -41,6 +144,11 @@ NetworkConnection::NetworkConnection(unsigned int uid,
 
 NetworkConnection::~NetworkConnection() { Stop(); }
 
+void NetworkConnection::set_socket_flags(unsigned int flags) {
+  if ((flags & NT_NET_SOCKET_NAGLE) != 0) m_stream->setNagle(true);
+  m_cork = (flags & NT_NET_SOCKET_CORK) != 0;
+}
+
 void NetworkConnection::Start() {
   if (m_active) return;
   m_active = true;
@@ -53,6 +161,10 @@ void NetworkConnection::Start() {
     m_read_shutdown = false;
     m_write_shutdown = false;
   }
+  if (m_loop_runner) {
+    StartLoop();
+    return;
+  }
   // start threads
   m_write_thread = std::thread(&NetworkConnection::WriteThreadMain, this);
   m_read_thread = std::thread(&NetworkConnection::ReadThreadMain, this);
@@ -62,8 +174,12 @@ void NetworkConnection::Stop() {
   DEBUG2("NetworkConnection stopping (" << this << ")");
   set_state(kDead);
   m_active = false;
-  // closing the stream so the read thread terminates
-  if (m_stream) m_stream->close();
+  if (m_loop) {
+    StopLoop();
+  } else {
+    // closing the stream so the read thread terminates
+    if (m_stream) m_stream->close();
+  }
   // send an empty outgoing message set so the write thread terminates
   m_outgoing.push(Outgoing());
   // wait for threads to terminate, with timeout
@@ -97,6 +213,26 @@ ConnectionInfo NetworkConnection::info() const {
                         m_last_update, m_proto_rev};
 }
 
+ConnectionStats NetworkConnection::stats() const {
+  ConnectionStats stats;
+  stats.conn = info();
+  stats.bytes_sent = m_bytes_sent;
+  stats.bytes_received = m_bytes_received;
+  for (int i = 0; i < NT_MSG_TYPE_COUNT; ++i) {
+    stats.messages_sent[i] = m_msgs_sent[i];
+    stats.messages_received[i] = m_msgs_received[i];
+  }
+  {
+    std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+    stats.coalesced = m_coalesced;
+    stats.filtered = m_filtered;
+    stats.pending = m_pending_outgoing.size();
+  }
+  stats.queued = m_outgoing.size();
+  stats.rtt = m_stream->getRoundTripTime();
+  return stats;
+}
+
 unsigned int NetworkConnection::proto_rev() const { return m_proto_rev; }
 
 void NetworkConnection::set_proto_rev(unsigned int proto_rev) {
@@ -130,17 +266,165 @@ void NetworkConnection::set_remote_id(StringRef remote_id) {
   m_remote_id = remote_id;
 }
 
+void NetworkConnection::TrackArrayBase(ArrayBases& bases, const Message& msg) {
+  switch (msg.type()) {
+    case Message::kEntryAssign:
+    case Message::kEntryUpdate: {
+      unsigned int id = msg.id();
+      if (id == 0xffff) break;
+      auto value = msg.value();
+      if (value && value->IsDoubleArray()) {
+        if (id >= bases.size()) bases.resize(id + 1);
+        bases[id] = std::move(value);
+      } else if (id < bases.size()) {
+        bases[id].reset();
+      }
+      break;
+    }
+    case Message::kEntryDelete:
+      if (msg.id() < bases.size()) bases[msg.id()].reset();
+      break;
+    case Message::kClearEntries:
+      bases.clear();
+      break;
+    default:
+      break;
+  }
+}
+
+void NetworkConnection::set_subscriptions(
+    wpi::ArrayRef<std::string> prefixes,
+    wpi::ArrayRef<std::shared_ptr<Message>> initial) {
+  std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+  m_subscriptions.assign(prefixes.begin(), prefixes.end());
+  m_subscribed = true;
+  for (auto& msg : initial) {
+    if (msg && msg->Is(Message::kEntryAssign)) FilterOutgoing(*msg);
+  }
+  // don't count the initial assignments; they have already been sent
+  m_filtered = 0;
+}
+
+bool NetworkConnection::FilterOutgoing(const Message& msg) {
+  unsigned int id = msg.id();
+  switch (msg.type()) {
+    case Message::kEntryAssign: {
+      StringRef name = msg.str();
+      bool wanted = m_published.count(name) != 0;
+      for (auto& prefix : m_subscriptions) {
+        if (wanted) break;
+        wanted = name.startswith(prefix);
+      }
+      if (id != 0xffff) SetWanted(id, wanted ? kWantedSend : kWantedDrop);
+      if (wanted) return true;
+      break;
+    }
+    case Message::kEntryUpdate:
+    case Message::kFlagsUpdate:
+    case Message::kEntryDelete:
+      // send anything we haven't seen an assignment for
+      if (id >= m_wanted.size() || m_wanted[id] != kWantedDrop) return true;
+      break;
+    default:
+      return true;
+  }
+  ++m_filtered;
+  return false;
+}
+
+bool NetworkConnection::IsFiltered(unsigned int id) const {
+  std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+  return id < m_wanted.size() && m_wanted[id] == kWantedDrop;
+}
+
+void NetworkConnection::SetWanted(unsigned int id, Wanted wanted) {
+  if (id >= m_wanted.size()) m_wanted.resize(id + 1, kWantedUnknown);
+  m_wanted[id] = wanted;
+}
+
+void NetworkConnection::TrackPublished(const Message& msg) {
+  if (!m_subscribed) return;
+  switch (msg.type()) {
+    case Message::kEntryAssign: {
+      std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+      m_published[msg.str()] = true;
+      if (msg.id() != 0xffff) SetWanted(msg.id(), kWantedSend);
+      break;
+    }
+    case Message::kEntryUpdate:
+    case Message::kEntryUpdateDelta:
+    case Message::kFlagsUpdate: {
+      std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+      SetWanted(msg.id(), kWantedSend);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void NetworkConnection::CountMessage(std::atomic<uint64_t>* counters,
+                                     const Message& msg) {
+  int type;
+  switch (msg.type()) {
+    case Message::kKeepAlive:
+      type = NT_MSG_KEEP_ALIVE;
+      break;
+    case Message::kEntryAssign:
+      type = NT_MSG_ENTRY_ASSIGN;
+      break;
+    case Message::kEntryUpdate:
+    case Message::kEntryUpdateDelta:
+      type = NT_MSG_ENTRY_UPDATE;
+      break;
+    case Message::kFlagsUpdate:
+      type = NT_MSG_FLAGS_UPDATE;
+      break;
+    case Message::kEntryDelete:
+      type = NT_MSG_ENTRY_DELETE;
+      break;
+    case Message::kClearEntries:
+      type = NT_MSG_CLEAR_ENTRIES;
+      break;
+    case Message::kExecuteRpc:
+      type = NT_MSG_EXECUTE_RPC;
+      break;
+    case Message::kRpcResponse:
+      type = NT_MSG_RPC_RESPONSE;
+      break;
+    default:
+      type = NT_MSG_HANDSHAKE;
+      break;
+  }
+  Count(counters[type], 1);
+}
+
 void NetworkConnection::ReadThreadMain() {
-  wpi::raw_socket_istream is(*m_stream);
+  wpi::raw_socket_istream sis(*m_stream);
+  CountingIstream is(sis, m_bytes_received);
   WireDecoder decoder(is, m_proto_rev, m_logger);
+  // deltas are only accepted once the peer has negotiated them
+  Message::GetDeltaBaseFunc get_delta_base =
+      [&](unsigned int id) -> std::shared_ptr<Value> {
+    if (id >= m_rx_arrays.size()) return nullptr;
+    return m_rx_arrays[id];
+  };
+  Message::GetDeltaBaseFunc no_delta_base;
 
   set_state(kHandshake);
   if (!m_handshake(*this,
                    [&] {
                      decoder.set_proto_rev(m_proto_rev);
-                     auto msg = Message::Read(decoder, m_get_entry_type);
+                     auto msg = Message::Read(
+                         decoder, m_get_entry_type,
+                         m_array_deltas ? get_delta_base : no_delta_base);
                      if (!msg && decoder.error())
                        DEBUG("error reading in handshake: " << decoder.error());
+                     if (msg) {
+                       CountMessage(m_msgs_received, *msg);
+                       TrackArrayBase(m_rx_arrays, *msg);
+                       TrackPublished(*msg);
+                     }
                      return msg;
                    },
                    [&](wpi::ArrayRef<std::shared_ptr<Message>> msgs) {
@@ -156,7 +440,9 @@ void NetworkConnection::ReadThreadMain() {
     if (!m_stream) break;
     decoder.set_proto_rev(m_proto_rev);
     decoder.Reset();
-    auto msg = Message::Read(decoder, m_get_entry_type);
+    auto msg =
+        Message::Read(decoder, m_get_entry_type,
+                      m_array_deltas ? get_delta_base : no_delta_base);
     if (!msg) {
       if (decoder.error()) INFO("read error: " << decoder.error());
       // terminate connection on bad message
@@ -167,6 +453,9 @@ void NetworkConnection::ReadThreadMain() {
                             << " id=" << msg->id()
                             << " seq_num=" << msg->seq_num_uid());
     m_last_update = Now();
+    CountMessage(m_msgs_received, *msg);
+    TrackArrayBase(m_rx_arrays, *msg);
+    TrackPublished(*msg);
     m_process_incoming(std::move(msg), this);
   }
   DEBUG2("read thread died (" << this << ")");
@@ -184,28 +473,46 @@ done:
 }
 
 void NetworkConnection::WriteThreadMain() {
+  // The encoder buffer is reused for every write.  Long strings and raw
+  // values are not copied into it, but are sent directly from the message
+  // (which is kept alive by batches until the send completes).
   WireEncoder encoder(m_proto_rev);
+  encoder.set_zero_copy_threshold(kZeroCopyThreshold);
+  wpi::SmallVector<wpi::StringRef, 16> bufs;
+  std::vector<Outgoing> batches;
+  bool corked = false;
 
   while (m_active) {
-    auto msgs = m_outgoing.pop();
+    batches.emplace_back(m_outgoing.pop());
     DEBUG4("write thread woke up");
-    if (msgs.empty()) continue;
+    // combine everything posted since the last write into a single send
+    while (!m_outgoing.empty()) batches.emplace_back(m_outgoing.pop());
     encoder.set_proto_rev(m_proto_rev);
     encoder.Reset();
-    DEBUG3("sending " << msgs.size() << " messages");
-    for (auto& msg : msgs) {
-      if (msg) {
-        DEBUG3("sending type=" << msg->type() << " with str=" << msg->str()
-                               << " id=" << msg->id()
-                               << " seq_num=" << msg->seq_num_uid());
-        msg->Write(encoder);
-      }
-    }
+    for (auto& msgs : batches) EncodeOutgoing(encoder, msgs);
     wpi::NetworkStream::Error err;
     if (!m_stream) break;
-    if (encoder.size() == 0) continue;
-    if (m_stream->send(encoder.data(), encoder.size(), &err) == 0) break;
-    DEBUG4("sent " << encoder.size() << " bytes");
+    if (encoder.size() != 0) {
+      if (m_cork && !corked) corked = m_stream->setCork(true);
+      bufs.clear();
+      encoder.GetBuffers(bufs);
+      if (m_stream->sendv(bufs, &err) == 0) break;
+      DEBUG4("sent " << encoder.size() << " bytes");
+      Count(m_bytes_sent, encoder.size());
+    }
+    // stay corked while more is waiting to be sent
+    if (corked && m_outgoing.empty()) corked = !m_stream->setCork(false);
+
+    // hand the largest vector back for reuse by PostOutgoing()
+    {
+      std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+      for (auto& msgs : batches) {
+        msgs.clear();
+        if (msgs.capacity() > m_spare_outgoing.capacity())
+          m_spare_outgoing.swap(msgs);
+      }
+    }
+    batches.clear();
   }
   DEBUG2("write thread died (" << this << ")");
   set_state(kDead);
@@ -220,15 +527,363 @@ void NetworkConnection::WriteThreadMain() {
   }
 }
 
+void NetworkConnection::EncodeOutgoing(WireEncoder& encoder,
+                                       const Outgoing& msgs) {
+  // pre-size the buffer so encoding doesn't need to reallocate
+  size_t size = 0;
+  for (auto& msg : msgs) {
+    if (msg) size += msg->GetSize(encoder);
+  }
+  encoder.Reserve(encoder.size() + size);
+
+  DEBUG3("sending " << msgs.size() << " messages");
+  for (auto& msg : msgs) {
+    if (msg) {
+      DEBUG3("sending type=" << msg->type() << " with str=" << msg->str()
+                             << " id=" << msg->id()
+                             << " seq_num=" << msg->seq_num_uid());
+      // send array updates as deltas if supported and worthwhile
+      bool sent = false;
+      if (m_array_deltas && msg->Is(Message::kEntryUpdate) &&
+          msg->id() < m_tx_arrays.size() && m_tx_arrays[msg->id()])
+        sent = msg->WriteDelta(encoder, *m_tx_arrays[msg->id()]);
+      if (!sent) msg->Write(encoder);
+      CountMessage(m_msgs_sent, *msg);
+      TrackArrayBase(m_tx_arrays, *msg);
+    }
+  }
+}
+
+void NetworkConnection::StartLoop() {
+  m_loop.reset(new LoopState(m_proto_rev, m_logger));
+  m_stream->setBlocking(false);
+
+  m_loop_runner->ExecSync([this](wpi::uv::Loop& loop) {
+    auto poll = wpi::uv::Poll::CreateSocket(
+        loop, static_cast<uv_os_sock_t>(m_stream->getNativeHandle()));
+    auto wakeup = wpi::uv::Async<>::Create(loop);
+    if (!poll || !wakeup) {
+      if (poll) poll->Close();
+      if (wakeup) wakeup->Close();
+      return;
+    }
+    poll->pollEvent.connect([this](int events) {
+      if ((events & UV_READABLE) != 0) LoopRead();
+      if ((events & UV_WRITABLE) != 0) LoopFlush();
+    });
+    poll->error.connect([this](wpi::uv::Error err) {
+      DEBUG("poll error: " << err.str());
+      LoopClose();
+    });
+    wakeup->wakeup.connect([this] { LoopWakeup(); });
+    m_loop->poll_events = UV_READABLE;
+    poll->Start(UV_READABLE);
+    m_loop->poll = poll;
+    m_loop->wakeup = wakeup;
+  });
+
+  if (!m_loop->poll) {
+    // the loop is not running
+    set_state(kDead);
+    m_active = false;
+    return;
+  }
+
+  // the handshake takes the place of the read thread
+  m_read_thread = std::thread(&NetworkConnection::HandshakeThreadMain, this);
+}
+
+void NetworkConnection::StopLoop() {
+  {
+    std::lock_guard<wpi::mutex> lock(m_loop->wakeup_mutex);
+    m_loop->closing = true;
+  }
+  // wake up the handshake thread if it's waiting for a message
+  m_loop->handshake_incoming.push(nullptr);
+
+  // the socket must not be closed while it's being polled
+  auto loop = m_loop_runner->GetLoop();
+  if (loop && loop->GetThreadId() == std::this_thread::get_id())
+    LoopClose();
+  else
+    m_loop_runner->ExecSync([this](wpi::uv::Loop&) { LoopClose(); });
+  if (m_stream) m_stream->close();
+}
+
+void NetworkConnection::HandshakeThreadMain() {
+  auto& lp = *m_loop;
+
+  set_state(kHandshake);
+  if (m_handshake(*this,
+                  [&] {
+                    lp.handshake_wants = true;
+                    WakeLoop();
+                    return lp.handshake_incoming.pop();
+                  },
+                  [&](wpi::ArrayRef<std::shared_ptr<Message>> msgs) {
+                    m_outgoing.emplace(msgs);
+                    WakeLoop();
+                  })) {
+    set_state(kActive);
+    lp.handshake_done = true;
+  } else {
+    set_state(kDead);
+    m_active = false;
+  }
+  // the loop either takes over incoming messages or closes the connection
+  WakeLoop();
+
+  // use condition variable to signal thread shutdown
+  {
+    std::lock_guard<wpi::mutex> lock(m_shutdown_mutex);
+    m_read_shutdown = true;
+    m_read_shutdown_cv.notify_one();
+  }
+}
+
+void NetworkConnection::WakeLoop() {
+  // not started, or the loop wasn't running when it was
+  if (!m_loop) return;
+  std::lock_guard<wpi::mutex> lock(m_loop->wakeup_mutex);
+  if (!m_loop->closing && m_loop->wakeup) m_loop->wakeup->Send();
+}
+
+void NetworkConnection::LoopWakeup() {
+  auto& lp = *m_loop;
+  if (lp.closed) return;
+  if (!m_active) {
+    LoopClose();
+    return;
+  }
+
+  // process anything received after the handshake finished
+  if (!lp.active && lp.handshake_done) {
+    lp.active = true;
+    while (!lp.handshake_incoming.empty()) {
+      auto msg = lp.handshake_incoming.pop();
+      if (!msg) continue;
+      m_last_update = Now();
+      m_process_incoming(std::move(msg), this);
+    }
+  }
+
+  // decode anything received while waiting for the handshake thread
+  if (!lp.rx_buf.empty() && !LoopDecode()) {
+    LoopClose();
+    return;
+  }
+
+  LoopFlush();
+}
+
+bool NetworkConnection::LoopEncode() {
+  auto& lp = *m_loop;
+
+  // hand the sent vectors back for reuse by PostOutgoing()
+  if (!lp.tx_batches.empty()) {
+    std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+    for (auto& msgs : lp.tx_batches) {
+      msgs.clear();
+      if (msgs.capacity() > m_spare_outgoing.capacity())
+        m_spare_outgoing.swap(msgs);
+    }
+  }
+  lp.tx_batches.clear();
+  lp.tx_bufs.clear();
+  lp.tx_index = 0;
+
+  // combine all posted batches into a single write
+  if (m_outgoing.empty()) return false;
+  lp.encoder.set_proto_rev(m_proto_rev);
+  lp.encoder.Reset();
+  while (!m_outgoing.empty()) {
+    lp.tx_batches.emplace_back(m_outgoing.pop());
+    EncodeOutgoing(lp.encoder, lp.tx_batches.back());
+  }
+  lp.encoder.GetBuffers(lp.tx_bufs);
+  return !lp.tx_bufs.empty();
+}
+
+void NetworkConnection::LoopRead() {
+  auto& lp = *m_loop;
+  if (lp.closed) return;
+
+  // read everything available without blocking
+  static constexpr size_t kReadSize = 4096;
+  bool done = false;
+  for (;;) {
+    size_t old_size = lp.rx_buf.size();
+    lp.rx_buf.resize(old_size + kReadSize);
+    wpi::NetworkStream::Error err = wpi::NetworkStream::kConnectionClosed;
+    size_t len = m_stream->receive(&lp.rx_buf[old_size], kReadSize, &err);
+    lp.rx_buf.resize(old_size + len);
+    Count(m_bytes_received, len);
+    if (len == 0) {
+      if (err != wpi::NetworkStream::kWouldBlock) done = true;
+      break;
+    }
+    if (len < kReadSize) break;
+  }
+
+  if (!LoopDecode()) done = true;
+
+  if (done) {
+    DEBUG2("connection closed by remote (" << this << ")");
+    LoopClose();
+  }
+}
+
+bool NetworkConnection::LoopDecode() {
+  auto& lp = *m_loop;
+
+  // decode all complete messages; deltas are only accepted once the peer
+  // has negotiated them
+  Message::GetDeltaBaseFunc get_delta_base =
+      [&](unsigned int id) -> std::shared_ptr<Value> {
+    if (id >= m_rx_arrays.size()) return nullptr;
+    return m_rx_arrays[id];
+  };
+  Message::GetDeltaBaseFunc no_delta_base;
+  bool ok = true;
+  size_t pos = 0;
+  while (!lp.closed && pos < lp.rx_buf.size()) {
+    if (!lp.active && !lp.handshake_wants) break;
+    lp.is.Reset(lp.rx_buf.data() + pos, lp.rx_buf.size() - pos);
+    lp.decoder.set_proto_rev(m_proto_rev);
+    lp.decoder.Reset();
+    auto msg =
+        Message::Read(lp.decoder, m_get_entry_type,
+                      m_array_deltas ? get_delta_base : no_delta_base);
+    if (lp.is.has_error()) break;  // wait for the rest of the message
+    if (!msg) {
+      if (lp.decoder.error()) INFO("read error: " << lp.decoder.error());
+      // terminate connection on bad message
+      ok = false;
+      break;
+    }
+    pos = lp.rx_buf.size() - lp.is.in_avail();
+    CountMessage(m_msgs_received, *msg);
+    TrackArrayBase(m_rx_arrays, *msg);
+    TrackPublished(*msg);
+    if (!lp.active) {
+      lp.handshake_wants = false;
+      lp.handshake_incoming.push(std::move(msg));
+      continue;
+    }
+    DEBUG3("received type=" << msg->type() << " with str=" << msg->str()
+                            << " id=" << msg->id()
+                            << " seq_num=" << msg->seq_num_uid());
+    m_last_update = Now();
+    m_process_incoming(std::move(msg), this);
+  }
+  lp.rx_buf.erase(0, pos);
+  return ok;
+}
+
+void NetworkConnection::LoopFlush() {
+  auto& lp = *m_loop;
+  if (lp.closed) return;
+
+  // send straight from the encoder (and message) buffers; when everything
+  // has been sent, encode whatever has been posted since
+  for (;;) {
+    if (lp.tx_index == lp.tx_bufs.size() && !LoopEncode()) break;
+    // stay corked until everything buffered has been sent
+    if (m_cork && !lp.corked) lp.corked = m_stream->setCork(true);
+    while (lp.tx_index < lp.tx_bufs.size()) {
+      auto& buf = lp.tx_bufs[lp.tx_index];
+      wpi::NetworkStream::Error err = wpi::NetworkStream::kConnectionClosed;
+      size_t len = m_stream->send(buf.data(), buf.size(), &err);
+      if (len == 0) {
+        if (err == wpi::NetworkStream::kWouldBlock) break;
+        LoopClose();
+        return;
+      }
+      DEBUG4("sent " << len << " bytes");
+      Count(m_bytes_sent, len);
+      buf = buf.drop_front(len);
+      if (buf.empty()) ++lp.tx_index;
+    }
+    if (lp.tx_index < lp.tx_bufs.size()) break;  // would block
+  }
+
+  // only poll for writability while there's data left to send
+  int events = UV_READABLE;
+  if (lp.tx_index == lp.tx_bufs.size()) {
+    if (lp.corked) lp.corked = !m_stream->setCork(false);
+  } else {
+    events |= UV_WRITABLE;
+  }
+  if (events != lp.poll_events) {
+    lp.poll_events = events;
+    lp.poll->Start(events);
+  }
+}
+
+void NetworkConnection::LoopClose() {
+  auto& lp = *m_loop;
+  if (lp.closed || !lp.poll) return;
+  lp.closed = true;
+  {
+    std::lock_guard<wpi::mutex> lock(lp.wakeup_mutex);
+    lp.closing = true;
+  }
+  DEBUG2("event loop connection closing (" << this << ")");
+  lp.poll->Close();
+  lp.wakeup->Close();
+  set_state(kDead);
+  m_active = false;
+  // also wake up the handshake thread
+  lp.handshake_incoming.push(nullptr);
+  m_stream->close();
+}
+
 void NetworkConnection::QueueOutgoing(std::shared_ptr<Message> msg) {
   std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+  QueueOutgoingImpl(std::move(msg));
+  if (m_post_now) {
+    m_post_now = false;
+    // until the connection is active, wait for the first periodic update
+    if (state() == kActive) PostOutgoingImpl(false);
+  }
+}
+
+void NetworkConnection::QueueOutgoing(
+    wpi::ArrayRef<std::shared_ptr<Message>> msgs) {
+  std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+  for (auto& msg : msgs) QueueOutgoingImpl(msg);
+  if (m_post_now) {
+    m_post_now = false;
+    if (state() == kActive) PostOutgoingImpl(false);
+  }
+}
+
+void NetworkConnection::NoteSendPeriod(unsigned int id, unsigned int period) {
+  m_pending_hinted = true;
+  // send now if the entry hasn't been sent within the period; otherwise
+  // PostOutgoingImpl() holds it until it has, so post again at that time
+  if (period == 0 || id >= m_last_sent.size()) {
+    m_post_now = true;
+    return;
+  }
+  auto due = m_last_sent[id] + std::chrono::milliseconds(period);
+  if (std::chrono::steady_clock::now() >= due)
+    m_post_now = true;
+  else if (m_schedule_flush)
+    m_schedule_flush(due);
+}
+
+void NetworkConnection::QueueOutgoingImpl(std::shared_ptr<Message> msg) {
+  if (m_subscribed && !FilterOutgoing(*msg)) return;
 
   // Merge with previous.  One case we don't combine: delete/assign loop.
   switch (msg->type()) {
     case Message::kEntryAssign:
     case Message::kEntryUpdate: {
-      // don't do this for unassigned id's
       unsigned int id = msg->id();
+      if (msg->send_period() != Message::kSendDefault)
+        NoteSendPeriod(id, msg->send_period());
+      // don't do this for unassigned id's
       if (id == 0xffff) {
         m_pending_outgoing.push_back(msg);
         break;
@@ -241,9 +896,11 @@ void NetworkConnection::QueueOutgoing(std::shared_ptr<Message> msg) {
           // need to update assignment with new seq_num and value
           oldmsg = Message::EntryAssign(oldmsg->str(), id, msg->seq_num_uid(),
                                         msg->value(), oldmsg->flags());
+          oldmsg->set_send_period(msg->send_period());
         } else {
           oldmsg = msg;  // easy update
         }
+        ++m_coalesced;
       } else {
         // new, but remember it
         size_t pos = m_pending_outgoing.size();
@@ -266,10 +923,12 @@ void NetworkConnection::QueueOutgoing(std::shared_ptr<Message> msg) {
         if (m_pending_update[id].first != 0) {
           m_pending_outgoing[m_pending_update[id].first - 1].reset();
           m_pending_update[id].first = 0;
+          ++m_coalesced;
         }
         if (m_pending_update[id].second != 0) {
           m_pending_outgoing[m_pending_update[id].second - 1].reset();
           m_pending_update[id].second = 0;
+          ++m_coalesced;
         }
       }
 
@@ -287,6 +946,7 @@ void NetworkConnection::QueueOutgoing(std::shared_ptr<Message> msg) {
       if (id < m_pending_update.size() && m_pending_update[id].second != 0) {
         // overwrite the previous one for this id
         m_pending_outgoing[m_pending_update[id].second - 1] = msg;
+        ++m_coalesced;
       } else {
         // new, but remember it
         size_t pos = m_pending_outgoing.size();
@@ -303,8 +963,10 @@ void NetworkConnection::QueueOutgoing(std::shared_ptr<Message> msg) {
         auto t = i->type();
         if (t == Message::kEntryAssign || t == Message::kEntryUpdate ||
             t == Message::kFlagsUpdate || t == Message::kEntryDelete ||
-            t == Message::kClearEntries)
+            t == Message::kClearEntries) {
           i.reset();
+          ++m_coalesced;
+        }
       }
       m_pending_update.resize(0);
       m_pending_outgoing.push_back(msg);
@@ -318,6 +980,10 @@ void NetworkConnection::QueueOutgoing(std::shared_ptr<Message> msg) {
 
 void NetworkConnection::PostOutgoing(bool keep_alive) {
   std::lock_guard<wpi::mutex> lock(m_pending_mutex);
+  PostOutgoingImpl(keep_alive);
+}
+
+void NetworkConnection::PostOutgoingImpl(bool keep_alive) {
   auto now = std::chrono::steady_clock::now();
   if (m_pending_outgoing.empty()) {
     if (!keep_alive) return;
@@ -325,9 +991,60 @@ void NetworkConnection::PostOutgoing(bool keep_alive) {
     if ((now - m_last_post) < std::chrono::seconds(1)) return;
     m_outgoing.emplace(Outgoing{Message::KeepAlive()});
   } else {
+    // hold back updates for entries that were sent too recently
+    Outgoing held;
+    auto next_due = std::chrono::steady_clock::time_point::max();
+    if (m_pending_hinted) {
+      auto is_held = [&](const Message& msg) {
+        unsigned int id = msg.id();
+        if (!msg.Is(Message::kEntryUpdate) ||
+            msg.send_period() == Message::kSendDefault ||
+            id >= m_last_sent.size())
+          return false;
+        auto due =
+            m_last_sent[id] + std::chrono::milliseconds(msg.send_period());
+        if (now >= due) return false;
+        if (due < next_due) next_due = due;
+        return true;
+      };
+      // nothing to do if everything pending is held
+      if (std::all_of(m_pending_outgoing.begin(), m_pending_outgoing.end(),
+                      [&](const std::shared_ptr<Message>& msg) {
+                        return !msg || is_held(*msg);
+                      })) {
+        if (m_schedule_flush && next_due != next_due.max())
+          m_schedule_flush(next_due);
+        return;
+      }
+      for (auto& msg : m_pending_outgoing) {
+        if (!msg || msg->send_period() == Message::kSendDefault) continue;
+        unsigned int id = msg->id();
+        if (id == 0xffff) continue;
+        if (is_held(*msg)) {
+          held.emplace_back(std::move(msg));
+          continue;
+        }
+        if (id >= m_last_sent.size()) m_last_sent.resize(id + 1);
+        m_last_sent[id] = now;
+      }
+    }
+
     m_outgoing.emplace(std::move(m_pending_outgoing));
+    // reuse a vector already sent by the write thread, if available
+    m_pending_outgoing.swap(m_spare_outgoing);
     m_pending_outgoing.resize(0);
     m_pending_update.resize(0);
+
+    // held updates stay pending (and coalescing) until the first is due
+    for (auto& msg : held) {
+      unsigned int id = msg->id();
+      if (id >= m_pending_update.size()) m_pending_update.resize(id + 1);
+      m_pending_update[id].first = m_pending_outgoing.size() + 1;
+      m_pending_outgoing.emplace_back(std::move(msg));
+    }
+    m_pending_hinted = !held.empty();
+    if (!held.empty() && m_schedule_flush) m_schedule_flush(next_due);
   }
   m_last_post = now;
+  if (m_loop_runner) WakeLoop();
 }
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include <wpi/ConcurrentQueue.h>
+#include <wpi/StringMap.h>
 #include <wpi/condition_variable.h>
 #include <wpi/mutex.h>
 
@@ -27,6 +28,7 @@
 #include "ntcore_cpp.h"
 
 namespace wpi {
+class EventLoopRunner;
 class Logger;
 class NetworkStream;
 }  // namespace wpi
@@ -34,6 +36,7 @@ class NetworkStream;
 namespace nt {
 
 class IConnectionNotifier;
+class WireEncoder;
 
 class NetworkConnection : public INetworkConnection {
  public:
@@ -45,6 +48,8 @@ class NetworkConnection : public INetworkConnection {
   typedef std::function<void(std::shared_ptr<Message> msg,
                              NetworkConnection* conn)>
       ProcessIncomingFunc;
+  typedef std::function<void(std::chrono::steady_clock::time_point when)>
+      ScheduleFlushFunc;
   typedef std::vector<std::shared_ptr<Message>> Outgoing;
   typedef wpi::ConcurrentQueue<Outgoing> OutgoingQueue;
 
@@ -60,16 +65,36 @@ class NetworkConnection : public INetworkConnection {
     m_process_incoming = func;
   }
 
+  // Set the function used to request a PostOutgoing() at a later time (when
+  // updates held back by their send period become due).  This must be called
+  // before Start().
+  void set_schedule_flush(ScheduleFlushFunc func) {
+    m_schedule_flush = std::move(func);
+  }
+
+  // Drive the connection from an event loop instead of from dedicated read
+  // and write threads.  The connection keeps the loop running for as long as
+  // it exists.  This must be called before Start().
+  void set_event_loop(std::shared_ptr<wpi::EventLoopRunner> loop) {
+    m_loop_runner = std::move(loop);
+  }
+
+  // Apply NT_NetworkSocketFlags.  This must be called before Start().
+  void set_socket_flags(unsigned int flags);
+
   void Start();
   void Stop();
 
   ConnectionInfo info() const override;
+  ConnectionStats stats() const override;
 
   bool active() const { return m_active; }
   wpi::NetworkStream& stream() { return *m_stream; }
 
   void QueueOutgoing(std::shared_ptr<Message> msg) override;
+  void QueueOutgoing(wpi::ArrayRef<std::shared_ptr<Message>> msgs) override;
   void PostOutgoing(bool keep_alive) override;
+  bool IsFiltered(unsigned int id) const override;
 
   unsigned int uid() const { return m_uid; }
 
@@ -84,12 +109,61 @@ class NetworkConnection : public INetworkConnection {
 
   uint64_t last_update() const { return m_last_update; }
 
+  // Enable sending double array updates as deltas.  Set during the handshake
+  // once the remote end has indicated support.
+  void set_array_deltas(bool enable) { m_array_deltas = enable; }
+
+  // Only send entries whose names start with one of the given prefixes (or
+  // that the remote end has published itself).  Set during the handshake
+  // once the remote end has sent its subscriptions; initial is the initial
+  // entry assignments already sent, used to classify existing ids.
+  void set_subscriptions(wpi::ArrayRef<std::string> prefixes,
+                         wpi::ArrayRef<std::shared_ptr<Message>> initial);
+
   NetworkConnection(const NetworkConnection&) = delete;
   NetworkConnection& operator=(const NetworkConnection&) = delete;
 
  private:
   void ReadThreadMain();
   void WriteThreadMain();
+  void EncodeOutgoing(WireEncoder& encoder, const Outgoing& msgs);
+
+  // Event loop mode.  The handshake still runs on a thread (in place of the
+  // read thread, which exits once the handshake completes); everything else
+  // runs on the loop.
+  struct LoopState;
+  void StartLoop();
+  void StopLoop();
+  void HandshakeThreadMain();
+  void WakeLoop();
+  void LoopWakeup();
+  void LoopRead();
+  // Returns false on a bad message
+  bool LoopDecode();
+  // Returns false if there is nothing to send
+  bool LoopEncode();
+  void LoopFlush();
+  void LoopClose();
+  // Must be called with m_pending_mutex held
+  void QueueOutgoingImpl(std::shared_ptr<Message> msg);
+  void PostOutgoingImpl(bool keep_alive);
+  void NoteSendPeriod(unsigned int id, unsigned int period);
+
+  // Strings at least this long are sent without copying; see WriteThreadMain
+  static constexpr size_t kZeroCopyThreshold = 256;
+
+  // Tracks the last double array value sent or received for each id; these
+  // are the bases for array deltas, and must match on both ends.
+  typedef std::vector<std::shared_ptr<Value>> ArrayBases;
+  static void TrackArrayBase(ArrayBases& bases, const Message& msg);
+
+  // Subscription filtering (see set_subscriptions()).  Must be called with
+  // m_pending_mutex held.
+  enum Wanted : uint8_t { kWantedUnknown = 0, kWantedSend, kWantedDrop };
+  bool FilterOutgoing(const Message& msg);
+  void SetWanted(unsigned int id, Wanted wanted);
+  // Note entries published by the remote end so they are always sent.
+  void TrackPublished(const Message& msg);
 
   unsigned int m_uid;
   std::unique_ptr<wpi::NetworkStream> m_stream;
@@ -99,6 +173,7 @@ class NetworkConnection : public INetworkConnection {
   HandshakeFunc m_handshake;
   Message::GetEntryTypeFunc m_get_entry_type;
   ProcessIncomingFunc m_process_incoming;
+  ScheduleFlushFunc m_schedule_flush;
   std::thread m_read_thread;
   std::thread m_write_thread;
   std::atomic_bool m_active;
@@ -109,10 +184,48 @@ class NetworkConnection : public INetworkConnection {
   std::string m_remote_id;
   std::atomic_ullong m_last_update;
   std::chrono::steady_clock::time_point m_last_post;
-
-  wpi::mutex m_pending_mutex;
+  std::atomic_bool m_array_deltas{false};
+  bool m_cork = false;
+  ArrayBases m_tx_arrays;  // only accessed from write thread or loop
+  ArrayBases m_rx_arrays;  // only accessed from read thread or loop
+
+  // Statistics.  Each counter has a single writer (the read thread, the
+  // write thread, or the loop), so they are updated without locked
+  // read-modify-write operations.
+  static void Count(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+  }
+  static void CountMessage(std::atomic<uint64_t>* counters,
+                           const Message& msg);
+  std::atomic<uint64_t> m_bytes_sent{0};
+  std::atomic<uint64_t> m_bytes_received{0};
+  std::atomic<uint64_t> m_msgs_sent[NT_MSG_TYPE_COUNT] = {};
+  std::atomic<uint64_t> m_msgs_received[NT_MSG_TYPE_COUNT] = {};
+
+  mutable wpi::mutex m_pending_mutex;
   Outgoing m_pending_outgoing;
+  Outgoing m_spare_outgoing;
   std::vector<std::pair<size_t, size_t>> m_pending_update;
+  uint64_t m_coalesced = 0;
+
+  // Subscription filter state; m_subscribed is only set during the
+  // handshake, the rest is protected by m_pending_mutex.
+  std::atomic_bool m_subscribed{false};
+  std::vector<std::string> m_subscriptions;
+  wpi::StringMap<bool> m_published;
+  std::vector<Wanted> m_wanted;
+  uint64_t m_filtered = 0;
+
+  // Send period hints (see Message::send_period()): when each id was last
+  // sent, whether any pending messages have hints, and whether a hinted
+  // message is due to be sent immediately.
+  std::vector<std::chrono::steady_clock::time_point> m_last_sent;
+  bool m_pending_hinted = false;
+  bool m_post_now = false;
+
+  std::shared_ptr<wpi::EventLoopRunner> m_loop_runner;
+  std::unique_ptr<LoopState> m_loop;
 
   // Condition variables for shutdown
   wpi::mutex m_shutdown_mutex;
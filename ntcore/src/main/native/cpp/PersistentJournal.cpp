@@ -0,0 +1,217 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include "PersistentJournal.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <wpi/FileSystem.h>
+#include <wpi/SmallString.h>
+#include <wpi/raw_istream.h>
+#include <wpi/raw_ostream.h>
+
+#include "Log.h"
+
+using namespace nt;
+
+// Journal file layout: 8 byte header (4 byte magic, u32 version), then
+// blocks, each prefixed by its u32 length.  Integers are little endian.
+static constexpr char kJournalMagic[4] = {'\x89', 'N', 'T', 'J'};
+static constexpr uint32_t kJournalVersion = 1;
+static constexpr size_t kJournalHeaderSize = 8;
+
+constexpr uint64_t PersistentJournal::kMinCompactSize;
+
+static void Write32(wpi::raw_ostream& os, uint32_t val) {
+  char buf[4];
+  for (int i = 0; i < 4; ++i) buf[i] = static_cast<char>(val >> (8 * i));
+  os << StringRef(buf, 4);
+}
+
+static uint32_t Get32(const char* buf) {
+  uint32_t val = 0;
+  for (int i = 3; i >= 0; --i)
+    val = (val << 8) | static_cast<unsigned char>(buf[i]);
+  return val;
+}
+
+// Write a file by writing a temporary file and renaming it over the original.
+static const char* WriteFile(StringRef filename, StringRef data) {
+  wpi::SmallString<128> tmp = filename;
+  tmp += ".tmp";
+  wpi::SmallString<128> bak = filename;
+  bak += ".bak";
+
+  std::error_code ec;
+  wpi::raw_fd_ostream os(tmp, ec, wpi::sys::fs::F_None);
+  if (ec.value() != 0) return "could not open file";
+  os << data;
+  os.close();
+  if (os.has_error()) {
+    std::remove(tmp.c_str());
+    return "error saving file";
+  }
+
+  // Safely move to real file.  We ignore any failures related to the backup.
+  wpi::SmallString<128> fn = filename;
+  std::remove(bak.c_str());
+  std::rename(fn.c_str(), bak.c_str());
+  if (std::rename(tmp.c_str(), fn.c_str()) != 0) {
+    std::rename(bak.c_str(), fn.c_str());  // attempt to restore backup
+    return "could not rename temp file to real file";
+  }
+  return nullptr;
+}
+
+PersistentJournal::PersistentJournal(wpi::Logger& logger)
+    : m_logger(logger) {}
+
+PersistentJournal::~PersistentJournal() { Wait(); }
+
+bool PersistentJournal::IsJournaling(StringRef filename) {
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  return m_filename == filename;
+}
+
+bool PersistentJournal::CanAppend(StringRef filename) {
+  if (m_busy) return false;
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  return m_os && m_filename == filename &&
+         m_size < std::max(kMinCompactSize, m_snapshot_size);
+}
+
+const char* PersistentJournal::Append(StringRef filename, StringRef block) {
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  if (!m_os || m_filename != filename) return "journal not open";
+  return AppendImpl(block);
+}
+
+const char* PersistentJournal::AppendImpl(StringRef block) {
+  Write32(*m_os, block.size());
+  *m_os << block;
+  m_os->flush();
+  if (m_os->has_error()) {
+    // force compaction on the next save
+    m_os->clear_error();
+    m_os.reset();
+    return "error writing journal";
+  }
+  m_size += 4 + block.size();
+  return nullptr;
+}
+
+const char* PersistentJournal::Compact(StringRef filename, StringRef block,
+                                       WriteFunc write, bool wait) {
+  std::lock_guard<wpi::mutex> thread_lock(m_thread_mutex);
+  if (m_thread.joinable()) m_thread.join();
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    if (m_os && m_filename == filename && !block.empty()) {
+      if (const char* err = AppendImpl(block))
+        WARNING("persistent journal: " << err);
+    }
+    m_os.reset();
+    m_filename = filename;
+  }
+
+  m_busy = true;
+  if (wait) return CompactImpl(filename, std::move(write));
+  std::string fn = filename;
+  m_thread = std::thread([=] {
+    if (const char* err = CompactImpl(fn, write))
+      WARNING("persistent save: " << err);
+  });
+  return nullptr;
+}
+
+const char* PersistentJournal::CompactImpl(std::string filename,
+                                           WriteFunc write) {
+  std::string data;
+  wpi::raw_string_ostream os(data);
+  write(os);
+  os.flush();
+
+  DEBUG("compacting persistent journal into '" << filename << "'");
+  const char* err = WriteFile(filename, data);
+
+  // start a new journal
+  std::string jfn = GetFilename(filename);
+  std::unique_ptr<wpi::raw_fd_ostream> jos;
+  if (!err) {
+    std::string header(kJournalMagic, sizeof(kJournalMagic));
+    wpi::raw_string_ostream hos(header);
+    Write32(hos, kJournalVersion);
+    hos.flush();
+    err = WriteFile(jfn, header);
+  }
+  if (!err) {
+    std::error_code ec;
+    jos.reset(new wpi::raw_fd_ostream(jfn, ec, wpi::sys::fs::F_Append));
+    if (ec.value() != 0) {
+      jos.reset();
+      err = "could not open journal";
+    }
+  }
+
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    if (m_filename == filename) {
+      m_os = std::move(jos);
+      m_size = kJournalHeaderSize;
+      m_snapshot_size = data.size();
+    }
+  }
+  m_busy = false;
+  return err;
+}
+
+void PersistentJournal::Wait() {
+  std::lock_guard<wpi::mutex> thread_lock(m_thread_mutex);
+  if (m_thread.joinable()) m_thread.join();
+}
+
+void PersistentJournal::Close() {
+  std::lock_guard<wpi::mutex> thread_lock(m_thread_mutex);
+  if (m_thread.joinable()) m_thread.join();
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  m_os.reset();
+  m_filename.clear();
+}
+
+bool PersistentJournal::Read(const Twine& filename,
+                             std::function<bool(StringRef block)> apply) {
+  std::string jfn = GetFilename(filename.str());
+  wpi::sys::fs::file_status status;
+  if (wpi::sys::fs::status(jfn, status)) return false;
+  uint64_t left = status.getSize();
+  std::error_code ec;
+  wpi::raw_fd_istream is(jfn, ec);
+  if (ec.value() != 0 || left < kJournalHeaderSize) return false;
+  left -= kJournalHeaderSize;
+
+  char header[kJournalHeaderSize];
+  is.read(header, sizeof(header));
+  if (is.has_error() ||
+      std::memcmp(header, kJournalMagic, sizeof(kJournalMagic)) != 0 ||
+      Get32(header + 4) != kJournalVersion)
+    return false;
+
+  std::string block;
+  while (left >= 4) {
+    char len_buf[4];
+    is.read(len_buf, sizeof(len_buf));
+    uint32_t len = Get32(len_buf);
+    if (is.has_error() || len > left - 4) break;
+    left -= 4 + len;
+    block.resize(len);
+    is.read(&block[0], len);
+    if (is.has_error() || !apply(block)) break;
+  }
+  return true;
+}
@@ -0,0 +1,119 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_PERSISTENTJOURNAL_H_
+#define NTCORE_PERSISTENTJOURNAL_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <wpi/StringRef.h>
+#include <wpi/Twine.h>
+#include <wpi/mutex.h>
+
+namespace wpi {
+class Logger;
+class raw_fd_ostream;
+class raw_ostream;
+}  // namespace wpi
+
+namespace nt {
+
+using wpi::StringRef;
+using wpi::Twine;
+
+// Append-only journal of changes to persistent values, kept alongside the
+// persistent file as "<filename>.journal".  Periodic saves append a block of
+// changed entries instead of rewriting the persistent file.  Once the journal
+// grows larger than the persistent file, it is compacted: a new persistent
+// file is written on a background thread and the journal is restarted.
+//
+// Blocks are opaque to the journal (Storage writes them in the binary
+// persistent format, which is checksummed).  The final changes are appended
+// before compacting, so the journal always ends at the state captured in the
+// new persistent file.  Replaying it on either the old or the new persistent
+// file gives the same result, so a crash part way through compaction loses
+// nothing.
+class PersistentJournal {
+ public:
+  typedef std::function<void(wpi::raw_ostream& os)> WriteFunc;
+
+  explicit PersistentJournal(wpi::Logger& logger);
+  ~PersistentJournal();
+
+  PersistentJournal(const PersistentJournal&) = delete;
+  PersistentJournal& operator=(const PersistentJournal&) = delete;
+
+  // True while a background compaction is in progress.
+  bool busy() const { return m_busy; }
+
+  // Whether the journal is for filename (i.e. saves of filename should go
+  // through the journal).
+  bool IsJournaling(StringRef filename);
+
+  // Whether changes to filename can be appended.  If not, the journal needs
+  // to be compacted; this is the case for the first save of a file (the
+  // journal is never reopened), once the journal has grown too large, and
+  // after an error.
+  bool CanAppend(StringRef filename);
+
+  // Append a block of changes.  Returns an error string, or nullptr.
+  const char* Append(StringRef filename, StringRef block);
+
+  // Append a final block of changes (if not empty), then write a new
+  // persistent file using write and restart the journal.  Unless wait is
+  // true, the files are written on a background thread, and errors are
+  // logged rather than returned.
+  const char* Compact(StringRef filename, StringRef block, WriteFunc write,
+                      bool wait);
+
+  // Wait for a background compaction to finish.
+  void Wait();
+
+  // Wait for compaction and close the journal.
+  void Close();
+
+  // Read the journal for filename, calling apply for each block.  Reading
+  // stops at the first incomplete block, or if apply returns false (e.g.
+  // because of a checksum mismatch in a block that was being appended when
+  // the program stopped).  Returns false if there is no valid journal.
+  static bool Read(const Twine& filename,
+                   std::function<bool(StringRef block)> apply);
+
+  static std::string GetFilename(StringRef filename) {
+    return filename.str() + ".journal";
+  }
+
+ private:
+  const char* AppendImpl(StringRef block);
+  const char* CompactImpl(std::string filename, WriteFunc write);
+
+  // Journals smaller than this are never compacted
+  static constexpr uint64_t kMinCompactSize = 64 * 1024;
+
+  wpi::Logger& m_logger;
+  std::atomic_bool m_busy{false};
+
+  // Guards starting and joining the compaction thread
+  wpi::mutex m_thread_mutex;
+  std::thread m_thread;
+
+  wpi::mutex m_mutex;
+  std::string m_filename;
+  std::unique_ptr<wpi::raw_fd_ostream> m_os;
+  uint64_t m_size = 0;
+  uint64_t m_snapshot_size = 0;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_PERSISTENTJOURNAL_H_
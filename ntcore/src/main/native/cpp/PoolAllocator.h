@@ -0,0 +1,122 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_POOLALLOCATOR_H_
+#define NTCORE_POOLALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+
+#include <wpi/spinlock.h>
+
+namespace nt {
+
+// Number of blocks all pools have obtained from the heap (for testing).
+std::atomic<size_t>& PoolHeapAllocations();
+
+// Thread-safe free list of fixed-size memory blocks.  Blocks are obtained
+// from the heap the first time and recycled on release, so once the pool has
+// warmed up, allocation does not touch the heap.  At most kMaxFree blocks are
+// retained; beyond that, released blocks go back to the heap.
+//
+// There is one pool per block size; pools are intentionally never destroyed
+// so that objects released during static destruction are still safe.
+template <size_t Size>
+class BlockPool {
+ public:
+  static constexpr size_t kMaxFree = 4096;
+
+  static BlockPool& GetInstance() {
+    static BlockPool* inst = new BlockPool;
+    return *inst;
+  }
+
+  void* Allocate() {
+    {
+      std::lock_guard<wpi::spinlock> lock(m_mutex);
+      if (m_free) {
+        FreeBlock* block = m_free;
+        m_free = block->next;
+        --m_num_free;
+        return block;
+      }
+    }
+    PoolHeapAllocations().fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(kBlockSize);
+  }
+
+  void Deallocate(void* p) {
+    {
+      std::lock_guard<wpi::spinlock> lock(m_mutex);
+      if (m_num_free < kMaxFree) {
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = m_free;
+        m_free = block;
+        ++m_num_free;
+        return;
+      }
+    }
+    ::operator delete(p);
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  static constexpr size_t kBlockSize =
+      Size < sizeof(FreeBlock) ? sizeof(FreeBlock) : Size;
+
+  BlockPool() = default;
+
+  wpi::spinlock m_mutex;
+  FreeBlock* m_free = nullptr;
+  size_t m_num_free = 0;
+};
+
+// Stateless allocator that serves single-object allocations from a BlockPool.
+// Intended for use with std::allocate_shared() for small, frequently created
+// objects (scalar values and update messages); the object and shared_ptr
+// control block then come from a single recycled block.
+template <typename T>
+class PoolAllocator {
+ public:
+  typedef T value_type;
+
+  PoolAllocator() noexcept = default;
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>&) noexcept {}  // NOLINT
+
+  T* allocate(size_t n) {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned types not supported");
+    if (n != 1) return std::allocator<T>().allocate(n);
+    return static_cast<T*>(BlockPool<sizeof(T)>::GetInstance().Allocate());
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    if (n != 1) return std::allocator<T>().deallocate(p, n);
+    BlockPool<sizeof(T)>::GetInstance().Deallocate(p);
+  }
+};
+
+template <typename T, typename U>
+inline bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+  return false;
+}
+
+}  // namespace nt
+
+#endif  // NTCORE_POOLALLOCATOR_H_
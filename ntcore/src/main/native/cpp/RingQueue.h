@@ -0,0 +1,121 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_RINGQUEUE_H_
+#define NTCORE_RINGQUEUE_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace nt {
+
+// A FIFO queue stored in a circular buffer, with an optional capacity.
+//
+// The buffer grows geometrically up to the capacity (or without limit if the
+// capacity is 0) and is never shrunk, so a queue that is regularly drained
+// stops allocating once it has reached its working size.  Popped elements
+// are destroyed immediately, so they release any resources they hold.
+//
+// Callers are responsible for checking full() before pushing to a bounded
+// queue.  Not thread-safe.
+template <typename T>
+class RingQueue {
+ public:
+  typedef T value_type;
+  typedef size_t size_type;
+
+  explicit RingQueue(size_type capacity = 0) : m_capacity(capacity) {}
+  RingQueue(const RingQueue&) = delete;
+  RingQueue& operator=(const RingQueue&) = delete;
+
+  ~RingQueue() { clear(); }
+
+  size_type size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  // 0 if unbounded
+  size_type capacity() const { return m_capacity; }
+  bool full() const { return m_capacity != 0 && m_size >= m_capacity; }
+
+  // Changes the capacity.  If the queue holds more than capacity elements,
+  // the oldest ones are removed; returns the number removed.
+  size_type set_capacity(size_type capacity) {
+    m_capacity = capacity;
+    size_type removed = 0;
+    while (m_capacity != 0 && m_size > m_capacity) {
+      pop();
+      ++removed;
+    }
+    return removed;
+  }
+
+  // Element i from the front (0 is the oldest)
+  T& operator[](size_type i) { return *Element(i); }
+  const T& operator[](size_type i) const { return *Element(i); }
+
+  T& front() { return (*this)[0]; }
+  const T& front() const { return (*this)[0]; }
+
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    assert(!full());
+    if (m_size == m_buf_size) Grow();
+    new (Slot(m_size)) T(std::forward<Args>(args)...);
+    ++m_size;
+  }
+
+  void push(const T& value) { emplace(value); }
+  void push(T&& value) { emplace(std::move(value)); }
+
+  void pop() {
+    assert(!empty());
+    Element(0)->~T();
+    m_head = (m_head + 1) % m_buf_size;
+    --m_size;
+  }
+
+  void clear() {
+    while (!empty()) pop();
+  }
+
+ private:
+  typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+  void* Slot(size_type i) const { return &m_buf[(m_head + i) % m_buf_size]; }
+
+  T* Element(size_type i) const {
+    assert(i < m_size);
+    return reinterpret_cast<T*>(Slot(i));
+  }
+
+  void Grow() {
+    size_type new_size = std::max<size_type>(16, m_buf_size * 2);
+    if (m_capacity != 0) new_size = std::min(new_size, m_capacity);
+    std::unique_ptr<Storage[]> buf(new Storage[new_size]);
+    for (size_type i = 0; i < m_size; ++i) {
+      new (&buf[i]) T(std::move(*Element(i)));
+      Element(i)->~T();
+    }
+    m_buf = std::move(buf);
+    m_buf_size = new_size;
+    m_head = 0;
+  }
+
+  std::unique_ptr<Storage[]> m_buf;
+  size_type m_buf_size = 0;
+  size_type m_head = 0;
+  size_type m_size = 0;
+  size_type m_capacity;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_RINGQUEUE_H_
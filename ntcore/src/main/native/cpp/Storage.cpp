@@ -7,6 +7,8 @@
 
 #include "Storage.h"
 
+#include <algorithm>
+
 #include <wpi/timestamp.h>
 
 #include "Handle.h"
@@ -20,7 +22,10 @@ using namespace nt;
 
 Storage::Storage(IEntryNotifier& notifier, IRpcServer& rpc_server,
                  wpi::Logger& logger)
-    : m_notifier(notifier), m_rpc_server(rpc_server), m_logger(logger) {
+    : m_notifier(notifier),
+      m_rpc_server(rpc_server),
+      m_logger(logger),
+      m_journal(logger) {
   m_terminating = false;
 }
 
@@ -98,8 +103,24 @@ void Storage::ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
     // the sender as well as all other connections.
     if (id == 0xffff) {
       entry = GetOrNew(name);
-      // see if it was already assigned; ignore if so.
-      if (entry->id != 0xffff) return;
+      if (!entry) return;
+      // see if it was already assigned; ignore if so, unless the
+      // assignment was filtered out for this connection, in which case
+      // the requester would never learn the id.  It's sent just to the
+      // requester, which now wants it as it has published the entry.
+      if (entry->id != 0xffff) {
+        if (!conn || !m_dispatcher) return;
+        auto outmsg =
+            Message::EntryAssign(entry->name, entry->id,
+                                 entry->seq_num.value(), entry->value,
+                                 entry->flags);
+        outmsg->set_send_period(entry->send_period);
+        auto dispatcher = m_dispatcher;
+        lock.unlock();
+        if (conn->IsFiltered(outmsg->id()))
+          dispatcher->QueueOutgoing(outmsg, conn, nullptr);
+        return;
+      }
 
       entry->flags = msg->flags();
       entry->seq_num = seq_num;
@@ -126,12 +147,13 @@ void Storage::ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
     if (!entry) {
       // create local
       entry = GetOrNew(name);
+      if (!entry) return;
       entry->id = id;
       m_idmap[id] = entry;
       if (!entry->value) {
         // didn't exist at all (rather than just being a response to a
         // id assignment request)
-        entry->value = msg->value();
+        entry->SetValue(msg->value());
         entry->flags = msg->flags();
         entry->seq_num = seq_num;
 
@@ -182,17 +204,17 @@ void Storage::ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
   if (!may_need_update && conn->proto_rev() >= 0x0300) {
     // update persistent dirty flag if persistent flag changed
     if ((entry->flags & NT_PERSISTENT) != (msg->flags() & NT_PERSISTENT))
-      m_persistent_dirty = true;
+      MarkPersistentDirty(entry);
     if (entry->flags != msg->flags()) notify_flags |= NT_NOTIFY_FLAGS;
     entry->flags = msg->flags();
   }
 
   // update persistent dirty flag if the value changed and it's persistent
   if (entry->IsPersistent() && *entry->value != *msg->value())
-    m_persistent_dirty = true;
+    MarkPersistentDirty(entry);
 
   // update local
-  entry->value = msg->value();
+  entry->SetValue(msg->value());
   entry->seq_num = seq_num;
 
   // notify
@@ -204,6 +226,7 @@ void Storage::ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
     auto dispatcher = m_dispatcher;
     auto outmsg = Message::EntryAssign(entry->name, id, msg->seq_num_uid(),
                                        msg->value(), entry->flags);
+    outmsg->set_send_period(entry->send_period);
     lock.unlock();
     dispatcher->QueueOutgoing(outmsg, nullptr, conn);
   }
@@ -227,11 +250,11 @@ void Storage::ProcessIncomingEntryUpdate(std::shared_ptr<Message> msg,
   if (seq_num <= entry->seq_num) return;
 
   // update local
-  entry->value = msg->value();
+  entry->SetValue(msg->value());
   entry->seq_num = seq_num;
 
   // update persistent dirty flag if it's a persistent value
-  if (entry->IsPersistent()) m_persistent_dirty = true;
+  if (entry->IsPersistent()) MarkPersistentDirty(entry);
 
   // notify
   m_notifier.NotifyEntry(entry->local_id, entry->name, entry->value,
@@ -241,8 +264,15 @@ void Storage::ProcessIncomingEntryUpdate(std::shared_ptr<Message> msg,
   // be any other connections, so don't bother)
   if (m_server && m_dispatcher) {
     auto dispatcher = m_dispatcher;
+    // the incoming message may still be referenced by the connection, so
+    // copy it rather than changing its send period
+    auto outmsg = msg;
+    if (entry->send_period != msg->send_period()) {
+      outmsg = Message::EntryUpdate(id, msg->seq_num_uid(), msg->value());
+      outmsg->set_send_period(entry->send_period);
+    }
     lock.unlock();
-    dispatcher->QueueOutgoing(msg, nullptr, conn);
+    dispatcher->QueueOutgoing(outmsg, nullptr, conn);
   }
 }
 
@@ -418,11 +448,12 @@ void Storage::ApplyInitialAssignments(
     StringRef name = msg->str();
 
     Entry* entry = GetOrNew(name);
+    if (!entry) continue;
     entry->seq_num = seq_num;
     entry->id = id;
     if (!entry->value) {
       // doesn't currently exist
-      entry->value = msg->value();
+      entry->SetValue(msg->value());
       entry->flags = msg->flags();
       // notify
       m_notifier.NotifyEntry(entry->local_id, name, entry->value,
@@ -436,7 +467,7 @@ void Storage::ApplyInitialAssignments(
         update_msgs.emplace_back(Message::EntryUpdate(
             entry->id, entry->seq_num.value(), entry->value));
       } else {
-        entry->value = msg->value();
+        entry->SetValue(msg->value());
         unsigned int notify_flags = NT_NOTIFY_UPDATE;
         // don't update flags from a <3.0 remote (not part of message)
         if (conn.proto_rev() >= 0x0300) {
@@ -483,9 +514,9 @@ std::shared_ptr<Value> Storage::GetEntryValue(StringRef name) const {
 }
 
 std::shared_ptr<Value> Storage::GetEntryValue(unsigned int local_id) const {
-  std::lock_guard<wpi::mutex> lock(m_mutex);
+  // lock-free; see LocalMap
   if (local_id >= m_localmap.size()) return nullptr;
-  return m_localmap[local_id]->value;
+  return m_localmap[local_id]->LoadValue();
 }
 
 bool Storage::SetDefaultEntryValue(StringRef name,
@@ -494,6 +525,7 @@ bool Storage::SetDefaultEntryValue(StringRef name,
   if (!value) return false;
   std::unique_lock<wpi::mutex> lock(m_mutex);
   Entry* entry = GetOrNew(name);
+  if (!entry) return false;
 
   // we return early if value already exists; if types match return true
   if (entry->value) return entry->value->type() == value->type();
@@ -521,6 +553,7 @@ bool Storage::SetEntryValue(StringRef name, std::shared_ptr<Value> value) {
   if (!value) return true;
   std::unique_lock<wpi::mutex> lock(m_mutex);
   Entry* entry = GetOrNew(name);
+  if (!entry) return false;
 
   if (entry->value && entry->value->type() != value->type())
     return false;  // error on type mismatch
@@ -543,12 +576,100 @@ bool Storage::SetEntryValue(unsigned int local_id,
   return true;
 }
 
+std::vector<std::shared_ptr<Value>> Storage::GetEntryValues(
+    wpi::ArrayRef<unsigned int> local_ids) const {
+  std::vector<std::shared_ptr<Value>> values;
+  values.reserve(local_ids.size());
+  // hold the lock so the result is a consistent snapshot
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  for (auto local_id : local_ids) {
+    if (local_id >= m_localmap.size())
+      values.emplace_back();
+    else
+      values.emplace_back(m_localmap[local_id]->value);
+  }
+  return values;
+}
+
+bool Storage::SetEntryValues(wpi::ArrayRef<unsigned int> local_ids,
+                             wpi::ArrayRef<std::shared_ptr<Value>> values) {
+  if (local_ids.size() != values.size()) return false;
+  bool rv = true;
+  std::vector<std::shared_ptr<Message>> msgs;
+  std::unique_lock<wpi::mutex> lock(m_mutex);
+  for (size_t i = 0; i < local_ids.size(); ++i) {
+    auto& value = values[i];
+    if (!value || local_ids[i] >= m_localmap.size()) continue;
+    Entry* entry = m_localmap[local_ids[i]].get();
+
+    if (entry->value && entry->value->type() != value->type()) {
+      rv = false;  // error on type mismatch
+      continue;
+    }
+
+    if (auto msg = UpdateEntryValue(entry, value, true))
+      msgs.emplace_back(std::move(msg));
+  }
+  if (msgs.empty()) return rv;
+  auto dispatcher = m_dispatcher;
+  lock.unlock();
+  dispatcher->QueueOutgoing(msgs, nullptr, nullptr);
+  return rv;
+}
+
+size_t Storage::GetEntryDoubles(wpi::ArrayRef<unsigned int> local_ids,
+                                double default_value, double* values) const {
+  size_t count = 0;
+  // like GetEntryValues(), but without copying shared_ptrs
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  for (size_t i = 0; i < local_ids.size(); ++i) {
+    const Value* value = nullptr;
+    if (local_ids[i] < m_localmap.size())
+      value = m_localmap[local_ids[i]]->value.get();
+    if (value && value->IsDouble()) {
+      values[i] = value->GetDouble();
+      ++count;
+    } else {
+      values[i] = default_value;
+    }
+  }
+  return count;
+}
+
+size_t Storage::GetEntryBooleans(wpi::ArrayRef<unsigned int> local_ids,
+                                 bool default_value, bool* values) const {
+  size_t count = 0;
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  for (size_t i = 0; i < local_ids.size(); ++i) {
+    const Value* value = nullptr;
+    if (local_ids[i] < m_localmap.size())
+      value = m_localmap[local_ids[i]]->value.get();
+    if (value && value->IsBoolean()) {
+      values[i] = value->GetBoolean();
+      ++count;
+    } else {
+      values[i] = default_value;
+    }
+  }
+  return count;
+}
+
 void Storage::SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
                                 std::unique_lock<wpi::mutex>& lock,
                                 bool local) {
-  if (!value) return;
+  auto msg = UpdateEntryValue(entry, value, local);
+  if (!msg) return;
+  auto dispatcher = m_dispatcher;
+  lock.unlock();
+  dispatcher->QueueOutgoing(msg, nullptr, nullptr);
+}
+
+std::shared_ptr<Message> Storage::UpdateEntryValue(Entry* entry,
+                                                   std::shared_ptr<Value> value,
+                                                   bool local) {
+  if (!value) return nullptr;
   auto old_value = entry->value;
-  entry->value = value;
+  entry->SetValue(value);
 
   // if we're the server, assign an id if it doesn't have one
   if (m_server && entry->id == 0xffff) {
@@ -559,7 +680,7 @@ void Storage::SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
 
   // update persistent dirty flag if value changed and it's persistent
   if (entry->IsPersistent() && (!old_value || *old_value != *value))
-    m_persistent_dirty = true;
+    MarkPersistentDirty(entry);
 
   // notify
   if (!old_value)
@@ -573,23 +694,20 @@ void Storage::SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
   if (local) entry->local_write = true;
 
   // generate message
-  if (!m_dispatcher || (!local && !m_server)) return;
-  auto dispatcher = m_dispatcher;
+  if (!m_dispatcher || (!local && !m_server)) return nullptr;
+  std::shared_ptr<Message> msg;
   if (!old_value || old_value->type() != value->type()) {
     if (local) ++entry->seq_num;
-    auto msg = Message::EntryAssign(
-        entry->name, entry->id, entry->seq_num.value(), value, entry->flags);
-    lock.unlock();
-    dispatcher->QueueOutgoing(msg, nullptr, nullptr);
+    msg = Message::EntryAssign(entry->name, entry->id, entry->seq_num.value(),
+                               value, entry->flags);
   } else if (*old_value != *value) {
     if (local) ++entry->seq_num;
     // don't send an update if we don't have an assigned id yet
-    if (entry->id != 0xffff) {
-      auto msg = Message::EntryUpdate(entry->id, entry->seq_num.value(), value);
-      lock.unlock();
-      dispatcher->QueueOutgoing(msg, nullptr, nullptr);
-    }
+    if (entry->id != 0xffff)
+      msg = Message::EntryUpdate(entry->id, entry->seq_num.value(), value);
   }
+  if (msg) msg->set_send_period(entry->send_period);
+  return msg;
 }
 
 void Storage::SetEntryTypeValue(StringRef name, std::shared_ptr<Value> value) {
@@ -597,6 +715,7 @@ void Storage::SetEntryTypeValue(StringRef name, std::shared_ptr<Value> value) {
   if (!value) return;
   std::unique_lock<wpi::mutex> lock(m_mutex);
   Entry* entry = GetOrNew(name);
+  if (!entry) return;
 
   SetEntryValueImpl(entry, value, lock, true);
 }
@@ -633,7 +752,7 @@ void Storage::SetEntryFlagsImpl(Entry* entry, unsigned int flags,
 
   // update persistent dirty flag if persistent flag changed
   if ((entry->flags & NT_PERSISTENT) != (flags & NT_PERSISTENT))
-    m_persistent_dirty = true;
+    MarkPersistentDirty(entry);
 
   entry->flags = flags;
 
@@ -687,8 +806,7 @@ void Storage::DeleteEntryImpl(Entry* entry, std::unique_lock<wpi::mutex>& lock,
   if (id < m_idmap.size()) m_idmap[id] = nullptr;
 
   // empty the value and reset id and local_write flag
-  std::shared_ptr<Value> old_value;
-  old_value.swap(entry->value);
+  auto old_value = entry->ExchangeValue(nullptr);
   entry->id = 0xffff;
   entry->local_write = false;
 
@@ -699,7 +817,7 @@ void Storage::DeleteEntryImpl(Entry* entry, std::unique_lock<wpi::mutex>& lock,
   }
 
   // update persistent dirty flag if it's a persistent value
-  if (entry->IsPersistent()) m_persistent_dirty = true;
+  if (entry->IsPersistent()) MarkPersistentDirty(entry);
 
   // reset flags
   entry->flags = 0;
@@ -732,7 +850,7 @@ void Storage::DeleteAllEntriesImpl(bool local, F should_delete) {
       if (entry->id < m_idmap.size()) m_idmap[entry->id] = nullptr;
       entry->id = 0xffff;
       entry->local_write = false;
-      entry->value.reset();
+      entry->SetValue(nullptr);
       continue;
     }
   }
@@ -757,24 +875,131 @@ void Storage::DeleteAllEntries() {
   dispatcher->QueueOutgoing(Message::ClearEntries(), nullptr, nullptr);
 }
 
+void Storage::MarkPersistentDirty(Entry* entry) {
+  m_persistent_dirty = true;
+  if (!m_persistent_journal || entry->persistent_changed) return;
+  entry->persistent_changed = true;
+  m_persistent_changes.push_back(entry);
+}
+
 Storage::Entry* Storage::GetOrNew(const Twine& name) {
   wpi::SmallString<128> nameBuf;
   StringRef nameStr = name.toStringRef(nameBuf);
   auto& entry = m_entries[nameStr];
   if (!entry) {
+    if (m_localmap.full()) {
+      // local ids must fit in a handle
+      ERROR("too many entries; not creating '" << nameStr << "'");
+      m_entries.erase(nameStr);
+      return nullptr;
+    }
     m_localmap.emplace_back(new Entry(nameStr));
     entry = m_localmap.back().get();
     entry->local_id = m_localmap.size() - 1;
+    m_entries_index.emplace(entry->name, entry);
+    if (!m_send_periods.empty())
+      entry->send_period = GetPrefixSendPeriod(nameStr);
   }
   return entry;
 }
 
+unsigned int Storage::GetPrefixSendPeriod(StringRef name) const {
+  unsigned int period = Message::kSendDefault;
+  size_t len = 0;
+  for (auto& hint : m_send_periods) {
+    if (hint.first.size() < len || !name.startswith(hint.first)) continue;
+    period = hint.second;
+    len = hint.first.size();
+  }
+  return period;
+}
+
+void Storage::SetEntrySendPeriod(unsigned int local_id, unsigned int period) {
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  if (local_id >= m_localmap.size()) return;
+  Entry* entry = m_localmap[local_id].get();
+  entry->send_period_set = period != Message::kSendDefault;
+  entry->send_period =
+      entry->send_period_set ? period : GetPrefixSendPeriod(entry->name);
+}
+
+void Storage::SetPrefixSendPeriod(const Twine& prefix, unsigned int period) {
+  wpi::SmallString<128> prefixBuf;
+  StringRef prefixStr = prefix.toStringRef(prefixBuf);
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+
+  auto it = std::find_if(
+      m_send_periods.begin(), m_send_periods.end(),
+      [&](const std::pair<std::string, unsigned int>& hint) {
+        return hint.first == prefixStr;
+      });
+  if (period == Message::kSendDefault) {
+    if (it == m_send_periods.end()) return;
+    m_send_periods.erase(it);
+  } else if (it != m_send_periods.end()) {
+    it->second = period;
+  } else {
+    m_send_periods.emplace_back(prefixStr, period);
+  }
+
+  // update existing entries; a longer prefix may still take precedence
+  ForEachEntry(prefixStr, [&](Entry* entry) {
+    if (!entry->send_period_set)
+      entry->send_period = GetPrefixSendPeriod(entry->name);
+  });
+}
+
+unsigned int Storage::GetEntrySendPeriod(unsigned int local_id) const {
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  if (local_id >= m_localmap.size()) return Message::kSendDefault;
+  return m_localmap[local_id]->send_period;
+}
+
+void Storage::SetEntryHistory(unsigned int local_id, size_t capacity) {
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  if (local_id >= m_localmap.size()) return;
+  Entry* entry = m_localmap[local_id].get();
+  if (capacity == 0) {
+    entry->history.reset();
+  } else if (entry->history) {
+    entry->history->set_capacity(capacity);
+  } else {
+    entry->history.reset(new ValueHistory(capacity));
+    entry->history->Add(entry->value);
+  }
+}
+
+std::shared_ptr<Value> Storage::GetEntryValueAt(unsigned int local_id,
+                                                uint64_t time) const {
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  if (local_id >= m_localmap.size()) return nullptr;
+  Entry* entry = m_localmap[local_id].get();
+  if (entry->history) return entry->history->GetAt(time);
+  // without history, only the current value is known
+  if (!entry->value || entry->value->time() > time) return nullptr;
+  return entry->value;
+}
+
+std::vector<std::shared_ptr<Value>> Storage::GetEntryHistory(
+    unsigned int local_id, uint64_t since) const {
+  std::lock_guard<wpi::mutex> lock(m_mutex);
+  if (local_id >= m_localmap.size())
+    return std::vector<std::shared_ptr<Value>>{};
+  Entry* entry = m_localmap[local_id].get();
+  if (entry->history) return entry->history->GetSince(since);
+  std::vector<std::shared_ptr<Value>> values;
+  if (entry->value && entry->value->time() >= since)
+    values.push_back(entry->value);
+  return values;
+}
+
 unsigned int Storage::GetEntry(const Twine& name) {
   if (name.isTriviallyEmpty() ||
       (name.isSingleStringRef() && name.getSingleStringRef().empty()))
     return UINT_MAX;
   std::unique_lock<wpi::mutex> lock(m_mutex);
-  return GetOrNew(name)->local_id;
+  Entry* entry = GetOrNew(name);
+  return entry ? entry->local_id : UINT_MAX;
 }
 
 std::vector<unsigned int> Storage::GetEntries(const Twine& prefix,
@@ -783,13 +1008,11 @@ std::vector<unsigned int> Storage::GetEntries(const Twine& prefix,
   StringRef prefixStr = prefix.toStringRef(prefixBuf);
   std::lock_guard<wpi::mutex> lock(m_mutex);
   std::vector<unsigned int> ids;
-  for (auto& i : m_entries) {
-    Entry* entry = i.getValue();
+  ForEachEntry(prefixStr, [&](Entry* entry) {
     auto value = entry->value.get();
-    if (!value || !i.getKey().startswith(prefixStr)) continue;
-    if (types != 0 && (types & value->type()) == 0) continue;
+    if (!value || (types != 0 && (types & value->type()) == 0)) return;
     ids.push_back(entry->local_id);
-  }
+  });
   return ids;
 }
 
@@ -820,19 +1043,19 @@ std::string Storage::GetEntryName(unsigned int local_id) const {
 }
 
 NT_Type Storage::GetEntryType(unsigned int local_id) const {
-  std::unique_lock<wpi::mutex> lock(m_mutex);
+  // lock-free; see LocalMap
   if (local_id >= m_localmap.size()) return NT_UNASSIGNED;
-  Entry* entry = m_localmap[local_id].get();
-  if (!entry->value) return NT_UNASSIGNED;
-  return entry->value->type();
+  auto value = m_localmap[local_id]->LoadValue();
+  if (!value) return NT_UNASSIGNED;
+  return value->type();
 }
 
 uint64_t Storage::GetEntryLastChange(unsigned int local_id) const {
-  std::unique_lock<wpi::mutex> lock(m_mutex);
+  // lock-free; see LocalMap
   if (local_id >= m_localmap.size()) return 0;
-  Entry* entry = m_localmap[local_id].get();
-  if (!entry->value) return 0;
-  return entry->value->last_change();
+  auto value = m_localmap[local_id]->LoadValue();
+  if (!value) return 0;
+  return value->last_change();
 }
 
 std::vector<EntryInfo> Storage::GetEntryInfo(int inst, const Twine& prefix,
@@ -841,19 +1064,17 @@ std::vector<EntryInfo> Storage::GetEntryInfo(int inst, const Twine& prefix,
   StringRef prefixStr = prefix.toStringRef(prefixBuf);
   std::lock_guard<wpi::mutex> lock(m_mutex);
   std::vector<EntryInfo> infos;
-  for (auto& i : m_entries) {
-    Entry* entry = i.getValue();
+  ForEachEntry(prefixStr, [&](Entry* entry) {
     auto value = entry->value.get();
-    if (!value || !i.getKey().startswith(prefixStr)) continue;
-    if (types != 0 && (types & value->type()) == 0) continue;
+    if (!value || (types != 0 && (types & value->type()) == 0)) return;
     EntryInfo info;
     info.entry = Handle(inst, entry->local_id, Handle::kEntry);
-    info.name = i.getKey();
+    info.name = entry->name;
     info.type = value->type();
     info.flags = entry->flags;
     info.last_change = value->last_change();
     infos.push_back(std::move(info));
-  }
+  });
   return infos;
 }
 
@@ -867,12 +1088,11 @@ unsigned int Storage::AddListener(
   unsigned int uid = m_notifier.Add(callback, prefixStr, flags);
   // perform immediate notifications
   if ((flags & NT_NOTIFY_IMMEDIATE) != 0 && (flags & NT_NOTIFY_NEW) != 0) {
-    for (auto& i : m_entries) {
-      Entry* entry = i.getValue();
-      if (!entry->value || !i.getKey().startswith(prefixStr)) continue;
-      m_notifier.NotifyEntry(entry->local_id, i.getKey(), entry->value,
+    ForEachEntry(prefixStr, [&](Entry* entry) {
+      if (!entry->value) return;
+      m_notifier.NotifyEntry(entry->local_id, entry->name, entry->value,
                              NT_NOTIFY_IMMEDIATE | NT_NOTIFY_NEW, uid);
-    }
+    });
   }
   return uid;
 }
@@ -904,13 +1124,12 @@ unsigned int Storage::AddPolledListener(unsigned int poller,
   unsigned int uid = m_notifier.AddPolled(poller, prefixStr, flags);
   // perform immediate notifications
   if ((flags & NT_NOTIFY_IMMEDIATE) != 0 && (flags & NT_NOTIFY_NEW) != 0) {
-    for (auto& i : m_entries) {
-      if (!i.getKey().startswith(prefixStr)) continue;
-      Entry* entry = i.getValue();
-      if (!entry->value) continue;
-      m_notifier.NotifyEntry(entry->local_id, i.getKey(), entry->value,
+    ForEachEntry(prefixStr, [&](Entry* entry) {
+      // if no value, don't notify
+      if (!entry->value) return;
+      m_notifier.NotifyEntry(entry->local_id, entry->name, entry->value,
                              NT_NOTIFY_IMMEDIATE | NT_NOTIFY_NEW, uid);
-    }
+    });
   }
   return uid;
 }
@@ -944,20 +1163,14 @@ bool Storage::GetPersistentEntries(
     if (periodic && !m_persistent_dirty) return false;
     m_persistent_dirty = false;
     entries->reserve(m_entries.size());
-    for (auto& i : m_entries) {
-      Entry* entry = i.getValue();
+    // the index is in name order
+    for (auto& i : m_entries_index) {
+      Entry* entry = i.second;
       // only write persistent-flagged values
       if (!entry->value || !entry->IsPersistent()) continue;
-      entries->emplace_back(i.getKey(), entry->value);
+      entries->emplace_back(i.first, entry->value);
     }
   }
-
-  // sort in name order
-  std::sort(entries->begin(), entries->end(),
-            [](const std::pair<std::string, std::shared_ptr<Value>>& a,
-               const std::pair<std::string, std::shared_ptr<Value>>& b) {
-              return a.first < b.first;
-            });
   return true;
 }
 
@@ -970,21 +1183,11 @@ bool Storage::GetEntries(
   // copy values out of storage as quickly as possible so lock isn't held
   {
     std::lock_guard<wpi::mutex> lock(m_mutex);
-    entries->reserve(m_entries.size());
-    for (auto& i : m_entries) {
-      Entry* entry = i.getValue();
-      // only write values with given prefix
-      if (!entry->value || !i.getKey().startswith(prefixStr)) continue;
-      entries->emplace_back(i.getKey(), entry->value);
-    }
+    // only write values with given prefix (in name order)
+    ForEachEntry(prefixStr, [&](Entry* entry) {
+      if (entry->value) entries->emplace_back(entry->name, entry->value);
+    });
   }
-
-  // sort in name order
-  std::sort(entries->begin(), entries->end(),
-            [](const std::pair<std::string, std::shared_ptr<Value>>& a,
-               const std::pair<std::string, std::shared_ptr<Value>>& b) {
-              return a.first < b.first;
-            });
   return true;
 }
 
@@ -996,7 +1199,7 @@ void Storage::CreateRpc(unsigned int local_id, StringRef def,
 
   auto old_value = entry->value;
   auto value = Value::MakeRpc(def);
-  entry->value = value;
+  entry->SetValue(value);
 
   // set up the RPC info
   entry->rpc_uid = rpc_uid;
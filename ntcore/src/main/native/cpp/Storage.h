@@ -13,6 +13,7 @@
 #include <atomic>
 #include <cstddef>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,9 +25,12 @@
 #include <wpi/condition_variable.h>
 #include <wpi/mutex.h>
 
+#include "AppendOnlyVector.h"
 #include "IStorage.h"
 #include "Message.h"
+#include "PersistentJournal.h"
 #include "SequenceNumber.h"
+#include "ValueHistory.h"
 #include "ntcore_cpp.h"
 
 namespace wpi {
@@ -85,12 +89,35 @@ class Storage : public IStorage {
   bool SetEntryValue(StringRef name, std::shared_ptr<Value> value);
   bool SetEntryValue(unsigned int local_id, std::shared_ptr<Value> value);
 
+  std::vector<std::shared_ptr<Value>> GetEntryValues(
+      wpi::ArrayRef<unsigned int> local_ids) const;
+  bool SetEntryValues(wpi::ArrayRef<unsigned int> local_ids,
+                      wpi::ArrayRef<std::shared_ptr<Value>> values);
+  size_t GetEntryDoubles(wpi::ArrayRef<unsigned int> local_ids,
+                         double default_value, double* values) const;
+  size_t GetEntryBooleans(wpi::ArrayRef<unsigned int> local_ids,
+                          bool default_value, bool* values) const;
+
   void SetEntryTypeValue(StringRef name, std::shared_ptr<Value> value);
   void SetEntryTypeValue(unsigned int local_id, std::shared_ptr<Value> value);
 
   void SetEntryFlags(StringRef name, unsigned int flags);
   void SetEntryFlags(unsigned int local_id, unsigned int flags);
 
+  // Send period hints (see Message::send_period()).  A per-entry hint takes
+  // precedence over prefix hints; of the prefix hints, the longest matching
+  // prefix is used.  Message::kSendDefault removes the hint.
+  void SetEntrySendPeriod(unsigned int local_id, unsigned int period);
+  void SetPrefixSendPeriod(const Twine& prefix, unsigned int period);
+  unsigned int GetEntrySendPeriod(unsigned int local_id) const;
+
+  // Value history.  A capacity of 0 disables (and discards) the history.
+  void SetEntryHistory(unsigned int local_id, size_t capacity);
+  std::shared_ptr<Value> GetEntryValueAt(unsigned int local_id,
+                                         uint64_t time) const;
+  std::vector<std::shared_ptr<Value>> GetEntryHistory(unsigned int local_id,
+                                                      uint64_t since) const;
+
   unsigned int GetEntryFlags(StringRef name) const;
   unsigned int GetEntryFlags(unsigned int local_id) const;
 
@@ -132,6 +159,15 @@ class Storage : public IStorage {
       const Twine& filename,
       std::function<void(size_t line, const char* msg)> warn) override;
 
+  // Persistent saves use the text format by default.  Loads accept either
+  // format.
+  void SetPersistentBinary(bool enabled) { m_persistent_binary = enabled; }
+
+  // Periodic persistent saves rewrite the whole file by default.  With a
+  // journal, they instead append the changed entries to a journal file, which
+  // is compacted into the persistent file in the background as it grows.
+  void SetPersistentJournal(bool enabled);
+
   const char* SaveEntries(const Twine& filename, const Twine& prefix) const;
   const char* LoadEntries(
       const Twine& filename, const Twine& prefix,
@@ -145,6 +181,12 @@ class Storage : public IStorage {
 
   void SaveEntries(wpi::raw_ostream& os, const Twine& prefix) const;
 
+  void SavePersistentBinary(wpi::raw_ostream& os, bool periodic) const;
+  bool LoadEntriesBinary(
+      StringRef data, const Twine& prefix, bool persistent,
+      std::function<void(size_t line, const char* msg)> warn);
+  static bool IsBinaryFormat(StringRef data);
+
   // RPC configuration needs to come through here as RPC definitions are
   // actually special Storage value types.
   void CreateRpc(unsigned int local_id, StringRef def, unsigned int rpc_uid);
@@ -165,10 +207,34 @@ class Storage : public IStorage {
     // raw Entry* via the ID map.
     std::string name;
 
-    // The current value and flags.
+    // The current value and flags.  The value may be read without holding
+    // m_mutex (see LoadValue()), so it must only be changed via SetValue()
+    // or ExchangeValue() (with m_mutex held).
     std::shared_ptr<Value> value;
     unsigned int flags{0};
 
+    std::shared_ptr<Value> LoadValue() const {
+      return std::atomic_load(&value);
+    }
+    void SetValue(std::shared_ptr<Value> value_) {
+      AddHistory(value_);
+      std::atomic_store(&value, std::move(value_));
+    }
+    std::shared_ptr<Value> ExchangeValue(std::shared_ptr<Value> value_) {
+      AddHistory(value_);
+      return std::atomic_exchange(&value, std::move(value_));
+    }
+    void AddHistory(const std::shared_ptr<Value>& value_) {
+      if (!history) return;
+      if (value_)
+        history->Add(value_);
+      else
+        history->AddDeleted(Now());
+    }
+
+    // Value history, if enabled (see SetEntryHistory()).
+    std::unique_ptr<ValueHistory> history;
+
     // Unique ID for this entry as used in network messages.  The value is
     // assigned by the server, so on the client this is 0xffff until an
     // entry assignment is received back from the server.
@@ -184,6 +250,14 @@ class Storage : public IStorage {
     // on client to determine whether or not to accept remote changes.
     bool local_write{false};
 
+    // Send period hint for outgoing messages, and whether it was set for
+    // this entry specifically (rather than from a prefix hint).
+    unsigned int send_period{Message::kSendDefault};
+    bool send_period_set{false};
+
+    // If this entry is in m_persistent_changes.
+    bool persistent_changed{false};
+
     // RPC handle.
     unsigned int rpc_uid{UINT_MAX};
 
@@ -193,20 +267,34 @@ class Storage : public IStorage {
   };
 
   typedef wpi::StringMap<Entry*> EntriesMap;
+  // Entries sorted by name, so prefix queries only visit matching entries.
+  // Keys refer to Entry::name; entries are never freed.
+  typedef std::map<StringRef, Entry*> EntriesIndex;
   typedef std::vector<Entry*> IdMap;
-  typedef std::vector<std::unique_ptr<Entry>> LocalMap;
+  // The local map is append-only, so lookups by local id (the common case from
+  // user code) can be done without taking m_mutex.
+  typedef AppendOnlyVector<std::unique_ptr<Entry>> LocalMap;
   typedef std::pair<unsigned int, unsigned int> RpcIdPair;
   typedef wpi::DenseMap<RpcIdPair, std::string> RpcResultMap;
   typedef wpi::SmallSet<RpcIdPair, 12> RpcBlockingCallSet;
 
   mutable wpi::mutex m_mutex;
   EntriesMap m_entries;
+  EntriesIndex m_entries_index;
   IdMap m_idmap;
   LocalMap m_localmap;
   RpcResultMap m_rpc_results;
   RpcBlockingCallSet m_rpc_blocking_calls;
+  // Prefix send period hints
+  std::vector<std::pair<std::string, unsigned int>> m_send_periods;
   // If any persistent values have changed
   mutable bool m_persistent_dirty = false;
+  // If persistent saves use the binary format
+  std::atomic_bool m_persistent_binary{false};
+  // If periodic persistent saves use a journal, and the entries that have
+  // changed since the last save (only tracked when using a journal)
+  std::atomic_bool m_persistent_journal{false};
+  mutable std::vector<Entry*> m_persistent_changes;
 
   // condition variable and termination flag for blocking on a RPC result
   std::atomic_bool m_terminating;
@@ -220,6 +308,10 @@ class Storage : public IStorage {
   IRpcServer& m_rpc_server;
   wpi::Logger& m_logger;
 
+  // Serializes journaled saves with enabling and disabling the journal
+  mutable wpi::mutex m_journal_mutex;
+  mutable PersistentJournal m_journal;
+
   void ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
                                   INetworkConnection* conn);
   void ProcessIncomingEntryUpdate(std::shared_ptr<Message> msg,
@@ -236,6 +328,30 @@ class Storage : public IStorage {
   void ProcessIncomingRpcResponse(std::shared_ptr<Message> msg,
                                   INetworkConnection* conn);
 
+  static bool ParseText(
+      wpi::raw_istream& is, StringRef prefix,
+      std::function<void(size_t line, const char* msg)> warn,
+      std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries);
+  static bool ParseBinary(
+      StringRef data, StringRef prefix, bool deletes,
+      std::function<void(size_t line, const char* msg)> warn,
+      std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries);
+  const char* SavePersistentJournal(StringRef filename, bool periodic) const;
+  void ApplyJournal(
+      const Twine& filename, StringRef prefix,
+      std::function<void(size_t line, const char* msg)> warn,
+      std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries);
+  const char* LoadEntriesFile(
+      const Twine& filename, const Twine& prefix, bool persistent,
+      std::function<void(size_t line, const char* msg)> warn);
+  static void SaveBinary(
+      wpi::raw_ostream& os,
+      wpi::ArrayRef<std::pair<std::string, std::shared_ptr<Value>>> entries);
+  void LoadEntriesImpl(
+      const std::vector<std::pair<std::string, std::shared_ptr<Value>>>&
+          entries,
+      bool persistent);
+
   bool GetPersistentEntries(
       bool periodic,
       std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries)
@@ -245,6 +361,10 @@ class Storage : public IStorage {
                       entries) const;
   void SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
                          std::unique_lock<wpi::mutex>& lock, bool local);
+  // Must be called with m_mutex held; returns the message to send, if any
+  std::shared_ptr<Message> UpdateEntryValue(Entry* entry,
+                                            std::shared_ptr<Value> value,
+                                            bool local);
   void SetEntryFlagsImpl(Entry* entry, unsigned int flags,
                          std::unique_lock<wpi::mutex>& lock, bool local);
   void DeleteEntryImpl(Entry* entry, std::unique_lock<wpi::mutex>& lock,
@@ -254,7 +374,20 @@ class Storage : public IStorage {
   template <typename F>
   void DeleteAllEntriesImpl(bool local, F should_delete);
   void DeleteAllEntriesImpl(bool local);
+  // Returns nullptr (without creating it) if there are too many entries
   Entry* GetOrNew(const Twine& name);
+
+  // Call func for each entry whose name starts with prefix, in name order.
+  template <typename F>
+  void ForEachEntry(StringRef prefix, F func) const {
+    for (auto i = m_entries_index.lower_bound(prefix);
+         i != m_entries_index.end() && i->first.startswith(prefix); ++i)
+      func(i->second);
+  }
+
+  // Must be called with m_mutex held
+  void MarkPersistentDirty(Entry* entry);
+  unsigned int GetPrefixSendPeriod(StringRef name) const;
 };
 
 }  // namespace nt
@@ -0,0 +1,434 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <wpi/FileSystem.h>
+#include <wpi/SmallString.h>
+#include <wpi/SmallVector.h>
+#include <wpi/raw_istream.h>
+#include <wpi/raw_ostream.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Log.h"
+#include "Storage.h"
+
+using namespace nt;
+
+// Binary persistent file layout.  All integers are little endian.
+//
+//   header (24 bytes):
+//     magic        4 bytes: 0x89 'N' 'T' 'B'
+//     version      u32
+//     count        u32 number of entries
+//     crc          u32 CRC-32 of the entry data
+//     length       u64 length of the entry data
+//   entry data (count entries):
+//     type         u8 (NT_Type); NT_UNASSIGNED (with an empty value) is used
+//                  by the persistent journal to record a deleted entry
+//     name         u32 length, then bytes
+//     value        u32 length, then value bytes (so unknown types can be
+//                  skipped):
+//       boolean      u8
+//       double       IEEE 754 double (as u64)
+//       string/raw   bytes
+//       arrays       u32 element count, then elements encoded as above;
+//                    array string elements are prefixed by u32 length
+static constexpr char kBinaryMagic[4] = {'\x89', 'N', 'T', 'B'};
+static constexpr uint32_t kBinaryVersion = 1;
+static constexpr size_t kBinaryHeaderSize = 24;
+
+static uint32_t Crc32(StringRef data) {
+  static const auto table = [] {
+    std::vector<uint32_t> t(256);
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      t[i] = c;
+    }
+    return t;
+  }();
+  uint32_t crc = 0xffffffff;
+  for (unsigned char c : data) crc = table[(crc ^ c) & 0xff] ^ (crc >> 8);
+  return crc ^ 0xffffffff;
+}
+
+static void Write32(wpi::SmallVectorImpl<char>& buf, uint32_t val) {
+  for (int i = 0; i < 4; ++i) buf.push_back(static_cast<char>(val >> (8 * i)));
+}
+
+static void Write64(wpi::SmallVectorImpl<char>& buf, uint64_t val) {
+  for (int i = 0; i < 8; ++i) buf.push_back(static_cast<char>(val >> (8 * i)));
+}
+
+static void Put32(char* buf, uint32_t val) {
+  for (int i = 0; i < 4; ++i) buf[i] = static_cast<char>(val >> (8 * i));
+}
+
+static void Put64(char* buf, uint64_t val) {
+  for (int i = 0; i < 8; ++i) buf[i] = static_cast<char>(val >> (8 * i));
+}
+
+static uint32_t Get32(const char* buf) {
+  uint32_t val = 0;
+  for (int i = 3; i >= 0; --i)
+    val = (val << 8) | static_cast<unsigned char>(buf[i]);
+  return val;
+}
+
+static uint64_t Get64(const char* buf) {
+  uint64_t val = 0;
+  for (int i = 7; i >= 0; --i)
+    val = (val << 8) | static_cast<unsigned char>(buf[i]);
+  return val;
+}
+
+static void WriteDouble(wpi::SmallVectorImpl<char>& buf, double val) {
+  uint64_t v;
+  std::memcpy(&v, &val, sizeof(v));
+  Write64(buf, v);
+}
+
+static double GetDouble(const char* buf) {
+  uint64_t v = Get64(buf);
+  double val;
+  std::memcpy(&val, &v, sizeof(val));
+  return val;
+}
+
+static void WriteString(wpi::SmallVectorImpl<char>& buf, StringRef str) {
+  Write32(buf, str.size());
+  buf.append(str.begin(), str.end());
+}
+
+namespace {
+
+class SaveBinaryImpl {
+ public:
+  typedef std::pair<std::string, std::shared_ptr<Value>> Entry;
+
+  explicit SaveBinaryImpl(wpi::raw_ostream& os) : m_os(os) {}
+
+  void Save(wpi::ArrayRef<Entry> entries);
+
+ private:
+  void WriteValue(const Value& value);
+
+  wpi::raw_ostream& m_os;
+  wpi::SmallVector<char, 4096> m_buf;
+};
+
+class LoadBinaryImpl {
+ public:
+  typedef std::pair<std::string, std::shared_ptr<Value>> Entry;
+  typedef std::function<void(size_t line, const char* msg)> WarnFunc;
+
+  LoadBinaryImpl(StringRef data, bool deletes, WarnFunc warn)
+      : m_data(data), m_deletes(deletes), m_warn(warn) {}
+
+  bool Load(StringRef prefix, std::vector<Entry>* entries);
+
+ private:
+  std::shared_ptr<Value> ReadValue(NT_Type type, StringRef data);
+
+  void Warn(const char* msg) {
+    if (m_warn) m_warn(m_entry_num, msg);
+  }
+
+  StringRef m_data;
+  bool m_deletes;
+  WarnFunc m_warn;
+  size_t m_entry_num = 0;
+};
+
+}  // namespace
+
+void SaveBinaryImpl::Save(wpi::ArrayRef<Entry> entries) {
+  // reserve space for the header; filled in once the data is written
+  m_buf.resize(kBinaryHeaderSize);
+  uint32_t count = 0;
+  for (auto& i : entries) {
+    if (!i.second) {
+      // deleted entry
+      m_buf.push_back(static_cast<char>(NT_UNASSIGNED));
+      WriteString(m_buf, i.first);
+      Write32(m_buf, 0);
+      ++count;
+      continue;
+    }
+    switch (i.second->type()) {
+      case NT_BOOLEAN:
+      case NT_DOUBLE:
+      case NT_STRING:
+      case NT_RAW:
+      case NT_BOOLEAN_ARRAY:
+      case NT_DOUBLE_ARRAY:
+      case NT_STRING_ARRAY:
+        break;
+      default:
+        continue;
+    }
+    m_buf.push_back(static_cast<char>(i.second->type()));
+    WriteString(m_buf, i.first);
+    WriteValue(*i.second);
+    ++count;
+  }
+
+  StringRef data(m_buf.data() + kBinaryHeaderSize,
+                 m_buf.size() - kBinaryHeaderSize);
+  char* header = m_buf.data();
+  std::memcpy(header, kBinaryMagic, sizeof(kBinaryMagic));
+  Put32(header + 4, kBinaryVersion);
+  Put32(header + 8, count);
+  Put32(header + 12, Crc32(data));
+  Put64(header + 16, data.size());
+  m_os << StringRef(m_buf.data(), m_buf.size());
+}
+
+void SaveBinaryImpl::WriteValue(const Value& value) {
+  // value length is filled in after the value is written
+  size_t start = m_buf.size();
+  Write32(m_buf, 0);
+  switch (value.type()) {
+    case NT_BOOLEAN:
+      m_buf.push_back(value.GetBoolean() ? 1 : 0);
+      break;
+    case NT_DOUBLE:
+      WriteDouble(m_buf, value.GetDouble());
+      break;
+    case NT_STRING:
+      m_buf.append(value.GetString().begin(), value.GetString().end());
+      break;
+    case NT_RAW:
+      m_buf.append(value.GetRaw().begin(), value.GetRaw().end());
+      break;
+    case NT_BOOLEAN_ARRAY:
+      Write32(m_buf, value.GetBooleanArray().size());
+      for (auto elem : value.GetBooleanArray()) m_buf.push_back(elem ? 1 : 0);
+      break;
+    case NT_DOUBLE_ARRAY:
+      Write32(m_buf, value.GetDoubleArray().size());
+      for (auto elem : value.GetDoubleArray()) WriteDouble(m_buf, elem);
+      break;
+    case NT_STRING_ARRAY:
+      Write32(m_buf, value.GetStringArray().size());
+      for (auto& elem : value.GetStringArray()) WriteString(m_buf, elem);
+      break;
+    default:
+      break;
+  }
+  Put32(m_buf.data() + start, m_buf.size() - start - 4);
+}
+
+bool LoadBinaryImpl::Load(StringRef prefix, std::vector<Entry>* entries) {
+  if (m_data.size() < kBinaryHeaderSize ||
+      std::memcmp(m_data.data(), kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+    Warn("binary header mismatch");
+    return false;
+  }
+  const char* header = m_data.data();
+  if (Get32(header + 4) != kBinaryVersion) {
+    Warn("unsupported binary format version");
+    return false;
+  }
+  uint32_t count = Get32(header + 8);
+  uint64_t len = Get64(header + 16);
+  StringRef data = m_data.drop_front(kBinaryHeaderSize);
+  if (len != data.size()) {
+    Warn("binary file truncated");
+    return false;
+  }
+  if (Crc32(data) != Get32(header + 12)) {
+    Warn("binary file checksum mismatch");
+    return false;
+  }
+
+  entries->reserve(entries->size() + count);
+  for (m_entry_num = 1; m_entry_num <= count; ++m_entry_num) {
+    // type and name length
+    if (data.size() < 5) {
+      Warn("unexpected end of file");
+      return false;
+    }
+    NT_Type type = static_cast<NT_Type>(static_cast<unsigned char>(data[0]));
+    size_t name_len = Get32(data.data() + 1);
+    data = data.drop_front(5);
+
+    // name and value length (name_len + 4 could wrap on 32-bit)
+    if (data.size() < 4 || name_len > data.size() - 4) {
+      Warn("unexpected end of file");
+      return false;
+    }
+    StringRef name = data.substr(0, name_len);
+    size_t value_len = Get32(data.data() + name_len);
+    data = data.drop_front(name_len + 4);
+
+    // value
+    if (data.size() < value_len) {
+      Warn("unexpected end of file");
+      return false;
+    }
+    StringRef value_data = data.substr(0, value_len);
+    data = data.drop_front(value_len);
+
+    if (name.empty() || !name.startswith(prefix)) continue;
+    if (type == NT_UNASSIGNED && m_deletes) {
+      entries->emplace_back(name, nullptr);
+      continue;
+    }
+    auto value = ReadValue(type, value_data);
+    if (value) entries->emplace_back(name, std::move(value));
+  }
+  return true;
+}
+
+std::shared_ptr<Value> LoadBinaryImpl::ReadValue(NT_Type type,
+                                                 StringRef data) {
+  switch (type) {
+    case NT_BOOLEAN:
+      if (data.size() != 1) break;
+      return Value::MakeBoolean(data[0] != 0);
+    case NT_DOUBLE:
+      if (data.size() != 8) break;
+      return Value::MakeDouble(GetDouble(data.data()));
+    case NT_STRING:
+      return Value::MakeString(data);
+    case NT_RAW:
+      return Value::MakeRaw(data);
+    case NT_BOOLEAN_ARRAY: {
+      if (data.size() < 4) break;
+      size_t size = Get32(data.data());
+      if (data.size() - 4 != size) break;
+      std::vector<int> arr;
+      arr.reserve(size);
+      for (size_t i = 0; i < size; ++i) arr.push_back(data[4 + i] != 0);
+      return Value::MakeBooleanArray(std::move(arr));
+    }
+    case NT_DOUBLE_ARRAY: {
+      if (data.size() < 4) break;
+      size_t size = Get32(data.data());
+      if ((data.size() - 4) / 8 != size || (data.size() - 4) % 8 != 0) break;
+      std::vector<double> arr;
+      arr.reserve(size);
+      for (size_t i = 0; i < size; ++i)
+        arr.push_back(GetDouble(data.data() + 4 + 8 * i));
+      return Value::MakeDoubleArray(std::move(arr));
+    }
+    case NT_STRING_ARRAY: {
+      if (data.size() < 4) break;
+      size_t size = Get32(data.data());
+      data = data.drop_front(4);
+      std::vector<std::string> arr;
+      arr.reserve(size);
+      for (size_t i = 0; i < size; ++i) {
+        if (data.size() < 4) break;
+        size_t len = Get32(data.data());
+        if (data.size() - 4 < len) break;
+        arr.emplace_back(data.substr(4, len));
+        data = data.drop_front(4 + len);
+      }
+      if (arr.size() != size || !data.empty()) break;
+      return Value::MakeStringArray(std::move(arr));
+    }
+    default:
+      Warn("unrecognized type");
+      return nullptr;
+  }
+  Warn("invalid value");
+  return nullptr;
+}
+
+void Storage::SaveBinary(
+    wpi::raw_ostream& os,
+    wpi::ArrayRef<std::pair<std::string, std::shared_ptr<Value>>> entries) {
+  SaveBinaryImpl(os).Save(entries);
+}
+
+void Storage::SavePersistentBinary(wpi::raw_ostream& os, bool periodic) const {
+  std::vector<SaveBinaryImpl::Entry> entries;
+  if (!GetPersistentEntries(periodic, &entries)) return;
+  SaveBinaryImpl(os).Save(entries);
+}
+
+bool Storage::LoadEntriesBinary(
+    StringRef data, const Twine& prefix, bool persistent,
+    std::function<void(size_t line, const char* msg)> warn) {
+  wpi::SmallString<128> prefixBuf;
+  StringRef prefixStr = prefix.toStringRef(prefixBuf);
+
+  std::vector<LoadBinaryImpl::Entry> entries;
+  if (!ParseBinary(data, prefixStr, false, warn, &entries)) return false;
+  LoadEntriesImpl(entries, persistent);
+  return true;
+}
+
+bool Storage::ParseBinary(
+    StringRef data, StringRef prefix, bool deletes,
+    std::function<void(size_t line, const char* msg)> warn,
+    std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries) {
+  return LoadBinaryImpl(data, deletes, warn).Load(prefix, entries);
+}
+
+bool Storage::IsBinaryFormat(StringRef data) {
+  return data.startswith(StringRef(kBinaryMagic, sizeof(kBinaryMagic)));
+}
+
+const char* Storage::LoadEntriesFile(
+    const Twine& filename, const Twine& prefix, bool persistent,
+    std::function<void(size_t line, const char* msg)> warn) {
+  wpi::SmallString<128> prefixBuf;
+  StringRef prefixStr = prefix.toStringRef(prefixBuf);
+
+  int fd;
+  if (wpi::sys::fs::openFileForRead(filename, fd)) return "could not open file";
+  wpi::sys::fs::file_status status;
+  if (wpi::sys::fs::status(fd, status)) {
+    ::close(fd);
+    return "could not open file";
+  }
+
+  // map the whole file; both formats are parsed straight out of the mapping
+  std::unique_ptr<wpi::sys::fs::mapped_file_region> region;
+  StringRef data;
+  if (status.getSize() > 0) {
+    std::error_code ec;
+    region.reset(new wpi::sys::fs::mapped_file_region(
+        fd, wpi::sys::fs::mapped_file_region::readonly, status.getSize(), 0,
+        ec));
+    if (ec) {
+      ::close(fd);
+      return "could not read file";
+    }
+    data = StringRef(region->const_data(), region->size());
+  }
+  ::close(fd);
+
+  std::vector<LoadBinaryImpl::Entry> entries;
+  if (IsBinaryFormat(data)) {
+    if (!ParseBinary(data, prefixStr, false, warn, &entries))
+      return "error reading file";
+  } else {
+    wpi::raw_mem_istream is(data.data(), data.size());
+    if (!ParseText(is, prefixStr, warn, &entries)) return "error reading file";
+  }
+
+  // apply changes journaled since the persistent file was written
+  if (persistent) ApplyJournal(filename, prefixStr, warn, &entries);
+
+  LoadEntriesImpl(entries, persistent);
+  return nullptr;
+}
@@ -5,12 +5,14 @@
 /* the project.                                                               */
 /*----------------------------------------------------------------------------*/
 
+#include <algorithm>
 #include <cctype>
 #include <string>
 
 #include <wpi/Base64.h>
 #include <wpi/SmallString.h>
 #include <wpi/StringExtras.h>
+#include <wpi/StringMap.h>
 #include <wpi/raw_istream.h>
 
 #include "IDispatcher.h"
@@ -366,17 +368,71 @@ bool Storage::LoadEntries(
   std::vector<LoadPersistentImpl::Entry> entries;
 
   // load file
-  if (!LoadPersistentImpl(is, warn).Load(prefixStr, &entries)) return false;
+  if (!ParseText(is, prefixStr, warn, &entries)) return false;
+  LoadEntriesImpl(entries, persistent);
+  return true;
+}
+
+bool Storage::ParseText(
+    wpi::raw_istream& is, StringRef prefix,
+    std::function<void(size_t line, const char* msg)> warn,
+    std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries) {
+  return LoadPersistentImpl(is, warn).Load(prefix, entries);
+}
 
+void Storage::ApplyJournal(
+    const Twine& filename, StringRef prefix,
+    std::function<void(size_t line, const char* msg)> warn,
+    std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries) {
+  wpi::StringMap<size_t> index;
+  for (size_t i = 0; i < entries->size(); ++i)
+    index[(*entries)[i].first] = i;
+
+  // journal blocks are binary; a null value means the entry was deleted
+  size_t block_num = 0;
+  std::vector<LoadPersistentImpl::Entry> changes;
+  PersistentJournal::Read(filename, [&](StringRef block) {
+    ++block_num;
+    changes.clear();
+    if (!ParseBinary(block, prefix, true, nullptr, &changes)) {
+      if (warn) warn(block_num, "ignoring corrupt journal block");
+      return false;
+    }
+    for (auto& change : changes) {
+      auto it = index.find(change.first);
+      if (it != index.end()) {
+        (*entries)[it->second].second = std::move(change.second);
+      } else if (change.second) {
+        index[change.first] = entries->size();
+        entries->emplace_back(std::move(change));
+      }
+    }
+    return true;
+  });
+
+  entries->erase(std::remove_if(entries->begin(), entries->end(),
+                                [](const LoadPersistentImpl::Entry& entry) {
+                                  return !entry.second;
+                                }),
+                 entries->end());
+}
+
+void Storage::LoadEntriesImpl(
+    const std::vector<std::pair<std::string, std::shared_ptr<Value>>>& entries,
+    bool persistent) {
   // copy values into storage as quickly as possible so lock isn't held
   std::vector<std::shared_ptr<Message>> msgs;
   std::unique_lock<wpi::mutex> lock(m_mutex);
   for (auto& i : entries) {
     Entry* entry = GetOrNew(i.first);
+    if (!entry) continue;
     auto old_value = entry->value;
-    entry->value = i.second;
+    entry->SetValue(i.second);
     bool was_persist = entry->IsPersistent();
     if (!was_persist && persistent) entry->flags |= NT_PERSISTENT;
+    if (was_persist && !persistent &&
+        (!old_value || *old_value != *i.second))
+      MarkPersistentDirty(entry);
 
     // if we're the server, assign an id if it doesn't have one
     if (m_server && entry->id == 0xffff) {
@@ -424,26 +480,16 @@ bool Storage::LoadEntries(
     for (auto& msg : msgs)
       dispatcher->QueueOutgoing(std::move(msg), nullptr, nullptr);
   }
-
-  return true;
 }
 
 const char* Storage::LoadPersistent(
     const Twine& filename,
     std::function<void(size_t line, const char* msg)> warn) {
-  std::error_code ec;
-  wpi::raw_fd_istream is(filename, ec);
-  if (ec.value() != 0) return "could not open file";
-  if (!LoadEntries(is, "", true, warn)) return "error reading file";
-  return nullptr;
+  return LoadEntriesFile(filename, "", true, warn);
 }
 
 const char* Storage::LoadEntries(
     const Twine& filename, const Twine& prefix,
     std::function<void(size_t line, const char* msg)> warn) {
-  std::error_code ec;
-  wpi::raw_fd_istream is(filename, ec);
-  if (ec.value() != 0) return "could not open file";
-  if (!LoadEntries(is, prefix, false, warn)) return "error reading file";
-  return nullptr;
+  return LoadEntriesFile(filename, prefix, false, warn);
 }
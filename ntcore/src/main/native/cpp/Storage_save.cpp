@@ -185,6 +185,11 @@ const char* Storage::SavePersistent(const Twine& filename,
                                     bool periodic) const {
   wpi::SmallString<128> fn;
   filename.toVector(fn);
+  {
+    std::lock_guard<wpi::mutex> lock(m_journal_mutex);
+    if (m_persistent_journal && (periodic || m_journal.IsJournaling(fn)))
+      return SavePersistentJournal(fn, periodic);
+  }
   wpi::SmallString<128> tmp = fn;
   tmp += ".tmp";
   wpi::SmallString<128> bak = fn;
@@ -197,19 +202,26 @@ const char* Storage::SavePersistent(const Twine& filename,
   const char* err = nullptr;
 
   // start by writing to temporary file
-  std::error_code ec;
-  wpi::raw_fd_ostream os(tmp, ec, wpi::sys::fs::F_Text);
-  if (ec.value() != 0) {
-    err = "could not open file";
-    goto done;
-  }
-  DEBUG("saving persistent file '" << filename << "'");
-  SavePersistentImpl(os).Save(entries);
-  os.close();
-  if (os.has_error()) {
-    std::remove(tmp.c_str());
-    err = "error saving file";
-    goto done;
+  {
+    bool binary = m_persistent_binary;
+    std::error_code ec;
+    wpi::raw_fd_ostream os(
+        tmp, ec, binary ? wpi::sys::fs::F_None : wpi::sys::fs::F_Text);
+    if (ec.value() != 0) {
+      err = "could not open file";
+      goto done;
+    }
+    DEBUG("saving persistent file '" << filename << "'");
+    if (binary)
+      SaveBinary(os, entries);
+    else
+      SavePersistentImpl(os).Save(entries);
+    os.close();
+    if (os.has_error()) {
+      std::remove(tmp.c_str());
+      err = "error saving file";
+      goto done;
+    }
   }
 
   // Safely move to real file.  We ignore any failures related to the backup.
@@ -221,12 +233,95 @@ const char* Storage::SavePersistent(const Twine& filename,
     goto done;
   }
 
+  // a full save supersedes any journal
+  std::remove(PersistentJournal::GetFilename(fn).c_str());
+
 done:
   // try again if there was an error
   if (err && periodic) m_persistent_dirty = true;
   return err;
 }
 
+void Storage::SetPersistentJournal(bool enabled) {
+  // wait for any save in progress so it can't reopen a closed journal
+  std::lock_guard<wpi::mutex> lock(m_journal_mutex);
+  m_persistent_journal = enabled;
+  if (enabled) return;
+  m_journal.Close();
+  std::lock_guard<wpi::mutex> entries_lock(m_mutex);
+  for (auto entry : m_persistent_changes) entry->persistent_changed = false;
+  m_persistent_changes.clear();
+}
+
+const char* Storage::SavePersistentJournal(StringRef filename,
+                                           bool periodic) const {
+  // periodic saves try again later rather than waiting for compaction
+  if (m_journal.busy()) {
+    if (periodic) return nullptr;
+    m_journal.Wait();
+  }
+
+  // Get changes (and all entries, if compacting) as quickly as possible so
+  // lock isn't held
+  std::vector<SavePersistentImpl::Entry> changes;
+  std::vector<SavePersistentImpl::Entry> entries;
+  bool compact;
+  {
+    std::lock_guard<wpi::mutex> lock(m_mutex);
+    // for periodic, don't re-save unless something has changed
+    if (periodic && !m_persistent_dirty) return nullptr;
+    m_persistent_dirty = false;
+    compact = !periodic || !m_journal.CanAppend(filename);
+
+    // a null value records that the entry is no longer persistent
+    changes.reserve(m_persistent_changes.size());
+    for (auto entry : m_persistent_changes) {
+      entry->persistent_changed = false;
+      if (entry->value && entry->IsPersistent())
+        changes.emplace_back(entry->name, entry->value);
+      else
+        changes.emplace_back(entry->name, nullptr);
+    }
+    m_persistent_changes.clear();
+
+    if (compact) {
+      entries.reserve(m_entries.size());
+      for (auto& i : m_entries_index) {
+        Entry* entry = i.second;
+        if (!entry->value || !entry->IsPersistent()) continue;
+        entries.emplace_back(i.first, entry->value);
+      }
+    }
+  }
+
+  std::string block;
+  if (!changes.empty()) {
+    wpi::raw_string_ostream os(block);
+    SaveBinary(os, changes);
+  }
+
+  const char* err;
+  if (compact) {
+    bool binary = m_persistent_binary;
+    err = m_journal.Compact(
+        filename, block,
+        [binary, entries](wpi::raw_ostream& os) {
+          if (binary)
+            SaveBinary(os, entries);
+          else
+            SavePersistentImpl(os).Save(entries);
+        },
+        !periodic);
+  } else {
+    DEBUG("appending " << changes.size() << " changes to persistent journal");
+    err = m_journal.Append(filename, block);
+  }
+
+  // try again if there was an error; the journal will be compacted
+  if (err && periodic) m_persistent_dirty = true;
+  return err;
+}
+
 void Storage::SaveEntries(wpi::raw_ostream& os, const Twine& prefix) const {
   std::vector<SavePersistentImpl::Entry> entries;
   if (!GetEntries(prefix, &entries)) return;
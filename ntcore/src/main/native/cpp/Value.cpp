@@ -10,6 +10,7 @@
 #include <wpi/memory.h>
 #include <wpi/timestamp.h>
 
+#include "PoolAllocator.h"
 #include "Value_internal.h"
 #include "networktables/NetworkTableValue.h"
 
@@ -43,6 +44,22 @@ Value::~Value() {
     delete[] m_val.data.arr_string.arr;
 }
 
+// Scalar values are created at high rates (e.g. telemetry published every
+// loop iteration), so they are allocated from a pool rather than the heap.
+std::shared_ptr<Value> Value::MakeBoolean(bool value, uint64_t time) {
+  auto val = std::allocate_shared<Value>(PoolAllocator<Value>(), NT_BOOLEAN,
+                                         time, private_init());
+  val->m_val.data.v_boolean = value;
+  return val;
+}
+
+std::shared_ptr<Value> Value::MakeDouble(double value, uint64_t time) {
+  auto val = std::allocate_shared<Value>(PoolAllocator<Value>(), NT_DOUBLE,
+                                         time, private_init());
+  val->m_val.data.v_double = value;
+  return val;
+}
+
 std::shared_ptr<Value> Value::MakeBooleanArray(wpi::ArrayRef<bool> value,
                                                uint64_t time) {
   auto val = std::make_shared<Value>(NT_BOOLEAN_ARRAY, time, private_init());
@@ -0,0 +1,126 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include "ValueHistory.h"
+
+#include <algorithm>
+
+using namespace nt;
+
+size_t ValueHistory::size() const {
+  if (m_numeric) return m_numeric->size();
+  if (m_values) return m_values->size();
+  return 0;
+}
+
+void ValueHistory::set_capacity(size_t capacity) {
+  m_capacity = capacity;
+  if (m_numeric) m_numeric->set_capacity(capacity);
+  if (m_values) m_values->set_capacity(capacity);
+}
+
+void ValueHistory::Add(const std::shared_ptr<Value>& value) {
+  if (!value) return;
+  if (value->type() != m_type) {
+    // switch buffers, releasing the old one
+    m_type = value->type();
+    if (IsNumeric(m_type)) {
+      m_values.reset();
+      if (m_numeric)
+        m_numeric->clear();
+      else
+        m_numeric.reset(new RingQueue<NumericSample>(m_capacity));
+    } else {
+      m_numeric.reset();
+      if (m_values)
+        m_values->clear();
+      else
+        m_values.reset(new RingQueue<ValueSample>(m_capacity));
+    }
+  }
+  uint64_t time = std::max(value->time(), m_last_time);
+  m_last_time = time;
+
+  if (m_numeric) {
+    if (m_numeric->full()) m_numeric->pop();
+    m_numeric->emplace(time,
+                       m_type == NT_BOOLEAN ? (value->GetBoolean() ? 1.0 : 0.0)
+                                            : value->GetDouble(),
+                       false);
+  } else {
+    if (m_values->full()) m_values->pop();
+    m_values->emplace(time, value);
+  }
+}
+
+void ValueHistory::AddDeleted(uint64_t time) {
+  time = std::max(time, m_last_time);
+  m_last_time = time;
+  if (m_numeric) {
+    if (m_numeric->full()) m_numeric->pop();
+    m_numeric->emplace(time, 0.0, true);
+  } else if (m_values) {
+    if (m_values->full()) m_values->pop();
+    m_values->emplace(time, nullptr);
+  }
+  // otherwise there were no values, so there's nothing to record
+}
+
+std::shared_ptr<Value> ValueHistory::GetAt(uint64_t time) const {
+  if (m_numeric) {
+    size_t i = Find(*m_numeric, time, false);
+    if (i == 0) return nullptr;
+    return MakeValue((*m_numeric)[i - 1]);
+  } else if (m_values) {
+    size_t i = Find(*m_values, time, false);
+    if (i == 0) return nullptr;
+    return (*m_values)[i - 1].value;
+  }
+  return nullptr;
+}
+
+std::vector<std::shared_ptr<Value>> ValueHistory::GetSince(
+    uint64_t since) const {
+  std::vector<std::shared_ptr<Value>> values;
+  if (m_numeric) {
+    size_t i = Find(*m_numeric, since, true);
+    values.reserve(m_numeric->size() - i);
+    for (; i < m_numeric->size(); ++i)
+      values.emplace_back(MakeValue((*m_numeric)[i]));
+  } else if (m_values) {
+    size_t i = Find(*m_values, since, true);
+    values.reserve(m_values->size() - i);
+    for (; i < m_values->size(); ++i)
+      values.emplace_back((*m_values)[i].value);
+  }
+  return values;
+}
+
+std::shared_ptr<Value> ValueHistory::MakeValue(
+    const NumericSample& sample) const {
+  if (sample.deleted) return nullptr;
+  if (m_type == NT_BOOLEAN)
+    return Value::MakeBoolean(sample.value != 0, sample.time);
+  return Value::MakeDouble(sample.value, sample.time);
+}
+
+template <typename T>
+size_t ValueHistory::Find(const RingQueue<T>& samples, uint64_t time,
+                          bool inclusive) {
+  // binary search; samples are in time order
+  size_t lo = 0;
+  size_t hi = samples.size();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    uint64_t t = samples[mid].time;
+    if (t < time || (!inclusive && t == time))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
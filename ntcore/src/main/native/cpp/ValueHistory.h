@@ -0,0 +1,90 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NTCORE_VALUEHISTORY_H_
+#define NTCORE_VALUEHISTORY_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "RingQueue.h"
+#include "networktables/NetworkTableValue.h"
+
+namespace nt {
+
+// Fixed-capacity history of the values of an entry, oldest first.
+//
+// Boolean and double samples are stored as just a time and a double, so
+// recording them doesn't allocate or keep the Value alive.  Other types keep
+// a reference to the Value.  Only the buffer for the entry's current type is
+// allocated; if the type of the entry changes, the history is cleared and
+// the other buffer is used.  Deleting the entry is recorded as a sample with
+// no value.
+//
+// Samples are expected to be added in time order; a sample older than the
+// previous one is recorded with the previous sample's time.  Not
+// thread-safe.
+class ValueHistory {
+ public:
+  explicit ValueHistory(size_t capacity) : m_capacity(capacity) {}
+
+  size_t size() const;
+  size_t capacity() const { return m_capacity; }
+  void set_capacity(size_t capacity);
+
+  void Add(const std::shared_ptr<Value>& value);
+  // Records that the entry was deleted at time.
+  void AddDeleted(uint64_t time);
+
+  // Returns the value in effect at time (the latest sample at or before it),
+  // or nullptr if there is no such sample or the entry was deleted.
+  std::shared_ptr<Value> GetAt(uint64_t time) const;
+
+  // Returns all samples at or after since, oldest first.  Deletions are
+  // returned as nullptr.
+  std::vector<std::shared_ptr<Value>> GetSince(uint64_t since) const;
+
+ private:
+  struct NumericSample {
+    NumericSample(uint64_t time_, double value_, bool deleted_)
+        : time(time_), value(value_), deleted(deleted_) {}
+    uint64_t time;
+    double value;
+    bool deleted;
+  };
+  struct ValueSample {
+    ValueSample(uint64_t time_, std::shared_ptr<Value> value_)
+        : time(time_), value(std::move(value_)) {}
+    uint64_t time;
+    std::shared_ptr<Value> value;  // nullptr if deleted
+  };
+
+  static bool IsNumeric(NT_Type type) {
+    return type == NT_BOOLEAN || type == NT_DOUBLE;
+  }
+  std::shared_ptr<Value> MakeValue(const NumericSample& sample) const;
+
+  // Index of the first sample with a time after (or, if inclusive, at or
+  // after) time.
+  template <typename T>
+  static size_t Find(const RingQueue<T>& samples, uint64_t time,
+                     bool inclusive);
+
+  NT_Type m_type = NT_UNASSIGNED;
+  uint64_t m_last_time = 0;
+  size_t m_capacity;
+  // Only the one matching m_type is allocated
+  std::unique_ptr<RingQueue<NumericSample>> m_numeric;
+  std::unique_ptr<RingQueue<ValueSample>> m_values;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_VALUEHISTORY_H_
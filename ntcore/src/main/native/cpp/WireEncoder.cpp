@@ -195,5 +195,22 @@ void WireEncoder::WriteString(wpi::StringRef str) {
   }
 
   // contents
-  m_data.append(str.data(), str.data() + len);
+  if (m_zero_copy_threshold != 0 && len >= m_zero_copy_threshold) {
+    m_refs.emplace_back(m_data.size(), str.substr(0, len));
+    m_ref_size += len;
+  } else {
+    m_data.append(str.data(), str.data() + len);
+  }
+}
+
+void WireEncoder::GetBuffers(wpi::SmallVectorImpl<wpi::StringRef>& bufs) const {
+  size_t pos = 0;
+  for (auto& ref : m_refs) {
+    if (ref.first != pos)
+      bufs.emplace_back(m_data.data() + pos, ref.first - pos);
+    bufs.emplace_back(ref.second);
+    pos = ref.first;
+  }
+  if (pos != m_data.size())
+    bufs.emplace_back(m_data.data() + pos, m_data.size() - pos);
 }
@@ -12,6 +12,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <utility>
 
 #include <wpi/SmallVector.h>
 #include <wpi/StringRef.h>
@@ -38,24 +39,52 @@ class WireEncoder {
   /* Clears buffer and error indicator. */
   void Reset() {
     m_data.clear();
+    m_refs.clear();
+    m_ref_size = 0;
     m_error = nullptr;
   }
 
+  /* Reserves space in the memory buffer for size bytes of written data. */
+  void Reserve(size_t size) { m_data.reserve(size); }
+
+  /* Enables zero-copy writes of long strings.  Strings with at least
+   * threshold bytes of contents are not copied into the memory buffer;
+   * instead, a reference to the string data is kept, and GetBuffers() must be
+   * used to get the written data.  The caller is responsible for keeping the
+   * referenced data alive until then.  A threshold of 0 (the default)
+   * disables this.
+   */
+  void set_zero_copy_threshold(size_t threshold) {
+    m_zero_copy_threshold = threshold;
+  }
+
   /* Returns error indicator (a string describing the error).  Returns nullptr
    * if no error has occurred.
    */
   const char* error() const { return m_error; }
 
-  /* Returns pointer to start of memory buffer with written data. */
-  const char* data() const { return m_data.data(); }
+  /* Returns pointer to start of memory buffer with written data.  Not valid
+   * if any zero-copy writes were performed.
+   */
+  const char* data() const {
+    assert(m_refs.empty());
+    return m_data.data();
+  }
 
-  /* Returns number of bytes written to memory buffer. */
-  size_t size() const { return m_data.size(); }
+  /* Returns number of bytes written (including zero-copy writes). */
+  size_t size() const { return m_data.size() + m_ref_size; }
 
   wpi::StringRef ToStringRef() const {
+    assert(m_refs.empty());
     return wpi::StringRef(m_data.data(), m_data.size());
   }
 
+  /* Gets the written data as a list of buffers in order, suitable for a
+   * gather write.  Buffers point to the memory buffer or, for zero-copy
+   * writes, to the original data.
+   */
+  void GetBuffers(wpi::SmallVectorImpl<wpi::StringRef>& bufs) const;
+
   /* Writes a single byte. */
   void Write8(unsigned int val) {
     m_data.push_back(static_cast<char>(val & 0xff));
@@ -104,6 +133,11 @@ class WireEncoder {
 
  private:
   wpi::SmallVector<char, 256> m_data;
+
+  /* Zero-copy references and the m_data offset they are located at. */
+  wpi::SmallVector<std::pair<size_t, wpi::StringRef>, 4> m_refs;
+  size_t m_ref_size = 0;
+  size_t m_zero_copy_threshold = 0;
 };
 
 }  // namespace nt
@@ -7,10 +7,14 @@
 
 #include <jni.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <iterator>
 
 #include <wpi/ConvertUTF.h>
 #include <wpi/SmallString.h>
+#include <wpi/SmallVector.h>
 #include <wpi/jni_util.h>
 #include <wpi/raw_ostream.h>
 
@@ -32,9 +36,11 @@ static JavaVM* jvm = nullptr;
 static JClass booleanCls;
 static JClass connectionInfoCls;
 static JClass connectionNotificationCls;
+static JClass connectionStatsCls;
 static JClass doubleCls;
 static JClass entryInfoCls;
 static JClass entryNotificationCls;
+static JClass listenerQueueStatsCls;
 static JClass logMessageCls;
 static JClass rpcAnswerCls;
 static JClass valueCls;
@@ -48,9 +54,12 @@ static const JClassInit classes[] = {
     {"edu/wpi/first/networktables/ConnectionInfo", &connectionInfoCls},
     {"edu/wpi/first/networktables/ConnectionNotification",
      &connectionNotificationCls},
+    {"edu/wpi/first/networktables/ConnectionStats", &connectionStatsCls},
     {"java/lang/Double", &doubleCls},
     {"edu/wpi/first/networktables/EntryInfo", &entryInfoCls},
     {"edu/wpi/first/networktables/EntryNotification", &entryNotificationCls},
+    {"edu/wpi/first/networktables/ListenerQueueStats",
+     &listenerQueueStatsCls},
     {"edu/wpi/first/networktables/LogMessage", &logMessageCls},
     {"edu/wpi/first/networktables/RpcAnswer", &rpcAnswerCls},
     {"edu/wpi/first/networktables/NetworkTableValue", &valueCls}};
@@ -215,6 +224,35 @@ static jobject MakeJObject(JNIEnv* env, const nt::ConnectionInfo& info) {
                         (jlong)info.last_update, (jint)info.protocol_version);
 }
 
+static jobject MakeJObject(JNIEnv* env, const nt::ListenerQueueStats& stats) {
+  static jmethodID constructor =
+      env->GetMethodID(listenerQueueStatsCls, "<init>", "(JJJJ)V");
+  return env->NewObject(listenerQueueStatsCls, constructor,
+                        (jlong)stats.queued, (jlong)stats.capacity,
+                        (jlong)stats.dropped, (jlong)stats.coalesced);
+}
+
+static jobject MakeJObject(JNIEnv* env, const nt::ConnectionStats& stats) {
+  static jmethodID constructor = env->GetMethodID(
+      connectionStatsCls, "<init>",
+      "(Ledu/wpi/first/networktables/ConnectionInfo;JJ[J[JJJJJI)V");
+  JLocal<jobject> conn{env, MakeJObject(env, stats.conn)};
+  jlong sent[NT_MSG_TYPE_COUNT];
+  jlong received[NT_MSG_TYPE_COUNT];
+  std::copy(std::begin(stats.messages_sent), std::end(stats.messages_sent),
+            sent);
+  std::copy(std::begin(stats.messages_received),
+            std::end(stats.messages_received), received);
+  JLocal<jlongArray> sent_arr{env, MakeJLongArray(env, sent)};
+  JLocal<jlongArray> received_arr{env, MakeJLongArray(env, received)};
+  return env->NewObject(connectionStatsCls, constructor, conn.obj(),
+                        (jlong)stats.bytes_sent, (jlong)stats.bytes_received,
+                        sent_arr.obj(), received_arr.obj(),
+                        (jlong)stats.coalesced, (jlong)stats.filtered,
+                        (jlong)stats.pending, (jlong)stats.queued,
+                        (jint)stats.rtt);
+}
+
 static jobject MakeJObject(JNIEnv* env, jobject inst,
                            const nt::ConnectionNotification& notification) {
   static jmethodID constructor = env->GetMethodID(
@@ -459,8 +497,7 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_setBoolean
                           nt::Value::MakeBoolean(value != JNI_FALSE, time));
     return JNI_TRUE;
   }
-  return nt::SetEntryValue(entry,
-                           nt::Value::MakeBoolean(value != JNI_FALSE, time));
+  return nt::SetEntryBoolean(entry, value != JNI_FALSE, time);
 }
 
 /*
@@ -476,7 +513,37 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_setDouble
     nt::SetEntryTypeValue(entry, nt::Value::MakeDouble(value, time));
     return JNI_TRUE;
   }
-  return nt::SetEntryValue(entry, nt::Value::MakeDouble(value, time));
+  return nt::SetEntryDouble(entry, value, time);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setDoubles
+ * Signature: ([IJ[D)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setDoubles
+  (JNIEnv* env, jclass, jintArray entries, jlong time, jdoubleArray values)
+{
+  if (!entries) {
+    nullPointerEx.Throw(env, "entries cannot be null");
+    return false;
+  }
+  if (!values) {
+    nullPointerEx.Throw(env, "values cannot be null");
+    return false;
+  }
+  std::vector<std::shared_ptr<nt::Value>> v;
+  {
+    CriticalJDoubleArrayRef ref{env, values};
+    v.reserve(ref.array().size());
+    for (double d : ref.array()) v.emplace_back(nt::Value::MakeDouble(d, time));
+  }
+  JIntArrayRef ref{env, entries};
+  return nt::SetEntryValues(
+      wpi::makeArrayRef(reinterpret_cast<const NT_Entry*>(ref.array().data()),
+                        ref.array().size()),
+      v);
 }
 
 /*
@@ -629,6 +696,252 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_getValue
   return MakeJValue(env, val.get());
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getValueAt
+ * Signature: (IJ)Ledu/wpi/first/networktables/NetworkTableValue;
+ */
+JNIEXPORT jobject JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getValueAt
+  (JNIEnv* env, jclass, jint entry, jlong time)
+{
+  auto val = nt::GetEntryValueAt(entry, time);
+  return MakeJValue(env, val.get());
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getHistory
+ * Signature: (IJ)[Ljava/lang/Object;
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getHistory
+  (JNIEnv* env, jclass, jint entry, jlong since)
+{
+  auto values = nt::GetEntryHistory(entry, since);
+  jobjectArray jarr = env->NewObjectArray(values.size(), valueCls, nullptr);
+  if (!jarr) return nullptr;
+  for (size_t i = 0; i < values.size(); ++i) {
+    JLocal<jobject> elem{env, MakeJValue(env, values[i].get())};
+    env->SetObjectArrayElement(jarr, i, elem.obj());
+  }
+  return jarr;
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setEntryHistory
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setEntryHistory
+  (JNIEnv* env, jclass, jint entry, jint capacity)
+{
+  if (capacity < 0) {
+    illegalArgEx.Throw(env, "capacity cannot be negative");
+    return;
+  }
+  nt::SetEntryHistory(entry, capacity);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getValues
+ * Signature: ([I)[Ljava/lang/Object;
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getValues
+  (JNIEnv* env, jclass, jintArray entries)
+{
+  if (!entries) {
+    nullPointerEx.Throw(env, "entries cannot be null");
+    return nullptr;
+  }
+  std::vector<std::shared_ptr<nt::Value>> values;
+  {
+    JIntArrayRef ref{env, entries};
+    values = nt::GetEntryValues(
+        wpi::makeArrayRef(reinterpret_cast<const NT_Entry*>(ref.array().data()),
+                          ref.array().size()));
+  }
+  jobjectArray jarr = env->NewObjectArray(values.size(), valueCls, nullptr);
+  if (!jarr) return nullptr;
+  for (size_t i = 0; i < values.size(); ++i) {
+    JLocal<jobject> elem{env, MakeJValue(env, values[i].get())};
+    env->SetObjectArrayElement(jarr, i, elem.obj());
+  }
+  return jarr;
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getDoubles
+ * Signature: ([I[DD)I
+ */
+JNIEXPORT jint JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getDoubles
+  (JNIEnv* env, jclass, jintArray entries, jdoubleArray values,
+   jdouble defaultValue)
+{
+  if (!entries) {
+    nullPointerEx.Throw(env, "entries cannot be null");
+    return 0;
+  }
+  if (!values) {
+    nullPointerEx.Throw(env, "values cannot be null");
+    return 0;
+  }
+  jsize len = env->GetArrayLength(entries);
+  if (env->GetArrayLength(values) < len) {
+    illegalArgEx.Throw(env, "values must be at least as long as entries");
+    return 0;
+  }
+  // read straight into the Java array, so nothing is allocated
+  CriticalJIntArrayRef ref{env, entries};
+  if (!ref) return 0;
+  auto out =
+      static_cast<jdouble*>(env->GetPrimitiveArrayCritical(values, nullptr));
+  if (!out) return 0;
+  size_t count = nt::GetEntryDoubles(
+      wpi::makeArrayRef(reinterpret_cast<const NT_Entry*>(ref.array().data()),
+                        len),
+      defaultValue, out);
+  env->ReleasePrimitiveArrayCritical(values, out, 0);
+  return count;
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getDoublesBuffer
+ * Signature: ([ILjava/nio/ByteBuffer;D)I
+ */
+JNIEXPORT jint JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getDoublesBuffer
+  (JNIEnv* env, jclass, jintArray entries, jobject values,
+   jdouble defaultValue)
+{
+  if (!entries) {
+    nullPointerEx.Throw(env, "entries cannot be null");
+    return 0;
+  }
+  if (!values) {
+    nullPointerEx.Throw(env, "values cannot be null");
+    return 0;
+  }
+  auto out = static_cast<char*>(env->GetDirectBufferAddress(values));
+  if (!out) {
+    illegalArgEx.Throw(env, "values must be a direct ByteBuffer");
+    return 0;
+  }
+  jsize len = env->GetArrayLength(entries);
+  if (env->GetDirectBufferCapacity(values) <
+      static_cast<jlong>(len * sizeof(double))) {
+    illegalArgEx.Throw(env, "values is too small");
+    return 0;
+  }
+  CriticalJIntArrayRef ref{env, entries};
+  if (!ref) return 0;
+  auto handles = wpi::makeArrayRef(
+      reinterpret_cast<const NT_Entry*>(ref.array().data()), len);
+  if (reinterpret_cast<uintptr_t>(out) % alignof(double) == 0)
+    return nt::GetEntryDoubles(handles, defaultValue,
+                               reinterpret_cast<double*>(out));
+  // unaligned buffer; reused per thread, like the entry ids in
+  // GetEntryDoubles()
+  thread_local wpi::SmallVector<double, 64> buf;
+  buf.resize(len);
+  size_t count = nt::GetEntryDoubles(handles, defaultValue, buf.data());
+  std::memcpy(out, buf.data(), len * sizeof(double));
+  return count;
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getBooleans
+ * Signature: ([I[ZZ)I
+ */
+JNIEXPORT jint JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getBooleans
+  (JNIEnv* env, jclass, jintArray entries, jbooleanArray values,
+   jboolean defaultValue)
+{
+  if (!entries) {
+    nullPointerEx.Throw(env, "entries cannot be null");
+    return 0;
+  }
+  if (!values) {
+    nullPointerEx.Throw(env, "values cannot be null");
+    return 0;
+  }
+  jsize len = env->GetArrayLength(entries);
+  if (env->GetArrayLength(values) < len) {
+    illegalArgEx.Throw(env, "values must be at least as long as entries");
+    return 0;
+  }
+  // reused per thread, like the entry ids in GetEntryBooleans()
+  thread_local wpi::SmallVector<bool, 64> buf;
+  buf.resize(len);
+  size_t count;
+  {
+    CriticalJIntArrayRef ref{env, entries};
+    if (!ref) return 0;
+    count = nt::GetEntryBooleans(
+        wpi::makeArrayRef(
+            reinterpret_cast<const NT_Entry*>(ref.array().data()), len),
+        defaultValue, buf.data());
+  }
+  auto out =
+      static_cast<jboolean*>(env->GetPrimitiveArrayCritical(values, nullptr));
+  if (!out) return 0;
+  for (jsize i = 0; i < len; ++i) out[i] = buf[i] ? JNI_TRUE : JNI_FALSE;
+  env->ReleasePrimitiveArrayCritical(values, out, 0);
+  return count;
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getBooleansBuffer
+ * Signature: ([ILjava/nio/ByteBuffer;Z)I
+ */
+JNIEXPORT jint JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getBooleansBuffer
+  (JNIEnv* env, jclass, jintArray entries, jobject values,
+   jboolean defaultValue)
+{
+  if (!entries) {
+    nullPointerEx.Throw(env, "entries cannot be null");
+    return 0;
+  }
+  if (!values) {
+    nullPointerEx.Throw(env, "values cannot be null");
+    return 0;
+  }
+  auto out = static_cast<uint8_t*>(env->GetDirectBufferAddress(values));
+  if (!out) {
+    illegalArgEx.Throw(env, "values must be a direct ByteBuffer");
+    return 0;
+  }
+  jsize len = env->GetArrayLength(entries);
+  if (env->GetDirectBufferCapacity(values) < len) {
+    illegalArgEx.Throw(env, "values is too small");
+    return 0;
+  }
+  // reused per thread, like the entry ids in GetEntryBooleans()
+  thread_local wpi::SmallVector<bool, 64> buf;
+  buf.resize(len);
+  size_t count;
+  {
+    CriticalJIntArrayRef ref{env, entries};
+    if (!ref) return 0;
+    count = nt::GetEntryBooleans(
+        wpi::makeArrayRef(
+            reinterpret_cast<const NT_Entry*>(ref.array().data()), len),
+        defaultValue, buf.data());
+  }
+  for (jsize i = 0; i < len; ++i) out[i] = buf[i] ? 1 : 0;
+  return count;
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    getBoolean
@@ -713,6 +1026,54 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_getDoubleArray
   return MakeJDoubleArray(env, val->GetDoubleArray());
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    readBooleanArray
+ * Signature: (I[Z)I
+ */
+JNIEXPORT jint JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_readBooleanArray
+  (JNIEnv* env, jclass, jint entry, jbooleanArray values)
+{
+  if (!values) {
+    nullPointerEx.Throw(env, "values cannot be null");
+    return 0;
+  }
+  auto val = nt::GetEntryValue(entry);
+  if (!val || !val->IsBooleanArray()) return -1;
+  auto arr = val->GetBooleanArray();
+  size_t len = std::min(arr.size(),
+                        static_cast<size_t>(env->GetArrayLength(values)));
+  auto out =
+      static_cast<jboolean*>(env->GetPrimitiveArrayCritical(values, nullptr));
+  if (!out) return 0;
+  for (size_t i = 0; i < len; ++i) out[i] = arr[i] ? JNI_TRUE : JNI_FALSE;
+  env->ReleasePrimitiveArrayCritical(values, out, 0);
+  return arr.size();
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    readDoubleArray
+ * Signature: (I[D)I
+ */
+JNIEXPORT jint JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_readDoubleArray
+  (JNIEnv* env, jclass, jint entry, jdoubleArray values)
+{
+  if (!values) {
+    nullPointerEx.Throw(env, "values cannot be null");
+    return 0;
+  }
+  auto val = nt::GetEntryValue(entry);
+  if (!val || !val->IsDoubleArray()) return -1;
+  auto arr = val->GetDoubleArray();
+  size_t len = std::min(arr.size(),
+                        static_cast<size_t>(env->GetArrayLength(values)));
+  env->SetDoubleArrayRegion(values, 0, len, arr.data());
+  return arr.size();
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    getStringArray
@@ -862,6 +1223,30 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_getEntryFlags
   return nt::GetEntryFlags(entry);
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setEntryUpdateRate
+ * Signature: (ID)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setEntryUpdateRate
+  (JNIEnv*, jclass, jint entry, jdouble interval)
+{
+  nt::SetEntryUpdateRate(entry, interval);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getEntryUpdateRate
+ * Signature: (I)D
+ */
+JNIEXPORT jdouble JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getEntryUpdateRate
+  (JNIEnv*, jclass, jint entry)
+{
+  return nt::GetEntryUpdateRate(entry);
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    deleteEntry
@@ -1046,6 +1431,35 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_waitForEntryListenerQueue
   return nt::WaitForEntryListenerQueue(inst, timeout);
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setEntryListenerQueue
+ * Signature: (IJI)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setEntryListenerQueue
+  (JNIEnv* env, jclass, jint handle, jlong capacity, jint overflow)
+{
+  if (capacity < 0) {
+    illegalArgEx.Throw(env, "capacity cannot be negative");
+    return;
+  }
+  nt::SetEntryListenerQueue(handle, capacity,
+                            static_cast<NT_QueueOverflow>(overflow));
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getEntryListenerQueueStats
+ * Signature: (I)Ledu/wpi/first/networktables/ListenerQueueStats;
+ */
+JNIEXPORT jobject JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getEntryListenerQueueStats
+  (JNIEnv* env, jclass, jint handle)
+{
+  return MakeJObject(env, nt::GetEntryListenerQueueStats(handle));
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    createConnectionListenerPoller
@@ -1608,6 +2022,90 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_setUpdateRate
   nt::SetUpdateRate(inst, interval);
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setNetworkEventLoop
+ * Signature: (IZ)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setNetworkEventLoop
+  (JNIEnv*, jclass, jint inst, jboolean enabled)
+{
+  nt::SetNetworkEventLoop(inst, enabled);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setNetworkFlushMode
+ * Signature: (IID)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setNetworkFlushMode
+  (JNIEnv*, jclass, jint inst, jint mode, jdouble window)
+{
+  nt::SetNetworkFlushMode(inst, static_cast<NT_NetworkFlushMode>(mode),
+                          window);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setNetworkSocketFlags
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setNetworkSocketFlags
+  (JNIEnv*, jclass, jint inst, jint flags)
+{
+  nt::SetNetworkSocketFlags(inst, flags);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setNetworkSubscriptions
+ * Signature: (I[Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setNetworkSubscriptions
+  (JNIEnv* env, jclass, jint inst, jobjectArray prefixes)
+{
+  if (!prefixes) {
+    nullPointerEx.Throw(env, "prefixes cannot be null");
+    return;
+  }
+  int len = env->GetArrayLength(prefixes);
+  std::vector<std::string> strs;
+  std::vector<nt::StringRef> refs;
+  strs.reserve(len);
+  refs.reserve(len);
+  for (int i = 0; i < len; ++i) {
+    JLocal<jstring> elem{
+        env, static_cast<jstring>(env->GetObjectArrayElement(prefixes, i))};
+    if (!elem) {
+      nullPointerEx.Throw(env, "null string in prefixes");
+      return;
+    }
+    strs.emplace_back(JStringRef{env, elem}.str());
+    refs.emplace_back(strs.back());
+  }
+  nt::SetNetworkSubscriptions(inst, refs);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setPrefixUpdateRate
+ * Signature: (ILjava/lang/String;D)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setPrefixUpdateRate
+  (JNIEnv* env, jclass, jint inst, jstring prefix, jdouble interval)
+{
+  if (!prefix) {
+    nullPointerEx.Throw(env, "prefix cannot be null");
+    return;
+  }
+  nt::SetPrefixUpdateRate(inst, JStringRef{env, prefix}.str(), interval);
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    flush
@@ -1640,6 +2138,26 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_getConnections
   return jarr;
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    getConnectionStats
+ * Signature: (I)[Ljava/lang/Object;
+ */
+JNIEXPORT jobjectArray JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_getConnectionStats
+  (JNIEnv* env, jclass, jint inst)
+{
+  auto arr = nt::GetConnectionStats(inst);
+  jobjectArray jarr =
+      env->NewObjectArray(arr.size(), connectionStatsCls, nullptr);
+  if (!jarr) return nullptr;
+  for (size_t i = 0; i < arr.size(); ++i) {
+    JLocal<jobject> jelem{env, MakeJObject(env, arr[i])};
+    env->SetObjectArrayElement(jarr, i, jelem);
+  }
+  return jarr;
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    isConnected
@@ -1697,6 +2215,30 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_loadPersistent
   return MakeJStringArray(env, warns);
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setPersistentBinary
+ * Signature: (IZ)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setPersistentBinary
+  (JNIEnv*, jclass, jint inst, jboolean binary)
+{
+  nt::SetPersistentBinary(inst, binary);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setPersistentJournal
+ * Signature: (IZ)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setPersistentJournal
+  (JNIEnv*, jclass, jint inst, jboolean enabled)
+{
+  nt::SetPersistentJournal(inst, enabled);
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    saveEntries
@@ -1752,6 +2294,87 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_loadEntries
   return MakeJStringArray(env, warns);
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    startDataLog
+ * Signature: (ILjava/lang/String;Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_startDataLog
+  (JNIEnv* env, jclass, jint inst, jstring filename, jstring prefix)
+{
+  if (!filename) {
+    nullPointerEx.Throw(env, "filename cannot be null");
+    return 0;
+  }
+  if (!prefix) {
+    nullPointerEx.Throw(env, "prefix cannot be null");
+    return 0;
+  }
+  const char* err = nullptr;
+  NT_DataLogger logger = nt::StartDataLog(
+      inst, JStringRef{env, filename}.str(), JStringRef{env, prefix}.str(),
+      &err);
+  if (err) persistentEx.Throw(env, err);
+  return logger;
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    stopDataLog
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_stopDataLog
+  (JNIEnv*, jclass, jint logger)
+{
+  nt::StopDataLog(logger);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    startDataLogReplay
+ * Signature: (ILjava/lang/String;D)I
+ */
+JNIEXPORT jint JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_startDataLogReplay
+  (JNIEnv* env, jclass, jint inst, jstring filename, jdouble speed)
+{
+  if (!filename) {
+    nullPointerEx.Throw(env, "filename cannot be null");
+    return 0;
+  }
+  const char* err = nullptr;
+  NT_DataLogReplay replay = nt::StartDataLogReplay(
+      inst, JStringRef{env, filename}.str(), speed, &err);
+  if (err) persistentEx.Throw(env, err);
+  return replay;
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    waitForDataLogReplay
+ * Signature: (ID)Z
+ */
+JNIEXPORT jboolean JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_waitForDataLogReplay
+  (JNIEnv*, jclass, jint replay, jdouble timeout)
+{
+  return nt::WaitForDataLogReplay(replay, timeout);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    stopDataLogReplay
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_stopDataLogReplay
+  (JNIEnv*, jclass, jint replay)
+{
+  nt::StopDataLogReplay(replay);
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    now
@@ -7,9 +7,12 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <iterator>
 
+#include <wpi/SmallVector.h>
 #include <wpi/memory.h>
 #include <wpi/timestamp.h>
 
@@ -42,6 +45,21 @@ static void ConvertToC(const ConnectionInfo& in, NT_ConnectionInfo* out) {
   out->protocol_version = in.protocol_version;
 }
 
+static void ConvertToC(const ConnectionStats& in, NT_ConnectionStats* out) {
+  ConvertToC(in.conn, &out->conn);
+  out->bytes_sent = in.bytes_sent;
+  out->bytes_received = in.bytes_received;
+  std::copy(std::begin(in.messages_sent), std::end(in.messages_sent),
+            out->messages_sent);
+  std::copy(std::begin(in.messages_received), std::end(in.messages_received),
+            out->messages_received);
+  out->coalesced = in.coalesced;
+  out->filtered = in.filtered;
+  out->pending = in.pending;
+  out->queued = in.queued;
+  out->rtt = in.rtt;
+}
+
 static void ConvertToC(const RpcParamDef& in, NT_RpcParamDef* out) {
   ConvertToC(in.name, &out->name);
   ConvertToC(*in.def_value, &out->def_value);
@@ -222,6 +240,65 @@ int NT_SetEntryValue(NT_Entry entry, const struct NT_Value* value) {
   return nt::SetEntryValue(entry, ConvertFromC(*value));
 }
 
+void NT_GetEntryValues(const NT_Entry* entries, size_t count,
+                       struct NT_Value* values) {
+  auto v = nt::GetEntryValues(wpi::makeArrayRef(entries, count));
+  for (size_t i = 0; i < count; ++i) {
+    NT_InitValue(&values[i]);
+    if (v[i]) ConvertToC(*v[i], &values[i]);
+  }
+}
+
+NT_Bool NT_SetEntryValues(const NT_Entry* entries,
+                          const struct NT_Value* values, size_t count) {
+  std::vector<std::shared_ptr<Value>> v;
+  v.reserve(count);
+  for (size_t i = 0; i < count; ++i) v.emplace_back(ConvertFromC(values[i]));
+  return nt::SetEntryValues(wpi::makeArrayRef(entries, count), v);
+}
+
+size_t NT_GetEntryDoubles(const NT_Entry* entries, size_t count,
+                          double default_value, double* values) {
+  return nt::GetEntryDoubles(wpi::makeArrayRef(entries, count), default_value,
+                             values);
+}
+
+size_t NT_GetEntryBooleans(const NT_Entry* entries, size_t count,
+                           NT_Bool default_value, NT_Bool* values) {
+  // reused per thread, like the entry ids
+  thread_local wpi::SmallVector<bool, 64> v;
+  v.resize(count);
+  size_t rv = nt::GetEntryBooleans(wpi::makeArrayRef(entries, count),
+                                   default_value, v.data());
+  for (size_t i = 0; i < count; ++i) values[i] = v[i];
+  return rv;
+}
+
+void NT_SetEntryHistory(NT_Entry entry, size_t capacity) {
+  nt::SetEntryHistory(entry, capacity);
+}
+
+void NT_GetEntryValueAt(NT_Entry entry, uint64_t time, struct NT_Value* value) {
+  NT_InitValue(value);
+  auto v = nt::GetEntryValueAt(entry, time);
+  if (!v) return;
+  ConvertToC(*v, value);
+}
+
+struct NT_Value* NT_GetEntryHistory(NT_Entry entry, uint64_t since,
+                                    size_t* count) {
+  auto v = nt::GetEntryHistory(entry, since);
+  *count = v.size();
+  if (v.empty()) return nullptr;
+  auto values =
+      static_cast<NT_Value*>(wpi::CheckedMalloc(v.size() * sizeof(NT_Value)));
+  for (size_t i = 0; i < v.size(); ++i) {
+    NT_InitValue(&values[i]);
+    if (v[i]) ConvertToC(*v[i], &values[i]);  // unassigned if deleted
+  }
+  return values;
+}
+
 void NT_SetEntryTypeValue(NT_Entry entry, const struct NT_Value* value) {
   nt::SetEntryTypeValue(entry, ConvertFromC(*value));
 }
@@ -324,6 +401,20 @@ void NT_CancelPollEntryListener(NT_EntryListenerPoller poller) {
   nt::CancelPollEntryListener(poller);
 }
 
+void NT_SetEntryListenerQueue(NT_Handle handle, size_t capacity,
+                              enum NT_QueueOverflow overflow) {
+  nt::SetEntryListenerQueue(handle, capacity, overflow);
+}
+
+void NT_GetEntryListenerQueueStats(NT_Handle handle,
+                                   struct NT_ListenerQueueStats* stats) {
+  auto stats_cpp = nt::GetEntryListenerQueueStats(handle);
+  stats->queued = stats_cpp.queued;
+  stats->capacity = stats_cpp.capacity;
+  stats->dropped = stats_cpp.dropped;
+  stats->coalesced = stats_cpp.coalesced;
+}
+
 void NT_RemoveEntryListener(NT_EntryListener entry_listener) {
   nt::RemoveEntryListener(entry_listener);
 }
@@ -594,6 +685,40 @@ void NT_SetUpdateRate(NT_Inst inst, double interval) {
   nt::SetUpdateRate(inst, interval);
 }
 
+void NT_SetNetworkEventLoop(NT_Inst inst, NT_Bool enabled) {
+  nt::SetNetworkEventLoop(inst, enabled);
+}
+
+void NT_SetNetworkFlushMode(NT_Inst inst, enum NT_NetworkFlushMode mode,
+                            double window) {
+  nt::SetNetworkFlushMode(inst, mode, window);
+}
+
+void NT_SetNetworkSocketFlags(NT_Inst inst, unsigned int flags) {
+  nt::SetNetworkSocketFlags(inst, flags);
+}
+
+void NT_SetNetworkSubscriptions(NT_Inst inst, size_t count,
+                                const char** prefixes) {
+  std::vector<StringRef> v;
+  v.reserve(count);
+  for (size_t i = 0; i < count; ++i) v.emplace_back(prefixes[i]);
+  nt::SetNetworkSubscriptions(inst, v);
+}
+
+void NT_SetEntryUpdateRate(NT_Entry entry, double interval) {
+  nt::SetEntryUpdateRate(entry, interval);
+}
+
+double NT_GetEntryUpdateRate(NT_Entry entry) {
+  return nt::GetEntryUpdateRate(entry);
+}
+
+void NT_SetPrefixUpdateRate(NT_Inst inst, const char* prefix,
+                            size_t prefix_len, double interval) {
+  nt::SetPrefixUpdateRate(inst, StringRef(prefix, prefix_len), interval);
+}
+
 void NT_Flush(NT_Inst inst) { nt::Flush(inst); }
 
 NT_Bool NT_IsConnected(NT_Inst inst) { return nt::IsConnected(inst); }
@@ -603,6 +728,11 @@ struct NT_ConnectionInfo* NT_GetConnections(NT_Inst inst, size_t* count) {
   return ConvertToC<NT_ConnectionInfo>(conn_v, count);
 }
 
+struct NT_ConnectionStats* NT_GetConnectionStats(NT_Inst inst, size_t* count) {
+  auto stats_v = nt::GetConnectionStats(inst);
+  return ConvertToC<NT_ConnectionStats>(stats_v, count);
+}
+
 /*
  * File Save/Load Functions
  */
@@ -616,6 +746,14 @@ const char* NT_LoadPersistent(NT_Inst inst, const char* filename,
   return nt::LoadPersistent(inst, filename, warn);
 }
 
+void NT_SetPersistentBinary(NT_Inst inst, NT_Bool binary) {
+  nt::SetPersistentBinary(inst, binary);
+}
+
+void NT_SetPersistentJournal(NT_Inst inst, NT_Bool enabled) {
+  nt::SetPersistentJournal(inst, enabled);
+}
+
 const char* NT_SaveEntries(NT_Inst inst, const char* filename,
                            const char* prefix, size_t prefix_len) {
   return nt::SaveEntries(inst, filename, StringRef(prefix, prefix_len));
@@ -627,6 +765,37 @@ const char* NT_LoadEntries(NT_Inst inst, const char* filename,
   return nt::LoadEntries(inst, filename, StringRef(prefix, prefix_len), warn);
 }
 
+/*
+ * Data Log Functions
+ */
+
+NT_DataLogger NT_StartDataLog(NT_Inst inst, const char* filename,
+                              const char* prefix, size_t prefix_len,
+                              const char** err) {
+  return nt::StartDataLog(inst, filename, StringRef(prefix, prefix_len), err);
+}
+
+void NT_StopDataLog(NT_DataLogger logger) { nt::StopDataLog(logger); }
+
+NT_DataLogReplay NT_StartDataLogReplay(NT_Inst inst, const char* filename,
+                                       double speed, const char** err) {
+  return nt::StartDataLogReplay(inst, filename, speed, err);
+}
+
+NT_Bool NT_WaitForDataLogReplay(NT_DataLogReplay replay, double timeout) {
+  return nt::WaitForDataLogReplay(replay, timeout);
+}
+
+void NT_StopDataLogReplay(NT_DataLogReplay replay) {
+  nt::StopDataLogReplay(replay);
+}
+
+const char* NT_ConvertDataLog(const char* filename, const char* out_filename,
+                              enum NT_DataLogFormat format,
+                              void (*warn)(size_t record, const char* msg)) {
+  return nt::ConvertDataLog(filename, out_filename, format, warn);
+}
+
 /*
  * Utility Functions
  */
@@ -711,6 +880,11 @@ void NT_DisposeValue(NT_Value* value) {
   value->last_change = 0;
 }
 
+void NT_DisposeValueArray(NT_Value* arr, size_t count) {
+  for (size_t i = 0; i < count; i++) NT_DisposeValue(&arr[i]);
+  std::free(arr);
+}
+
 void NT_InitValue(NT_Value* value) {
   value->type = NT_UNASSIGNED;
   value->last_change = 0;
@@ -734,6 +908,11 @@ void NT_DisposeConnectionInfoArray(NT_ConnectionInfo* arr, size_t count) {
   std::free(arr);
 }
 
+void NT_DisposeConnectionStatsArray(NT_ConnectionStats* arr, size_t count) {
+  for (size_t i = 0; i < count; i++) DisposeConnectionInfo(&arr[i].conn);
+  std::free(arr);
+}
+
 void NT_DisposeEntryInfoArray(NT_EntryInfo* arr, size_t count) {
   for (size_t i = 0; i < count; i++) DisposeEntryInfo(&arr[i]);
   std::free(arr);
@@ -840,7 +1019,7 @@ NT_Bool NT_SetEntryDouble(NT_Entry entry, uint64_t time, double v_double,
     nt::SetEntryTypeValue(entry, Value::MakeDouble(v_double, time));
     return 1;
   } else {
-    return nt::SetEntryValue(entry, Value::MakeDouble(v_double, time));
+    return nt::SetEntryDouble(entry, v_double, time);
   }
 }
 
@@ -850,7 +1029,7 @@ NT_Bool NT_SetEntryBoolean(NT_Entry entry, uint64_t time, NT_Bool v_boolean,
     nt::SetEntryTypeValue(entry, Value::MakeBoolean(v_boolean != 0, time));
     return 1;
   } else {
-    return nt::SetEntryValue(entry, Value::MakeBoolean(v_boolean != 0, time));
+    return nt::SetEntryBoolean(entry, v_boolean != 0, time);
   }
 }
 
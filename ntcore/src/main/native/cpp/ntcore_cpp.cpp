@@ -7,12 +7,17 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
 
+#include <wpi/SmallString.h>
+#include <wpi/SmallVector.h>
 #include <wpi/timestamp.h>
 
+#include "DataLogReader.h"
 #include "Handle.h"
 #include "InstanceImpl.h"
 #include "Log.h"
@@ -43,7 +48,7 @@ void DestroyInstance(NT_Inst inst) {
 NT_Inst GetInstanceFromHandle(NT_Handle handle) {
   Handle h{handle};
   auto type = h.GetType();
-  if (type >= Handle::kConnectionListener && type <= Handle::kRpcCallPoller)
+  if (type >= Handle::kConnectionListener && type <= Handle::kDataLogReplay)
     return Handle(h.GetInst(), 0, Handle::kInstance);
 
   return 0;
@@ -141,6 +146,126 @@ bool SetEntryValue(NT_Entry entry, std::shared_ptr<Value> value) {
   return ii->storage.SetEntryValue(id, value);
 }
 
+bool SetEntryBoolean(NT_Entry entry, bool value, uint64_t time) {
+  return SetEntryValue(entry, Value::MakeBoolean(value, time));
+}
+
+bool SetEntryDouble(NT_Entry entry, double value, uint64_t time) {
+  return SetEntryValue(entry, Value::MakeDouble(value, time));
+}
+
+// Converts entry handles to local ids for a batch operation.  All entries must
+// belong to the same instance as the first one.  Invalid handles are mapped to
+// an out-of-range local id, which Storage ignores.  Returns the instance, or
+// nullptr if the first handle is not a valid entry.
+static InstanceImpl* GetBatchIds(ArrayRef<NT_Entry> entries,
+                                 wpi::SmallVectorImpl<unsigned int>& ids,
+                                 bool* all_valid) {
+  *all_valid = true;
+  if (entries.empty()) return nullptr;
+  int inst = Handle{entries[0]}.GetTypedInst(Handle::kEntry);
+  auto ii = InstanceImpl::Get(inst);
+  if (!ii) {
+    *all_valid = false;
+    return nullptr;
+  }
+  ids.reserve(entries.size());
+  for (auto entry : entries) {
+    Handle handle{entry};
+    int id = handle.GetTypedIndex(Handle::kEntry);
+    if (id < 0 || handle.GetInst() != inst) {
+      *all_valid = false;
+      ids.push_back(UINT_MAX);
+    } else {
+      ids.push_back(id);
+    }
+  }
+  return ii;
+}
+
+// Per-thread id buffer for the batch getters, so they only allocate the
+// first time a thread reads more than 64 entries at once.
+static wpi::SmallVectorImpl<unsigned int>& GetBatchIdBuffer() {
+  thread_local wpi::SmallVector<unsigned int, 64> ids;
+  ids.clear();
+  return ids;
+}
+
+std::vector<std::shared_ptr<Value>> GetEntryValues(
+    ArrayRef<NT_Entry> entries) {
+  wpi::SmallVector<unsigned int, 64> ids;
+  bool all_valid;
+  auto ii = GetBatchIds(entries, ids, &all_valid);
+  if (!ii) return std::vector<std::shared_ptr<Value>>(entries.size());
+
+  return ii->storage.GetEntryValues(ids);
+}
+
+bool SetEntryValues(ArrayRef<NT_Entry> entries,
+                    ArrayRef<std::shared_ptr<Value>> values) {
+  if (entries.size() != values.size()) return false;
+  wpi::SmallVector<unsigned int, 64> ids;
+  bool all_valid;
+  auto ii = GetBatchIds(entries, ids, &all_valid);
+  if (!ii) return entries.empty();
+
+  return ii->storage.SetEntryValues(ids, values) && all_valid;
+}
+
+size_t GetEntryDoubles(ArrayRef<NT_Entry> entries, double default_value,
+                       double* values) {
+  auto& ids = GetBatchIdBuffer();
+  bool all_valid;
+  auto ii = GetBatchIds(entries, ids, &all_valid);
+  if (!ii) {
+    std::fill_n(values, entries.size(), default_value);
+    return 0;
+  }
+
+  return ii->storage.GetEntryDoubles(ids, default_value, values);
+}
+
+size_t GetEntryBooleans(ArrayRef<NT_Entry> entries, bool default_value,
+                        bool* values) {
+  auto& ids = GetBatchIdBuffer();
+  bool all_valid;
+  auto ii = GetBatchIds(entries, ids, &all_valid);
+  if (!ii) {
+    std::fill_n(values, entries.size(), default_value);
+    return 0;
+  }
+
+  return ii->storage.GetEntryBooleans(ids, default_value, values);
+}
+
+void SetEntryHistory(NT_Entry entry, size_t capacity) {
+  Handle handle{entry};
+  int id = handle.GetTypedIndex(Handle::kEntry);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (id < 0 || !ii) return;
+
+  ii->storage.SetEntryHistory(id, capacity);
+}
+
+std::shared_ptr<Value> GetEntryValueAt(NT_Entry entry, uint64_t time) {
+  Handle handle{entry};
+  int id = handle.GetTypedIndex(Handle::kEntry);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (id < 0 || !ii) return nullptr;
+
+  return ii->storage.GetEntryValueAt(id, time);
+}
+
+std::vector<std::shared_ptr<Value>> GetEntryHistory(NT_Entry entry,
+                                                    uint64_t since) {
+  Handle handle{entry};
+  int id = handle.GetTypedIndex(Handle::kEntry);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (id < 0 || !ii) return std::vector<std::shared_ptr<Value>>{};
+
+  return ii->storage.GetEntryHistory(id, since);
+}
+
 void SetEntryTypeValue(StringRef name, std::shared_ptr<Value> value) {
   InstanceImpl::GetDefault()->storage.SetEntryTypeValue(name, value);
 }
@@ -356,6 +481,30 @@ void CancelPollEntryListener(NT_EntryListenerPoller poller) {
   ii->entry_notifier.CancelPoll(id);
 }
 
+void SetEntryListenerQueue(NT_Handle handle, size_t capacity,
+                           NT_QueueOverflow overflow) {
+  Handle h{handle};
+  auto ii = InstanceImpl::Get(h.GetInst());
+  if (!ii) return;
+
+  if (h.IsType(Handle::kInstance)) {
+    ii->entry_notifier.SetQueue(capacity, overflow);
+  } else if (h.IsType(Handle::kEntryListenerPoller)) {
+    ii->entry_notifier.SetPollerQueue(h.GetIndex(), capacity, overflow);
+  }
+}
+
+ListenerQueueStats GetEntryListenerQueueStats(NT_Handle handle) {
+  Handle h{handle};
+  auto ii = InstanceImpl::Get(h.GetInst());
+  if (!ii) return ListenerQueueStats{0, 0, 0, 0};
+
+  if (h.IsType(Handle::kEntryListenerPoller))
+    return ii->entry_notifier.GetPollerQueueStats(h.GetIndex());
+  if (!h.IsType(Handle::kInstance)) return ListenerQueueStats{0, 0, 0, 0};
+  return ii->entry_notifier.GetQueueStats();
+}
+
 void RemoveEntryListener(NT_EntryListener entry_listener) {
   Handle handle{entry_listener};
   int uid = handle.GetTypedIndex(Handle::kEntryListener);
@@ -881,6 +1030,69 @@ void SetUpdateRate(NT_Inst inst, double interval) {
   ii->dispatcher.SetUpdateRate(interval);
 }
 
+void SetNetworkEventLoop(NT_Inst inst, bool enabled) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) return;
+
+  ii->dispatcher.SetEventLoop(enabled);
+}
+
+void SetNetworkFlushMode(NT_Inst inst, NT_NetworkFlushMode mode,
+                         double window) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) return;
+
+  ii->dispatcher.SetFlushMode(mode, window);
+}
+
+void SetNetworkSocketFlags(NT_Inst inst, unsigned int flags) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) return;
+
+  ii->dispatcher.SetSocketFlags(flags);
+}
+
+void SetNetworkSubscriptions(NT_Inst inst, ArrayRef<StringRef> prefixes) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) return;
+
+  ii->dispatcher.SetSubscriptions(prefixes);
+}
+
+static unsigned int ToSendPeriod(double interval) {
+  if (interval < 0) return Message::kSendDefault;
+  if (interval >= (Message::kSendDefault - 1) / 1000.0)
+    return Message::kSendDefault - 1;
+  return static_cast<unsigned int>(interval * 1000 + 0.5);
+}
+
+void SetEntryUpdateRate(NT_Entry entry, double interval) {
+  Handle handle{entry};
+  int id = handle.GetTypedIndex(Handle::kEntry);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (id < 0 || !ii) return;
+
+  ii->storage.SetEntrySendPeriod(id, ToSendPeriod(interval));
+}
+
+double GetEntryUpdateRate(NT_Entry entry) {
+  Handle handle{entry};
+  int id = handle.GetTypedIndex(Handle::kEntry);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (id < 0 || !ii) return -1;
+
+  unsigned int period = ii->storage.GetEntrySendPeriod(id);
+  if (period == Message::kSendDefault) return -1;
+  return period / 1000.0;
+}
+
+void SetPrefixUpdateRate(NT_Inst inst, const Twine& prefix, double interval) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) return;
+
+  ii->storage.SetPrefixSendPeriod(prefix, ToSendPeriod(interval));
+}
+
 void Flush() { InstanceImpl::GetDefault()->dispatcher.Flush(); }
 
 void Flush(NT_Inst inst) {
@@ -901,6 +1113,13 @@ std::vector<ConnectionInfo> GetConnections(NT_Inst inst) {
   return ii->dispatcher.GetConnections();
 }
 
+std::vector<ConnectionStats> GetConnectionStats(NT_Inst inst) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) return std::vector<ConnectionStats>{};
+
+  return ii->dispatcher.GetConnectionStats();
+}
+
 bool IsConnected(NT_Inst inst) {
   auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
   if (!ii) return false;
@@ -938,6 +1157,20 @@ const char* LoadPersistent(
   return ii->storage.LoadPersistent(filename, warn);
 }
 
+void SetPersistentBinary(NT_Inst inst, bool binary) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) return;
+
+  ii->storage.SetPersistentBinary(binary);
+}
+
+void SetPersistentJournal(NT_Inst inst, bool enabled) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) return;
+
+  ii->storage.SetPersistentJournal(enabled);
+}
+
 const char* SaveEntries(NT_Inst inst, const Twine& filename,
                         const Twine& prefix) {
   auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
@@ -955,6 +1188,93 @@ const char* LoadEntries(
   return ii->storage.LoadEntries(filename, prefix, warn);
 }
 
+/*
+ * Data Log Functions
+ */
+
+NT_DataLogger StartDataLog(NT_Inst inst, const Twine& filename,
+                           const Twine& prefix, const char** err) {
+  int i = Handle{inst}.GetTypedInst(Handle::kInstance);
+  auto ii = InstanceImpl::Get(i);
+  if (!ii) {
+    if (err) *err = "invalid instance handle";
+    return 0;
+  }
+
+  unsigned int uid;
+  const char* e = ii->data_logger.Start(filename, prefix, &uid);
+  if (e) {
+    if (err) *err = e;
+    return 0;
+  }
+  return Handle(i, uid, Handle::kDataLogger);
+}
+
+void StopDataLog(NT_DataLogger logger) {
+  Handle handle{logger};
+  int uid = handle.GetTypedIndex(Handle::kDataLogger);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (uid < 0 || !ii) return;
+
+  ii->data_logger.Stop(uid);
+}
+
+NT_DataLogReplay StartDataLogReplay(NT_Inst inst, const Twine& filename,
+                                    double speed, const char** err) {
+  int i = Handle{inst}.GetTypedInst(Handle::kInstance);
+  auto ii = InstanceImpl::Get(i);
+  if (!ii) {
+    if (err) *err = "invalid instance handle";
+    return 0;
+  }
+
+  unsigned int uid;
+  const char* e = ii->data_log_replay.Start(filename, speed, &uid);
+  if (e) {
+    if (err) *err = e;
+    return 0;
+  }
+  return Handle(i, uid, Handle::kDataLogReplay);
+}
+
+bool WaitForDataLogReplay(NT_DataLogReplay replay, double timeout) {
+  Handle handle{replay};
+  int uid = handle.GetTypedIndex(Handle::kDataLogReplay);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (uid < 0 || !ii) return true;
+
+  return ii->data_log_replay.Wait(uid, timeout);
+}
+
+void StopDataLogReplay(NT_DataLogReplay replay) {
+  Handle handle{replay};
+  int uid = handle.GetTypedIndex(Handle::kDataLogReplay);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (uid < 0 || !ii) return;
+
+  ii->data_log_replay.Stop(uid);
+}
+
+const char* ConvertDataLog(
+    const Twine& filename, const Twine& out_filename, NT_DataLogFormat format,
+    std::function<void(size_t record, const char* msg)> warn) {
+  DataLogReader reader(warn);
+  if (const char* err = reader.Open(filename)) return err;
+
+  wpi::SmallString<128> fn;
+  out_filename.toVector(fn);
+  std::error_code ec;
+  wpi::raw_fd_ostream os(fn, ec, wpi::sys::fs::F_Text);
+  if (ec.value() != 0) return "could not open output file";
+  reader.Convert(os, format);
+  os.close();
+  if (os.has_error()) {
+    os.clear_error();
+    return "error writing output file";
+  }
+  return nullptr;
+}
+
 void SetLogger(LogFunc func, unsigned int min_level) {
   auto ii = InstanceImpl::GetDefault();
   static wpi::mutex mutex;
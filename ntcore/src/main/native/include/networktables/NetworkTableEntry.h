@@ -124,6 +124,31 @@ class NetworkTableEntry final {
    */
   std::shared_ptr<Value> GetValue() const;
 
+  /**
+   * Gets the entry's value at a past time (the latest value recorded at or
+   * before that time).  Only the current value is available unless history
+   * is enabled with SetHistory().
+   *
+   * @param time time, in the units returned by nt::Now()
+   * @return the entry's value, or nullptr if no value is known for the time
+   */
+  std::shared_ptr<Value> GetValueAt(uint64_t time) const;
+
+  /**
+   * Gets the entry's recorded values at or after a time, oldest first.
+   *
+   * @param since time, in the units returned by nt::Now()
+   * @return the entry's values
+   */
+  std::vector<std::shared_ptr<Value>> GetHistory(uint64_t since) const;
+
+  /**
+   * Enables recording the entry's past values.
+   *
+   * @param capacity maximum number of values to keep (0 to disable)
+   */
+  void SetHistory(size_t capacity);
+
   /**
    * Gets the entry's value as a boolean. If the entry does not exist or is of
    * different type, it will return the default value.
@@ -424,6 +449,24 @@ class NetworkTableEntry final {
    */
   bool IsPersistent() const;
 
+  /**
+   * Sets the update rate of this entry, overriding the instance update rate.
+   * An interval of 0 sends each change immediately; a positive interval
+   * sends changes at most once per interval (latest value only).
+   *
+   * @param interval minimum update interval in seconds, or negative to use
+   *                 the prefix or instance update rate
+   */
+  void SetUpdateRate(double interval);
+
+  /**
+   * Gets the update rate of this entry.
+   *
+   * @return Entry or prefix update interval in seconds, or -1 if the
+   *         instance update rate is used
+   */
+  double GetUpdateRate() const;
+
   /**
    * Deletes the entry.
    */
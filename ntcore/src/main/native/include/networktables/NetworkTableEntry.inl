@@ -45,6 +45,20 @@ inline std::shared_ptr<Value> NetworkTableEntry::GetValue() const {
   return GetEntryValue(m_handle);
 }
 
+inline std::shared_ptr<Value> NetworkTableEntry::GetValueAt(
+    uint64_t time) const {
+  return GetEntryValueAt(m_handle, time);
+}
+
+inline std::vector<std::shared_ptr<Value>> NetworkTableEntry::GetHistory(
+    uint64_t since) const {
+  return GetEntryHistory(m_handle, since);
+}
+
+inline void NetworkTableEntry::SetHistory(size_t capacity) {
+  SetEntryHistory(m_handle, capacity);
+}
+
 inline bool NetworkTableEntry::GetBoolean(bool defaultValue) const {
   auto value = GetEntryValue(m_handle);
   if (!value || value->type() != NT_BOOLEAN) return defaultValue;
@@ -130,11 +144,11 @@ inline bool NetworkTableEntry::SetValue(std::shared_ptr<Value> value) {
 }
 
 inline bool NetworkTableEntry::SetBoolean(bool value) {
-  return SetEntryValue(m_handle, Value::MakeBoolean(value));
+  return SetEntryBoolean(m_handle, value);
 }
 
 inline bool NetworkTableEntry::SetDouble(double value) {
-  return SetEntryValue(m_handle, Value::MakeDouble(value));
+  return SetEntryDouble(m_handle, value);
 }
 
 inline bool NetworkTableEntry::SetString(const Twine& value) {
@@ -206,6 +220,14 @@ inline bool NetworkTableEntry::IsPersistent() const {
   return (GetFlags() & kPersistent) != 0;
 }
 
+inline void NetworkTableEntry::SetUpdateRate(double interval) {
+  SetEntryUpdateRate(m_handle, interval);
+}
+
+inline double NetworkTableEntry::GetUpdateRate() const {
+  return GetEntryUpdateRate(m_handle);
+}
+
 inline void NetworkTableEntry::Delete() { DeleteEntry(m_handle); }
 
 inline void NetworkTableEntry::CreateRpc(
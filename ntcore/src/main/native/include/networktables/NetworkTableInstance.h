@@ -64,6 +64,23 @@ class NetworkTableInstance final {
     kNetModeFailure = NT_NET_MODE_FAILURE
   };
 
+  /**
+   * Network flush modes (as used by SetNetworkFlushMode()).
+   */
+  enum FlushMode {
+    kFlushPeriodic = NT_NET_FLUSH_PERIODIC,
+    kFlushIdle = NT_NET_FLUSH_IDLE
+  };
+
+  /**
+   * Network socket option flag values (as used by SetNetworkSocketFlags()).
+   * This is a bitmask.
+   */
+  enum SocketFlags {
+    kSocketNagle = NT_NET_SOCKET_NAGLE,
+    kSocketCork = NT_NET_SOCKET_CORK
+  };
+
   /**
    * Logging levels (as used by SetLogger()).
    */
@@ -218,6 +235,24 @@ class NetworkTableInstance final {
    */
   bool WaitForEntryListenerQueue(double timeout);
 
+  /**
+   * Limit the number of notifications waiting for entry listener callbacks.
+   * By default the queue is unlimited.
+   *
+   * @param capacity  maximum number of queued notifications (0 for unlimited)
+   * @param overflow  what to do when the queue is full (NT_QUEUE_BLOCK
+   *                  behaves like NT_QUEUE_COALESCE)
+   */
+  void SetEntryListenerQueue(size_t capacity, NT_QueueOverflow overflow);
+
+  /**
+   * Get statistics for the queue of notifications waiting for entry listener
+   * callbacks.
+   *
+   * @return Queue statistics
+   */
+  ListenerQueueStats GetEntryListenerQueueStats() const;
+
   /** @} */
 
   /**
@@ -417,6 +452,59 @@ class NetworkTableInstance final {
    */
   void SetUpdateRate(double interval);
 
+  /**
+   * Enable or disable event loop networking.
+   * When enabled, all network connections are serviced by a single event
+   * loop thread, rather than each connection having its own threads.
+   * This only takes effect when the client or server is next started.
+   *
+   * @param enabled true to use an event loop, false to use threads (default)
+   */
+  void SetNetworkEventLoop(bool enabled);
+
+  /**
+   * Set the network flush mode.
+   * In periodic mode (the default), changes are sent at the update rate, or
+   * sooner when Flush() is called.  In idle mode, changes are sent as soon
+   * as they are queued, after waiting up to the window for further changes
+   * to send with them.
+   *
+   * @param mode   flush mode
+   * @param window batching window in seconds (range 0 to 1.0)
+   */
+  void SetNetworkFlushMode(FlushMode mode, double window = 0);
+
+  /**
+   * Set network socket options.
+   * This only takes effect for new connections.
+   *
+   * @param flags bitmask of SocketFlags values
+   */
+  void SetNetworkSocketFlags(unsigned int flags);
+
+  /**
+   * Set the entry name prefixes to receive updates for when connected as a
+   * client.  Entries outside the prefixes are still received once when
+   * connecting, but are not updated after that, so their local values go
+   * stale until the next connection.  Publishing such an entry from the
+   * client subscribes to it.  An empty list (the default) receives
+   * everything.  This only takes effect for new connections.
+   *
+   * @param prefixes entry name prefixes
+   */
+  void SetNetworkSubscriptions(ArrayRef<StringRef> prefixes);
+
+  /**
+   * Sets the update rate of all entries starting with a prefix, overriding
+   * the instance update rate.  Entry-specific update rates take precedence,
+   * and the longest matching prefix is used.
+   *
+   * @param prefix   entry name prefix
+   * @param interval minimum update interval in seconds (0 to send each
+   *                 change immediately), or negative to remove
+   */
+  void SetPrefixUpdateRate(const Twine& prefix, double interval);
+
   /**
    * Flushes all updated values immediately to the network.
    * @note This is rate-limited to protect the network from flooding.
@@ -433,6 +521,13 @@ class NetworkTableInstance final {
    */
   std::vector<ConnectionInfo> GetConnections() const;
 
+  /**
+   * Get statistics for the currently established network connections.
+   *
+   * @return array of connection statistics
+   */
+  std::vector<ConnectionStats> GetConnectionStats() const;
+
   /**
    * Return whether or not the instance is connected to another node.
    *
@@ -470,6 +565,27 @@ class NetworkTableInstance final {
       const Twine& filename,
       std::function<void(size_t line, const char* msg)> warn);
 
+  /**
+   * Selects the file format used for saving persistent values.  The text
+   * format is used by default.  The binary format is faster to save and load
+   * and includes a checksum; LoadPersistent() and LoadEntries() accept either
+   * format, and SaveEntries() always uses the text format.
+   *
+   * @param binary    true to use the binary format, false for text
+   */
+  void SetPersistentBinary(bool binary);
+
+  /**
+   * Enables journaling of persistent values.  Instead of rewriting the whole
+   * persistent file, periodic saves append changed values to
+   * "<filename>.journal", and the persistent file is rewritten in the
+   * background once the journal grows large.  LoadPersistent() applies the
+   * journal when it is present.
+   *
+   * @param enabled   true to enable journaling
+   */
+  void SetPersistentJournal(bool enabled);
+
   /**
    * Save table values to a file.  The file format used is identical to
    * that used for SavePersistent.
@@ -59,6 +59,16 @@ inline bool NetworkTableInstance::WaitForEntryListenerQueue(double timeout) {
   return ::nt::WaitForEntryListenerQueue(m_handle, timeout);
 }
 
+inline void NetworkTableInstance::SetEntryListenerQueue(
+    size_t capacity, NT_QueueOverflow overflow) {
+  ::nt::SetEntryListenerQueue(m_handle, capacity, overflow);
+}
+
+inline ListenerQueueStats NetworkTableInstance::GetEntryListenerQueueStats()
+    const {
+  return ::nt::GetEntryListenerQueueStats(m_handle);
+}
+
 inline void NetworkTableInstance::RemoveConnectionListener(
     NT_ConnectionListener conn_listener) {
   ::nt::RemoveConnectionListener(conn_listener);
@@ -135,6 +145,30 @@ inline void NetworkTableInstance::SetUpdateRate(double interval) {
   ::nt::SetUpdateRate(m_handle, interval);
 }
 
+inline void NetworkTableInstance::SetNetworkEventLoop(bool enabled) {
+  ::nt::SetNetworkEventLoop(m_handle, enabled);
+}
+
+inline void NetworkTableInstance::SetNetworkFlushMode(FlushMode mode,
+                                                      double window) {
+  ::nt::SetNetworkFlushMode(m_handle, static_cast<NT_NetworkFlushMode>(mode),
+                            window);
+}
+
+inline void NetworkTableInstance::SetNetworkSocketFlags(unsigned int flags) {
+  ::nt::SetNetworkSocketFlags(m_handle, flags);
+}
+
+inline void NetworkTableInstance::SetNetworkSubscriptions(
+    ArrayRef<StringRef> prefixes) {
+  ::nt::SetNetworkSubscriptions(m_handle, prefixes);
+}
+
+inline void NetworkTableInstance::SetPrefixUpdateRate(const Twine& prefix,
+                                                      double interval) {
+  ::nt::SetPrefixUpdateRate(m_handle, prefix, interval);
+}
+
 inline void NetworkTableInstance::Flush() const { ::nt::Flush(m_handle); }
 
 inline std::vector<ConnectionInfo> NetworkTableInstance::GetConnections()
@@ -142,6 +176,11 @@ inline std::vector<ConnectionInfo> NetworkTableInstance::GetConnections()
   return ::nt::GetConnections(m_handle);
 }
 
+inline std::vector<ConnectionStats> NetworkTableInstance::GetConnectionStats()
+    const {
+  return ::nt::GetConnectionStats(m_handle);
+}
+
 inline bool NetworkTableInstance::IsConnected() const {
   return ::nt::IsConnected(m_handle);
 }
@@ -157,6 +196,14 @@ inline const char* NetworkTableInstance::LoadPersistent(
   return ::nt::LoadPersistent(m_handle, filename, warn);
 }
 
+inline void NetworkTableInstance::SetPersistentBinary(bool binary) {
+  ::nt::SetPersistentBinary(m_handle, binary);
+}
+
+inline void NetworkTableInstance::SetPersistentJournal(bool enabled) {
+  ::nt::SetPersistentJournal(m_handle, enabled);
+}
+
 inline const char* NetworkTableInstance::SaveEntries(
     const Twine& filename, const Twine& prefix) const {
   return ::nt::SaveEntries(m_handle, filename, prefix);
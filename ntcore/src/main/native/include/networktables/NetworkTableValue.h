@@ -241,11 +241,7 @@ class Value final {
    *             time)
    * @return The entry value
    */
-  static std::shared_ptr<Value> MakeBoolean(bool value, uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_BOOLEAN, time, private_init());
-    val->m_val.data.v_boolean = value;
-    return val;
-  }
+  static std::shared_ptr<Value> MakeBoolean(bool value, uint64_t time = 0);
 
   /**
    * Creates a double entry value.
@@ -255,11 +251,7 @@ class Value final {
    *             time)
    * @return The entry value
    */
-  static std::shared_ptr<Value> MakeDouble(double value, uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_DOUBLE, time, private_init());
-    val->m_val.data.v_double = value;
-    return val;
-  }
+  static std::shared_ptr<Value> MakeDouble(double value, uint64_t time = 0);
 
   /**
    * Creates a string entry value.
@@ -36,6 +36,8 @@ typedef int NT_Bool;
 typedef unsigned int NT_Handle;
 typedef NT_Handle NT_ConnectionListener;
 typedef NT_Handle NT_ConnectionListenerPoller;
+typedef NT_Handle NT_DataLogger;
+typedef NT_Handle NT_DataLogReplay;
 typedef NT_Handle NT_Entry;
 typedef NT_Handle NT_EntryListener;
 typedef NT_Handle NT_EntryListenerPoller;
@@ -97,6 +99,45 @@ enum NT_NetworkMode {
   NT_NET_MODE_FAILURE = 0x08,  /* flag for failure (either client or server) */
 };
 
+/** Network flush modes */
+enum NT_NetworkFlushMode {
+  NT_NET_FLUSH_PERIODIC = 0, /* send at the update rate, or on NT_Flush() */
+  NT_NET_FLUSH_IDLE = 1      /* send as soon as changes are queued */
+};
+
+/** Network socket option flags */
+enum NT_NetworkSocketFlags {
+  NT_NET_SOCKET_NAGLE = 0x01, /* leave the Nagle algorithm enabled */
+  NT_NET_SOCKET_CORK = 0x02   /* cork the socket while writing (Linux) */
+};
+
+/** Message type categories, for connection statistics */
+enum NT_MessageType {
+  NT_MSG_KEEP_ALIVE = 0,
+  NT_MSG_HANDSHAKE = 1,     /* all client and server hello messages */
+  NT_MSG_ENTRY_ASSIGN = 2,
+  NT_MSG_ENTRY_UPDATE = 3,  /* including array delta updates */
+  NT_MSG_FLAGS_UPDATE = 4,
+  NT_MSG_ENTRY_DELETE = 5,
+  NT_MSG_CLEAR_ENTRIES = 6,
+  NT_MSG_EXECUTE_RPC = 7,
+  NT_MSG_RPC_RESPONSE = 8,
+  NT_MSG_TYPE_COUNT = 9
+};
+
+/** Listener queue overflow policies */
+enum NT_QueueOverflow {
+  NT_QUEUE_DROP_OLDEST = 0, /* drop the oldest queued notification */
+  NT_QUEUE_COALESCE = 1,    /* replace a queued update of the same entry */
+  NT_QUEUE_BLOCK = 2        /* wait for the queue to be polled */
+};
+
+/** Data log conversion formats */
+enum NT_DataLogFormat {
+  NT_DATALOG_CSV = 0, /* one "time,name,type,value" row per change */
+  NT_DATALOG_JSON = 1 /* array with one object per change */
+};
+
 /*
  * Structures
  */
@@ -187,6 +228,63 @@ struct NT_ConnectionInfo {
   unsigned int protocol_version;
 };
 
+/** NetworkTables Connection Statistics */
+struct NT_ConnectionStats {
+  /** Connection information. */
+  struct NT_ConnectionInfo conn;
+
+  /** Number of bytes sent. */
+  uint64_t bytes_sent;
+
+  /** Number of bytes received. */
+  uint64_t bytes_received;
+
+  /** Number of messages sent, indexed by NT_MessageType. */
+  uint64_t messages_sent[NT_MSG_TYPE_COUNT];
+
+  /** Number of messages received, indexed by NT_MessageType. */
+  uint64_t messages_received[NT_MSG_TYPE_COUNT];
+
+  /**
+   * Number of outgoing messages replaced by a later message for the same
+   * entry before they were sent.
+   */
+  uint64_t coalesced;
+
+  /**
+   * Number of outgoing entry messages not sent because the remote client is
+   * not subscribed to the entry (see NT_SetNetworkSubscriptions()).
+   */
+  uint64_t filtered;
+
+  /** Number of outgoing messages waiting for the next flush. */
+  size_t pending;
+
+  /** Number of flushed batches of messages not yet written to the socket. */
+  size_t queued;
+
+  /** Round trip time estimate, in microseconds (0 if not available). */
+  unsigned int rtt;
+};
+
+/** NetworkTables Listener Queue Statistics */
+struct NT_ListenerQueueStats {
+  /** Number of notifications currently queued. */
+  size_t queued;
+
+  /** Maximum number of queued notifications (0 if unlimited). */
+  size_t capacity;
+
+  /** Number of notifications dropped because the queue was full. */
+  uint64_t dropped;
+
+  /**
+   * Number of notifications merged into an already queued notification
+   * because the queue was full.
+   */
+  uint64_t coalesced;
+};
+
 /** NetworkTables RPC Version 1 Definition Parameter */
 struct NT_RpcParamDef {
   struct NT_String name;
@@ -407,6 +505,117 @@ NT_Bool NT_SetDefaultEntryValue(NT_Entry entry,
  */
 NT_Bool NT_SetEntryValue(NT_Entry entry, const struct NT_Value* value);
 
+/**
+ * Get Entry Values.
+ *
+ * Returns copies of the current values of several entries, read as a
+ * consistent snapshot.  All entries must belong to the same instance.
+ *
+ * @param entries   array of entry handles
+ * @param count     number of entries
+ * @param values    array of count values to store the returned entry values
+ *
+ * It is the caller's responsibility to free each value once it's no longer
+ * needed (the utility function NT_DisposeValue() is useful for this
+ * purpose).
+ */
+void NT_GetEntryValues(const NT_Entry* entries, size_t count,
+                       struct NT_Value* values);
+
+/**
+ * Set Entry Values.
+ *
+ * Sets new values for several entries at once.  This only saves lock round
+ * trips and queues a single batch of network updates; the update is not
+ * atomic.  Entries whose current type differs from the type of the new value
+ * are not updated.  All entries must belong to the same instance.
+ *
+ * @param entries   array of entry handles
+ * @param values    array of new entry values
+ * @param count     number of entries and values
+ * @return 0 on error (type mismatch or invalid handle), 1 on success
+ */
+NT_Bool NT_SetEntryValues(const NT_Entry* entries,
+                          const struct NT_Value* values, size_t count);
+
+/**
+ * Get Entry Doubles.
+ *
+ * Reads the values of several double entries at once, as a consistent
+ * snapshot.  This does not allocate memory, other than growing a per-thread
+ * buffer the first time more than 64 entries are read at once on a thread.
+ * All entries must belong to the same instance.
+ *
+ * @param entries         array of entry handles
+ * @param count           number of entries
+ * @param default_value   value stored for entries that are not doubles
+ * @param values          array of count values to fill in
+ * @return Number of entries that had double values
+ */
+size_t NT_GetEntryDoubles(const NT_Entry* entries, size_t count,
+                          double default_value, double* values);
+
+/**
+ * Get Entry Booleans.
+ *
+ * Reads the values of several boolean entries at once; see
+ * NT_GetEntryDoubles().
+ *
+ * @param entries         array of entry handles
+ * @param count           number of entries
+ * @param default_value   value stored for entries that are not booleans
+ * @param values          array of count values to fill in
+ * @return Number of entries that had boolean values
+ */
+size_t NT_GetEntryBooleans(const NT_Entry* entries, size_t count,
+                           NT_Bool default_value, NT_Bool* values);
+
+/**
+ * Set Entry History.
+ *
+ * Enables recording past values of an entry, for use with
+ * NT_GetEntryValueAt() and NT_GetEntryHistory().  History is disabled by
+ * default.
+ *
+ * @param entry     entry handle
+ * @param capacity  maximum number of values to keep (0 to disable history)
+ */
+void NT_SetEntryHistory(NT_Entry entry, size_t capacity);
+
+/**
+ * Get Entry Value At Time.
+ *
+ * Returns the value the entry had at a past time (the latest recorded value
+ * at or before the time).  The value is unassigned if no value is known for
+ * that time.
+ *
+ * @param entry     entry handle
+ * @param time      time, in the units returned by NT_Now()
+ * @param value     storage for returned entry value
+ *
+ * It is the caller's responsibility to free value once it's no longer
+ * needed (the utility function NT_DisposeValue() is useful for this
+ * purpose).
+ */
+void NT_GetEntryValueAt(NT_Entry entry, uint64_t time, struct NT_Value* value);
+
+/**
+ * Get Entry History.
+ *
+ * Returns the recorded values of the entry at or after a time, oldest first.
+ * A deletion of the entry is returned as an unassigned value.
+ *
+ * @param entry     entry handle
+ * @param since     time, in the units returned by NT_Now()
+ * @param count     returns the number of values
+ * @return array of entry values
+ *
+ * It is the caller's responsibility to free the array.  The
+ * NT_DisposeValueArray function is useful for this purpose.
+ */
+struct NT_Value* NT_GetEntryHistory(NT_Entry entry, uint64_t since,
+                                    size_t* count);
+
 /**
  * Set Entry Type and Value.
  *
@@ -637,6 +846,30 @@ struct NT_EntryNotification* NT_PollEntryListenerTimeout(
  */
 void NT_CancelPollEntryListener(NT_EntryListenerPoller poller);
 
+/**
+ * Limit the number of entry notifications that can be queued.  By default
+ * queues are unlimited, so a listener that can't keep up uses more and more
+ * memory.
+ *
+ * @param handle    instance handle (for the queue of notifications waiting
+ *                  for listener callbacks) or entry listener poller handle
+ * @param capacity  maximum number of queued notifications (0 for unlimited)
+ * @param overflow  what to do when the queue is full; NT_QUEUE_BLOCK is only
+ *                  supported for pollers (for the instance queue, it behaves
+ *                  like NT_QUEUE_COALESCE)
+ */
+void NT_SetEntryListenerQueue(NT_Handle handle, size_t capacity,
+                              enum NT_QueueOverflow overflow);
+
+/**
+ * Get statistics for an entry listener queue.
+ *
+ * @param handle    instance handle or entry listener poller handle
+ * @param stats     statistics (output)
+ */
+void NT_GetEntryListenerQueueStats(NT_Handle handle,
+                                   struct NT_ListenerQueueStats* stats);
+
 /**
  * Remove an entry listener.
  *
@@ -1160,6 +1393,103 @@ void NT_StopDSClient(NT_Inst inst);
  */
 void NT_SetUpdateRate(NT_Inst inst, double interval);
 
+/**
+ * Enable or disable event loop networking.
+ * When enabled, all network connections are serviced by a single event loop
+ * thread, rather than each connection having its own read and write threads.
+ * The wire protocol is unaffected.  This only takes effect when the client
+ * or server is next started.
+ *
+ * @param inst      instance handle
+ * @param enabled   true to use an event loop, false to use threads (default)
+ */
+void NT_SetNetworkEventLoop(NT_Inst inst, NT_Bool enabled);
+
+/**
+ * Set the network flush mode.
+ * In periodic mode (the default), queued changes are sent at the update rate
+ * (see NT_SetUpdateRate()), or sooner when NT_Flush() is called; flushes are
+ * limited to once every 10 ms.  In idle mode, changes are sent as soon as
+ * they are queued.  A non-zero window delays sending by up to that long
+ * after the first change is queued, so changes made in quick succession are
+ * sent together; with a window of 0, each change is handed to the network
+ * immediately (changes made while a send is in progress are still combined
+ * into the next send).  NT_Flush() is not rate limited in idle mode.
+ *
+ * @param inst      instance handle
+ * @param mode      flush mode
+ * @param window    batching window in seconds (range 0 to 1.0); only used
+ *                  in idle mode
+ */
+void NT_SetNetworkFlushMode(NT_Inst inst, enum NT_NetworkFlushMode mode,
+                            double window);
+
+/**
+ * Set network socket options.
+ * By default the Nagle algorithm is disabled, as changes are already
+ * combined into batches before sending.  Corking holds back partial
+ * segments while a batch is being written, and while further batches are
+ * queued behind it.  This only takes effect for new connections.
+ *
+ * @param inst      instance handle
+ * @param flags     bitmask of NT_NetworkSocketFlags values
+ */
+void NT_SetNetworkSocketFlags(NT_Inst inst, unsigned int flags);
+
+/**
+ * Set the entry name prefixes to receive updates for when connected as a
+ * client.  Servers that support it only send changes to entries under
+ * these prefixes (and to entries this client publishes).  Entries outside
+ * the prefixes are still received once in the initial snapshot (which is
+ * sent before the server knows the subscriptions), but are not updated
+ * after that, so their local values go stale until the next connection.
+ * Publishing such an entry from the client subscribes to it.  An empty list
+ * (the default) receives everything.  This only takes effect for new
+ * connections.
+ *
+ * @param inst      instance handle
+ * @param count     length of the prefixes array
+ * @param prefixes  array of entry name prefixes
+ */
+void NT_SetNetworkSubscriptions(NT_Inst inst, size_t count,
+                                const char** prefixes);
+
+/**
+ * Set the update rate of an entry.
+ * This overrides the periodic update rate (see NT_SetUpdateRate()) for this
+ * entry.  An interval of 0 sends each change immediately.  A positive
+ * interval sends changes immediately, but at most once per interval; when
+ * changes come faster than that, only the latest value is sent.  A negative
+ * interval removes the entry-specific rate.
+ *
+ * @param entry     entry handle
+ * @param interval  minimum interval between updates, in seconds
+ */
+void NT_SetEntryUpdateRate(NT_Entry entry, double interval);
+
+/**
+ * Get the update rate of an entry.
+ *
+ * @param entry     entry handle
+ * @return Entry or prefix update interval in seconds, or -1 if the periodic
+ *         update rate is used
+ */
+double NT_GetEntryUpdateRate(NT_Entry entry);
+
+/**
+ * Set the update rate of all entries starting with a prefix.
+ * This applies to existing and future entries, but not to entries with an
+ * entry-specific update rate.  If multiple prefixes match, the longest one
+ * is used.  A negative interval removes the prefix update rate.
+ *
+ * @param inst        instance handle
+ * @param prefix      entry name prefix
+ * @param prefix_len  length of prefix in bytes
+ * @param interval    minimum interval between updates, in seconds
+ */
+void NT_SetPrefixUpdateRate(NT_Inst inst, const char* prefix,
+                            size_t prefix_len, double interval);
+
 /**
  * Flush Entries.
  *
@@ -1188,6 +1518,19 @@ void NT_Flush(NT_Inst inst);
  */
 struct NT_ConnectionInfo* NT_GetConnections(NT_Inst inst, size_t* count);
 
+/**
+ * Get statistics for the currently established network connections.
+ * Counters start at zero when each connection is established.
+ *
+ * @param inst  instance handle
+ * @param count returns the number of elements in the array
+ * @return      array of connection statistics
+ *
+ * It is the caller's responsibility to free the array. The
+ * NT_DisposeConnectionStatsArray function is useful for this purpose.
+ */
+struct NT_ConnectionStats* NT_GetConnectionStats(NT_Inst inst, size_t* count);
+
 /**
  * Return whether or not the instance is connected to another node.
  *
@@ -1227,6 +1570,28 @@ const char* NT_SavePersistent(NT_Inst inst, const char* filename);
 const char* NT_LoadPersistent(NT_Inst inst, const char* filename,
                               void (*warn)(size_t line, const char* msg));
 
+/**
+ * Select the file format used for saving persistent values.  The text format
+ * is used by default.  The binary format is faster to save and load and
+ * includes a checksum; NT_LoadPersistent() and NT_LoadEntries() accept either
+ * format, and NT_SaveEntries() always uses the text format.
+ *
+ * @param inst      instance handle
+ * @param binary    true to use the binary format, false for the text format
+ */
+void NT_SetPersistentBinary(NT_Inst inst, NT_Bool binary);
+
+/**
+ * Enable journaling of persistent values.  When enabled, periodic saves
+ * append the changed values to "<filename>.journal" instead of rewriting the
+ * persistent file, which is rewritten in the background once the journal
+ * grows large.  NT_LoadPersistent() applies the journal if present.
+ *
+ * @param inst      instance handle
+ * @param enabled   true to enable journaling
+ */
+void NT_SetPersistentJournal(NT_Inst inst, NT_Bool enabled);
+
 /**
  * Save table values to a file.  The file format used is identical to
  * that used for SavePersistent.
@@ -1257,6 +1622,90 @@ const char* NT_LoadEntries(NT_Inst inst, const char* filename,
 
 /** @} */
 
+/**
+ * @defgroup ntcore_datalog_cfunc Data Log Functions
+ * @{
+ */
+
+/**
+ * Start logging entry changes to a binary data log file.  The current value
+ * of each matching entry and every subsequent change (including changes
+ * received from the network) and deletion is recorded with its timestamp.
+ * Changes are buffered in memory and written to the file by a background
+ * thread.  Any existing file is replaced.
+ *
+ * @param inst        instance handle
+ * @param filename    filename
+ * @param prefix      log only keys starting with this prefix
+ * @param prefix_len  length of prefix in bytes
+ * @param err         set to an error string if the log cannot be started
+ * @return data logger handle, or 0 on error
+ */
+NT_DataLogger NT_StartDataLog(NT_Inst inst, const char* filename,
+                              const char* prefix, size_t prefix_len,
+                              const char** err);
+
+/**
+ * Stop a data log.  Buffered changes are written to the file before this
+ * function returns.  Changes still queued for listeners are not logged; call
+ * NT_WaitForEntryListenerQueue() first to include them.
+ *
+ * @param logger      data logger handle
+ */
+void NT_StopDataLog(NT_DataLogger logger);
+
+/**
+ * Start replaying a binary data log into an instance.  Each recorded change
+ * and deletion is applied as a local change (so it drives entry listeners and
+ * is sent to any connected clients), with the same spacing as the recording
+ * divided by speed.  Values are timestamped with the time they are applied.
+ * The replay runs on a background thread.  Typically the instance is started
+ * as a local-only server (or not started at all).
+ *
+ * @param inst      instance handle
+ * @param filename  data log filename
+ * @param speed     replay speed relative to the recording (e.g. 1 for real
+ *                  time, 10 for 10x); 0 replays as fast as possible
+ * @param err       set to an error string if the replay cannot be started
+ * @return data log replay handle, or 0 on error
+ */
+NT_DataLogReplay NT_StartDataLogReplay(NT_Inst inst, const char* filename,
+                                       double speed, const char** err);
+
+/**
+ * Wait for a data log replay to finish.
+ *
+ * @param replay    data log replay handle
+ * @param timeout   timeout, in seconds; a negative value waits forever
+ * @return False if timed out, otherwise true.
+ */
+NT_Bool NT_WaitForDataLogReplay(NT_DataLogReplay replay, double timeout);
+
+/**
+ * Stop a data log replay (if it is still running) and release its handle.
+ * Must be called for each replay, even one that has finished.
+ *
+ * @param replay    data log replay handle
+ */
+void NT_StopDataLogReplay(NT_DataLogReplay replay);
+
+/**
+ * Convert a binary data log file to text.  Times are written in seconds since
+ * the start of the log.  A log that was not stopped cleanly is converted up to
+ * the last complete change.
+ *
+ * @param filename      data log filename
+ * @param out_filename  output filename
+ * @param format        output format
+ * @param warn          callback function for warnings
+ * @return error string, or nullptr if successful
+ */
+const char* NT_ConvertDataLog(const char* filename, const char* out_filename,
+                              enum NT_DataLogFormat format,
+                              void (*warn)(size_t record, const char* msg));
+
+/** @} */
+
 /**
  * @defgroup ntcore_utility_cfunc Utility Functions
  * @{
@@ -1269,6 +1718,14 @@ const char* NT_LoadEntries(NT_Inst inst, const char* filename,
  */
 void NT_DisposeValue(struct NT_Value* value);
 
+/**
+ * Disposes a value array.
+ *
+ * @param arr   pointer to the array to dispose
+ * @param count number of elements in the array
+ */
+void NT_DisposeValueArray(struct NT_Value* arr, size_t count);
+
 /**
  * Initializes a NT_Value.
  * Sets type to NT_UNASSIGNED and clears rest of struct.
@@ -1308,6 +1765,15 @@ void NT_DisposeEntryArray(NT_Entry* arr, size_t count);
  */
 void NT_DisposeConnectionInfoArray(struct NT_ConnectionInfo* arr, size_t count);
 
+/**
+ * Disposes a connection statistics array.
+ *
+ * @param arr   pointer to the array to dispose
+ * @param count number of elements in the array
+ */
+void NT_DisposeConnectionStatsArray(struct NT_ConnectionStats* arr,
+                                    size_t count);
+
 /**
  * Disposes an entry info array.
  *
@@ -103,6 +103,63 @@ struct ConnectionInfo {
   }
 };
 
+/** NetworkTables Connection Statistics */
+struct ConnectionStats {
+  /** Connection information. */
+  ConnectionInfo conn;
+
+  /** Number of bytes sent. */
+  uint64_t bytes_sent;
+
+  /** Number of bytes received. */
+  uint64_t bytes_received;
+
+  /** Number of messages sent, indexed by NT_MessageType. */
+  uint64_t messages_sent[NT_MSG_TYPE_COUNT];
+
+  /** Number of messages received, indexed by NT_MessageType. */
+  uint64_t messages_received[NT_MSG_TYPE_COUNT];
+
+  /**
+   * Number of outgoing messages replaced by a later message for the same
+   * entry before they were sent.
+   */
+  uint64_t coalesced;
+
+  /**
+   * Number of outgoing entry messages not sent because the remote client is
+   * not subscribed to the entry (see SetNetworkSubscriptions()).
+   */
+  uint64_t filtered;
+
+  /** Number of outgoing messages waiting for the next flush. */
+  size_t pending;
+
+  /** Number of flushed batches of messages not yet written to the socket. */
+  size_t queued;
+
+  /** Round trip time estimate, in microseconds (0 if not available). */
+  unsigned int rtt;
+};
+
+/** NetworkTables Listener Queue Statistics */
+struct ListenerQueueStats {
+  /** Number of notifications currently queued. */
+  size_t queued;
+
+  /** Maximum number of queued notifications (0 if unlimited). */
+  size_t capacity;
+
+  /** Number of notifications dropped because the queue was full. */
+  uint64_t dropped;
+
+  /**
+   * Number of notifications merged into an already queued notification
+   * because the queue was full.
+   */
+  uint64_t coalesced;
+};
+
 /** NetworkTables RPC Version 1 Definition Parameter */
 struct RpcParamDef {
   RpcParamDef() = default;
@@ -450,6 +507,149 @@ bool SetEntryValue(StringRef name, std::shared_ptr<Value> value);
  */
 bool SetEntryValue(NT_Entry entry, std::shared_ptr<Value> value);
 
+/**
+ * Set Entry Boolean Value.
+ *
+ * Sets new entry value without an explicit Value object.  The value itself
+ * is allocated from an internal pool rather than the heap; entry listener
+ * notifications and network updates resulting from the change may still
+ * allocate.  If the entry currently has a different type, returns error and
+ * does not update value.
+ *
+ * @param entry     entry handle
+ * @param value     new entry value
+ * @param time      if nonzero, the creation time to use (instead of the
+ *                  current time)
+ * @return False on error (type mismatch), True on success
+ */
+bool SetEntryBoolean(NT_Entry entry, bool value, uint64_t time = 0);
+
+/**
+ * Set Entry Double Value.
+ *
+ * Sets new entry value without an explicit Value object.  The value itself
+ * is allocated from an internal pool rather than the heap; entry listener
+ * notifications and network updates resulting from the change may still
+ * allocate.  If the entry currently has a different type, returns error and
+ * does not update value.
+ *
+ * @param entry     entry handle
+ * @param value     new entry value
+ * @param time      if nonzero, the creation time to use (instead of the
+ *                  current time)
+ * @return False on error (type mismatch), True on success
+ */
+bool SetEntryDouble(NT_Entry entry, double value, uint64_t time = 0);
+
+/**
+ * Get Entry Values.
+ *
+ * Returns the values of several entries at once.  The values are read as a
+ * consistent snapshot; no other update can be observed partway through.
+ *
+ * All entries must belong to the same instance.  Invalid handles and
+ * entries that do not exist result in empty (nullptr) values.
+ *
+ * @param entries   entry handles
+ * @return Entry values, in the same order as entries
+ */
+std::vector<std::shared_ptr<Value>> GetEntryValues(ArrayRef<NT_Entry> entries);
+
+/**
+ * Set Entry Values.
+ *
+ * Sets new values for several entries at once.  This is cheaper than calling
+ * SetEntryValue() for each entry: the storage lock is taken once and the
+ * resulting network updates are queued as a single batch.  The update is not
+ * atomic; GetEntryValue() and listeners may observe the new values one at a
+ * time.
+ *
+ * All entries must belong to the same instance.  Entries whose current type
+ * differs from the type of the new value are not updated, and an error is
+ * returned; the other entries are still updated.
+ *
+ * @param entries   entry handles
+ * @param values    new entry values (must be the same size as entries)
+ * @return False on error (type mismatch, invalid handle, or size mismatch),
+ *         True on success
+ */
+bool SetEntryValues(ArrayRef<NT_Entry> entries,
+                    ArrayRef<std::shared_ptr<Value>> values);
+
+/**
+ * Get Entry Doubles.
+ *
+ * Reads the values of several double entries at once into a caller-provided
+ * array, as a consistent snapshot (see GetEntryValues()).  Unlike
+ * GetEntryValues(), this does not allocate memory, other than growing a
+ * per-thread buffer the first time more than 64 entries are read at once on
+ * a thread.  All entries must belong to the same instance.
+ *
+ * @param entries         entry handles
+ * @param default_value   value stored for entries that are not doubles (or
+ *                        do not exist, or are invalid handles)
+ * @param values          array of entries.size() values to fill in
+ * @return Number of entries that had double values
+ */
+size_t GetEntryDoubles(ArrayRef<NT_Entry> entries, double default_value,
+                       double* values);
+
+/**
+ * Get Entry Booleans.
+ *
+ * Reads the values of several boolean entries at once into a
+ * caller-provided array; see GetEntryDoubles().
+ *
+ * @param entries         entry handles
+ * @param default_value   value stored for entries that are not booleans (or
+ *                        do not exist, or are invalid handles)
+ * @param values          array of entries.size() values to fill in
+ * @return Number of entries that had boolean values
+ */
+size_t GetEntryBooleans(ArrayRef<NT_Entry> entries, bool default_value,
+                        bool* values);
+
+/**
+ * Set Entry History.
+ *
+ * Enables recording past values of an entry (both local and remote
+ * changes), for use with GetEntryValueAt() and GetEntryHistory().  History
+ * is disabled by default.  Boolean and double values are recorded without
+ * allocating memory.
+ *
+ * @param entry     entry handle
+ * @param capacity  maximum number of values to keep (0 to disable history)
+ */
+void SetEntryHistory(NT_Entry entry, size_t capacity);
+
+/**
+ * Get Entry Value At Time.
+ *
+ * Returns the value the entry had at a past time: the latest recorded value
+ * with a time at or before the given time.  If history is not enabled, only
+ * the current value is available.
+ *
+ * @param entry     entry handle
+ * @param time      time, in the units returned by Now()
+ * @return entry value, or nullptr if no value is known for that time or the
+ *         entry had been deleted
+ */
+std::shared_ptr<Value> GetEntryValueAt(NT_Entry entry, uint64_t time);
+
+/**
+ * Get Entry History.
+ *
+ * Returns the recorded values of the entry with a time at or after since,
+ * oldest first.  A deletion of the entry is returned as nullptr.  If history
+ * is not enabled, only the current value is available.
+ *
+ * @param entry     entry handle
+ * @param since     time, in the units returned by Now()
+ * @return entry values
+ */
+std::vector<std::shared_ptr<Value>> GetEntryHistory(NT_Entry entry,
+                                                    uint64_t since);
+
 /**
  * Set Entry Type and Value.
  *
@@ -744,6 +944,32 @@ std::vector<EntryNotification> PollEntryListener(NT_EntryListenerPoller poller,
  */
 void CancelPollEntryListener(NT_EntryListenerPoller poller);
 
+/**
+ * Limit the number of entry notifications that can be queued.  By default
+ * queues are unlimited, so a listener that can't keep up uses more and more
+ * memory.  When a queue is full, the overflow policy selects between dropping
+ * the oldest notification, replacing a queued notification for the same
+ * entry (falling back to dropping the oldest), or waiting for the poller to
+ * catch up (which delays notifications to all other listeners).
+ *
+ * @param handle    instance handle (for the queue of notifications waiting
+ *                  for listener callbacks) or entry listener poller handle
+ * @param capacity  maximum number of queued notifications (0 for unlimited)
+ * @param overflow  what to do when the queue is full; NT_QUEUE_BLOCK is only
+ *                  supported for pollers (for the instance queue, it behaves
+ *                  like NT_QUEUE_COALESCE)
+ */
+void SetEntryListenerQueue(NT_Handle handle, size_t capacity,
+                           NT_QueueOverflow overflow);
+
+/**
+ * Get statistics for an entry listener queue.
+ *
+ * @param handle    instance handle or entry listener poller handle
+ * @return Queue statistics
+ */
+ListenerQueueStats GetEntryListenerQueueStats(NT_Handle handle);
+
 /**
  * Remove an entry listener.
  *
@@ -1322,6 +1548,102 @@ void SetUpdateRate(double interval);
  */
 void SetUpdateRate(NT_Inst inst, double interval);
 
+/**
+ * Enable or disable event loop networking.
+ * When enabled, all network connections are serviced by a single event loop
+ * thread, rather than each connection having its own read and write threads.
+ * The wire protocol is unaffected.  This only takes effect when the client
+ * or server is next started.
+ *
+ * @param inst      instance handle
+ * @param enabled   true to use an event loop, false to use threads (default)
+ */
+void SetNetworkEventLoop(NT_Inst inst, bool enabled);
+
+/**
+ * Set the network flush mode.
+ * In periodic mode (the default), queued changes are sent at the update rate
+ * (see SetUpdateRate()), or sooner when Flush() is called; flushes are
+ * limited to once every 10 ms.  In idle mode, changes are sent as soon as
+ * they are queued.  A non-zero window delays sending by up to that long
+ * after the first change is queued, so changes made in quick succession are
+ * sent together; with a window of 0, each change is handed to the network
+ * immediately (changes made while a send is in progress are still combined
+ * into the next send).  Flush() is not rate limited in idle mode.
+ *
+ * @param inst      instance handle
+ * @param mode      flush mode
+ * @param window    batching window in seconds (range 0 to 1.0); only used
+ *                  in idle mode
+ */
+void SetNetworkFlushMode(NT_Inst inst, NT_NetworkFlushMode mode,
+                         double window = 0);
+
+/**
+ * Set network socket options.
+ * By default the Nagle algorithm is disabled, as changes are already
+ * combined into batches before sending.  Corking holds back partial
+ * segments while a batch is being written, and while further batches are
+ * queued behind it.  This only takes effect for new connections.
+ *
+ * @param inst      instance handle
+ * @param flags     bitmask of NT_NetworkSocketFlags values
+ */
+void SetNetworkSocketFlags(NT_Inst inst, unsigned int flags);
+
+/**
+ * Set the entry name prefixes to receive updates for when connected as a
+ * client.  Servers that support it only send changes to entries under
+ * these prefixes (and to entries this client publishes).  Entries outside
+ * the prefixes are still received once in the initial snapshot (which is
+ * sent before the server knows the subscriptions), but are not updated
+ * after that, so their local values go stale until the next connection.
+ * Publishing such an entry from the client subscribes to it.  An empty list
+ * (the default) receives everything.  This only takes effect for new
+ * connections.
+ *
+ * @param inst      instance handle
+ * @param prefixes  entry name prefixes
+ */
+void SetNetworkSubscriptions(NT_Inst inst, ArrayRef<StringRef> prefixes);
+
+/**
+ * Set the update rate of an entry.
+ * This overrides the periodic update rate (see SetUpdateRate()) for this
+ * entry.  An interval of 0 sends each change immediately.  A positive
+ * interval sends changes immediately, but at most once per interval; when
+ * changes come faster than that, only the latest value is sent, with the
+ * next periodic update after the interval has elapsed.  A negative interval
+ * removes the entry-specific rate (so a prefix rate or the periodic rate is
+ * used).
+ *
+ * @param entry     entry handle
+ * @param interval  minimum interval between updates, in seconds
+ */
+void SetEntryUpdateRate(NT_Entry entry, double interval);
+
+/**
+ * Get the update rate of an entry.
+ *
+ * @param entry     entry handle
+ * @return Entry or prefix update interval in seconds, or -1 if the periodic
+ *         update rate is used (see SetEntryUpdateRate())
+ */
+double GetEntryUpdateRate(NT_Entry entry);
+
+/**
+ * Set the update rate of all entries starting with a prefix.
+ * This applies to existing and future entries, but not to entries with an
+ * entry-specific update rate.  If multiple prefixes match, the longest one
+ * is used.  See SetEntryUpdateRate() for the meaning of the interval; a
+ * negative interval removes the prefix update rate.
+ *
+ * @param inst      instance handle
+ * @param prefix    entry name prefix
+ * @param interval  minimum interval between updates, in seconds
+ */
+void SetPrefixUpdateRate(NT_Inst inst, const Twine& prefix, double interval);
+
 /**
  * Flush Entries.
  *
@@ -1359,6 +1681,16 @@ std::vector<ConnectionInfo> GetConnections();
  */
 std::vector<ConnectionInfo> GetConnections(NT_Inst inst);
 
+/**
+ * Get statistics for the currently established network connections.
+ * Counters start at zero when each connection is established.  Collecting
+ * the statistics is cheap enough to leave enabled at all times.
+ *
+ * @param inst  instance handle
+ * @return      array of connection statistics
+ */
+std::vector<ConnectionStats> GetConnectionStats(NT_Inst inst);
+
 /**
  * Return whether or not the instance is connected to another node.
  *
@@ -1414,6 +1746,31 @@ const char* LoadPersistent(
     NT_Inst inst, const Twine& filename,
     std::function<void(size_t line, const char* msg)> warn);
 
+/**
+ * Select the file format used for saving persistent values.  The text format
+ * is used by default.  The binary format is faster to save and load and
+ * includes a checksum; LoadPersistent() and LoadEntries() accept either
+ * format, and SaveEntries() always uses the text format, so it can be used
+ * to export values in a readable form.
+ *
+ * @param inst      instance handle
+ * @param binary    true to use the binary format, false for the text format
+ */
+void SetPersistentBinary(NT_Inst inst, bool binary);
+
+/**
+ * Enable journaling of persistent values.  When enabled, periodic saves
+ * append the changed values to "<filename>.journal" instead of rewriting the
+ * persistent file.  Once the journal grows larger than the persistent file,
+ * the persistent file is rewritten on a background thread and the journal is
+ * restarted.  An explicit SavePersistent() of the same file always rewrites
+ * it.  LoadPersistent() applies the journal if present.
+ *
+ * @param inst      instance handle
+ * @param enabled   true to enable journaling
+ */
+void SetPersistentJournal(NT_Inst inst, bool enabled);
+
 /**
  * Save table values to a file.  The file format used is identical to
  * that used for SavePersistent.
@@ -1442,6 +1799,91 @@ const char* LoadEntries(NT_Inst inst, const Twine& filename,
 
 /** @} */
 
+/**
+ * @defgroup ntcore_datalog_func Data Log Functions
+ * @{
+ */
+
+/**
+ * Start logging entry changes to a binary data log file.  The current value
+ * of each matching entry and every subsequent change (including changes
+ * received from the network) and deletion is recorded with its timestamp.
+ * Changes are buffered in memory and written to the file by a background
+ * thread.  Any existing file is replaced.
+ *
+ * @param inst      instance handle
+ * @param filename  filename
+ * @param prefix    log only keys starting with this prefix
+ * @param err       set to an error string if the log cannot be started
+ *                  (may be nullptr)
+ * @return data logger handle, or 0 on error
+ */
+NT_DataLogger StartDataLog(NT_Inst inst, const Twine& filename,
+                           const Twine& prefix, const char** err = nullptr);
+
+/**
+ * Stop a data log.  Buffered changes are written to the file before this
+ * function returns.  Changes still queued for listeners are not logged; call
+ * WaitForEntryListenerQueue() first to include them.
+ *
+ * @param logger    data logger handle
+ */
+void StopDataLog(NT_DataLogger logger);
+
+/**
+ * Start replaying a binary data log into an instance.  Each recorded change
+ * and deletion is applied as a local change (so it drives entry listeners and
+ * is sent to any connected clients), with the same spacing as the recording
+ * divided by speed.  Values are timestamped with the time they are applied.
+ * The replay runs on a background thread.  Typically the instance is started
+ * as a local-only server (or not started at all).
+ *
+ * @param inst      instance handle
+ * @param filename  data log filename
+ * @param speed     replay speed relative to the recording (e.g. 1 for real
+ *                  time, 10 for 10x); 0 replays as fast as possible
+ * @param err       set to an error string if the replay cannot be started
+ *                  (may be nullptr)
+ * @return data log replay handle, or 0 on error
+ */
+NT_DataLogReplay StartDataLogReplay(NT_Inst inst, const Twine& filename,
+                                    double speed,
+                                    const char** err = nullptr);
+
+/**
+ * Wait for a data log replay to finish.
+ *
+ * @param replay    data log replay handle
+ * @param timeout   timeout, in seconds; a negative value waits forever
+ * @return False if timed out, otherwise true.
+ */
+bool WaitForDataLogReplay(NT_DataLogReplay replay, double timeout);
+
+/**
+ * Stop a data log replay (if it is still running) and release its handle.
+ * Must be called for each replay, even one that has finished.
+ *
+ * @param replay    data log replay handle
+ */
+void StopDataLogReplay(NT_DataLogReplay replay);
+
+/**
+ * Convert a binary data log file to text.  Times are written in seconds since
+ * the start of the log.  A log that was not stopped cleanly is converted up to
+ * the last complete change.
+ *
+ * @param filename      data log filename
+ * @param out_filename  output filename
+ * @param format        output format
+ * @param warn          callback function for warnings
+ * @return error string, or nullptr if successful
+ */
+const char* ConvertDataLog(
+    const Twine& filename, const Twine& out_filename, NT_DataLogFormat format,
+    std::function<void(size_t record, const char* msg)> warn);
+
+/** @} */
+
 /**
  * @defgroup ntcore_utility_func Utility Functions
  * @{
@@ -0,0 +1,63 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AppendOnlyVector.h"
+#include "gtest/gtest.h"
+
+namespace nt {
+
+class AppendOnlyVectorTest : public ::testing::Test {};
+
+TEST_F(AppendOnlyVectorTest, Empty) {
+  AppendOnlyVector<int, 2, 4> v;
+  ASSERT_TRUE(v.empty());
+  ASSERT_EQ(0u, v.size());
+  ASSERT_EQ(16u, v.max_size());
+}
+
+TEST_F(AppendOnlyVectorTest, EmplaceBackAcrossChunks) {
+  AppendOnlyVector<std::unique_ptr<int>, 2, 4> v;
+  std::vector<int*> addrs;
+  for (int i = 0; i < 16; ++i) {
+    v.emplace_back(new int(i));
+    addrs.push_back(v.back().get());
+  }
+  ASSERT_EQ(16u, v.size());
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_EQ(i, *v[i]);
+    // elements never move
+    ASSERT_EQ(addrs[i], v[i].get());
+  }
+}
+
+TEST_F(AppendOnlyVectorTest, Full) {
+  AppendOnlyVector<int, 2, 4> v;
+  for (int i = 0; i < 16; ++i) ASSERT_NE(nullptr, v.emplace_back(i));
+  ASSERT_TRUE(v.full());
+  ASSERT_EQ(nullptr, v.emplace_back(16));
+  ASSERT_EQ(16u, v.size());
+  ASSERT_EQ(15, v.back());
+}
+
+TEST_F(AppendOnlyVectorTest, ConcurrentRead) {
+  AppendOnlyVector<int, 4> v;
+  std::thread reader([&] {
+    size_t seen = 0;
+    while (seen < 1000) {
+      size_t n = v.size();
+      for (; seen < n; ++seen) ASSERT_EQ(static_cast<int>(seen), v[seen]);
+    }
+  });
+  for (int i = 0; i < 1000; ++i) v.emplace_back(i);
+  reader.join();
+}
+
+}  // namespace nt
@@ -106,3 +106,226 @@ TEST_F(ConnectionListenerTest, Threaded) {
   EXPECT_EQ(handle, result[0].listener);
   EXPECT_FALSE(result[0].connected);
 }
+
+TEST_F(ConnectionListenerTest, EventLoop) {
+  nt::SetNetworkEventLoop(server_inst, true);
+  nt::SetNetworkEventLoop(client_inst, true);
+
+  // set up the poller
+  NT_ConnectionListenerPoller poller =
+      nt::CreateConnectionListenerPoller(server_inst);
+  ASSERT_NE(poller, 0u);
+  NT_ConnectionListener handle = nt::AddPolledConnectionListener(poller, false);
+  ASSERT_NE(handle, 0u);
+
+  // trigger a connect event
+  Connect();
+
+  // get the event
+  ASSERT_TRUE(nt::WaitForConnectionListenerQueue(server_inst, 1.0));
+  bool timed_out = false;
+  auto result = nt::PollConnectionListener(poller, 0.1, &timed_out);
+  EXPECT_FALSE(timed_out);
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(handle, result[0].listener);
+  EXPECT_TRUE(result[0].connected);
+  EXPECT_EQ(result[0].conn.remote_id, "client");
+
+  // values are exchanged in both directions
+  nt::SetEntryValue(nt::GetEntry(client_inst, "/foo"),
+                    nt::Value::MakeDouble(1.0));
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/bar"),
+                    nt::Value::MakeDouble(2.0));
+  nt::Flush(client_inst);
+  nt::Flush(server_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  auto value = nt::GetEntryValue(nt::GetEntry(server_inst, "/foo"));
+  ASSERT_TRUE(value && value->IsDouble());
+  EXPECT_EQ(value->GetDouble(), 1.0);
+  value = nt::GetEntryValue(nt::GetEntry(client_inst, "/bar"));
+  ASSERT_TRUE(value && value->IsDouble());
+  EXPECT_EQ(value->GetDouble(), 2.0);
+
+  // trigger a disconnect event
+  nt::StopClient(client_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // get the event
+  ASSERT_TRUE(nt::WaitForConnectionListenerQueue(server_inst, 1.0));
+  timed_out = false;
+  result = nt::PollConnectionListener(poller, 0.1, &timed_out);
+  EXPECT_FALSE(timed_out);
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(handle, result[0].listener);
+  EXPECT_FALSE(result[0].connected);
+}
+
+TEST_F(ConnectionListenerTest, Stats) {
+  Connect();
+
+  nt::SetEntryValue(nt::GetEntry(client_inst, "/foo"),
+                    nt::Value::MakeDouble(1.0));
+  nt::Flush(client_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  auto client_stats = nt::GetConnectionStats(client_inst);
+  ASSERT_EQ(client_stats.size(), 1u);
+  EXPECT_EQ("server", client_stats[0].conn.remote_id);
+  EXPECT_GT(client_stats[0].bytes_sent, 0u);
+  EXPECT_GT(client_stats[0].bytes_received, 0u);
+  EXPECT_GE(client_stats[0].messages_sent[NT_MSG_HANDSHAKE], 2u);
+  EXPECT_EQ(client_stats[0].messages_sent[NT_MSG_ENTRY_ASSIGN], 1u);
+
+  // the echo goes out with the server's next periodic update
+  std::vector<nt::ConnectionStats> server_stats;
+  for (int i = 0; i < 50; ++i) {
+    server_stats = nt::GetConnectionStats(server_inst);
+    if (server_stats.size() == 1 &&
+        server_stats[0].messages_sent[NT_MSG_ENTRY_ASSIGN] > 0 &&
+        server_stats[0].pending == 0)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(server_stats.size(), 1u);
+  EXPECT_EQ("client", server_stats[0].conn.remote_id);
+  EXPECT_EQ(server_stats[0].messages_received[NT_MSG_ENTRY_ASSIGN], 1u);
+  // the server echoes the assignment back with an id
+  EXPECT_EQ(server_stats[0].messages_sent[NT_MSG_ENTRY_ASSIGN], 1u);
+  EXPECT_EQ(server_stats[0].pending, 0u);
+}
+
+TEST_F(ConnectionListenerTest, FlushOnIdle) {
+  // periodic updates alone would take up to a second
+  nt::SetUpdateRate(server_inst, 1.0);
+  nt::SetUpdateRate(client_inst, 1.0);
+  nt::SetNetworkFlushMode(client_inst, NT_NET_FLUSH_IDLE, 0);
+  nt::SetNetworkFlushMode(server_inst, NT_NET_FLUSH_IDLE, 0.02);
+  nt::SetNetworkSocketFlags(server_inst, NT_NET_SOCKET_CORK);
+  nt::SetNetworkSocketFlags(client_inst, NT_NET_SOCKET_NAGLE);
+  Connect();
+
+  auto wait_for = [](NT_Entry entry, double expected) {
+    for (int i = 0; i < 20; ++i) {
+      auto value = nt::GetEntryValue(entry);
+      if (value && value->IsDouble() && value->GetDouble() == expected)
+        return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  };
+
+  // no window: sent immediately, without a flush
+  nt::SetEntryValue(nt::GetEntry(client_inst, "/foo"),
+                    nt::Value::MakeDouble(1.0));
+  EXPECT_TRUE(wait_for(nt::GetEntry(server_inst, "/foo"), 1.0));
+
+  // sent at the end of the window
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/bar"),
+                    nt::Value::MakeDouble(2.0));
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/bar"),
+                    nt::Value::MakeDouble(3.0));
+  EXPECT_TRUE(wait_for(nt::GetEntry(client_inst, "/bar"), 3.0));
+}
+
+TEST_F(ConnectionListenerTest, SendPeriodDeadline) {
+  // periodic updates alone would take up to a second
+  nt::SetUpdateRate(server_inst, 1.0);
+  nt::SetUpdateRate(client_inst, 1.0);
+  Connect();
+
+  auto server_entry = nt::GetEntry(server_inst, "/bar");
+  auto client_entry = nt::GetEntry(client_inst, "/bar");
+  nt::SetEntryUpdateRate(server_entry, 0.05);
+  nt::SetEntryValue(server_entry, nt::Value::MakeDouble(1.0));
+  nt::Flush(server_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // the first update is sent right away; the second is held until the
+  // period has elapsed and then sent without waiting for a periodic update
+  nt::SetEntryValue(server_entry, nt::Value::MakeDouble(2.0));
+  nt::SetEntryValue(server_entry, nt::Value::MakeDouble(3.0));
+  std::shared_ptr<nt::Value> value;
+  for (int i = 0; i < 30; ++i) {
+    value = nt::GetEntryValue(client_entry);
+    if (value && value->IsDouble() && value->GetDouble() == 3.0) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(value && value->IsDouble());
+  EXPECT_EQ(3.0, value->GetDouble());
+}
+
+TEST_F(ConnectionListenerTest, Subscriptions) {
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/sub/a"),
+                    nt::Value::MakeDouble(1.0));
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/other/b"),
+                    nt::Value::MakeDouble(1.0));
+  nt::SetNetworkSubscriptions(client_inst, {"/sub/"});
+  Connect();
+
+  // the initial snapshot isn't filtered
+  auto client_a = nt::GetEntry(client_inst, "/sub/a");
+  auto client_b = nt::GetEntry(client_inst, "/other/b");
+  ASSERT_TRUE(nt::GetEntryValue(client_b));
+
+  // entries published by the client are always sent back
+  nt::SetEntryValue(nt::GetEntry(client_inst, "/mine"),
+                    nt::Value::MakeDouble(1.0));
+  nt::Flush(client_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/sub/a"),
+                    nt::Value::MakeDouble(2.0));
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/other/b"),
+                    nt::Value::MakeDouble(2.0));
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/other/c"),
+                    nt::Value::MakeDouble(2.0));
+  nt::SetEntryValue(nt::GetEntry(server_inst, "/mine"),
+                    nt::Value::MakeDouble(2.0));
+  nt::Flush(server_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  EXPECT_EQ(2.0, nt::GetEntryValue(client_a)->GetDouble());
+  EXPECT_EQ(1.0, nt::GetEntryValue(client_b)->GetDouble());
+  EXPECT_FALSE(nt::GetEntryValue(nt::GetEntry(client_inst, "/other/c")));
+  EXPECT_EQ(2.0,
+            nt::GetEntryValue(nt::GetEntry(client_inst, "/mine"))->GetDouble());
+
+  auto server_stats = nt::GetConnectionStats(server_inst);
+  ASSERT_EQ(server_stats.size(), 1u);
+  EXPECT_EQ(server_stats[0].filtered, 2u);
+}
+
+TEST_F(ConnectionListenerTest, SubscriptionsPublishFiltered) {
+  nt::SetNetworkSubscriptions(client_inst, {"/sub/"});
+  Connect();
+
+  // assigned after connecting, so the client never sees it
+  auto server_entry = nt::GetEntry(server_inst, "/other/a");
+  nt::SetEntryValue(server_entry, nt::Value::MakeDouble(1.0));
+  nt::Flush(server_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  auto client_entry = nt::GetEntry(client_inst, "/other/a");
+  EXPECT_FALSE(nt::GetEntryValue(client_entry));
+
+  // publishing it from the client gets the existing assignment (and id)
+  nt::SetEntryValue(client_entry, nt::Value::MakeDouble(2.0));
+  nt::Flush(client_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  nt::Flush(server_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // so the client's updates reach the server, and the server's the client
+  nt::SetEntryValue(client_entry, nt::Value::MakeDouble(3.0));
+  nt::Flush(client_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  auto value = nt::GetEntryValue(server_entry);
+  ASSERT_TRUE(value && value->IsDouble());
+  EXPECT_EQ(3.0, value->GetDouble());
+
+  nt::SetEntryValue(server_entry, nt::Value::MakeDouble(4.0));
+  nt::Flush(server_inst);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  value = nt::GetEntryValue(client_entry);
+  ASSERT_TRUE(value && value->IsDouble());
+  EXPECT_EQ(4.0, value->GetDouble());
+}
@@ -0,0 +1,312 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <wpi/raw_ostream.h>
+
+#include "DataLogReader.h"
+#include "TestPrinters.h"
+#include "ValueMatcher.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ntcore_cpp.h"
+
+namespace nt {
+
+class DataLoggerTest : public ::testing::Test {
+ public:
+  DataLoggerTest() : inst(CreateInstance()) {}
+
+  ~DataLoggerTest() override {
+    DestroyInstance(inst);
+    std::remove(kFilename);
+  }
+
+  // Reads the whole log written to kFilename
+  std::vector<DataLogReader::Record> ReadLog(DataLogReader& reader);
+
+ protected:
+  static constexpr const char* kFilename = "DataLoggerTest.ntlog";
+  NT_Inst inst;
+};
+
+constexpr const char* DataLoggerTest::kFilename;
+
+std::vector<DataLogReader::Record> DataLoggerTest::ReadLog(
+    DataLogReader& reader) {
+  std::vector<DataLogReader::Record> records;
+  EXPECT_EQ(nullptr, reader.Open(kFilename));
+  DataLogReader::Record rec;
+  while (reader.Next(&rec)) records.emplace_back(rec);
+  return records;
+}
+
+TEST_F(DataLoggerTest, Log) {
+  auto foo = GetEntry(inst, "/log/foo");
+  auto bar = GetEntry(inst, "/log/bar");
+  auto other = GetEntry(inst, "/other");
+  SetEntryValue(foo, Value::MakeDouble(1.0));
+  SetEntryValue(other, Value::MakeDouble(2.0));
+
+  const char* err = nullptr;
+  auto logger = StartDataLog(inst, kFilename, "/log/", &err);
+  ASSERT_NE(0u, logger);
+  EXPECT_EQ(nullptr, err);
+
+  SetEntryValue(foo, Value::MakeDouble(3.0));
+  auto strs = Value::MakeStringArray(std::vector<std::string>{"a", "b"});
+  SetEntryValue(bar, strs);
+  SetEntryValue(other, Value::MakeDouble(4.0));
+  DeleteEntry(foo);
+  ASSERT_TRUE(WaitForEntryListenerQueue(inst, 1.0));
+  StopDataLog(logger);
+
+  // changes after stopping are not logged
+  SetEntryValue(bar, Value::MakeBoolean(true));
+  ASSERT_TRUE(WaitForEntryListenerQueue(inst, 1.0));
+
+  DataLogReader reader;
+  auto records = ReadLog(reader);
+  ASSERT_EQ(4u, records.size());
+
+  // initial value
+  EXPECT_EQ(datalog::kValue, records[0].type);
+  EXPECT_EQ("/log/foo", records[0].name);
+  EXPECT_THAT(records[0].value, ValueEq(Value::MakeDouble(1.0)));
+  EXPECT_EQ(reader.start_time(), records[0].time);
+
+  EXPECT_EQ("/log/foo", records[1].name);
+  EXPECT_EQ(records[0].id, records[1].id);
+  EXPECT_THAT(records[1].value, ValueEq(Value::MakeDouble(3.0)));
+
+  EXPECT_EQ("/log/bar", records[2].name);
+  EXPECT_NE(records[0].id, records[2].id);
+  EXPECT_THAT(records[2].value, ValueEq(strs));
+
+  EXPECT_EQ(datalog::kDelete, records[3].type);
+  EXPECT_EQ("/log/foo", records[3].name);
+  EXPECT_EQ(nullptr, records[3].value);
+
+  for (size_t i = 1; i < records.size(); ++i)
+    EXPECT_LE(records[i - 1].time, records[i].time);
+}
+
+TEST_F(DataLoggerTest, AllTypes) {
+  std::vector<std::shared_ptr<Value>> values{
+      Value::MakeBoolean(true),
+      Value::MakeDouble(-0.5),
+      Value::MakeString("hello"),
+      Value::MakeRaw(std::string("\0\xff", 2)),
+      Value::MakeBooleanArray(std::vector<int>{1, 0, 1}),
+      Value::MakeDoubleArray(std::vector<double>{1.5, 2.5}),
+      Value::MakeStringArray(std::vector<std::string>{"", "x"}),
+      Value::MakeDoubleArray(std::vector<double>{})};
+
+  auto logger = StartDataLog(inst, kFilename, "");
+  ASSERT_NE(0u, logger);
+  auto entry = GetEntry(inst, "value");
+  for (auto& value : values) SetEntryTypeValue(entry, value);
+  ASSERT_TRUE(WaitForEntryListenerQueue(inst, 1.0));
+  StopDataLog(logger);
+
+  DataLogReader reader;
+  auto records = ReadLog(reader);
+  ASSERT_EQ(values.size(), records.size());
+  for (size_t i = 0; i < values.size(); ++i)
+    EXPECT_THAT(records[i].value, ValueEq(values[i]));
+}
+
+TEST_F(DataLoggerTest, Truncated) {
+  auto logger = StartDataLog(inst, kFilename, "");
+  ASSERT_NE(0u, logger);
+  auto entry = GetEntry(inst, "a");
+  SetEntryValue(entry, Value::MakeDouble(1.0));
+  SetEntryValue(entry, Value::MakeDouble(2.0));
+  ASSERT_TRUE(WaitForEntryListenerQueue(inst, 1.0));
+  StopDataLog(logger);
+
+  std::string data;
+  std::FILE* f = std::fopen(kFilename, "rb");
+  ASSERT_NE(nullptr, f);
+  char buf[256];
+  while (size_t n = std::fread(buf, 1, sizeof(buf), f)) data.append(buf, n);
+  std::fclose(f);
+
+  // drop the last byte of the second value
+  std::vector<std::string> warnings;
+  DataLogReader reader(
+      [&](size_t record, const char* msg) { warnings.emplace_back(msg); });
+  data.pop_back();
+  ASSERT_EQ(nullptr, reader.SetData(data));
+  DataLogReader::Record rec;
+  ASSERT_TRUE(reader.Next(&rec));
+  EXPECT_THAT(rec.value, ValueEq(Value::MakeDouble(1.0)));
+  EXPECT_FALSE(reader.Next(&rec));
+  EXPECT_EQ(1u, warnings.size());
+
+  EXPECT_STREQ("not a data log", reader.SetData("[NetworkTables]"));
+}
+
+TEST_F(DataLoggerTest, HugeId) {
+  // start record for id 2^40, then a value for it
+  std::string data{"\x89NTL\x01\0\0\0\0\0\0\0\0\0\0\0", 16};
+  data += "\x01\x80\x80\x80\x80\x80\x20\x01" "a";
+  data += "\x02\x80\x80\x80\x80\x80\x20\x00\x01";
+  data.append(8, '\0');
+
+  std::vector<std::string> warnings;
+  DataLogReader reader(
+      [&](size_t record, const char* msg) { warnings.emplace_back(msg); });
+  ASSERT_EQ(nullptr, reader.SetData(data));
+  DataLogReader::Record rec;
+  EXPECT_FALSE(reader.Next(&rec));
+  EXPECT_EQ(1u, warnings.size());
+}
+
+TEST_F(DataLoggerTest, StartError) {
+  const char* err = nullptr;
+  EXPECT_EQ(0u, StartDataLog(inst, "no/such/dir/log.ntlog", "", &err));
+  EXPECT_STREQ("could not open file", err);
+}
+
+TEST_F(DataLoggerTest, Replay) {
+  auto logger = StartDataLog(inst, kFilename, "");
+  ASSERT_NE(0u, logger);
+  auto foo = GetEntry(inst, "foo");
+  auto bar = GetEntry(inst, "bar");
+  for (int i = 0; i < 100; ++i) SetEntryDouble(foo, i);
+  SetEntryValue(bar, Value::MakeString("x"));
+  DeleteEntry(bar);
+  SetEntryTypeValue(foo, Value::MakeBoolean(true));
+  ASSERT_TRUE(WaitForEntryListenerQueue(inst, 1.0));
+  StopDataLog(logger);
+
+  NT_Inst inst2 = CreateInstance();
+  std::vector<std::shared_ptr<Value>> foo_values;
+  std::vector<unsigned int> bar_flags;
+  AddEntryListener(inst2, "",
+                   [&](const EntryNotification& event) {
+                     if (event.name == "foo")
+                       foo_values.emplace_back(event.value);
+                     else
+                       bar_flags.emplace_back(event.flags);
+                   },
+                   NT_NOTIFY_LOCAL | NT_NOTIFY_NEW | NT_NOTIFY_UPDATE |
+                       NT_NOTIFY_DELETE);
+
+  const char* err = nullptr;
+  auto replay = StartDataLogReplay(inst2, kFilename, 0, &err);
+  ASSERT_NE(0u, replay) << err;
+  EXPECT_TRUE(WaitForDataLogReplay(replay, 1.0));
+  StopDataLogReplay(replay);
+  ASSERT_TRUE(WaitForEntryListenerQueue(inst2, 1.0));
+
+  // every change is replayed, in order
+  ASSERT_EQ(101u, foo_values.size());
+  for (int i = 0; i < 100; ++i)
+    EXPECT_THAT(foo_values[i], ValueEq(Value::MakeDouble(i)));
+  EXPECT_THAT(foo_values[100], ValueEq(Value::MakeBoolean(true)));
+  ASSERT_EQ(2u, bar_flags.size());
+  EXPECT_EQ(NT_NOTIFY_LOCAL | NT_NOTIFY_NEW, bar_flags[0]);
+  EXPECT_EQ(NT_NOTIFY_LOCAL | NT_NOTIFY_DELETE, bar_flags[1]);
+
+  EXPECT_THAT(GetEntryValue(GetEntry(inst2, "foo")),
+              ValueEq(Value::MakeBoolean(true)));
+  EXPECT_EQ(nullptr, GetEntryValue(GetEntry(inst2, "bar")));
+  DestroyInstance(inst2);
+}
+
+TEST_F(DataLoggerTest, ReplaySpeed) {
+  // "a" = true at +0, false at +0.5 s and true at +1 s
+  std::string data("\x89NTL\x01\x00\x00\x00\x40\x42\x0f\x00\x00\x00\x00\x00",
+                   16);
+  data += std::string("\x01\x00\x01" "a", 4);
+  data += std::string("\x02\x00\x00\x01\x01", 5);
+  data += std::string("\x02\x00\xa0\xc2\x1e\x01\x00", 7);
+  data += std::string("\x02\x00\xa0\xc2\x1e\x01\x01", 7);
+  std::FILE* f = std::fopen(kFilename, "wb");
+  ASSERT_NE(nullptr, f);
+  std::fwrite(data.data(), 1, data.size(), f);
+  std::fclose(f);
+
+  // 10x speed takes about 0.1 s
+  auto start = std::chrono::steady_clock::now();
+  auto replay = StartDataLogReplay(inst, kFilename, 10);
+  ASSERT_NE(0u, replay);
+  EXPECT_TRUE(WaitForDataLogReplay(replay, 1.0));
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  EXPECT_GE(elapsed.count(), 0.09);
+  EXPECT_LT(elapsed.count(), 0.9);
+  StopDataLogReplay(replay);
+
+  // values are timestamped with the replay time
+  auto value = GetEntryValue(GetEntry(inst, "a"));
+  EXPECT_THAT(value, ValueEq(Value::MakeBoolean(true)));
+  EXPECT_LE(value->time(), Now());
+  EXPECT_GT(value->time() + 500000, Now());
+
+  // real time is stopped partway through
+  replay = StartDataLogReplay(inst, kFilename, 1);
+  ASSERT_NE(0u, replay);
+  EXPECT_FALSE(WaitForDataLogReplay(replay, 0.1));
+  StopDataLogReplay(replay);
+  EXPECT_THAT(GetEntryValue(GetEntry(inst, "a")),
+              ValueEq(Value::MakeBoolean(true)));
+
+  const char* err = nullptr;
+  EXPECT_EQ(0u, StartDataLogReplay(inst, "nosuchfile.ntlog", 1, &err));
+  EXPECT_STREQ("could not open file", err);
+}
+
+TEST_F(DataLoggerTest, Convert) {
+  DataLogReader reader;
+  std::string data("\x89NTL\x01\x00\x00\x00\x40\x42\x0f\x00\x00\x00\x00\x00",
+                   16);
+  // "a,b" = 0.5 at +1 s, "s" = "x\"y" at +1.5 s, delete "a,b" at +2 s
+  data += std::string("\x01\x00\x03" "a,b", 6);
+  data += std::string("\x02\x00\xc0\x84\x3d\x02", 6);
+  data += std::string("\x00\x00\x00\x00\x00\x00\xe0\x3f", 8);
+  data += std::string("\x01\x01\x01s", 4);
+  data += std::string("\x02\x01\xa0\xc2\x1e\x04\x03x\"y", 10);
+  data += std::string("\x03\x00\xa0\xc2\x1e", 5);
+
+  std::string out;
+  {
+    ASSERT_EQ(nullptr, reader.SetData(data));
+    wpi::raw_string_ostream os(out);
+    reader.Convert(os, NT_DATALOG_CSV);
+  }
+  EXPECT_EQ(
+      "time,name,type,value\n"
+      "1.000000,\"a,b\",double,0.5\n"
+      "1.500000,s,string,\"x\"\"y\"\n"
+      "2.000000,\"a,b\",delete,\n",
+      out);
+
+  out.clear();
+  {
+    ASSERT_EQ(nullptr, reader.SetData(data));
+    wpi::raw_string_ostream os(out);
+    reader.Convert(os, NT_DATALOG_JSON);
+  }
+  EXPECT_EQ(
+      "[\n"
+      "{\"time\":1.000000,\"name\":\"a,b\",\"type\":\"double\","
+      "\"value\":0.5},\n"
+      "{\"time\":1.500000,\"name\":\"s\",\"type\":\"string\","
+      "\"value\":\"x\\\"y\"},\n"
+      "{\"time\":2.000000,\"name\":\"a,b\",\"type\":\"delete\"}\n"
+      "]\n",
+      out);
+}
+
+}  // namespace nt
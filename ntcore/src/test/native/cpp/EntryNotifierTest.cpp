@@ -5,6 +5,8 @@
 /* the project.                                                               */
 /*----------------------------------------------------------------------------*/
 
+#include <vector>
+
 #include <wpi/Logger.h>
 
 #include "EntryNotifier.h"
@@ -277,6 +279,109 @@ TEST_F(EntryNotifierTest, PollPrefixBasic) {
   EXPECT_EQ(g4count, 2);
 }
 
+TEST_F(EntryNotifierTest, PollPrefixRemove) {
+  auto poller = notifier.CreatePoller();
+  auto h1 = notifier.AddPolled(poller, "/", NT_NOTIFY_NEW);
+  notifier.AddPolled(poller, "/foo/bar/baz", NT_NOTIFY_NEW);  // too long
+  auto h3 = notifier.AddPolled(poller, "/b", NT_NOTIFY_NEW);
+  auto h4 = notifier.AddPolled(poller, "/foo", NT_NOTIFY_NEW);
+  notifier.Remove(h3);
+
+  GenerateNotifications();
+
+  ASSERT_TRUE(notifier.WaitForQueue(1.0));
+  bool timed_out = false;
+  auto results = notifier.Poll(poller, 0, &timed_out);
+  ASSERT_FALSE(timed_out);
+
+  int h1count = 0;
+  int h4count = 0;
+  for (const auto& result : results) {
+    SCOPED_TRACE(::testing::PrintToString(result));
+    if (Handle{result.listener}.GetIndex() == static_cast<int>(h1)) {
+      ++h1count;
+    } else if (Handle{result.listener}.GetIndex() == static_cast<int>(h4)) {
+      ++h4count;
+      EXPECT_EQ("/foo/bar", result.name);
+    } else {
+      ADD_FAILURE() << "unexpected listener index";
+    }
+  }
+  EXPECT_EQ(h1count, 6);  // all keys
+  EXPECT_EQ(h4count, 2);
+}
+
+TEST_F(EntryNotifierTest, PollQueueDropOldest) {
+  auto poller = notifier.CreatePoller();
+  notifier.AddPolled(poller, "/foo", NT_NOTIFY_UPDATE);
+  notifier.SetPollerQueue(poller, 2, NT_QUEUE_DROP_OLDEST);
+
+  notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(1), NT_NOTIFY_UPDATE);
+  notifier.NotifyEntry(6, "/foo/b", Value::MakeDouble(2), NT_NOTIFY_UPDATE);
+  notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(3), NT_NOTIFY_UPDATE);
+
+  ASSERT_TRUE(notifier.WaitForQueue(1.0));
+  auto stats = notifier.GetPollerQueueStats(poller);
+  EXPECT_EQ(2u, stats.queued);
+  EXPECT_EQ(2u, stats.capacity);
+  EXPECT_EQ(1u, stats.dropped);
+  EXPECT_EQ(0u, stats.coalesced);
+
+  bool timed_out = false;
+  auto results = notifier.Poll(poller, 0, &timed_out);
+  ASSERT_FALSE(timed_out);
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ("/foo/b", results[0].name);
+  EXPECT_EQ("/foo/a", results[1].name);
+  EXPECT_EQ(*Value::MakeDouble(3), *results[1].value);
+}
+
+TEST_F(EntryNotifierTest, PollQueueCoalesce) {
+  auto poller = notifier.CreatePoller();
+  notifier.AddPolled(poller, "/foo", NT_NOTIFY_UPDATE);
+  notifier.SetPollerQueue(poller, 2, NT_QUEUE_COALESCE);
+
+  notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(1), NT_NOTIFY_UPDATE);
+  notifier.NotifyEntry(6, "/foo/b", Value::MakeDouble(2), NT_NOTIFY_UPDATE);
+  notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(3), NT_NOTIFY_UPDATE);
+
+  ASSERT_TRUE(notifier.WaitForQueue(1.0));
+  auto stats = notifier.GetPollerQueueStats(poller);
+  EXPECT_EQ(0u, stats.dropped);
+  EXPECT_EQ(1u, stats.coalesced);
+
+  bool timed_out = false;
+  auto results = notifier.Poll(poller, 0, &timed_out);
+  ASSERT_FALSE(timed_out);
+  ASSERT_EQ(2u, results.size());
+  // latest value, in the position of the original notification
+  EXPECT_EQ("/foo/a", results[0].name);
+  EXPECT_EQ(*Value::MakeDouble(3), *results[0].value);
+  EXPECT_EQ("/foo/b", results[1].name);
+}
+
+TEST_F(EntryNotifierTest, PollQueueBlock) {
+  auto poller = notifier.CreatePoller();
+  notifier.AddPolled(poller, "/foo", NT_NOTIFY_UPDATE);
+  notifier.SetPollerQueue(poller, 1, NT_QUEUE_BLOCK);
+
+  for (int i = 0; i < 5; ++i)
+    notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(i), NT_NOTIFY_UPDATE);
+
+  std::vector<EntryNotification> results;
+  while (results.size() < 5) {
+    bool timed_out = false;
+    auto polled = notifier.Poll(poller, 1.0, &timed_out);
+    ASSERT_FALSE(timed_out);
+    ASSERT_LE(polled.size(), 1u);
+    results.insert(results.end(), polled.begin(), polled.end());
+  }
+  ASSERT_TRUE(notifier.WaitForQueue(1.0));
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(*Value::MakeDouble(i), *results[i].value);
+  EXPECT_EQ(0u, notifier.GetPollerQueueStats(poller).dropped);
+}
+
 TEST_F(EntryNotifierTest, PollPrefixImmediate) {
   auto poller = notifier.CreatePoller();
   notifier.AddPolled(poller, "/foo", NT_NOTIFY_NEW | NT_NOTIFY_IMMEDIATE);
@@ -0,0 +1,156 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wpi/Logger.h>
+#include <wpi/raw_istream.h>
+
+#include "Message.h"
+#include "TestPrinters.h"
+#include "ValueMatcher.h"
+#include "WireDecoder.h"
+#include "WireEncoder.h"
+#include "gtest/gtest.h"
+
+namespace nt {
+
+class MessageTest : public ::testing::Test {
+ protected:
+  static NT_Type GetEntryType(unsigned int) { return NT_DOUBLE_ARRAY; }
+
+  std::shared_ptr<Message> Decode(const WireEncoder& e,
+                                  std::shared_ptr<Value> base) {
+    wpi::raw_mem_istream is(e.data(), e.size());
+    WireDecoder d(is, 0x0300u, logger);
+    return Message::Read(d, GetEntryType,
+                         [&](unsigned int) { return base; });
+  }
+
+  wpi::Logger logger;
+};
+
+TEST_F(MessageTest, ClientSubscribeRoundTrip) {
+  std::vector<std::string> prefixes{"/SmartDashboard/", "/LiveWindow"};
+  WireEncoder e(0x0300u);
+  Message::ClientSubscribe(prefixes)->Write(e);
+
+  auto out = Decode(e, nullptr);
+  ASSERT_TRUE(out);
+  ASSERT_EQ(Message::kClientSubscribe, out->type());
+  ASSERT_THAT(out->value(), ValueEq(Value::MakeStringArray(prefixes)));
+
+  // not sent in protocol 2.0
+  WireEncoder e2(0x0200u);
+  Message::ClientSubscribe(prefixes)->Write(e2);
+  ASSERT_EQ(0u, e2.size());
+}
+
+TEST_F(MessageTest, ArrayDeltaRoundTrip) {
+  std::vector<double> arr(100, 1.0);
+  auto base = Value::MakeDoubleArray(arr);
+  arr[3] = 2.0;
+  arr[4] = 3.0;
+  arr[50] = 4.0;
+  auto value = Value::MakeDoubleArray(arr);
+  auto msg = Message::EntryUpdate(5, 7, value);
+
+  WireEncoder e(0x0300u);
+  ASSERT_TRUE(msg->WriteDelta(e, *base));
+  // 5 header + size + runs + 2 runs * 2 + 3 values * 8
+  ASSERT_EQ(35u, e.size());
+
+  auto out = Decode(e, base);
+  ASSERT_TRUE(out);
+  ASSERT_EQ(Message::kEntryUpdate, out->type());
+  ASSERT_EQ(5u, out->id());
+  ASSERT_EQ(7u, out->seq_num_uid());
+  ASSERT_THAT(out->value(), ValueEq(value));
+}
+
+TEST_F(MessageTest, ArrayDeltaResize) {
+  auto base = Value::MakeDoubleArray(std::vector<double>(100, 1.0));
+  std::vector<double> arr(102, 1.0);
+  arr[101] = 5.0;
+  auto value = Value::MakeDoubleArray(arr);
+  auto msg = Message::EntryUpdate(5, 7, value);
+
+  WireEncoder e(0x0300u);
+  ASSERT_TRUE(msg->WriteDelta(e, *base));
+  auto out = Decode(e, base);
+  ASSERT_TRUE(out);
+  ASSERT_THAT(out->value(), ValueEq(value));
+
+  // shrinking doesn't need any runs
+  WireEncoder e2(0x0300u);
+  ASSERT_TRUE(Message::EntryUpdate(5, 8, base)->WriteDelta(e2, *value));
+  out = Decode(e2, value);
+  ASSERT_TRUE(out);
+  ASSERT_THAT(out->value(), ValueEq(base));
+}
+
+TEST_F(MessageTest, ArrayDeltaNotSmaller) {
+  auto base = Value::MakeDoubleArray(std::vector<double>{1.0, 2.0});
+  auto value = Value::MakeDoubleArray(std::vector<double>{3.0, 4.0});
+  WireEncoder e(0x0300u);
+  ASSERT_FALSE(Message::EntryUpdate(5, 7, value)->WriteDelta(e, *base));
+  ASSERT_EQ(0u, e.size());
+}
+
+TEST_F(MessageTest, ArrayDeltaNotArray) {
+  auto base = Value::MakeDoubleArray(std::vector<double>{1.0, 2.0});
+  WireEncoder e(0x0300u);
+  ASSERT_FALSE(Message::EntryUpdate(5, 7, Value::MakeDouble(1.0))
+                   ->WriteDelta(e, *base));
+  ASSERT_EQ(0u, e.size());
+}
+
+TEST_F(MessageTest, ArrayDeltaNoBase) {
+  std::vector<double> arr(100, 1.0);
+  auto base = Value::MakeDoubleArray(arr);
+  arr[0] = 2.0;
+  WireEncoder e(0x0300u);
+  ASSERT_TRUE(Message::EntryUpdate(5, 7, Value::MakeDoubleArray(arr))
+                  ->WriteDelta(e, *base));
+  ASSERT_FALSE(Decode(e, nullptr));
+
+  // not accepted unless negotiated
+  wpi::raw_mem_istream is(e.data(), e.size());
+  WireDecoder d(is, 0x0300u, logger);
+  ASSERT_FALSE(Message::Read(d, GetEntryType));
+}
+
+TEST_F(MessageTest, GetSize) {
+  std::shared_ptr<Message> msgs[] = {
+      Message::KeepAlive(),
+      Message::ClientHello("me"),
+      Message::ProtoUnsup(),
+      Message::ServerHelloDone(),
+      Message::ServerHello(1, "server"),
+      Message::ClientHelloDone(),
+      Message::ClientFeatures(Message::kFeatureArrayDelta),
+      Message::ClientSubscribe({"/a/", "/b"}),
+      Message::EntryAssign("name", 1, 2, Value::MakeString("value"), 0),
+      Message::EntryUpdate(1, 2, Value::MakeDouble(1.0)),
+      Message::EntryUpdate(1, 2, Value::MakeDoubleArray({1.0, 2.0})),
+      Message::FlagsUpdate(1, 1),
+      Message::EntryDelete(1),
+      Message::ClearEntries(),
+      Message::ExecuteRpc(1, 2, "params"),
+      Message::RpcResponse(1, 2, "result")};
+  for (unsigned int proto_rev : {0x0200u, 0x0300u}) {
+    for (auto& msg : msgs) {
+      WireEncoder e(proto_rev);
+      msg->Write(e);
+      EXPECT_EQ(e.size(), msg->GetSize(e)) << "type " << msg->type();
+    }
+  }
+}
+
+}  // namespace nt
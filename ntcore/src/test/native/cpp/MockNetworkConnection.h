@@ -18,6 +18,7 @@ namespace nt {
 class MockNetworkConnection : public INetworkConnection {
  public:
   MOCK_CONST_METHOD0(info, ConnectionInfo());
+  MOCK_CONST_METHOD0(stats, ConnectionStats());
 
   MOCK_METHOD1(QueueOutgoing, void(std::shared_ptr<Message> msg));
   MOCK_METHOD1(PostOutgoing, void(bool keep_alive));
@@ -0,0 +1,176 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <wpi/Logger.h>
+#include <wpi/TCPConnector.h>
+#include <wpi/raw_socket_istream.h>
+
+#include "Message.h"
+#include "TestPrinters.h"
+#include "ValueMatcher.h"
+#include "WireDecoder.h"
+#include "WireEncoder.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ntcore_cpp.h"
+
+namespace nt {
+
+// Talks to a server as a raw protocol 3.0 client.  Parameter is whether the
+// server uses the event loop.
+class NetworkConnectionTest : public ::testing::TestWithParam<bool> {
+ public:
+  NetworkConnectionTest() : server_inst(CreateInstance()) {
+    SetNetworkEventLoop(server_inst, GetParam());
+  }
+
+  ~NetworkConnectionTest() override { DestroyInstance(server_inst); }
+
+  // Connects and completes the handshake, optionally acknowledging array
+  // deltas.  Returns the id and sequence number assigned to "/a".
+  void Connect(bool array_deltas, unsigned int* id, unsigned int* seq_num);
+
+  void Send(const Message& msg);
+  void SendDelta(const Message& msg, const Value& base);
+
+  // Returns true if the server closed the connection within a second.
+  bool WaitForClose();
+
+ protected:
+  static constexpr int kPort = 10010;
+  NT_Inst server_inst;
+  wpi::Logger logger;
+  std::unique_ptr<wpi::NetworkStream> stream;
+};
+
+void NetworkConnectionTest::Connect(bool array_deltas, unsigned int* id,
+                                    unsigned int* seq_num) {
+  StartServer(server_inst, "networkconnectiontest.ini", "127.0.0.1", kPort);
+  for (int i = 0; i < 50 && !stream; ++i) {
+    stream = wpi::TCPConnector::connect("127.0.0.1", kPort, logger, 1);
+    if (!stream) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  ASSERT_TRUE(stream);
+  Send(*Message::ClientHello("test"));
+
+  wpi::raw_socket_istream is(*stream, 1);
+  WireDecoder decoder(is, 0x0300, logger);
+  auto get_type = [](unsigned int) { return NT_DOUBLE_ARRAY; };
+  for (;;) {
+    auto msg = Message::Read(decoder, get_type);
+    ASSERT_TRUE(msg);
+    if (msg->Is(Message::kServerHelloDone)) break;
+    if (msg->Is(Message::kEntryAssign) && msg->str() == "/a") {
+      *id = msg->id();
+      *seq_num = msg->seq_num_uid();
+    }
+  }
+
+  if (array_deltas)
+    Send(*Message::ClientFeatures(Message::kFeatureArrayDelta));
+  Send(*Message::ClientHelloDone());
+}
+
+void NetworkConnectionTest::Send(const Message& msg) {
+  WireEncoder encoder(0x0300);
+  msg.Write(encoder);
+  wpi::NetworkStream::Error err;
+  stream->send(encoder.data(), encoder.size(), &err);
+}
+
+void NetworkConnectionTest::SendDelta(const Message& msg, const Value& base) {
+  WireEncoder encoder(0x0300);
+  ASSERT_TRUE(msg.WriteDelta(encoder, base));
+  wpi::NetworkStream::Error err;
+  stream->send(encoder.data(), encoder.size(), &err);
+}
+
+bool NetworkConnectionTest::WaitForClose() {
+  char buf[256];
+  wpi::NetworkStream::Error err;
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (std::chrono::steady_clock::now() < end) {
+    if (stream->receive(buf, sizeof(buf), &err, 1) == 0 &&
+        err != wpi::NetworkStream::kConnectionTimedOut)
+      return true;
+  }
+  return false;
+}
+
+TEST_P(NetworkConnectionTest, ArrayDeltaNegotiated) {
+  std::vector<double> arr(20, 1.0);
+  auto base = Value::MakeDoubleArray(arr);
+  SetEntryValue(GetEntry(server_inst, "/a"), base);
+  unsigned int id = 0xffff, seq_num = 0;
+  Connect(true, &id, &seq_num);
+  ASSERT_NE(0xffffu, id);
+
+  // deltas are relative to the last full value sent on the connection
+  Send(*Message::EntryUpdate(id, seq_num + 1, base));
+  arr[3] = 2.0;
+  auto value = Value::MakeDoubleArray(arr);
+  SendDelta(*Message::EntryUpdate(id, seq_num + 2, value), *base);
+
+  auto entry = GetEntry(server_inst, "/a");
+  for (int i = 0; i < 100 && *GetEntryValue(entry) != *value; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_THAT(GetEntryValue(entry), ValueEq(value));
+}
+
+TEST_P(NetworkConnectionTest, ArrayDeltaNotNegotiated) {
+  std::vector<double> arr(20, 1.0);
+  auto base = Value::MakeDoubleArray(arr);
+  SetEntryValue(GetEntry(server_inst, "/a"), base);
+  unsigned int id = 0xffff, seq_num = 0;
+  Connect(false, &id, &seq_num);
+  ASSERT_NE(0xffffu, id);
+
+  Send(*Message::EntryUpdate(id, seq_num + 1, base));
+  arr[3] = 2.0;
+  SendDelta(*Message::EntryUpdate(id, seq_num + 2,
+                                  Value::MakeDoubleArray(arr)),
+            *base);
+
+  // the delta is a protocol error, so the server drops the connection
+  EXPECT_TRUE(WaitForClose());
+  EXPECT_THAT(GetEntryValue(GetEntry(server_inst, "/a")), ValueEq(base));
+}
+
+// A 2.0 client's messages sent right behind its hello must be decoded with
+// the negotiated protocol revision.
+TEST_P(NetworkConnectionTest, PipelinedAfterHello) {
+  StartServer(server_inst, "networkconnectiontest.ini", "127.0.0.1", kPort);
+  for (int i = 0; i < 50 && !stream; ++i) {
+    stream = wpi::TCPConnector::connect("127.0.0.1", kPort, logger, 1);
+    if (!stream) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  ASSERT_TRUE(stream);
+
+  auto value = Value::MakeDouble(5.0);
+  WireEncoder encoder(0x0200);
+  Message::ClientHello("")->Write(encoder);
+  Message::EntryAssign("/b", 0xffff, 1, value, 0)->Write(encoder);
+  Message::EntryAssign("/c", 0xffff, 1, value, 0)->Write(encoder);
+  wpi::NetworkStream::Error err;
+  stream->send(encoder.data(), encoder.size(), &err);
+
+  auto entry = GetEntry(server_inst, "/c");
+  for (int i = 0; i < 100 && !GetEntryValue(entry); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_THAT(GetEntryValue(GetEntry(server_inst, "/b")), ValueEq(value));
+  EXPECT_THAT(GetEntryValue(entry), ValueEq(value));
+}
+
+INSTANTIATE_TEST_CASE_P(NetworkConnectionTests, NetworkConnectionTest,
+                        ::testing::Bool(), );
+
+}  // namespace nt
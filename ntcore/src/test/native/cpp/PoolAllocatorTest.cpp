@@ -0,0 +1,60 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <memory>
+#include <vector>
+
+#include "PoolAllocator.h"
+#include "gtest/gtest.h"
+#include "networktables/NetworkTableValue.h"
+
+namespace nt {
+
+class PoolAllocatorTest : public ::testing::Test {};
+
+namespace {
+struct Pooled {
+  char data[72];
+};
+}  // namespace
+
+// The pool doesn't guarantee which free block is handed out, only that
+// freed blocks are handed out again before new ones come from the heap.
+TEST_F(PoolAllocatorTest, ReusesBlocks) {
+  PoolAllocator<Pooled> alloc;
+  std::vector<Pooled*> blocks;
+  for (int i = 0; i < 8; ++i) blocks.push_back(alloc.allocate(1));
+  for (auto p : blocks) alloc.deallocate(p, 1);
+  blocks.clear();
+
+  auto heap = PoolHeapAllocations().load();
+  for (int i = 0; i < 8; ++i) blocks.push_back(alloc.allocate(1));
+  for (auto p : blocks) alloc.deallocate(p, 1);
+  ASSERT_EQ(heap, PoolHeapAllocations().load());
+}
+
+TEST_F(PoolAllocatorTest, SharedPtr) {
+  auto p = std::allocate_shared<Pooled>(PoolAllocator<Pooled>());
+  ASSERT_TRUE(p);
+  p->data[0] = 1;
+  std::weak_ptr<Pooled> w = p;
+  p.reset();
+  ASSERT_TRUE(w.expired());
+}
+
+TEST_F(PoolAllocatorTest, ScalarValueReused) {
+  std::vector<std::shared_ptr<Value>> values;
+  for (int i = 0; i < 8; ++i) values.push_back(Value::MakeDouble(i));
+  values.clear();
+
+  auto heap = PoolHeapAllocations().load();
+  for (int i = 0; i < 8; ++i) values.push_back(Value::MakeDouble(i));
+  ASSERT_EQ(heap, PoolHeapAllocations().load());
+  ASSERT_EQ(7.0, values.back()->GetDouble());
+}
+
+}  // namespace nt
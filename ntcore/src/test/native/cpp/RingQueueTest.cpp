@@ -0,0 +1,82 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include <memory>
+
+#include "RingQueue.h"
+#include "gtest/gtest.h"
+
+namespace nt {
+
+class RingQueueTest : public ::testing::Test {};
+
+TEST_F(RingQueueTest, Empty) {
+  RingQueue<int> q;
+  ASSERT_TRUE(q.empty());
+  ASSERT_EQ(0u, q.size());
+  ASSERT_EQ(0u, q.capacity());
+  ASSERT_FALSE(q.full());
+}
+
+TEST_F(RingQueueTest, WrapAndGrow) {
+  RingQueue<int> q;
+  int next_push = 0;
+  int next_pop = 0;
+  // keep the head moving around the buffer while it grows
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 7 * (round + 1); ++i) q.push(next_push++);
+    for (int i = 0; i < 5 * (round + 1); ++i) {
+      ASSERT_EQ(next_pop++, q.front());
+      q.pop();
+    }
+  }
+  ASSERT_EQ(static_cast<size_t>(next_push - next_pop), q.size());
+  for (size_t i = 0; i < q.size(); ++i)
+    ASSERT_EQ(next_pop + static_cast<int>(i), q[i]);
+}
+
+TEST_F(RingQueueTest, Capacity) {
+  RingQueue<int> q(3);
+  q.push(1);
+  q.push(2);
+  ASSERT_FALSE(q.full());
+  q.push(3);
+  ASSERT_TRUE(q.full());
+
+  // shrinking drops the oldest
+  ASSERT_EQ(1u, q.set_capacity(2));
+  ASSERT_EQ(2u, q.size());
+  ASSERT_EQ(2, q[0]);
+  ASSERT_EQ(3, q[1]);
+
+  ASSERT_EQ(0u, q.set_capacity(0));
+  ASSERT_FALSE(q.full());
+}
+
+TEST_F(RingQueueTest, DestroysElements) {
+  auto p = std::make_shared<int>(5);
+  {
+    RingQueue<std::shared_ptr<int>> q;
+    for (int i = 0; i < 20; ++i) q.push(p);
+    ASSERT_EQ(21, p.use_count());
+    q.pop();
+    ASSERT_EQ(20, p.use_count());
+  }
+  ASSERT_EQ(1, p.use_count());
+}
+
+TEST_F(RingQueueTest, NoDefaultConstructor) {
+  struct NoDefault {
+    explicit NoDefault(int v) : value(v) {}
+    int value;
+  };
+  RingQueue<NoDefault> q;
+  for (int i = 0; i < 40; ++i) q.emplace(i);
+  ASSERT_EQ(39, q[39].value);
+}
+
+}  // namespace nt
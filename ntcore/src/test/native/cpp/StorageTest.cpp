@@ -7,6 +7,11 @@
 
 #include "StorageTest.h"
 
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include <wpi/FileSystem.h>
 #include <wpi/raw_istream.h>
 #include <wpi/raw_ostream.h>
 
@@ -21,6 +26,7 @@
 using ::testing::AnyNumber;
 using ::testing::IsNull;
 using ::testing::Return;
+using ::testing::SaveArg;
 using ::testing::_;
 
 namespace nt {
@@ -300,6 +306,68 @@ TEST_P(StorageTestPopulated, SetEntryValueDifferentValue) {
   }
 }
 
+TEST_P(StorageTestPopulated, SetEntryValues) {
+  auto value1 = Value::MakeDouble(5.0);
+  auto value2 = Value::MakeDouble(6.0);
+  auto bad = Value::MakeDouble(7.0);
+
+  if (GetParam()) {
+    EXPECT_CALL(dispatcher,
+                QueueOutgoing(MessageEq(Message::EntryUpdate(1, 2, value1)),
+                              IsNull(), IsNull()));
+    EXPECT_CALL(dispatcher,
+                QueueOutgoing(MessageEq(Message::EntryUpdate(2, 2, value2)),
+                              IsNull(), IsNull()));
+  }
+  EXPECT_CALL(notifier,
+              NotifyEntry(1, StringRef("foo2"), value1,
+                          NT_NOTIFY_UPDATE | NT_NOTIFY_LOCAL, UINT_MAX));
+  EXPECT_CALL(notifier,
+              NotifyEntry(2, StringRef("bar"), value2,
+                          NT_NOTIFY_UPDATE | NT_NOTIFY_LOCAL, UINT_MAX));
+
+  // type mismatch on "foo" is an error, but the other entries are updated
+  unsigned int ids[] = {1, 0, 2};
+  std::shared_ptr<Value> values[] = {value1, bad, value2};
+  EXPECT_FALSE(storage.SetEntryValues(ids, values));
+  EXPECT_EQ(value1, GetEntry("foo2")->value);
+  EXPECT_EQ(value2, GetEntry("bar")->value);
+  EXPECT_TRUE(GetEntry("foo")->value->IsBoolean());
+
+  auto got = storage.GetEntryValues(ids);
+  ASSERT_EQ(3u, got.size());
+  EXPECT_EQ(value1, got[0]);
+  EXPECT_TRUE(got[1]->IsBoolean());
+  EXPECT_EQ(value2, got[2]);
+}
+
+TEST_P(StorageTestPopulated, GetEntryDoubles) {
+  // "foo" is a boolean, and 99 doesn't exist
+  unsigned int ids[] = {1, 0, 2, 99};
+  double values[4];
+  EXPECT_EQ(2u, storage.GetEntryDoubles(ids, -1.0, values));
+  EXPECT_EQ(0.0, values[0]);
+  EXPECT_EQ(-1.0, values[1]);
+  EXPECT_EQ(1.0, values[2]);
+  EXPECT_EQ(-1.0, values[3]);
+}
+
+TEST_P(StorageTestPopulated, GetEntryBooleans) {
+  unsigned int ids[] = {0, 1, 3};
+  bool values[3];
+  EXPECT_EQ(2u, storage.GetEntryBooleans(ids, true, values));
+  EXPECT_TRUE(values[0]);
+  EXPECT_TRUE(values[1]);
+  EXPECT_FALSE(values[2]);
+}
+
+TEST_P(StorageTestPopulated, SetEntryValuesSizeMismatch) {
+  unsigned int ids[] = {1, 2};
+  std::shared_ptr<Value> values[] = {Value::MakeDouble(5.0)};
+  EXPECT_FALSE(storage.SetEntryValues(ids, values));
+  EXPECT_EQ(0.0, GetEntry("foo2")->value->GetDouble());
+}
+
 TEST_P(StorageTestEmpty, SetEntryValueEmptyName) {
   auto value = Value::MakeBoolean(true);
   EXPECT_TRUE(storage.SetEntryValue("", value));
@@ -399,6 +467,38 @@ TEST_P(StorageTestPopulated, SetDefaultEntryEmptyValue) {
     EXPECT_EQ(0u, idmap().size());
 }
 
+TEST_P(StorageTestPopulateOne, EntryHistory) {
+  EXPECT_CALL(dispatcher, QueueOutgoing(_, _, _)).Times(AnyNumber());
+  EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
+  auto local_id = storage.GetEntry("foo");
+  auto initial = GetEntry("foo")->value;
+
+  // without history, only the current value is available
+  EXPECT_EQ(initial, storage.GetEntryValueAt(local_id, initial->time()));
+  EXPECT_EQ(nullptr, storage.GetEntryValueAt(local_id, initial->time() - 1));
+
+  storage.SetEntryHistory(local_id, 10);
+  uint64_t time = initial->time();
+  storage.SetEntryValue("foo", Value::MakeBoolean(false, time + 10));
+  storage.SetEntryValue("foo", Value::MakeBoolean(true, time + 20));
+
+  EXPECT_EQ(*initial, *storage.GetEntryValueAt(local_id, time + 5));
+  EXPECT_EQ(*Value::MakeBoolean(false, time + 10),
+            *storage.GetEntryValueAt(local_id, time + 15));
+  EXPECT_EQ(3u, storage.GetEntryHistory(local_id, 0).size());
+  EXPECT_EQ(1u, storage.GetEntryHistory(local_id, time + 20).size());
+
+  // deletion is recorded; earlier values are kept
+  storage.DeleteEntry("foo");
+  EXPECT_EQ(nullptr, storage.GetEntryValueAt(local_id, UINT64_MAX));
+  EXPECT_EQ(*Value::MakeBoolean(false, time + 10),
+            *storage.GetEntryValueAt(local_id, time + 15));
+  EXPECT_EQ(4u, storage.GetEntryHistory(local_id, 0).size());
+
+  storage.SetEntryHistory(local_id, 0);
+  EXPECT_TRUE(storage.GetEntryHistory(local_id, 0).empty());
+}
+
 TEST_P(StorageTestEmpty, SetEntryFlagsNew) {
   // flags setting doesn't create an entry
   storage.SetEntryFlags("foo", 0u);
@@ -546,6 +646,28 @@ TEST_P(StorageTestPopulated, GetEntryInfoPrefixTypes) {
   EXPECT_EQ(NT_BOOLEAN, info[0].type);
 }
 
+TEST_P(StorageTestPopulated, GetEntriesPrefixBoundary) {
+  EXPECT_CALL(dispatcher, QueueOutgoing(_, _, _)).Times(AnyNumber());
+  EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
+  storage.SetEntryTypeValue("fo", Value::MakeDouble(1.0));
+  storage.SetEntryTypeValue("fon", Value::MakeDouble(1.0));
+  storage.SetEntryTypeValue("fop", Value::MakeDouble(1.0));
+  storage.GetEntry("foo3");  // no value
+
+  // results are in name order
+  auto ids = storage.GetEntries("foo", 0);
+  ASSERT_EQ(2u, ids.size());
+  EXPECT_EQ("foo", storage.GetEntryName(ids[0]));
+  EXPECT_EQ("foo2", storage.GetEntryName(ids[1]));
+
+  auto info = storage.GetEntryInfo(0, "fo", NT_DOUBLE);
+  ASSERT_EQ(4u, info.size());
+  EXPECT_EQ("fo", info[0].name);
+  EXPECT_EQ("fon", info[1].name);
+  EXPECT_EQ("foo2", info[2].name);
+  EXPECT_EQ("fop", info[3].name);
+}
+
 TEST_P(StorageTestPersistent, SavePersistentEmpty) {
   wpi::SmallString<256> buf;
   wpi::raw_svector_ostream oss(buf);
@@ -613,6 +735,167 @@ TEST_P(StorageTestPersistent, SavePersistent) {
   ASSERT_EQ("", line);
 }
 
+TEST_P(StorageTestPersistent, SavePersistentBinary) {
+  for (auto& i : entries()) i.getValue()->flags = NT_PERSISTENT;
+  wpi::SmallString<256> buf;
+  wpi::raw_svector_ostream oss(buf);
+  storage.SavePersistentBinary(oss, false);
+  ASSERT_TRUE(Storage::IsBinaryFormat(oss.str()));
+
+  // load into an empty storage; should be identical
+  EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
+  Storage storage2(notifier, rpc_server, logger);
+  MockLoadWarn warn;
+  auto warn_func = [&](size_t line, const char* msg) { warn.Warn(line, msg); };
+  EXPECT_TRUE(storage2.LoadEntriesBinary(oss.str(), "", true, warn_func));
+  EXPECT_EQ(entries().size(), storage2.GetEntries("", 0).size());
+  for (auto& i : entries()) {
+    auto value = storage2.GetEntryValue(i.getKey());
+    ASSERT_TRUE(value) << i.getKey().str();
+    EXPECT_EQ(*i.getValue()->value, *value) << i.getKey().str();
+    EXPECT_EQ(NT_PERSISTENT, storage2.GetEntryFlags(i.getKey()));
+  }
+
+  // prefix
+  Storage storage3(notifier, rpc_server, logger);
+  EXPECT_TRUE(
+      storage3.LoadEntriesBinary(oss.str(), "double/", false, warn_func));
+  EXPECT_EQ(3u, storage3.GetEntries("", 0).size());
+  EXPECT_EQ(0u, storage3.GetEntryFlags("double/big"));
+}
+
+TEST_P(StorageTestPersistent, LoadPersistentBinaryCorrupt) {
+  for (auto& i : entries()) i.getValue()->flags = NT_PERSISTENT;
+  wpi::SmallString<256> buf;
+  wpi::raw_svector_ostream oss(buf);
+  storage.SavePersistentBinary(oss, false);
+
+  Storage storage2(notifier, rpc_server, logger);
+  MockLoadWarn warn;
+  auto warn_func = [&](size_t line, const char* msg) { warn.Warn(line, msg); };
+
+  std::string data = oss.str();
+  data[data.size() / 2] ^= 0x40;
+  EXPECT_CALL(warn, Warn(0, wpi::StringRef("binary file checksum mismatch")));
+  EXPECT_FALSE(storage2.LoadEntriesBinary(data, "", true, warn_func));
+
+  EXPECT_CALL(warn, Warn(0, wpi::StringRef("binary file truncated")));
+  EXPECT_FALSE(storage2.LoadEntriesBinary(oss.str().drop_back(), "", true,
+                                          warn_func));
+  EXPECT_TRUE(storage2.GetEntries("", 0).empty());
+}
+
+TEST_P(StorageTestPersistent, LoadPersistentBinaryBadLength) {
+  // a single entry whose name length runs past the end of the data
+  std::string entry{"\x01\xfe\xff\xff\xff\x00\x00\x00", 8};
+  uint32_t crc = 0xffffffff;
+  for (unsigned char c : entry) {
+    crc ^= c;
+    for (int k = 0; k < 8; ++k)
+      crc = (crc & 1) ? 0xedb88320 ^ (crc >> 1) : crc >> 1;
+  }
+  crc ^= 0xffffffff;
+  std::string data{"\x89NTB\x01\x00\x00\x00\x01\x00\x00\x00", 12};
+  for (int i = 0; i < 4; ++i) data.push_back(static_cast<char>(crc >> (8 * i)));
+  data.push_back(static_cast<char>(entry.size()));
+  data.append(7, '\0');
+  data += entry;
+
+  Storage storage2(notifier, rpc_server, logger);
+  MockLoadWarn warn;
+  auto warn_func = [&](size_t line, const char* msg) { warn.Warn(line, msg); };
+  EXPECT_CALL(warn, Warn(1, wpi::StringRef("unexpected end of file")));
+  EXPECT_FALSE(storage2.LoadEntriesBinary(data, "", true, warn_func));
+  EXPECT_TRUE(storage2.GetEntries("", 0).empty());
+}
+
+TEST_P(StorageTestPersistent, SavePersistentJournal) {
+  std::string fn = "StorageTestJournal.ini";
+  std::string jfn = fn + ".journal";
+  for (auto& i : entries()) i.getValue()->flags = NT_PERSISTENT;
+  storage.SetPersistentJournal(true);
+  EXPECT_CALL(dispatcher, QueueOutgoing(_, _, _)).Times(AnyNumber());
+  EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
+
+  // first save compacts (writes the persistent file and starts the journal)
+  storage.SetEntryValue("double/zero", Value::MakeDouble(2.0));
+  EXPECT_EQ(nullptr, storage.SavePersistent(fn, true));
+  EXPECT_EQ(nullptr, storage.SavePersistent(fn, false));
+  wpi::sys::fs::file_status status;
+  ASSERT_FALSE(wpi::sys::fs::status(jfn, status));
+  uint64_t empty_size = status.getSize();
+
+  // later saves append changes
+  storage.SetEntryValue("double/neg", Value::MakeDouble(5.0));
+  storage.SetEntryFlags("string/normal", 0);
+  storage.DeleteEntry("raw/normal");
+  storage.SetEntryTypeValue("added", Value::MakeString("new"));
+  storage.SetEntryFlags("added", NT_PERSISTENT);
+  EXPECT_EQ(nullptr, storage.SavePersistent(fn, true));
+  ASSERT_FALSE(wpi::sys::fs::status(jfn, status));
+  EXPECT_GT(status.getSize(), empty_size);
+
+  // no changes, nothing appended
+  EXPECT_EQ(nullptr, storage.SavePersistent(fn, true));
+  uint64_t size = status.getSize();
+  ASSERT_FALSE(wpi::sys::fs::status(jfn, status));
+  EXPECT_EQ(size, status.getSize());
+
+  Storage storage2(notifier, rpc_server, logger);
+  MockLoadWarn warn;
+  auto warn_func = [&](size_t line, const char* msg) { warn.Warn(line, msg); };
+  EXPECT_EQ(nullptr, storage2.LoadPersistent(fn, warn_func));
+  // all but the one that is no longer persistent
+  EXPECT_EQ(storage.GetEntries("", 0).size() - 1,
+            storage2.GetEntries("", 0).size());
+  EXPECT_EQ(*Value::MakeDouble(2.0), *storage2.GetEntryValue("double/zero"));
+  EXPECT_EQ(*Value::MakeDouble(5.0), *storage2.GetEntryValue("double/neg"));
+  EXPECT_EQ(*Value::MakeString("new"), *storage2.GetEntryValue("added"));
+  EXPECT_FALSE(storage2.GetEntryValue("string/normal"));
+  EXPECT_FALSE(storage2.GetEntryValue("raw/normal"));
+
+  std::remove(fn.c_str());
+  std::remove(jfn.c_str());
+  std::remove((fn + ".bak").c_str());
+  std::remove((jfn + ".bak").c_str());
+}
+
+TEST_P(StorageTestPersistent, SavePersistentJournalToggle) {
+  std::string fn = "StorageTestJournalToggle.ini";
+  std::string jfn = fn + ".journal";
+  for (auto& i : entries()) i.getValue()->flags = NT_PERSISTENT;
+  EXPECT_CALL(dispatcher, QueueOutgoing(_, _, _)).Times(AnyNumber());
+  EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
+
+  // periodic saves (as from the dispatch thread) while the journal is
+  // enabled and disabled
+  std::atomic_bool done{false};
+  std::thread saver([&] {
+    for (int i = 0; !done; ++i) {
+      storage.SetEntryValue("double/zero", Value::MakeDouble(i));
+      storage.SavePersistent(fn, true);
+    }
+  });
+  for (int i = 0; i < 50; ++i) {
+    storage.SetPersistentJournal(true);
+    std::this_thread::yield();
+    storage.SetPersistentJournal(false);
+  }
+  done = true;
+  saver.join();
+
+  // once disabled, a save must not reopen the journal
+  EXPECT_EQ(nullptr, storage.SavePersistent(fn, true));
+  EXPECT_EQ(nullptr, storage.SavePersistent(fn, false));
+  wpi::sys::fs::file_status status;
+  EXPECT_TRUE(static_cast<bool>(wpi::sys::fs::status(jfn, status)));
+
+  std::remove(fn.c_str());
+  std::remove(jfn.c_str());
+  std::remove((fn + ".bak").c_str());
+  std::remove((jfn + ".bak").c_str());
+}
+
 TEST_P(StorageTestEmpty, LoadPersistentBadHeader) {
   MockLoadWarn warn;
   auto warn_func = [&](size_t line, const char* msg) { warn.Warn(line, msg); };
@@ -959,6 +1242,64 @@ TEST_P(StorageTestPopulateOne, DeletedEntryFlags) {
   EXPECT_EQ(storage.GetEntryFlags(handle), 0u);
 }
 
+TEST_P(StorageTestPopulated, SendPeriodPrefix) {
+  EXPECT_CALL(dispatcher, QueueOutgoing(_, _, _)).Times(AnyNumber());
+  EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
+  storage.SetPrefixSendPeriod("foo", 10);
+  EXPECT_EQ(10u, GetEntry("foo")->send_period);
+  EXPECT_EQ(10u, GetEntry("foo2")->send_period);
+  EXPECT_EQ(Message::kSendDefault, GetEntry("bar")->send_period);
+
+  // longest prefix wins
+  storage.SetPrefixSendPeriod("foo2", 5);
+  EXPECT_EQ(10u, GetEntry("foo")->send_period);
+  EXPECT_EQ(5u, GetEntry("foo2")->send_period);
+
+  // new entries pick up prefix hints
+  storage.SetEntryTypeValue("foo3", Value::MakeBoolean(true));
+  EXPECT_EQ(10u, GetEntry("foo3")->send_period);
+
+  // entry hints take precedence over prefix hints
+  unsigned int foo = GetEntry("foo")->local_id;
+  storage.SetEntrySendPeriod(foo, 0);
+  storage.SetPrefixSendPeriod("foo", Message::kSendDefault);
+  EXPECT_EQ(0u, storage.GetEntrySendPeriod(foo));
+  EXPECT_EQ(5u, GetEntry("foo2")->send_period);
+  EXPECT_EQ(Message::kSendDefault, GetEntry("foo3")->send_period);
+
+  // removing the entry hint falls back to the prefix hints
+  storage.SetEntrySendPeriod(foo, Message::kSendDefault);
+  EXPECT_EQ(Message::kSendDefault, storage.GetEntrySendPeriod(foo));
+}
+
+TEST_P(StorageTestPopulated, SendPeriodMessage) {
+  storage.SetPrefixSendPeriod("foo", 20);
+  auto value = Value::MakeDouble(1.0);
+
+  // client shouldn't send an update as id not assigned yet
+  std::shared_ptr<Message> msg;
+  if (GetParam()) {
+    EXPECT_CALL(dispatcher,
+                QueueOutgoing(MessageEq(Message::EntryUpdate(1, 2, value)),
+                              IsNull(), IsNull()))
+        .WillOnce(SaveArg<0>(&msg));
+  }
+  EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
+  storage.SetEntryTypeValue("foo2", value);
+  if (GetParam()) {
+    ASSERT_TRUE(msg);
+    EXPECT_EQ(20u, msg->send_period());
+  }
+
+  // type change results in an assign message, which is also hinted
+  EXPECT_CALL(dispatcher, QueueOutgoing(_, IsNull(), IsNull()))
+      .WillOnce(SaveArg<0>(&msg));
+  storage.SetEntryTypeValue("foo2", Value::MakeBoolean(true));
+  ASSERT_TRUE(msg);
+  EXPECT_TRUE(msg->Is(Message::kEntryAssign));
+  EXPECT_EQ(20u, msg->send_period());
+}
+
 TEST_P(StorageTestPopulateOne, DeletedDeleteAllEntries) {
   EXPECT_CALL(dispatcher, QueueOutgoing(_, _, _)).Times(AnyNumber());
   EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
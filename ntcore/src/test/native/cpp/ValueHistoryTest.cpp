@@ -0,0 +1,110 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+#include "TestPrinters.h"
+#include "ValueHistory.h"
+#include "gtest/gtest.h"
+
+namespace nt {
+
+class ValueHistoryTest : public ::testing::Test {};
+
+TEST_F(ValueHistoryTest, Empty) {
+  ValueHistory history(4);
+  EXPECT_EQ(0u, history.size());
+  EXPECT_EQ(nullptr, history.GetAt(100));
+  EXPECT_TRUE(history.GetSince(0).empty());
+}
+
+TEST_F(ValueHistoryTest, DoubleAt) {
+  ValueHistory history(4);
+  history.Add(Value::MakeDouble(1.0, 10));
+  history.Add(Value::MakeDouble(2.0, 20));
+  history.Add(Value::MakeDouble(3.0, 30));
+
+  EXPECT_EQ(nullptr, history.GetAt(9));
+  EXPECT_EQ(*Value::MakeDouble(1.0, 10), *history.GetAt(10));
+  EXPECT_EQ(*Value::MakeDouble(1.0, 10), *history.GetAt(19));
+  EXPECT_EQ(*Value::MakeDouble(2.0, 20), *history.GetAt(20));
+  EXPECT_EQ(*Value::MakeDouble(3.0, 30), *history.GetAt(1000));
+  EXPECT_EQ(30u, history.GetAt(1000)->time());
+}
+
+TEST_F(ValueHistoryTest, Capacity) {
+  ValueHistory history(2);
+  history.Add(Value::MakeBoolean(true, 10));
+  history.Add(Value::MakeBoolean(false, 20));
+  history.Add(Value::MakeBoolean(true, 30));
+  EXPECT_EQ(2u, history.size());
+  // oldest sample dropped
+  EXPECT_EQ(nullptr, history.GetAt(15));
+  EXPECT_EQ(*Value::MakeBoolean(false, 20), *history.GetAt(25));
+
+  history.set_capacity(1);
+  EXPECT_EQ(1u, history.size());
+  EXPECT_EQ(nullptr, history.GetAt(25));
+}
+
+TEST_F(ValueHistoryTest, Since) {
+  ValueHistory history(8);
+  history.Add(Value::MakeString("a", 10));
+  history.Add(Value::MakeString("b", 20));
+  history.Add(Value::MakeString("c", 30));
+
+  auto values = history.GetSince(20);
+  ASSERT_EQ(2u, values.size());
+  EXPECT_EQ("b", values[0]->GetString());
+  EXPECT_EQ("c", values[1]->GetString());
+  EXPECT_EQ(3u, history.GetSince(0).size());
+  EXPECT_TRUE(history.GetSince(31).empty());
+}
+
+TEST_F(ValueHistoryTest, TypeChange) {
+  ValueHistory history(8);
+  history.Add(Value::MakeDouble(1.0, 10));
+  history.Add(Value::MakeString("a", 20));
+  EXPECT_EQ(1u, history.size());
+  EXPECT_EQ(nullptr, history.GetAt(15));
+  EXPECT_EQ("a", history.GetAt(20)->GetString());
+}
+
+TEST_F(ValueHistoryTest, OutOfOrder) {
+  ValueHistory history(8);
+  history.Add(Value::MakeDouble(1.0, 20));
+  history.Add(Value::MakeDouble(2.0, 10));
+  // recorded with the previous time
+  EXPECT_EQ(nullptr, history.GetAt(15));
+  EXPECT_EQ(2.0, history.GetAt(20)->GetDouble());
+}
+
+TEST_F(ValueHistoryTest, DeleteAt) {
+  ValueHistory history(8);
+  history.Add(Value::MakeDouble(1.0, 10));
+  history.AddDeleted(20);
+  history.Add(Value::MakeDouble(2.0, 30));
+
+  EXPECT_EQ(*Value::MakeDouble(1.0, 10), *history.GetAt(15));
+  EXPECT_EQ(nullptr, history.GetAt(20));
+  EXPECT_EQ(nullptr, history.GetAt(25));
+  EXPECT_EQ(*Value::MakeDouble(2.0, 30), *history.GetAt(30));
+
+  auto values = history.GetSince(15);
+  ASSERT_EQ(2u, values.size());
+  EXPECT_EQ(nullptr, values[0]);
+  EXPECT_EQ(2.0, values[1]->GetDouble());
+}
+
+TEST_F(ValueHistoryTest, DeleteAtString) {
+  ValueHistory history(8);
+  history.Add(Value::MakeString("a", 10));
+  history.AddDeleted(20);
+  EXPECT_EQ("a", history.GetAt(15)->GetString());
+  EXPECT_EQ(nullptr, history.GetAt(25));
+  EXPECT_EQ(2u, history.GetSince(0).size());
+}
+
+}  // namespace nt
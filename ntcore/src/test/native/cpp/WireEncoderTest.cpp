@@ -9,6 +9,7 @@
 #include <climits>
 #include <string>
 
+#include <wpi/SmallVector.h>
 #include <wpi/StringRef.h>
 
 #include "TestPrinters.h"
@@ -490,4 +491,25 @@ TEST_F(WireEncoderTest, WriteString3) {
   EXPECT_EQ('x', e.data()[65539]);
 }
 
+TEST_F(WireEncoderTest, ZeroCopyString) {
+  WireEncoder e(0x0300u);
+  e.set_zero_copy_threshold(5);
+  std::string longstr(300, 'x');
+  e.Write8(1);
+  e.WriteString("hi");
+  e.WriteString(longstr);
+  e.Write8(2);
+  ASSERT_EQ(nullptr, e.error());
+  ASSERT_EQ(1u + 3u + 2u + 300u + 1u, e.size());
+
+  wpi::SmallVector<wpi::StringRef, 4> bufs;
+  e.GetBuffers(bufs);
+  ASSERT_EQ(3u, bufs.size());
+  ASSERT_EQ(wpi::StringRef("\x01\x02hi\xac\x02", 6), bufs[0]);
+  // refers to original data
+  ASSERT_EQ(longstr.data(), bufs[1].data());
+  ASSERT_EQ(300u, bufs[1].size());
+  ASSERT_EQ(wpi::StringRef("\x02", 1), bufs[2]);
+}
+
 }  // namespace nt
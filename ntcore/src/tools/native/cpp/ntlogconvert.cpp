@@ -0,0 +1,52 @@
+/*----------------------------------------------------------------------------*/
+/* Copyright (c) 2018 FIRST. All Rights Reserved.                             */
+/* Open Source Software - may be modified and shared by FRC teams. The code   */
+/* must be accompanied by the FIRST BSD license file in the root directory of */
+/* the project.                                                               */
+/*----------------------------------------------------------------------------*/
+
+// Converts a NetworkTables data log (see nt::StartDataLog()) to CSV or JSON.
+
+#include <wpi/StringRef.h>
+#include <wpi/raw_ostream.h>
+
+#include "ntcore_cpp.h"
+
+static void Usage(const char* argv0) {
+  wpi::errs() << "Usage: " << argv0 << " [--json] <log file> <output file>\n"
+              << "  --json    write JSON instead of CSV\n";
+}
+
+int main(int argc, char** argv) {
+  NT_DataLogFormat format = NT_DATALOG_CSV;
+  const char* filenames[2];
+  int num_filenames = 0;
+  for (int i = 1; i < argc; ++i) {
+    wpi::StringRef arg{argv[i]};
+    if (arg == "--json") {
+      format = NT_DATALOG_JSON;
+    } else if (arg == "--csv") {
+      format = NT_DATALOG_CSV;
+    } else if (arg.startswith("-") || num_filenames == 2) {
+      Usage(argv[0]);
+      return 1;
+    } else {
+      filenames[num_filenames++] = argv[i];
+    }
+  }
+  if (num_filenames != 2) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  const char* err = nt::ConvertDataLog(
+      filenames[0], filenames[1], format, [&](size_t record, const char* msg) {
+        wpi::errs() << filenames[0] << ": record " << record << ": " << msg
+                    << '\n';
+      });
+  if (err) {
+    wpi::errs() << filenames[0] << ": " << err << '\n';
+    return 1;
+  }
+  return 0;
+}
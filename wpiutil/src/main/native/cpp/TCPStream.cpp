@@ -31,10 +31,21 @@
 #else
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif
 
+#include <algorithm>
 #include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include "wpi/SmallVector.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
 
 using namespace wpi;
 
@@ -111,6 +122,91 @@ size_t TCPStream::send(const char* buffer, size_t len, Error* err) {
   return static_cast<size_t>(rv);
 }
 
+size_t TCPStream::sendv(ArrayRef<StringRef> bufs, Error* err) {
+  if (m_sd < 0) {
+    *err = kConnectionClosed;
+    return 0;
+  }
+#ifdef _WIN32
+  SmallVector<WSABUF, 16> wsaBufs;
+  for (auto buf : bufs) {
+    if (buf.empty()) continue;
+    WSABUF wsaBuf;
+    wsaBuf.buf = const_cast<char*>(buf.data());
+    wsaBuf.len = (ULONG)buf.size();
+    wsaBufs.push_back(wsaBuf);
+  }
+
+  // WSASend() may send only part of the data, so continue where it left off
+  size_t total = 0;
+  size_t i = 0;
+  while (i < wsaBufs.size()) {
+    DWORD rv;
+    if (WSASend(m_sd, &wsaBufs[i], (DWORD)(wsaBufs.size() - i), &rv, 0,
+                nullptr, nullptr) == SOCKET_ERROR) {
+      if (WSAGetLastError() == WSAEWOULDBLOCK && m_blocking) {
+        Sleep(1);
+        continue;
+      }
+      *err = WSAGetLastError() == WSAEWOULDBLOCK ? kWouldBlock
+                                                 : kConnectionReset;
+      return 0;
+    }
+    total += rv;
+    size_t n = rv;
+    while (i < wsaBufs.size() && n >= wsaBufs[i].len) n -= wsaBufs[i++].len;
+    if (n > 0) {
+      wsaBufs[i].buf += n;
+      wsaBufs[i].len -= static_cast<ULONG>(n);
+    }
+  }
+  return total;
+#else
+  SmallVector<iovec, 16> iov;
+  for (auto buf : bufs) {
+    if (buf.empty()) continue;
+    iovec v;
+    v.iov_base = const_cast<char*>(buf.data());
+    v.iov_len = buf.size();
+    iov.push_back(v);
+  }
+
+  // sendmsg() may send only part of the data (or IOV_MAX limits how many
+  // buffers can be passed at once), so continue where it left off
+  size_t total = 0;
+  size_t i = 0;
+  while (i < iov.size()) {
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov[i];
+    msg.msg_iovlen = std::min<size_t>(iov.size() - i, IOV_MAX);
+#ifdef MSG_NOSIGNAL
+    // disable SIGPIPE on Linux
+    ssize_t rv = ::sendmsg(m_sd, &msg, MSG_NOSIGNAL);
+#else
+    ssize_t rv = ::sendmsg(m_sd, &msg, 0);
+#endif
+    if (rv < 0) {
+      if (errno == EINTR) continue;
+      if (!m_blocking && (errno == EAGAIN || errno == EWOULDBLOCK))
+        *err = kWouldBlock;
+      else
+        *err = kConnectionReset;
+      // report the error even if part of the data was sent
+      return 0;
+    }
+    total += rv;
+    size_t n = rv;
+    while (i < iov.size() && n >= iov[i].iov_len) n -= iov[i++].iov_len;
+    if (n > 0) {
+      iov[i].iov_base = static_cast<char*>(iov[i].iov_base) + n;
+      iov[i].iov_len -= n;
+    }
+  }
+  return total;
+#endif
+}
+
 size_t TCPStream::receive(char* buffer, size_t len, Error* err, int timeout) {
   if (m_sd < 0) {
     *err = kConnectionClosed;
@@ -175,6 +271,23 @@ void TCPStream::setNoDelay() {
              sizeof optval);
 }
 
+bool TCPStream::setNagle(bool enabled) {
+  if (m_sd < 0) return false;
+  int optval = enabled ? 0 : 1;
+  return setsockopt(m_sd, IPPROTO_TCP, TCP_NODELAY,
+                    reinterpret_cast<char*>(&optval), sizeof optval) == 0;
+}
+
+bool TCPStream::setCork(bool enabled) {
+#ifdef TCP_CORK
+  if (m_sd < 0) return false;
+  int optval = enabled ? 1 : 0;
+  return setsockopt(m_sd, IPPROTO_TCP, TCP_CORK, &optval, sizeof optval) == 0;
+#else
+  return false;
+#endif
+}
+
 bool TCPStream::setBlocking(bool enabled) {
   if (m_sd < 0) return true;  // silently accept
 #ifdef _WIN32
@@ -189,11 +302,24 @@ bool TCPStream::setBlocking(bool enabled) {
     flags |= O_NONBLOCK;
   if (fcntl(m_sd, F_SETFL, flags) < 0) return false;
 #endif
+  m_blocking = enabled;
   return true;
 }
 
 int TCPStream::getNativeHandle() const { return m_sd; }
 
+unsigned int TCPStream::getRoundTripTime() const {
+#ifdef __linux__
+  if (m_sd < 0) return 0;
+  struct tcp_info info;
+  socklen_t len = sizeof(info);
+  if (getsockopt(m_sd, IPPROTO_TCP, TCP_INFO, &info, &len) != 0) return 0;
+  return info.tcpi_rtt;
+#else
+  return 0;
+#endif
+}
+
 bool TCPStream::WaitForReadEvent(int timeout) {
   fd_set sdset;
   struct timeval tv;
@@ -10,6 +10,7 @@
 
 #include <cstddef>
 
+#include "wpi/ArrayRef.h"
 #include "wpi/StringRef.h"
 
 namespace wpi {
@@ -27,6 +28,23 @@ class NetworkStream {
   };
 
   virtual size_t send(const char* buffer, size_t len, Error* err) = 0;
+
+  // Sends multiple buffers in order (a gather write).  The default
+  // implementation calls send() for each buffer; implementations should
+  // override this to send with a single system call.  Returns the total
+  // number of bytes sent, or 0 on error (even if part of the data was sent).
+  virtual size_t sendv(ArrayRef<StringRef> bufs, Error* err) {
+    size_t total = 0;
+    for (auto buf : bufs) {
+      while (!buf.empty()) {
+        size_t rv = send(buf.data(), buf.size(), err);
+        if (rv == 0) return 0;
+        total += rv;
+        buf = buf.drop_front(rv);
+      }
+    }
+    return total;
+  }
   virtual size_t receive(char* buffer, size_t len, Error* err,
                          int timeout = 0) = 0;
   virtual void close() = 0;
@@ -35,10 +53,23 @@ class NetworkStream {
   virtual int getPeerPort() const = 0;
   virtual void setNoDelay() = 0;
 
+  // Re-enables (or disables) the Nagle algorithm after setNoDelay().
+  // Returns false on failure or if not supported.
+  virtual bool setNagle(bool enabled) { return false; }
+
+  // Corks (or uncorks) the stream: while corked, partial segments are held
+  // back so consecutive sends are combined; uncorking sends anything held.
+  // Returns false on failure or if not supported.
+  virtual bool setCork(bool enabled) { return false; }
+
   // returns false on failure
   virtual bool setBlocking(bool enabled) = 0;
   virtual int getNativeHandle() const = 0;
 
+  // Returns the smoothed round trip time estimate, in microseconds, or 0 if
+  // not available.
+  virtual unsigned int getRoundTripTime() const { return 0; }
+
   NetworkStream(const NetworkStream&) = delete;
   NetworkStream& operator=(const NetworkStream&) = delete;
 };
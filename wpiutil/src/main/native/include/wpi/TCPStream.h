@@ -46,6 +46,7 @@ class TCPStream : public NetworkStream {
   ~TCPStream();
 
   size_t send(const char* buffer, size_t len, Error* err) override;
+  size_t sendv(ArrayRef<StringRef> bufs, Error* err) override;
   size_t receive(char* buffer, size_t len, Error* err,
                  int timeout = 0) override;
   void close() override;
@@ -53,8 +54,11 @@ class TCPStream : public NetworkStream {
   StringRef getPeerIP() const override;
   int getPeerPort() const override;
   void setNoDelay() override;
+  bool setNagle(bool enabled) override;
+  bool setCork(bool enabled) override;
   bool setBlocking(bool enabled) override;
   int getNativeHandle() const override;
+  unsigned int getRoundTripTime() const override;
 
   TCPStream(const TCPStream& stream) = delete;
   TCPStream& operator=(const TCPStream&) = delete;